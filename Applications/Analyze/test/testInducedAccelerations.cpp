@@ -30,6 +30,11 @@
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <OpenSim/Analyses/InducedAccelerationsSolver.h>
 
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+
 using namespace OpenSim;
 using namespace SimTK;
 using namespace std;
@@ -37,6 +42,7 @@ using namespace std;
 // Prototypes
 void testDoublePendulumWithSolver();
 void testDoublePendulum();
+void testContributorsTogetherWithContact();
 Vector calcDoublePendulumUdot(const Model &model, State &s, double Torq1, double Torq2, bool gravity, bool velocity);
 
 int main()
@@ -57,6 +63,8 @@ int main()
             std::vector<double>(result1.getSmallestNumberOfStates(), 0.15),
             __FILE__, __LINE__, "Induced Accelerations of Running failed");
         cout << "Induced Accelerations of Running passed\n" << endl;
+
+        testContributorsTogetherWithContact();
     }
     catch (const OpenSim::Exception& e) {
         e.print(cerr);
@@ -251,3 +259,63 @@ Vector calcDoublePendulumUdot(const Model &model, State &s, double Torq1, double
 
     return s.getUDot();
 }
+
+// Without constraint reactions to report, the accelerations induced by all
+// contributors are solved together. Compare them to those solved one
+// contributor at a time (the results of subject02_Setup_IAA_02_232.xml, which
+// reports constraint reactions), during stance, when the foot contact
+// constraints are on.
+void testContributorsTogetherWithContact()
+{
+    // The contact constraints were on during some of the frames.
+    Storage reactions("ResultsInducedAccelerations/subject02_running_arms_"
+            "InducedAccelerations_induced_constraint_reactions.sto");
+    double maxReaction = 0;
+    for (int i = 0; i < reactions.getSize(); ++i) {
+        const Array<double>& data = reactions.getStateVector(i)->getData();
+        for (int j = 0; j < data.getSize(); ++j)
+            maxReaction = std::max(maxReaction, std::abs(data[j]));
+    }
+    ASSERT(maxReaction > 0, __FILE__, __LINE__,
+        "The contact constraints of running were never on.");
+
+    std::string setup;
+    {
+        std::ifstream file("subject02_Setup_IAA_02_232.xml");
+        std::stringstream contents;
+        contents << file.rdbuf();
+        setup = contents.str();
+    }
+    auto replace = [&](const std::string& from, const std::string& to) {
+        const auto pos = setup.find(from);
+        ASSERT(pos != std::string::npos, __FILE__, __LINE__,
+            "Could not find '" + from + "' in the setup file.");
+        setup.replace(pos, from.size(), to);
+    };
+    replace("<report_constraint_reactions> true",
+            "<report_constraint_reactions> false");
+    replace("<results_directory> ResultsInducedAccelerations ",
+            "<results_directory> ResultsInducedAccelerationsTogether ");
+    const std::string setupFile =
+            "subject02_Setup_IAA_02_232_contributors_together.xml";
+    {
+        std::ofstream file(setupFile);
+        file << setup;
+    }
+
+    AnalyzeTool analyze(setupFile);
+    analyze.run();
+    Storage together("ResultsInducedAccelerationsTogether/subject02_running_"
+            "arms_InducedAccelerations_center_of_mass.sto");
+    Storage separate("ResultsInducedAccelerations/subject02_running_arms_"
+            "InducedAccelerations_center_of_mass.sto");
+    ASSERT(together.getSize() == separate.getSize(), __FILE__, __LINE__,
+        "Induced Accelerations of Running solved together has a different "
+        "number of frames.");
+    CHECK_STORAGE_AGAINST_STANDARD(together, separate,
+        std::vector<double>(separate.getSmallestNumberOfStates(), 1e-6),
+        __FILE__, __LINE__,
+        "Induced Accelerations of Running solved together failed");
+    cout << "Induced Accelerations of Running solved together passed\n"
+         << endl;
+}
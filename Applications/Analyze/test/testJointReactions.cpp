@@ -25,9 +25,14 @@
 #include <OpenSim/OpenSim.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 
+#include <fstream>
+#include <sstream>
+
 using namespace OpenSim;
 using namespace std;
 
+void testKinematicsWithStepInterval();
+
 int main()
 {
     try {
@@ -49,6 +54,21 @@ int main()
             "DoublePendulum3D failed");
         cout << "DoublePendulum3D passed" << endl;
 
+        // Analyzing the frames on 4 threads gives the same results.
+        AnalyzeTool analyzeThreads("DoublePendulum3D_Setup_JointReaction.xml");
+        analyzeThreads.setName("DoublePendulum3D_threads");
+        analyzeThreads.setNumThreads(4);
+        analyzeThreads.run();
+        Storage resultThreads(
+            "DoublePendulum3D_threads_JointReaction_ReactionLoads.sto");
+        ASSERT(resultThreads.getSize() == result2.getSize());
+        CHECK_STORAGE_AGAINST_STANDARD(resultThreads, result2,
+            std::vector<double>(result2.getSmallestNumberOfStates(), 1e-12), __FILE__, __LINE__,
+            "DoublePendulum3D with 4 threads failed");
+        cout << "DoublePendulum3D with 4 threads passed" << endl;
+
+        testKinematicsWithStepInterval();
+
         AnalyzeTool analyze3("SinglePin_Setup_JointReaction_FrameKeyword.xml");
         analyze.run();
         Storage result3("SinglePin_JointReaction_ReactionLoads.sto"),
@@ -74,3 +94,66 @@ int main()
     cout << "Done" << endl;
     return 0;
 }
+
+// Kinematics and BodyKinematics that record every third frame give the same
+// results on 7 threads. The frames between the first and the last frame do not
+// divide evenly among the threads, and some of the blocks of frames start at a
+// frame that the step interval skips.
+void testKinematicsWithStepInterval()
+{
+    std::string setup;
+    {
+        std::ifstream file("DoublePendulum3D_Setup_JointReaction.xml");
+        std::stringstream contents;
+        contents << file.rdbuf();
+        setup = contents.str();
+    }
+    const auto analyses = setup.find("<objects>", setup.find("<AnalysisSet"));
+    ASSERT(analyses != std::string::npos, __FILE__, __LINE__,
+        "Could not find the analyses in the setup file.");
+    setup.insert(analyses + std::string("<objects>").size(),
+        "<Kinematics name=\"Kinematics\">"
+        "<step_interval>3</step_interval></Kinematics>"
+        "<BodyKinematics name=\"BodyKinematics\">"
+        "<step_interval>3</step_interval></BodyKinematics>");
+    const std::string setupFile =
+        "DoublePendulum3D_Setup_Kinematics_step_interval.xml";
+    {
+        std::ofstream file(setupFile);
+        file << setup;
+    }
+
+    AnalyzeTool analyze(setupFile);
+    analyze.setName("DoublePendulum3D_interval");
+    analyze.run();
+    AnalyzeTool analyzeThreads(setupFile);
+    analyzeThreads.setName("DoublePendulum3D_interval_threads");
+    analyzeThreads.setNumThreads(7);
+    analyzeThreads.run();
+
+    for (const std::string& suffix : {"Kinematics_q", "Kinematics_u",
+            "BodyKinematics_pos_global", "BodyKinematics_vel_global",
+            "JointReaction_ReactionLoads"}) {
+        Storage result("DoublePendulum3D_interval_" + suffix + ".sto");
+        Storage resultThreads(
+            "DoublePendulum3D_interval_threads_" + suffix + ".sto");
+        ASSERT(resultThreads.getSize() == result.getSize(), __FILE__,
+            __LINE__, suffix + " with 7 threads has a different number of "
+            "rows.");
+        CHECK_STORAGE_AGAINST_STANDARD(resultThreads, result,
+            std::vector<double>(result.getSmallestNumberOfStates(), 1e-12),
+            __FILE__, __LINE__, suffix + " with 7 threads failed");
+    }
+    // The first and last frames, and every third frame in between.
+    Storage states("DoublePendulum3D_states.sto");
+    const int iInitial = states.findIndex(0.0);
+    const int iFinal = states.findIndex(3.0);
+    int numRecorded = 2;
+    for (int i = iInitial + 1; i < iFinal; ++i)
+        if (i % 3 == 0) ++numRecorded;
+    Storage positions("DoublePendulum3D_interval_Kinematics_q.sto");
+    ASSERT(positions.getSize() == numRecorded, __FILE__, __LINE__,
+        "Kinematics did not record every third frame.");
+    cout << "DoublePendulum3D Kinematics with step interval and 7 threads "
+            "passed" << endl;
+}
@@ -25,6 +25,8 @@
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Tools/AnalyzeTool.h>
 #include <OpenSim/Analyses/StaticOptimization.h>
+#include <OpenSim/Analyses/StaticOptimizationTarget.h>
+#include <OpenSim/Common/GCVSplineSet.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 
 using namespace OpenSim;
@@ -40,6 +42,10 @@ void testArm26(const string& muscleModelClassName, double atol, double ftol);
 
 void testArm26DisabledMuscles();
 
+void testArm26Parallel();
+
+void testConstraintMatrix();
+
 void testLapackErrorDLASD4();
 
 void testModelWithPassiveForces();
@@ -105,6 +111,22 @@ int main()
         failures.push_back("testArm26DisabledMuscles");
     }
 
+    try {
+        testArm26Parallel();
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testArm26Parallel");
+    }
+
+    try {
+        testConstraintMatrix();
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testConstraintMatrix");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -265,4 +287,89 @@ void testArm26DisabledMuscles() {
     ASSERT_EQUAL(forces.getColumnLabels().findIndex("TRIlat"), -1);
     ASSERT_EQUAL(forces.getColumnLabels().findIndex("TRImed"), -1);
 
-}
\ No newline at end of file
+}
+
+void testArm26Parallel() {
+    // Solving the frames in parallel must give the same results as solving
+    // them one at a time: every frame starts from the same model defaults
+    // and the same (zero) initial guess on both paths.
+    AnalyzeTool serial("arm26_Setup_StaticOptimization.xml");
+    serial.setResultsDir("Results_arm26_StaticOptimization_Serial");
+    serial.run();
+
+    AnalyzeTool parallel("arm26_Setup_StaticOptimization.xml");
+    parallel.setResultsDir("Results_arm26_StaticOptimization_Parallel");
+    auto& so = dynamic_cast<StaticOptimization&>(
+            parallel.getAnalysisSet().get("StaticOptimization"));
+    so.setNumThreads(3);
+    parallel.run();
+
+    Storage serialActivations(serial.getResultsDir() +
+            "/arm26_StaticOptimization_activation.sto");
+    Storage parallelActivations(parallel.getResultsDir() +
+            "/arm26_StaticOptimization_activation.sto");
+    ASSERT_EQUAL(serialActivations.getSize(), parallelActivations.getSize());
+    CHECK_STORAGE_AGAINST_STANDARD(parallelActivations, serialActivations,
+            std::vector<double>(6, 1e-6), __FILE__, __LINE__,
+            "Arm26 parallel activations failed.");
+
+    Storage serialForces(serial.getResultsDir() +
+            "/arm26_StaticOptimization_force.sto");
+    Storage parallelForces(parallel.getResultsDir() +
+            "/arm26_StaticOptimization_force.sto");
+    ASSERT_EQUAL(serialForces.getSize(), parallelForces.getSize());
+    CHECK_STORAGE_AGAINST_STANDARD(parallelForces, serialForces,
+            std::vector<double>(6, 1e-6), __FILE__, __LINE__,
+            "Arm26 parallel forces failed.");
+}
+
+void testConstraintMatrix() {
+    // The linear constraint matrix that StaticOptimizationTarget computes
+    // from the generalized force of each actuator must match the one obtained
+    // by realizing the accelerations with one activation perturbed at a time.
+    Model model("arm26.osim");
+    SimTK::State& s = model.initSystem();
+    const auto coordinates = model.getCoordinatesInMultibodyTreeOrder();
+    const int nc = (int)coordinates.size();
+    for (int i = 0; i < nc; ++i) {
+        coordinates[i]->setValue(s, 0.3 + 0.4 * i, false);
+        coordinates[i]->setSpeedValue(s, -0.5 + 0.8 * i);
+    }
+    model.equilibrateMuscles(s);
+
+    // The target reads the desired accelerations from splines of the speeds.
+    Array<string> labels;
+    labels.append("time");
+    for (const auto& coord : coordinates) labels.append(coord->getSpeedName());
+    Storage speeds;
+    speeds.setColumnLabels(labels);
+    std::vector<double> values(nc);
+    for (int k = 0; k < 10; ++k) {
+        for (int i = 0; i < nc; ++i) values[i] = std::sin(0.1 * k * (i + 1));
+        speeds.append(0.1 * k, nc, values.data());
+    }
+    GCVSplineSet splines(5, &speeds);
+
+    const int na = model.getActuators().getSize();
+    model.setAllControllersEnabled(false);
+    for (const auto& act : model.getComponentList<ScalarActuator>())
+        act.overrideActuation(s, true);
+    StaticOptimizationTarget target(s, &model, na, nc);
+    target.setStatesStore(&speeds);
+    target.setStatesSplineSet(splines);
+    model.realizeVelocity(s);
+    SimTK::Vector parameters(na, 0.0);
+    target.prepareToOptimize(s, &parameters[0]);
+
+    SimTK::Matrix perturbed;
+    target.computeConstraintMatrixByPerturbation(s, perturbed);
+    const SimTK::Matrix& analytic = target.getConstraintMatrix();
+    ASSERT_EQUAL(perturbed.nrow(), analytic.nrow());
+    ASSERT_EQUAL(perturbed.ncol(), analytic.ncol());
+    for (int c = 0; c < perturbed.nrow(); ++c) {
+        for (int p = 0; p < perturbed.ncol(); ++p) {
+            ASSERT_EQUAL(perturbed(c, p), analytic(c, p),
+                    1e-8 * std::max(1.0, std::abs(perturbed(c, p))));
+        }
+    }
+}
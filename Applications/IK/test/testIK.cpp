@@ -26,6 +26,8 @@
 #include <OpenSim/Common/Storage.h>
 #include "OpenSim/Common/STOFileAdapter.h"
 #include "OpenSim/Common/TRCFileAdapter.h"
+#include <OpenSim/Common/LogSink.h>
+#include <OpenSim/Common/Logger.h>
 #include <OpenSim/Common/Reporter.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/OrientationsReference.h>
@@ -106,6 +108,75 @@ int main()
         failures.push_back("testInverseKinematicsGait2354_GUI_workflow");
     }
 
+    try {
+        InverseKinematicsTool ikSerial("subject01_Setup_InverseKinematics.xml");
+        ikSerial.setOutputMotionFileName("subject01_walk1_ik_serial.mot");
+        ikSerial.run();
+        InverseKinematicsTool ikParallel(
+                "subject01_Setup_InverseKinematics.xml");
+        ikParallel.setNumThreads(4);
+        ikParallel.setOutputMotionFileName("subject01_walk1_ik_parallel.mot");
+        ikParallel.run();
+        Storage serial(ikSerial.getOutputMotionFileName());
+        Storage parallel(ikParallel.getOutputMotionFileName());
+        ASSERT(serial.getSize() == parallel.getSize(), __FILE__, __LINE__,
+                "Parallel IK produced a different number of frames.");
+        // Frames are solved independently to within the solver accuracy, so
+        // the parallel result should be nearly identical to the serial one.
+        CHECK_STORAGE_AGAINST_STANDARD(parallel, serial,
+            std::vector<double>(24, 1e-2), __FILE__, __LINE__,
+            "testInverseKinematicsGait2354 parallel failed");
+        cout << "testInverseKinematicsGait2354 parallel passed" << endl;
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testInverseKinematicsGait2354_parallel");
+    }
+
+    try {
+        InverseKinematicsTool ikAssembler(
+                "subject01_Setup_InverseKinematics.xml");
+        ikAssembler.setOutputMotionFileName("subject01_walk1_ik_assembler.mot");
+        ikAssembler.run();
+        InverseKinematicsTool ikLM("subject01_Setup_InverseKinematics.xml");
+        ikLM.setSolver("levenberg_marquardt");
+        ikLM.setOutputMotionFileName("subject01_walk1_ik_lm.mot");
+        // The tool reports the Levenberg-Marquardt iterations only if the
+        // solver did not fall back to the SimTK::Assembler.
+        auto sink = std::make_shared<StringLogSink>();
+        Logger::addSink(sink);
+        ikLM.run();
+        Logger::removeSink(sink);
+        const std::string& log = sink->getString();
+        const std::string iterationsLabel =
+                "Levenberg-Marquardt iterations per frame: ";
+        const auto iterationsPos = log.find(iterationsLabel);
+        ASSERT(iterationsPos != std::string::npos, __FILE__, __LINE__,
+                "IK did not track with Levenberg-Marquardt.");
+        ASSERT(std::stod(log.substr(iterationsPos + iterationsLabel.size()))
+                > 0, __FILE__, __LINE__,
+                "Levenberg-Marquardt IK took no iterations.");
+        Storage assembler(ikAssembler.getOutputMotionFileName());
+        Storage lm(ikLM.getOutputMotionFileName());
+        ASSERT(assembler.getSize() == lm.getSize(), __FILE__, __LINE__,
+                "Levenberg-Marquardt IK produced a different number of "
+                "frames.");
+        // Both solvers minimize the same objective, so they should agree to
+        // within the solver accuracy.
+        CHECK_STORAGE_AGAINST_STANDARD(lm, assembler,
+            std::vector<double>(24, 1e-2), __FILE__, __LINE__,
+            "testInverseKinematicsGait2354 Levenberg-Marquardt failed");
+
+        ikLM.setSolver("newton");
+        ASSERT_THROW(OpenSim::Exception, ikLM.run());
+        cout << "testInverseKinematicsGait2354 Levenberg-Marquardt passed"
+             << endl;
+    }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testInverseKinematicsGait2354_LevenbergMarquardt");
+    }
+
     try {
         InverseKinematicsTool ik3("constraintTest_setup_ik.xml");
         ik3.run();
@@ -26,6 +26,7 @@
 #include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Simulation/OpenSense/OpenSenseUtilities.h>
 #include <OpenSim/Simulation/OpenSense/IMUPlacer.h>
+#include <OpenSim/Simulation/OpenSense/StreamingIMUInverseKinematics.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Tools/IMUInverseKinematicsTool.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
@@ -33,6 +34,80 @@
 using namespace OpenSim;
 using namespace std;
 
+// Stream the first second of the trial solved by IMUInverseKinematicsTool
+// (setup_IMUInverseKinematics_HJC_trial.xml) and compare the last solution to
+// the tool's result at the same time.
+void testStreamingIMUInverseKinematics(const Model& model,
+        const std::string& toolResultsFile) {
+    TimeSeriesTable_<SimTK::Quaternion> quaternions(
+            "MT_012005D6_009-quaternions_RHJCSwinger.sto");
+    quaternions.trim(417, 418);
+    const int numSamples = int(quaternions.getNumRows());
+    const double lastTime = quaternions.getIndependentColumn().back();
+
+    StreamingIMUInverseKinematics ik(model, quaternions.getColumnLabels());
+    ik.setSensorToOpenSimRotations(SimTK::Vec3(-1.5707963, 0, 0));
+    ik.setAccuracy(1e-6);
+    int numPublished = 0;
+    ik.setSolutionListener(
+            [&](const StreamingIMUInverseKinematicsSolution&) {
+                ++numPublished;
+            });
+    ik.start();
+    const int numAccepted = IMUOrientationsReplay(quaternions).run(ik);
+    ik.stop();
+
+    auto stats = ik.getStatistics();
+    cout << "Streaming IK: " << stats.numSamplesSolved << " of " << numSamples
+         << " samples solved, " << stats.numSamplesSkipped << " skipped, "
+         << stats.numSamplesDroppedBufferFull << " dropped; mean latency "
+         << stats.meanLatency << " s, max latency " << stats.maxLatency
+         << " s." << endl;
+    ASSERT(stats.numSamplesAccepted == numAccepted);
+    ASSERT(numAccepted + stats.numSamplesDroppedBufferFull == numSamples);
+    ASSERT(stats.numSamplesAccepted == stats.numSamplesSolved +
+            stats.numSamplesSkipped + stats.numSolverFailures);
+    ASSERT(stats.numSolverFailures == 0);
+    ASSERT(numPublished == stats.numSamplesSolved);
+
+    // The newest sample is solved when the engine stops.
+    StreamingIMUInverseKinematicsSolution solution;
+    ASSERT(ik.getLatestSolution(solution));
+    ASSERT_EQUAL(lastTime, solution.time, 1e-12);
+
+    TimeSeriesTable toolResults(toolResultsFile);
+    const auto toolRow = toolResults.getRowAtIndex(
+            toolResults.getNearestRowIndexForTime(lastTime));
+    const auto& coordNames = ik.getCoordinateNames();
+    for (int i = 0; i < int(coordNames.size()); ++i) {
+        const auto& coord = model.getCoordinateSet().get(coordNames[i]);
+        double value = solution.coordinateValues[i];
+        if (coord.getMotionType() == Coordinate::Rotational)
+            value = SimTK::convertRadiansToDegrees(value);
+        const auto col = toolResults.getColumnIndex(coordNames[i]);
+        ASSERT_EQUAL(toolRow[int(col)], value, 1.0, __FILE__, __LINE__,
+                "Streaming IK differs from IMUInverseKinematicsTool for " +
+                        coordNames[i] + ".");
+    }
+
+    // Push samples much faster than they can be solved: samples are dropped
+    // or skipped, but every accepted sample is accounted for.
+    StreamingIMUInverseKinematics overloaded(
+            model, quaternions.getColumnLabels(), 2);
+    overloaded.start();
+    IMUOrientationsReplay fastReplay(quaternions);
+    fastReplay.setRealTimeFactor(SimTK::Infinity);
+    fastReplay.run(overloaded);
+    overloaded.stop();
+    stats = overloaded.getStatistics();
+    ASSERT(stats.numSamplesAccepted + stats.numSamplesDroppedBufferFull ==
+            numSamples);
+    ASSERT(stats.numSamplesAccepted == stats.numSamplesSolved +
+            stats.numSamplesSkipped + stats.numSolverFailures);
+    ASSERT(overloaded.getLatestSolution(solution));
+    ASSERT_EQUAL(lastTime, solution.time, 1e-12);
+}
+
 
 int main()
 {
@@ -90,6 +165,10 @@ int main()
         std::vector<double>(nc, 10.0), __FILE__, __LINE__,
         "testOpenSense::IK solutions differed due to heading.");
 
+    testStreamingIMUInverseKinematics(facingX,
+            "ik_hjc_" + facingX.getName() +
+            "/ik_MT_012005D6_009-quaternions_RHJCSwinger.mot");
+
     // Test a case where model pelvis rotation is non-zero so pelvis-x is different from ground-x
     IMUPlacer imuPlacer_rot("calibrate_rotated.xml");
     imuPlacer_rot.run();
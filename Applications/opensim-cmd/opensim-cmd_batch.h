@@ -0,0 +1,351 @@
+#ifndef OPENSIM_CMD_BATCH_H_
+#define OPENSIM_CMD_BATCH_H_
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  opensim-cmd_batch.h                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "opensim-cmd_run-tool.h"
+#include "parse_arguments.h"
+#include <docopt.h>
+
+#include <OpenSim/OpenSim.h>
+#include <OpenSim/Common/LogSink.h>
+#include <OpenSim/Common/Stopwatch.h>
+#include <OpenSim/Simulation/SimulationUtilities.h>
+#include <OpenSim/Auxiliary/getRSS.h>
+
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+static const char HELP_BATCH[] =
+R"(Run the tools in many XML setup files (e.g., for many trials), in parallel.
+
+Usage:
+  opensim-cmd [options]... batch [--threads=<n>] [--summary=<file>] [--log-dir=<dir>] <manifest-file>
+  opensim-cmd batch -h | --help
+
+Options:
+  -L <path>, --library <path>  Load a plugin.
+  -o <level>, --log <level>  Logging level.
+  -j <n>, --threads <n>  Number of setup files to run at once.
+  -s <file>, --summary <file>  Where to write the summary of the runs.
+  -d <dir>, --log-dir <dir>  Where to write the log of each run.
+
+Description:
+  The manifest is a text file that lists one setup file (for any tool that
+  run-tool supports) per line. Blank lines and lines starting with # are
+  ignored. Relative paths are relative to the directory of the manifest.
+
+  Each model file is loaded only once: tools that load a model named in their
+  setup file obtain a copy of the already-loaded model. Paths in the setup
+  files are relative to the directory of the setup file.
+
+  Setup files are run by --threads threads (by default, one per hardware
+  thread). The tools change the working directory to that of their setup
+  file, so only setup files in the same directory are run at the same time;
+  directories are processed in the order in which they first appear in the
+  manifest. Messages are written to the console and log files by a
+  background thread.
+
+  The summary (by default, batch_summary.csv) is a CSV file with one row per
+  setup file: the tool, whether it succeeded, the reason it failed, its wall
+  time, and the peak resident memory of the process when it finished. If
+  --log-dir is given, the messages logged while running each setup file are
+  also written to a separate file in that directory.
+
+  The command fails if any of the setup files fails.
+
+Examples:
+  opensim-cmd batch trials.txt
+  opensim-cmd batch --threads=8 --log-dir=logs --summary=ik_summary.csv ik_trials.txt
+)";
+
+namespace OpenSim {
+
+// The outcome of running one of the setup files in a batch manifest.
+struct BatchRun {
+    std::string setupFile;
+    std::string logFile;
+    std::string toolName;
+    bool success = false;
+    std::string failureReason;
+    double wallTime = 0;
+    size_t peakRSS = 0;
+    int threadIndex = -1;
+};
+
+// Loads each model file once, and gives out copies of the loaded models.
+// Different model files are loaded at the same time.
+class BatchModelCache {
+public:
+    std::unique_ptr<Model> getCopy(const std::string& fileName) {
+        std::shared_ptr<Entry> entry;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            std::shared_ptr<Entry>& slot = _models[fileName];
+            if (!slot) slot = std::make_shared<Entry>();
+            entry = slot;
+        }
+        std::lock_guard<std::mutex> lock(entry->mutex);
+        if (!entry->model) entry->model.reset(new Model(fileName));
+        return std::unique_ptr<Model>(entry->model->clone());
+    }
+    int getNumModels() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return (int)_models.size();
+    }
+private:
+    struct Entry {
+        std::mutex mutex;
+        std::unique_ptr<const Model> model;
+    };
+    std::mutex _mutex;
+    std::map<std::string, std::shared_ptr<Entry>> _models;
+};
+
+// Writes the messages logged while running a setup file to the log file of
+// that run. The thread that runs a setup file tags its messages with the log
+// file (Logger::setThreadTag()); the threads that its tool starts inherit the
+// tag, and the tag stays with the messages even if they are written later by
+// the background thread of the logger. Untagged messages are ignored.
+class BatchLogSink : public LogSink {
+public:
+    void beginRun(const std::string& logFile) {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _files[logFile].reset(new std::ofstream(logFile));
+        }
+        Logger::setThreadTag(logFile);
+    }
+    void endRun() {
+        // Write the messages of this run that are still buffered by this
+        // thread or queued for the background thread.
+        Logger::ThreadContext::flushAll();
+        Logger::flush();
+        const std::string logFile = Logger::getThreadTag();
+        Logger::setThreadTag("");
+        std::lock_guard<std::mutex> lock(_mutex);
+        _files.erase(logFile);
+    }
+protected:
+    void sinkImpl(const std::string& msg) override {
+        const std::string& tag = Logger::getThreadTag();
+        if (tag.empty()) return;
+        std::lock_guard<std::mutex> lock(_mutex);
+        auto it = _files.find(tag);
+        if (it != _files.end()) *it->second << msg << "\n";
+    }
+    void flushImpl() override {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto& kv : _files) kv.second->flush();
+    }
+private:
+    std::mutex _mutex;
+    std::map<std::string, std::unique_ptr<std::ofstream>> _files;
+};
+
+inline bool batch_is_absolute_path(const std::string& path) {
+    return !path.empty() && (path[0] == '/' || path[0] == '\\' ||
+                             (path.size() > 1 && path[1] == ':'));
+}
+
+// `path` if it is absolute, otherwise `path` relative to `directory`.
+inline std::string batch_absolute_path(const std::string& path,
+        const std::string& directory) {
+    if (batch_is_absolute_path(path)) return path;
+    if (directory.empty()) return path;
+    const char last = directory.back();
+    if (last == '/' || last == '\\') return directory + path;
+    return directory + "/" + path;
+}
+
+// Quote a field of the summary file, if necessary.
+inline std::string batch_csv_field(const std::string& field) {
+    if (field.find_first_of(",\"\n\r") == std::string::npos) return field;
+    std::string quoted = "\"";
+    for (const char c : field) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+// Read the setup files listed in a manifest, as absolute paths.
+inline std::vector<std::string> batch_read_manifest(
+        const std::string& manifestFile) {
+    std::ifstream manifest(manifestFile);
+    OPENSIM_THROW_IF(!manifest, Exception,
+            "Could not open batch manifest '{}'.", manifestFile);
+    const std::string directory = batch_absolute_path(
+            IO::getParentDirectory(manifestFile), IO::getCwd());
+    std::vector<std::string> setupFiles;
+    std::string line;
+    while (std::getline(manifest, line)) {
+        IO::TrimWhitespace(line);
+        if (line.empty() || line[0] == '#') continue;
+        setupFiles.push_back(batch_absolute_path(line,
+                directory.empty() ? IO::getCwd() : directory));
+    }
+    return setupFiles;
+}
+
+inline void batch_write_summary(const std::string& summaryFile,
+        const std::vector<BatchRun>& runs) {
+    std::ofstream summary(summaryFile);
+    OPENSIM_THROW_IF(!summary, Exception,
+            "Could not open summary file '{}' for writing.", summaryFile);
+    summary << "setup_file,tool,success,failure_reason,wall_time_s,"
+               "peak_rss_MB,thread,log_file\n";
+    for (const auto& run : runs) {
+        summary << batch_csv_field(run.setupFile) << ","
+                << batch_csv_field(run.toolName) << ","
+                << (run.success ? "true" : "false") << ","
+                << batch_csv_field(run.failureReason) << ","
+                << run.wallTime << ","
+                << (double)run.peakRSS / (1024.0 * 1024.0) << ","
+                << run.threadIndex << ","
+                << batch_csv_field(run.logFile) << "\n";
+    }
+}
+
+} // namespace OpenSim
+
+int batch(int argc, const char** argv) {
+
+    using namespace OpenSim;
+
+    std::map<std::string, docopt::value> args = OpenSim::parse_arguments(
+            HELP_BATCH, { argv + 1, argv + argc },
+            true); // show help if requested
+
+    const std::string cwd = IO::getCwd();
+    const auto& manifestFile = args["<manifest-file>"].asString();
+    int numThreads = 0;
+    if (args["--threads"]) {
+        numThreads = std::stoi(args["--threads"].asString());
+    }
+    const std::string summaryFile = batch_absolute_path(
+            args["--summary"] ? args["--summary"].asString()
+                              : std::string("batch_summary.csv"),
+            cwd);
+    std::string logDir;
+    if (args["--log-dir"]) {
+        logDir = batch_absolute_path(args["--log-dir"].asString(), cwd);
+        IO::makeDir(logDir);
+    }
+
+    // Group the setup files by directory, keeping the order of the manifest
+    // within each group.
+    std::vector<BatchRun> runs;
+    std::vector<std::string> directories;
+    std::map<std::string, std::vector<int>> runsByDirectory;
+    for (const auto& setupFile : batch_read_manifest(manifestFile)) {
+        const int index = (int)runs.size();
+        BatchRun run;
+        run.setupFile = setupFile;
+        if (!logDir.empty()) {
+            std::string name = setupFile.substr(
+                    IO::getParentDirectory(setupFile).size());
+            const auto dot = name.rfind('.');
+            if (dot != std::string::npos) name = name.substr(0, dot);
+            run.logFile = batch_absolute_path(
+                    fmt::format("{}_{}.log", index, name), logDir);
+        }
+        runs.push_back(run);
+        const std::string directory = IO::getParentDirectory(setupFile);
+        if (runsByDirectory.count(directory) == 0) {
+            directories.push_back(directory);
+        }
+        runsByDirectory[directory].push_back(index);
+    }
+    log_info("Running {} setup files from '{}'.", runs.size(), manifestFile);
+
+    // Many threads log at once; let a background thread write the messages.
+    const bool wasAsync = Logger::isAsync();
+    Logger::setAsync(true);
+
+    BatchModelCache modelCache;
+    std::shared_ptr<BatchLogSink> logSink;
+    if (!logDir.empty()) {
+        logSink = std::make_shared<BatchLogSink>();
+        Logger::addSink(logSink);
+    }
+
+    Stopwatch batchWatch;
+    for (const auto& directory : directories) {
+        const std::vector<int>& indices = runsByDirectory.at(directory);
+        // The tools change to and restore the working directory; since all
+        // tools running at once have the same directory, they always restore
+        // this one. Files in other directories (e.g., the data of external
+        // loads, contact meshes) are read by path, without changing the
+        // working directory.
+        IO::CwdChanger changeDir = IO::CwdChanger::changeTo(directory);
+        executeInParallel((int)indices.size(),
+                getNumThreadsForTasks(numThreads, (int)indices.size()),
+                [&](int thread, int i) {
+            BatchRun& run = runs[indices[i]];
+            run.threadIndex = thread;
+            if (logSink) logSink->beginRun(run.logFile);
+            // Tools load models by file name relative to the current working
+            // directory (this run's directory).
+            setToolModelLoader([&](const std::string& fileName) {
+                return modelCache.getCopy(
+                        batch_absolute_path(fileName, directory));
+            });
+            Stopwatch watch;
+            try {
+                run.success = run_tool_from_setup_file(run.setupFile,
+                        &run.toolName);
+                if (!run.success) {
+                    run.failureReason = "The tool did not succeed.";
+                }
+            } catch (const std::exception& e) {
+                run.failureReason = e.what();
+                log_error("Running '{}' failed: {}", run.setupFile, e.what());
+            }
+            run.wallTime = watch.getElapsedTime();
+            run.peakRSS = getPeakRSS();
+            setToolModelLoader(nullptr);
+            if (logSink) logSink->endRun();
+        });
+    }
+    if (logSink) Logger::removeSink(logSink);
+    Logger::setAsync(wasAsync);
+
+    batch_write_summary(summaryFile, runs);
+    int numFailures = 0;
+    for (const auto& run : runs) {
+        if (!run.success) {
+            ++numFailures;
+            log_error("'{}' failed: {}", run.setupFile, run.failureReason);
+        }
+    }
+    log_info("Ran {} setup files ({} failed) using {} models in {}; wrote "
+             "summary to '{}'.",
+            runs.size(), numFailures, modelCache.getNumModels(),
+            batchWatch.getElapsedTimeFormatted(), summaryFile);
+    if (numFailures) return EXIT_FAILURE;
+    return EXIT_SUCCESS;
+}
+
+#endif // OPENSIM_CMD_BATCH_H_
@@ -62,21 +62,21 @@ Examples:
   opensim-cmd --library=libosimMyCustomForce.dylib run-tool CMC_setup.xml
 )";
 
-int run_tool(int argc, const char** argv) {
-
-    using namespace OpenSim;
+namespace OpenSim {
 
-    std::map<std::string, docopt::value> args = OpenSim::parse_arguments(
-            HELP_RUN_TOOL, { argv + 1, argv + argc },
-            true); // show help if requested
+// Detect the tool defined in the setup file and run it. Returns whether the
+// tool succeeded; throws an exception if the tool cannot be constructed. If
+// provided, `toolClassName` is set to the class of the object in the file.
+inline bool run_tool_from_setup_file(const std::string& setupFile,
+        std::string* toolClassName = nullptr) {
 
     // Deserialize.
-    const auto& setupFile = args["<setup-xml-file>"].asString();
     auto obj = std::unique_ptr<Object>(Object::makeObjectFromFile(setupFile));
     if (obj == nullptr) {
         throw Exception( "A problem occurred when trying to load file '" +
                 setupFile + "'.");
     }
+    if (toolClassName) *toolClassName = obj->getConcreteClassName();
 
     // Detect and run the tool.
     if (auto* tool = dynamic_cast<AbstractTool*>(obj.get())) {
@@ -100,26 +100,35 @@ int run_tool(int argc, const char** argv) {
                      "constructed properly.");
             concreteTool.reset(tool->clone());
         }
-        const bool success = concreteTool->run();
-        if (success) return EXIT_SUCCESS;
-        else return EXIT_FAILURE;
+        return concreteTool->run();
     } else if (auto* tool = dynamic_cast<Tool*>(obj.get())) {
         // Tool.
         log_info("Preparing to run {}.", tool->getConcreteClassName());
-        const bool success = tool->run();
-        if (success) return EXIT_SUCCESS;
-        else return EXIT_FAILURE;
+        return tool->run();
     } else if (auto* scale = dynamic_cast<ScaleTool*>(obj.get())) {
         // ScaleTool.
         log_info("Preparing to run {}.", scale->getConcreteClassName());
-        const bool success = scale->run();
-        if (success) return EXIT_SUCCESS;
-        else return EXIT_FAILURE;
+        return scale->run();
     } else {
         throw Exception("The provided file '" + setupFile + "' does not "
                 "define an OpenSim Tool. Did you intend to load a plugin?");
     }
-    return EXIT_FAILURE;
+}
+
+} // namespace OpenSim
+
+int run_tool(int argc, const char** argv) {
+
+    using namespace OpenSim;
+
+    std::map<std::string, docopt::value> args = OpenSim::parse_arguments(
+            HELP_RUN_TOOL, { argv + 1, argv + argc },
+            true); // show help if requested
+
+    const auto& setupFile = args["<setup-xml-file>"].asString();
+    const bool success = run_tool_from_setup_file(setupFile);
+    if (success) return EXIT_SUCCESS;
+    else return EXIT_FAILURE;
 }
 
 #endif // OPENSIM_CMD_RUN_TOOL_H_
@@ -23,7 +23,9 @@
 
 #include <SimTKcommon/Testing.h>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <iterator>
 #include <memory>
 #include <regex>
 // We do *not* include OpenSim headers, since we are only interacting with
@@ -349,6 +351,160 @@ void testRunTool() {
     testLoadPluginLibraries("run-tool");
 }
 
+void testBatch() {
+    // Help.
+    // =====
+    {
+        StartsWith output("Run the tools in many XML setup files");
+        testCommand("batch -h", EXIT_SUCCESS, output);
+        testCommand("batch -help", EXIT_SUCCESS, output);
+    }
+
+    // Error messages.
+    // ===============
+    testCommand("batch", EXIT_FAILURE,
+            ContainsSubstring("Arguments did not match expected patterns"));
+    testCommand("batch putes.txt", EXIT_FAILURE,
+            ContainsSubstring("Could not open batch manifest 'putes.txt'."));
+
+    // Each setup file is run, even if others fail, and the failures are
+    // reported in the summary.
+    testCommand("print-xml cmc testbatch_cmc_setup.xml", EXIT_SUCCESS,
+            ContainsSubstring("Printing 'testbatch_cmc_setup.xml'.\n"));
+    testCommand("print-xml Model testbatch_Model.xml", EXIT_SUCCESS,
+            ContainsSubstring("Printing 'testbatch_Model.xml'.\n"));
+    {
+        std::ofstream manifest("testbatch_manifest.txt");
+        manifest << "# Setup files that fail.\n"
+                 << "testbatch_cmc_setup.xml\n\n"
+                 << "testbatch_Model.xml\n";
+    }
+    testCommand("batch --threads=2 --summary=testbatch_summary.csv "
+                "testbatch_manifest.txt", EXIT_FAILURE,
+            std::regex(RE_ANY + "(Running 2 setup files)" + RE_ANY +
+                       "(No model file was specified)" + RE_ANY +
+                       "(does not define an OpenSim Tool)" + RE_ANY +
+                       "(Ran 2 setup files \\(2 failed\\))" + RE_ANY));
+    {
+        std::ifstream summary("testbatch_summary.csv");
+        std::string header;
+        std::getline(summary, header);
+        SimTK_TEST(header.find("setup_file,tool,success,failure_reason") == 0);
+        const std::string rows((std::istreambuf_iterator<char>(summary)),
+                               std::istreambuf_iterator<char>());
+        SimTK_TEST(rows.find("testbatch_cmc_setup.xml,CMCTool,false,") !=
+                   std::string::npos);
+        SimTK_TEST(rows.find("testbatch_Model.xml,Model,false,") !=
+                   std::string::npos);
+    }
+
+    // Setup files that succeed run at the same time. The model that they
+    // share is loaded once, and the other runs use copies of it.
+    {
+        // A pendulum.
+        std::ofstream model("testbatch_pendulum.osim");
+        model << R"(<?xml version="1.0" encoding="UTF-8" ?>
+<OpenSimDocument Version="30000">
+<Model name="pendulum">
+<BodySet><objects>
+<Body name="ground"><mass>0</mass><Joint /></Body>
+<Body name="rod">
+<mass>1</mass>
+<mass_center>0 -0.5 0</mass_center>
+<inertia_xx>0.1</inertia_xx>
+<inertia_yy>0.1</inertia_yy>
+<inertia_zz>0.1</inertia_zz>
+<Joint><PinJoint>
+<parent_body>ground</parent_body>
+<location_in_parent>0 0 0</location_in_parent>
+<orientation_in_parent>0 0 0</orientation_in_parent>
+<location>0 0 0</location>
+<orientation>0 0 0</orientation>
+<CoordinateSet><objects>
+<Coordinate name="q"><default_value>0.5</default_value></Coordinate>
+</objects></CoordinateSet>
+</PinJoint></Joint>
+</Body>
+</objects></BodySet>
+</Model>
+</OpenSimDocument>
+)";
+    }
+    const int numValid = 3;
+    {
+        std::ofstream manifest("testbatch_valid_manifest.txt");
+        for (int i = 0; i < numValid; ++i) {
+            const std::string name = "testbatch_forward" + std::to_string(i);
+            std::ofstream setup(name + "_setup.xml");
+            setup << "<OpenSimDocument Version=\"40000\">\n"
+                  << "<ForwardTool name=\"" << name << "\">\n"
+                  << "<model_file>testbatch_pendulum.osim</model_file>\n"
+                  << "<results_directory>testbatch_results"
+                  << "</results_directory>\n"
+                  << "<initial_time>0</initial_time>\n"
+                  << "<final_time>0.05</final_time>\n"
+                  << "</ForwardTool>\n"
+                  << "</OpenSimDocument>\n";
+            manifest << name << "_setup.xml\n";
+        }
+    }
+    const auto countOccurrences = [](const std::string& str,
+            const std::string& sub) {
+        int count = 0;
+        for (auto pos = str.find(sub); pos != std::string::npos;
+                pos = str.find(sub, pos + sub.size()))
+            ++count;
+        return count;
+    };
+    const std::string validCommand = COMMAND + " batch --threads=" +
+            std::to_string(numValid) +
+            " --summary=testbatch_valid_summary.csv"
+            " testbatch_valid_manifest.txt";
+    {
+        const CommandOutput result = system_output(validCommand);
+        if (result.returncode != EXIT_SUCCESS ||
+                result.output.find("Ran " + std::to_string(numValid) +
+                        " setup files (0 failed) using 1 models") ==
+                        std::string::npos) {
+            throw std::runtime_error("When testing '" + validCommand +
+                    "' got the following output:\n" + result.output);
+        }
+        SimTK_TEST(countOccurrences(result.output, "Integrating from 0 to "
+                                                   "0.05.") == numValid);
+        std::ifstream summary("testbatch_valid_summary.csv");
+        std::string line;
+        std::getline(summary, line);
+        for (int i = 0; i < numValid; ++i) {
+            SimTK_TEST(std::getline(summary, line).good());
+            SimTK_TEST(line.find(",ForwardTool,true,") != std::string::npos);
+        }
+    }
+    // The log file of each run has the messages of that run.
+    {
+        const CommandOutput result = system_output(COMMAND +
+                " batch --threads=" + std::to_string(numValid) +
+                " --log-dir=testbatch_logs"
+                " --summary=testbatch_valid_summary.csv"
+                " testbatch_valid_manifest.txt");
+        SimTK_TEST(result.returncode == EXIT_SUCCESS);
+        for (int i = 0; i < numValid; ++i) {
+            const std::string name = "testbatch_forward" + std::to_string(i);
+            std::ifstream logFile("testbatch_logs/" + std::to_string(i) +
+                                  "_" + name + "_setup.log");
+            const std::string log((std::istreambuf_iterator<char>(logFile)),
+                                  std::istreambuf_iterator<char>());
+            SimTK_TEST(log.find("Running tool " + name + "...") !=
+                       std::string::npos);
+            SimTK_TEST(countOccurrences(log, "Integrating from 0 to 0.05.")
+                       == 1);
+        }
+    }
+
+    // Library option.
+    // ===============
+    testLoadPluginLibraries("batch");
+}
+
 void testPrintXML() {
     // Help.
     // =====
@@ -494,6 +650,7 @@ int main() {
     SimTK_START_TEST("testCommandLineInterface");
         SimTK_SUBTEST(testNoCommand);
         SimTK_SUBTEST(testRunTool);
+        SimTK_SUBTEST(testBatch);
         SimTK_SUBTEST(testPrintXML);
         SimTK_SUBTEST(testInfo);
         SimTK_SUBTEST(testUpdateFile);
@@ -14,6 +14,7 @@
 #include <OpenSim/Common/CSVFileAdapter.h>
 #include <OpenSim/Common/Component.h>
 #include <OpenSim/Common/ComponentPath.h>
+#include <OpenSim/Common/StateVariableLayout.h>
 #include <OpenSim/Common/Constant.h>
 #include <OpenSim/Common/DataAdapter.h>
 #include <OpenSim/Common/DataTable.h>
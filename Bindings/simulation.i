@@ -189,6 +189,7 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
 %include <OpenSim/Simulation/Model/PointForceDirection.h>
 %template(ArrayPointForceDirection) OpenSim::Array<OpenSim::PointForceDirection*>;
 
+%include <OpenSim/Simulation/Model/GeometryPathSurrogate.h>
 %include <OpenSim/Simulation/Model/GeometryPath.h>
 %include <OpenSim/Simulation/Model/Ligament.h>
 %include <OpenSim/Simulation/Model/Blankevoort1991Ligament.h>
@@ -230,6 +231,9 @@ OpenSim::ModelComponentSet<OpenSim::Controller>;
     SimTK::IteratorRange<OpenSim::StatesTrajectory::const_iterator>;
 %include <OpenSim/Simulation/StatesTrajectoryReporter.h>
 
+// Tool model loaders are C++ functions; not useful in scripting.
+%ignore OpenSim::loadToolModel;
+%ignore OpenSim::setToolModelLoader;
 %include <OpenSim/Simulation/SimulationUtilities.h>
 %include <OpenSim/Simulation/VisualizerUtilities.h>
 
@@ -21,6 +21,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 #include "Millard2012EquilibriumMuscle.h"
+#include "Millard2012EquilibriumMuscleBatch.h"
 #include <OpenSim/Simulation/Model/Model.h>
 
 using namespace std;
@@ -495,6 +496,11 @@ extendPostScale(const SimTK::State& s, const ScaleSet& scaleSet)
 void Millard2012EquilibriumMuscle::calcMuscleLengthInfo(const SimTK::State& s,
     MuscleLengthInfo& mli) const
 {
+    if(!_batch.empty()) {
+        _batch->calcMuscleLengthInfo(s, _batchIndex, mli);
+        return;
+    }
+
     // Get musculotendon actuator properties.
     //double maxIsoForce    = getMaxIsometricForce();
     double optFiberLength = getOptimalFiberLength();
@@ -605,6 +611,11 @@ void Millard2012EquilibriumMuscle::
 void Millard2012EquilibriumMuscle::
 calcFiberVelocityInfo(const SimTK::State& s, FiberVelocityInfo& fvi) const
 {
+    if(!_batch.empty()) {
+        _batch->calcFiberVelocityInfo(s, _batchIndex, fvi);
+        return;
+    }
+
     try {
         // Get the quantities that we've already computed.
         const MuscleLengthInfo &mli = getMuscleLengthInfo(s);
@@ -774,6 +785,11 @@ calcFiberVelocityInfo(const SimTK::State& s, FiberVelocityInfo& fvi) const
 void Millard2012EquilibriumMuscle::
 calcMuscleDynamicsInfo(const SimTK::State& s, MuscleDynamicsInfo& mdi) const
 {
+    if(!_batch.empty()) {
+        _batch->calcMuscleDynamicsInfo(s, _batchIndex, mdi);
+        return;
+    }
+
     try {
         // Get the quantities that we've already computed.
         const MuscleLengthInfo &mli = getMuscleLengthInfo(s);
@@ -931,6 +947,11 @@ calcMuscleDynamicsInfo(const SimTK::State& s, MuscleDynamicsInfo& mdi) const
 void Millard2012EquilibriumMuscle::extendConnectToModel(Model& model)
 {
     Super::extendConnectToModel(model);
+
+    // A Millard2012EquilibriumMuscleBatch in the model sets this again when
+    // the System is created.
+    _batch.reset();
+    _batchIndex = -1;
 }
 
 void Millard2012EquilibriumMuscle::
@@ -53,6 +53,8 @@
 
 namespace OpenSim {
 
+class Millard2012EquilibriumMuscleBatch;
+
 //==============================================================================
 //                         Millard2012EquilibriumMuscle
 //==============================================================================
@@ -554,6 +556,8 @@ protected:
     void computeStateVariableDerivatives(const SimTK::State& s) const override;
 
 private:
+    friend class Millard2012EquilibriumMuscleBatch;
+
     // The name used to access the activation state.
     static const std::string STATE_ACTIVATION_NAME;
     // The name used to access the fiber length state.
@@ -726,6 +730,14 @@ private:
     double m_minimumFiberLength;
     double m_minimumFiberLengthAlongTendon;
 
+    // The Millard2012EquilibriumMuscleBatch that computes the length,
+    // velocity, and dynamics quantities of this muscle (if any), and the
+    // index of this muscle in the batch. These are set by the batch when the
+    // System is created.
+    mutable SimTK::ReferencePtr<const Millard2012EquilibriumMuscleBatch>
+        _batch;
+    mutable int _batchIndex = -1;
+
     // Returns true if the fiber length is currently shorter than the minimum
     // value allowed by the pennation model and the active force length curve
     bool isFiberStateClamped(double lce, double dlceN) const;
@@ -0,0 +1,626 @@
+/* -------------------------------------------------------------------------- *
+ *             OpenSim:  Millard2012EquilibriumMuscleBatch.cpp                *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Millard2012EquilibriumMuscleBatch.h"
+#include "Millard2012EquilibriumMuscle.h"
+
+#include <OpenSim/Common/StateVariableLayout.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+#include <cmath>
+#include <unordered_map>
+
+using namespace OpenSim;
+
+void Millard2012EquilibriumMuscleBatch::Workspace::resize(int n)
+{
+    for (auto* v : {&pathLength, &lengtheningSpeed, &activation,
+                    &fiberLength, &normFiberLength, &pennationAngle,
+                    &cosPennationAngle, &sinPennationAngle, &tendonLength,
+                    &normTendonLength, &activeForceLength,
+                    &passiveForceLength, &tendonForceLength, &forceVelocity,
+                    &fiberVelocity, &normFiberVelocity,
+                    &pennationAngularVelocity, &fiberVelocityAlongTendon,
+                    &tendonVelocity, &fiberStateClamped, &fiberForce,
+                    &fiberForceAlongTendon, &activeFiberForce,
+                    &elasticFiberForce, &dampingFiberForce, &fiberStiffness,
+                    &fiberStiffnessAlongTendon, &tendonStiffness,
+                    &muscleStiffness}) {
+        v->resize(n);
+    }
+    muscles.resize(n);
+}
+
+//==============================================================================
+// MODELCOMPONENT INTERFACE
+//==============================================================================
+void Millard2012EquilibriumMuscleBatch::
+extendRealizeTopology(SimTK::State& s) const
+{
+    Super::extendRealizeTopology(s);
+
+    const Model& model = getModel();
+
+    // Locate the state variables of the muscles in the layout of the model,
+    // whose state variables are in the order of getStateVariableNames().
+    const Array<std::string> names = model.getStateVariableNames();
+    std::unordered_map<std::string, int> indexOfName;
+    for (int i = 0; i < names.getSize(); ++i) indexOfName[names[i]] = i;
+    auto findStateVariable = [&](const std::string& name) {
+        const auto it = indexOfName.find(name);
+        return it == indexOfName.end() ? -1 : it->second;
+    };
+
+    _muscles.clear();
+    for (const auto& muscle :
+            model.getComponentList<Millard2012EquilibriumMuscle>()) {
+        OPENSIM_THROW_IF_FRMOBJ(
+                !muscle._batch.empty() && muscle._batch.get() != this,
+                Exception,
+                "Muscle '{}' is already computed by another "
+                "Millard2012EquilibriumMuscleBatch; a Model may contain at "
+                "most one.", muscle.getAbsolutePathString());
+        muscle._batch.reset(this);
+        muscle._batchIndex = (int)_muscles.size();
+        _muscles.push_back(&muscle);
+    }
+
+    const int n = getNumMuscles();
+    _configuration.resize(n);
+    _ignoreActivationDynamics.resize(n);
+    _maxIsometricForce.resize(n);
+    _optimalFiberLength.resize(n);
+    _tendonSlackLength.resize(n);
+    _maxContractionVelocity.resize(n);
+    _fiberDamping.resize(n);
+    _minimumFiberLength.resize(n);
+    _pennation.resize(n);
+    _activationModel.resize(n);
+    _falCurve.resize(n);
+    _fpeCurve.resize(n);
+    _fvCurve.resize(n);
+    _fvInvCurve.resize(n);
+    _fseCurve.resize(n);
+    _activationIndex.resize(n);
+    _fiberLengthIndex.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const Millard2012EquilibriumMuscle& muscle = *_muscles[i];
+        if (muscle.get_ignore_tendon_compliance()) {
+            _configuration[i] = RigidTendon;
+        } else if (!muscle.use_fiber_damping) {
+            _configuration[i] = ElasticTendon;
+        } else {
+            _configuration[i] = DampedElasticTendon;
+        }
+        _ignoreActivationDynamics[i] = muscle.get_ignore_activation_dynamics();
+        _maxIsometricForce[i] = muscle.getMaxIsometricForce();
+        _optimalFiberLength[i] = muscle.getOptimalFiberLength();
+        _tendonSlackLength[i] = muscle.getTendonSlackLength();
+        _maxContractionVelocity[i] = muscle.getMaxContractionVelocity();
+        _fiberDamping[i] = muscle.get_fiber_damping();
+        _minimumFiberLength[i] = muscle.getMinimumFiberLength();
+        _pennation[i] = &muscle.getPennationModel();
+        _activationModel[i] = &muscle.getActivationModel();
+        _falCurve[i] = &muscle.get_ActiveForceLengthCurve();
+        _fpeCurve[i] = &muscle.get_FiberForceLengthCurve();
+        _fvCurve[i] = &muscle.get_ForceVelocityCurve();
+        _fvInvCurve[i] = &muscle.fvInvCurve;
+        _fseCurve[i] = &muscle.get_TendonForceLengthCurve();
+
+        const std::string path = muscle.getAbsolutePathString() + "/";
+        _activationIndex[i] = findStateVariable(
+                path + Millard2012EquilibriumMuscle::STATE_ACTIVATION_NAME);
+        _fiberLengthIndex[i] = findStateVariable(
+                path + Millard2012EquilibriumMuscle::STATE_FIBER_LENGTH_NAME);
+    }
+
+    _lengthWork.resize(n);
+    _velocityWork.resize(n);
+    _dynamicsWork.resize(n);
+}
+
+void Millard2012EquilibriumMuscleBatch::
+extendRealizeModel(SimTK::State& s) const
+{
+    Super::extendRealizeModel(s);
+
+    // The cache variables of the muscles are allocated when the muscles
+    // realize Topology, so their indices are only known now.
+    const int n = getNumMuscles();
+    _lengthInfoIndex.resize(n);
+    _velInfoIndex.resize(n);
+    _dynamicsInfoIndex.resize(n);
+    for (int i = 0; i < n; ++i) {
+        _lengthInfoIndex[i] = _muscles[i]->getCacheVariableIndex("lengthInfo");
+        _velInfoIndex[i] = _muscles[i]->getCacheVariableIndex("velInfo");
+        _dynamicsInfoIndex[i] =
+                _muscles[i]->getCacheVariableIndex("dynamicsInfo");
+    }
+}
+
+//==============================================================================
+// BATCH COMPUTATIONS
+//==============================================================================
+int Millard2012EquilibriumMuscleBatch::findMusclesToCompute(
+        const SimTK::State& s, int requester,
+        const std::vector<SimTK::CacheEntryIndex>& cacheIndex,
+        Workspace& w) const
+{
+    const SimTK::DefaultSystemSubsystem& subsystem =
+            getModel().getMultibodySystem().getDefaultSubsystem();
+    int n = 0;
+    for (int i = 0; i < getNumMuscles(); ++i) {
+        if (i == requester || !subsystem.isCacheValueRealized(s, cacheIndex[i]))
+            w.muscles[n++] = i;
+    }
+    return n;
+}
+
+double Millard2012EquilibriumMuscleBatch::getActivation(const SimTK::State& s,
+        const StateVariableLayout& layout, int i) const
+{
+    const double a = _ignoreActivationDynamics[i]
+            ? _muscles[i]->getControl(s)
+            : layout.getValue(s, _activationIndex[i]);
+    return _activationModel[i]->clampActivation(a);
+}
+
+void Millard2012EquilibriumMuscleBatch::calcMuscleLengthInfo(
+        const SimTK::State& s, int requester,
+        Muscle::MuscleLengthInfo& mli) const
+{
+    Workspace& w = _lengthWork;
+    const int n = findMusclesToCompute(s, requester, _lengthInfoIndex, w);
+    const StateVariableLayout& layout = getModel().getStateVariableLayout(s);
+
+    int k = 0;
+    try {
+        // Gather the fiber length of each muscle.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            w.pathLength[k] = _muscles[i]->getLength(s);
+            if (_configuration[i] == RigidTendon) {
+                w.fiberLength[k] = _pennation[i]->calcFiberLength(
+                        w.pathLength[k], _tendonSlackLength[i]);
+            } else {
+                w.fiberLength[k] = layout.getValue(s, _fiberLengthIndex[i]);
+            }
+        }
+
+        // Pennation.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            w.fiberLength[k] =
+                    std::max(w.fiberLength[k], _minimumFiberLength[i]);
+            w.normFiberLength[k] = w.fiberLength[k] / _optimalFiberLength[i];
+            w.pennationAngle[k] =
+                    _pennation[i]->calcPennationAngle(w.fiberLength[k]);
+            w.cosPennationAngle[k] = std::cos(w.pennationAngle[k]);
+            w.sinPennationAngle[k] = std::sin(w.pennationAngle[k]);
+        }
+
+        // Necessary even for the rigid tendon, as it might have gone slack.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            w.tendonLength[k] = _pennation[i]->calcTendonLength(
+                    w.cosPennationAngle[k], w.fiberLength[k],
+                    w.pathLength[k]);
+            w.normTendonLength[k] = w.tendonLength[k] / _tendonSlackLength[i];
+        }
+
+        // Force-length curves.
+        for (k = 0; k < n; ++k) {
+            w.passiveForceLength[k] =
+                    _fpeCurve[w.muscles[k]]->calcValue(w.normFiberLength[k]);
+        }
+        for (k = 0; k < n; ++k) {
+            w.activeForceLength[k] =
+                    _falCurve[w.muscles[k]]->calcValue(w.normFiberLength[k]);
+        }
+
+    } catch(const std::exception &x) {
+        std::string msg = "Exception caught in Millard2012EquilibriumMuscle::"
+                          "calcMuscleLengthInfo from "
+                          + _muscles[w.muscles[k]]->getName() + "\n"
+                          + x.what();
+        throw OpenSim::Exception(msg);
+    }
+
+    // Store the results.
+    const SimTK::DefaultSystemSubsystem& subsystem =
+            getModel().getMultibodySystem().getDefaultSubsystem();
+    for (k = 0; k < n; ++k) {
+        const int i = w.muscles[k];
+        Muscle::MuscleLengthInfo& out =
+                i == requester ? mli : _muscles[i]->updMuscleLengthInfo(s);
+        out.fiberLength = w.fiberLength[k];
+        out.normFiberLength = w.normFiberLength[k];
+        out.pennationAngle = w.pennationAngle[k];
+        out.cosPennationAngle = w.cosPennationAngle[k];
+        out.sinPennationAngle = w.sinPennationAngle[k];
+        out.fiberLengthAlongTendon =
+                w.fiberLength[k] * w.cosPennationAngle[k];
+        out.tendonLength = w.tendonLength[k];
+        out.normTendonLength = w.normTendonLength[k];
+        out.tendonStrain = w.normTendonLength[k] - 1.0;
+        out.fiberPassiveForceLengthMultiplier = w.passiveForceLength[k];
+        out.fiberActiveForceLengthMultiplier = w.activeForceLength[k];
+        if (i != requester)
+            subsystem.markCacheValueRealized(s, _lengthInfoIndex[i]);
+    }
+}
+
+void Millard2012EquilibriumMuscleBatch::calcFiberVelocityInfo(
+        const SimTK::State& s, int requester,
+        Muscle::FiberVelocityInfo& fvi) const
+{
+    Workspace& w = _velocityWork;
+    const int n = findMusclesToCompute(s, requester, _velInfoIndex, w);
+    const StateVariableLayout& layout = getModel().getStateVariableLayout(s);
+
+    int k = 0;
+    try {
+        // Gather the length quantities (computing them for all muscles if
+        // necessary), lengthening speed, and activation of each muscle.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const Muscle::MuscleLengthInfo& mli =
+                    _muscles[i]->getMuscleLengthInfo(s);
+            w.fiberLength[k] = mli.fiberLength;
+            w.pennationAngle[k] = mli.pennationAngle;
+            w.cosPennationAngle[k] = mli.cosPennationAngle;
+            w.sinPennationAngle[k] = mli.sinPennationAngle;
+            w.tendonLength[k] = mli.tendonLength;
+            w.normTendonLength[k] = mli.normTendonLength;
+            w.activeForceLength[k] = mli.fiberActiveForceLengthMultiplier;
+            w.passiveForceLength[k] = mli.fiberPassiveForceLengthMultiplier;
+            w.lengtheningSpeed[k] = _muscles[i]->getLengtheningSpeed(s);
+            w.activation[k] = _configuration[i] == RigidTendon
+                    ? SimTK::NaN : getActivation(s, layout, i);
+        }
+
+        // Tendon-force-length curve.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            w.tendonForceLength[k] = _configuration[i] == RigidTendon
+                    ? SimTK::NaN
+                    : _fseCurve[i]->calcValue(w.normTendonLength[k]);
+        }
+
+        // Compute fv by inverting the force-velocity relationship in the
+        // equilibrium equations.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const Millard2012EquilibriumMuscle& muscle = *_muscles[i];
+            double dlce  = SimTK::NaN;
+            double dlceN = SimTK::NaN;
+            double fv    = SimTK::NaN;
+
+            if (_configuration[i] == RigidTendon) {
+
+                if (w.tendonLength[k] < _tendonSlackLength[i]
+                                        - SimTK::SignificantReal) {
+                    // The tendon is buckling, so fiber velocity is zero.
+                    dlce  = 0.0;
+                    dlceN = 0.0;
+                    fv    = 1.0;
+                } else {
+                    dlce = _pennation[i]->calcFiberVelocity(
+                            w.cosPennationAngle[k], w.lengtheningSpeed[k],
+                            0.0);
+                    dlceN = dlce/(_optimalFiberLength[i]
+                                  *_maxContractionVelocity[i]);
+                    fv = _fvCurve[i]->calcValue(dlceN);
+                }
+
+            } else if (_configuration[i] == ElasticTendon) {
+
+                SimTK_ERRCHK_ALWAYS(
+                    w.cosPennationAngle[k] > SimTK::SignificantReal,
+                    "calcFiberVelocityInfo",
+                    "Pennation angle is 90 degrees, causing a singularity");
+                SimTK_ERRCHK_ALWAYS(w.activation[k] > SimTK::SignificantReal,
+                    "calcFiberVelocityInfo",
+                    "Activation is 0, causing a singularity");
+                SimTK_ERRCHK_ALWAYS(
+                    w.activeForceLength[k] > SimTK::SignificantReal,
+                    "calcFiberVelocityInfo",
+                    "Active-force-length factor is 0, causing a singularity");
+
+                fv = muscle.calcFv(w.activation[k], w.activeForceLength[k],
+                        w.passiveForceLength[k], w.tendonForceLength[k],
+                        w.cosPennationAngle[k]);
+
+                // Evaluate the inverse force-velocity curve.
+                dlceN = _fvInvCurve[i]->calcValue(fv);
+                dlce  = dlceN*_maxContractionVelocity[i]
+                        *_optimalFiberLength[i];
+
+            } else {
+
+                SimTK_ERRCHK_ALWAYS(_fiberDamping[i] > SimTK::SignificantReal,
+                    "calcFiberVelocityInfo",
+                    "Fiber damping coefficient must be greater than 0.");
+
+                // Newton solve for fiber velocity.
+                SimTK::Vec3 fiberVelocityV = muscle.calcDampedNormFiberVelocity(
+                        _maxIsometricForce[i], w.activation[k],
+                        w.activeForceLength[k], w.passiveForceLength[k],
+                        w.tendonForceLength[k], _fiberDamping[i],
+                        w.cosPennationAngle[k]);
+
+                if (fiberVelocityV[2] > 0.5) { //flag is set to 0.0 or 1.0
+                    dlceN = fiberVelocityV[0];
+                    dlce  = dlceN*_optimalFiberLength[i]
+                            *_maxContractionVelocity[i];
+                    fv = _fvCurve[i]->calcValue(dlceN);
+                } else {
+                    throw (OpenSim::Exception(muscle.getName() +
+                           " Fiber velocity Newton method did not converge"));
+                }
+            }
+
+            w.fiberVelocity[k] = dlce;
+            w.normFiberVelocity[k] = dlceN;
+            w.forceVelocity[k] = fv;
+        }
+
+        // Compute the other velocity-related components.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const MuscleFixedWidthPennationModel& penMdl = *_pennation[i];
+            const double dphidt = penMdl.calcPennationAngularVelocity(
+                    std::tan(w.pennationAngle[k]), w.fiberLength[k],
+                    w.fiberVelocity[k]);
+            w.pennationAngularVelocity[k] = dphidt;
+            w.fiberVelocityAlongTendon[k] = penMdl.calcFiberVelocityAlongTendon(
+                    w.fiberLength[k], w.fiberVelocity[k],
+                    w.sinPennationAngle[k], w.cosPennationAngle[k], dphidt);
+            w.tendonVelocity[k] = _configuration[i] == RigidTendon ? 0
+                    : penMdl.calcTendonVelocity(w.cosPennationAngle[k],
+                            w.sinPennationAngle[k], dphidt, w.fiberLength[k],
+                            w.fiberVelocity[k], w.lengtheningSpeed[k]);
+        }
+
+        // Check to see whether the fiber state is clamped.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            w.fiberStateClamped[k] = 0.0;
+            if (_muscles[i]->isFiberStateClamped(w.fiberLength[k],
+                                                 w.fiberVelocity[k])) {
+                w.fiberVelocity[k] = 0.0;
+                w.normFiberVelocity[k] = 0.0;
+                w.fiberVelocityAlongTendon[k] = 0.0;
+                w.pennationAngularVelocity[k] = 0.0;
+                w.tendonVelocity[k] = w.lengtheningSpeed[k];
+                w.forceVelocity[k] = 1.0;
+                w.fiberStateClamped[k] = 1.0;
+            }
+        }
+
+    } catch(const std::exception &x) {
+        std::string msg = "Exception caught in Millard2012EquilibriumMuscle::"
+                          "calcFiberVelocityInfo from "
+                          + _muscles[w.muscles[k]]->getName() + "\n"
+                          + x.what();
+        throw OpenSim::Exception(msg);
+    }
+
+    // Store the results.
+    const SimTK::DefaultSystemSubsystem& subsystem =
+            getModel().getMultibodySystem().getDefaultSubsystem();
+    for (k = 0; k < n; ++k) {
+        const int i = w.muscles[k];
+        Muscle::FiberVelocityInfo& out =
+                i == requester ? fvi : _muscles[i]->updFiberVelocityInfo(s);
+        out.fiberVelocity = w.fiberVelocity[k];
+        out.normFiberVelocity = w.normFiberVelocity[k];
+        out.fiberVelocityAlongTendon = w.fiberVelocityAlongTendon[k];
+        out.pennationAngularVelocity = w.pennationAngularVelocity[k];
+        out.tendonVelocity = w.tendonVelocity[k];
+        out.normTendonVelocity = w.tendonVelocity[k]/_tendonSlackLength[i];
+        out.fiberForceVelocityMultiplier = w.forceVelocity[k];
+        out.userDefinedVelocityExtras.resize(1);
+        out.userDefinedVelocityExtras[0] = w.fiberStateClamped[k];
+        if (i != requester)
+            subsystem.markCacheValueRealized(s, _velInfoIndex[i]);
+    }
+}
+
+void Millard2012EquilibriumMuscleBatch::calcMuscleDynamicsInfo(
+        const SimTK::State& s, int requester,
+        Muscle::MuscleDynamicsInfo& mdi) const
+{
+    Workspace& w = _dynamicsWork;
+    const int n = findMusclesToCompute(s, requester, _dynamicsInfoIndex, w);
+    const StateVariableLayout& layout = getModel().getStateVariableLayout(s);
+
+    int k = 0;
+    try {
+        // Gather the length and velocity quantities (computing them for all
+        // muscles if necessary), lengthening speed, and activation of each
+        // muscle.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const Millard2012EquilibriumMuscle& muscle = *_muscles[i];
+            const Muscle::MuscleLengthInfo& mli =
+                    muscle.getMuscleLengthInfo(s);
+            const Muscle::FiberVelocityInfo& mvi =
+                    muscle.getFiberVelocityInfo(s);
+            w.fiberLength[k] = mli.fiberLength;
+            w.normFiberLength[k] = mli.normFiberLength;
+            w.cosPennationAngle[k] = mli.cosPennationAngle;
+            w.sinPennationAngle[k] = mli.sinPennationAngle;
+            w.normTendonLength[k] = mli.normTendonLength;
+            w.activeForceLength[k] = mli.fiberActiveForceLengthMultiplier;
+            w.passiveForceLength[k] = mli.fiberPassiveForceLengthMultiplier;
+            w.fiberVelocity[k] = mvi.fiberVelocity;
+            w.normFiberVelocity[k] = mvi.normFiberVelocity;
+            w.tendonVelocity[k] = mvi.tendonVelocity;
+            w.forceVelocity[k] = mvi.fiberForceVelocityMultiplier;
+            w.fiberStateClamped[k] = mvi.userDefinedVelocityExtras[0];
+            w.lengtheningSpeed[k] = muscle.getLengtheningSpeed(s);
+            w.activation[k] = getActivation(s, layout, i);
+        }
+
+        for (k = 0; k < n; ++k) {
+            SimTK_ERRCHK_ALWAYS(w.fiberLength[k] > SimTK::SignificantReal,
+                "calcMuscleDynamicsInfo",
+                "The muscle fiber has a length of 0, causing a singularity");
+            SimTK_ERRCHK_ALWAYS(
+                w.cosPennationAngle[k] > SimTK::SignificantReal,
+                "calcMuscleDynamicsInfo",
+                "Pennation angle is 90 degrees, causing a singularity");
+        }
+
+        // Fiber forces and stiffnesses.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const Millard2012EquilibriumMuscle& muscle = *_muscles[i];
+            const double fiso = _maxIsometricForce[i];
+
+            double fm           = 0.0; //total fiber force
+            double aFm          = 0.0; //active fiber force
+            double p1Fm         = 0.0; //passive conservative fiber force
+            double p2Fm         = 0.0; //passive non-conservative fiber force
+            double dFm_dlce     = 0.0;
+            double dFmAT_dlceAT = 0.0;
+
+            if (w.fiberStateClamped[k] < 0.5) { //flag is set to 0.0 or 1.0
+                SimTK::Vec4 fiberForceV = muscle.calcFiberForce(fiso,
+                        w.activation[k], w.activeForceLength[k],
+                        w.forceVelocity[k], w.passiveForceLength[k],
+                        w.normFiberVelocity[k]);
+                fm   = fiberForceV[0];
+                aFm  = fiberForceV[1];
+                p1Fm = fiberForceV[2];
+                p2Fm = fiberForceV[3];
+
+                // The rigid tendon must saturate the damping force generated
+                // by the parallel element so that the fiber generates only
+                // tensile forces (see
+                // Millard2012EquilibriumMuscle::calcMuscleDynamicsInfo()).
+                if (_configuration[i] == RigidTendon && fm < 0) {
+                    fm   = 0.0;
+                    p2Fm = -aFm - p1Fm;
+                }
+
+                dFm_dlce = muscle.calcFiberStiffness(fiso, w.activation[k],
+                        w.forceVelocity[k], w.normFiberLength[k],
+                        _optimalFiberLength[i]);
+                const double dFmAT_dlce =
+                    muscle.calc_DFiberForceAT_DFiberLength(fm, dFm_dlce,
+                            w.fiberLength[k], w.sinPennationAngle[k],
+                            w.cosPennationAngle[k]);
+                dFmAT_dlceAT = muscle.calc_DFiberForceAT_DFiberLengthAT(
+                        dFmAT_dlce, w.sinPennationAngle[k],
+                        w.cosPennationAngle[k], w.fiberLength[k]);
+            }
+
+            w.fiberForce[k] = fm;
+            w.fiberForceAlongTendon[k] = fm * w.cosPennationAngle[k];
+            w.activeFiberForce[k] = aFm;
+            w.elasticFiberForce[k] = p1Fm;
+            w.dampingFiberForce[k] = p2Fm;
+            w.fiberStiffness[k] = dFm_dlce;
+            w.fiberStiffnessAlongTendon[k] = dFmAT_dlceAT;
+        }
+
+        // Tendon forces, and the stiffnesses of the tendon and of the whole
+        // musculotendon actuator.
+        for (k = 0; k < n; ++k) {
+            const int i = w.muscles[k];
+            const double fiso = _maxIsometricForce[i];
+            const double dFmAT_dlceAT = w.fiberStiffnessAlongTendon[k];
+            double dFt_dtl = 0.0;
+            double Ke      = 0.0;
+            if (_configuration[i] == RigidTendon) {
+                w.tendonForceLength[k] = w.fiberForceAlongTendon[k]/fiso;
+                if (w.fiberStateClamped[k] < 0.5) {
+                    dFt_dtl = SimTK::Infinity;
+                    Ke = dFmAT_dlceAT;
+                }
+            } else {
+                const TendonForceLengthCurve& fseCurve = *_fseCurve[i];
+                w.tendonForceLength[k] =
+                        fseCurve.calcValue(w.normTendonLength[k]);
+                if (w.fiberStateClamped[k] < 0.5) {
+                    dFt_dtl = fseCurve.calcDerivative(w.normTendonLength[k],1)
+                              *(fiso/_tendonSlackLength[i]);
+                    if (std::abs(dFmAT_dlceAT*dFt_dtl) > 0.0
+                        && std::abs(dFmAT_dlceAT+dFt_dtl)
+                           > SimTK::SignificantReal) {
+                        Ke = (dFmAT_dlceAT*dFt_dtl)/(dFmAT_dlceAT+dFt_dtl);
+                    }
+                }
+            }
+            w.tendonStiffness[k] = dFt_dtl;
+            w.muscleStiffness[k] = Ke;
+        }
+
+    } catch(const std::exception &x) {
+        std::string msg = "Exception caught in Millard2012EquilibriumMuscle::"
+                          "calcMuscleDynamicsInfo from "
+                          + _muscles[w.muscles[k]]->getName() + "\n"
+                          + x.what();
+        throw OpenSim::Exception(msg);
+    }
+
+    // Store the results.
+    const SimTK::DefaultSystemSubsystem& subsystem =
+            getModel().getMultibodySystem().getDefaultSubsystem();
+    for (k = 0; k < n; ++k) {
+        const int i = w.muscles[k];
+        Muscle::MuscleDynamicsInfo& out =
+                i == requester ? mdi : _muscles[i]->updMuscleDynamicsInfo(s);
+        const double fiso = _maxIsometricForce[i];
+        const double fse = w.tendonForceLength[k];
+        const double p1Fm = w.elasticFiberForce[k];
+        const double p2Fm = w.dampingFiberForce[k];
+
+        out.activation                = w.activation[k];
+        out.fiberForce                = w.fiberForce[k];
+        out.fiberForceAlongTendon     = w.fiberForceAlongTendon[k];
+        out.normFiberForce            = w.fiberForce[k]/fiso;
+        out.activeFiberForce          = w.activeFiberForce[k];
+        out.passiveFiberForce         = p1Fm + p2Fm;
+        out.tendonForce               = fse*fiso;
+        out.normTendonForce           = fse;
+        out.fiberStiffness            = w.fiberStiffness[k];
+        out.fiberStiffnessAlongTendon = w.fiberStiffnessAlongTendon[k];
+        out.tendonStiffness           = w.tendonStiffness[k];
+        out.muscleStiffness           = w.muscleStiffness[k];
+
+        out.fiberActivePower  = -(out.activeFiberForce+p2Fm)
+                                *w.fiberVelocity[k];
+        out.fiberPassivePower = -(p1Fm*w.fiberVelocity[k]);
+        out.tendonPower       = -(fse*fiso*w.tendonVelocity[k]);
+        out.musclePower       = -(out.tendonForce*w.lengtheningSpeed[k]);
+
+        out.userDefinedDynamicsExtras.resize(2);
+        out.userDefinedDynamicsExtras[0] = p1Fm; //elastic
+        out.userDefinedDynamicsExtras[1] = p2Fm; //damping
+        if (i != requester)
+            subsystem.markCacheValueRealized(s, _dynamicsInfoIndex[i]);
+    }
+}
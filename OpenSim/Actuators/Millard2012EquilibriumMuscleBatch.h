@@ -0,0 +1,181 @@
+#ifndef OPENSIM_MILLARD2012EQUILIBRIUMMUSCLEBATCH_H_
+#define OPENSIM_MILLARD2012EQUILIBRIUMMUSCLEBATCH_H_
+/* -------------------------------------------------------------------------- *
+ *              OpenSim:  Millard2012EquilibriumMuscleBatch.h                 *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Actuators/osimActuatorsDLL.h>
+#include <OpenSim/Simulation/Model/ModelComponent.h>
+#include <OpenSim/Simulation/Model/Muscle.h>
+
+#include <vector>
+
+namespace OpenSim {
+
+class Millard2012EquilibriumMuscle;
+class ActiveForceLengthCurve;
+class FiberForceLengthCurve;
+class ForceVelocityCurve;
+class ForceVelocityInverseCurve;
+class TendonForceLengthCurve;
+class MuscleFixedWidthPennationModel;
+class MuscleFirstOrderActivationDynamicModel;
+class StateVariableLayout;
+
+/** A model component that computes the length, velocity, and dynamics
+quantities of all of the Millard2012EquilibriumMuscle%s in a Model together,
+rather than one muscle at a time. Adding a Millard2012EquilibriumMuscleBatch
+to a Model does not change any results; it only changes how they are
+computed.
+
+The first time a Millard2012EquilibriumMuscle needs its MuscleLengthInfo,
+FiberVelocityInfo, or MuscleDynamicsInfo for a state, the batch gathers the
+inputs of every muscle (path length and lengthening speed, activation, and
+fiber length, read from the state by index) into contiguous arrays, evaluates
+each step of the computation (pennation, the force-length, force-velocity,
+and tendon-force-length curves, the fiber velocity solve, and the fiber and
+tendon forces) for all muscles in turn, and stores the results in the cache
+variables of each muscle. The remaining muscles then find their quantities
+already computed. This is most useful in models with many muscles, and when
+the muscle curves have been compiled (see
+SmoothSegmentedFunction::setDefaultCompileTolerance()).
+
+@code
+Model model("gait2392_millard2012muscle.osim");
+model.addModelComponent(new Millard2012EquilibriumMuscleBatch());
+SimTK::State& state = model.initSystem();
+@endcode
+
+A Model may contain at most one Millard2012EquilibriumMuscleBatch. The
+properties of the muscles are gathered when the System is created, so call
+Model::initSystem() after editing the properties of any muscle. A batch must
+not be used to compute quantities for the same Model from several threads at
+once. */
+class OSIMACTUATORS_API Millard2012EquilibriumMuscleBatch
+        : public ModelComponent {
+OpenSim_DECLARE_CONCRETE_OBJECT(Millard2012EquilibriumMuscleBatch,
+        ModelComponent);
+public:
+    Millard2012EquilibriumMuscleBatch() = default;
+
+    /** The number of muscles in the batch (available after the System has
+    been created). */
+    int getNumMuscles() const { return (int)_muscles.size(); }
+
+protected:
+    void extendRealizeTopology(SimTK::State& s) const override;
+    void extendRealizeModel(SimTK::State& s) const override;
+
+private:
+    friend class Millard2012EquilibriumMuscle;
+
+    /* Compute the MuscleLengthInfo of every muscle in the batch whose cached
+    value is not valid, storing the result for `requester` in `mli` and the
+    results for the other muscles in their cache variables. */
+    void calcMuscleLengthInfo(const SimTK::State& s, int requester,
+            Muscle::MuscleLengthInfo& mli) const;
+    /* Same as calcMuscleLengthInfo(), for the FiberVelocityInfo. */
+    void calcFiberVelocityInfo(const SimTK::State& s, int requester,
+            Muscle::FiberVelocityInfo& fvi) const;
+    /* Same as calcMuscleLengthInfo(), for the MuscleDynamicsInfo. */
+    void calcMuscleDynamicsInfo(const SimTK::State& s, int requester,
+            Muscle::MuscleDynamicsInfo& mdi) const;
+
+    struct Workspace;
+    /* Fill `w` with the muscles whose cache variables with indices
+    `cacheIndex` are not valid (always including `requester`), and return
+    the number of such muscles. */
+    int findMusclesToCompute(const SimTK::State& s, int requester,
+            const std::vector<SimTK::CacheEntryIndex>& cacheIndex,
+            Workspace& w) const;
+    /* The clamped activation of muscle `i`, from its state variable or, if
+    activation dynamics are ignored, its control. */
+    double getActivation(const SimTK::State& s,
+            const StateVariableLayout& layout, int i) const;
+
+    // The configuration of each muscle, which determines how its fiber
+    // velocity is computed.
+    enum Configuration { RigidTendon, ElasticTendon, DampedElasticTendon };
+
+    // The muscles in the batch and their constant parameters, gathered in
+    // extendRealizeTopology().
+    mutable std::vector<const Millard2012EquilibriumMuscle*> _muscles;
+    mutable std::vector<Configuration> _configuration;
+    mutable std::vector<bool> _ignoreActivationDynamics;
+    mutable std::vector<double> _maxIsometricForce;
+    mutable std::vector<double> _optimalFiberLength;
+    mutable std::vector<double> _tendonSlackLength;
+    mutable std::vector<double> _maxContractionVelocity;
+    mutable std::vector<double> _fiberDamping;
+    mutable std::vector<double> _minimumFiberLength;
+    mutable std::vector<const MuscleFixedWidthPennationModel*> _pennation;
+    mutable std::vector<const MuscleFirstOrderActivationDynamicModel*>
+            _activationModel;
+    mutable std::vector<const ActiveForceLengthCurve*> _falCurve;
+    mutable std::vector<const FiberForceLengthCurve*> _fpeCurve;
+    mutable std::vector<const ForceVelocityCurve*> _fvCurve;
+    mutable std::vector<const ForceVelocityInverseCurve*> _fvInvCurve;
+    mutable std::vector<const TendonForceLengthCurve*> _fseCurve;
+    // Indices of the activation and fiber length state variables of each
+    // muscle in the StateVariableLayout of the Model (-1 if the muscle does
+    // not have the state variable).
+    mutable std::vector<int> _activationIndex;
+    mutable std::vector<int> _fiberLengthIndex;
+    // Indices of the cache variables of each muscle.
+    mutable std::vector<SimTK::CacheEntryIndex> _lengthInfoIndex;
+    mutable std::vector<SimTK::CacheEntryIndex> _velInfoIndex;
+    mutable std::vector<SimTK::CacheEntryIndex> _dynamicsInfoIndex;
+
+    // Workspace for computing one stage: the muscles whose quantities are
+    // being computed, and the value of each quantity for these muscles.
+    // Each stage has its own workspace, since gathering the inputs of one
+    // stage can compute the quantities of a lower stage.
+    struct Workspace {
+        std::vector<int> muscles;
+        std::vector<double> pathLength, lengtheningSpeed, activation;
+        std::vector<double> fiberLength, normFiberLength;
+        std::vector<double> pennationAngle, cosPennationAngle,
+                sinPennationAngle;
+        std::vector<double> tendonLength, normTendonLength;
+        std::vector<double> activeForceLength, passiveForceLength;
+        std::vector<double> tendonForceLength, forceVelocity;
+        std::vector<double> fiberVelocity, normFiberVelocity;
+        std::vector<double> pennationAngularVelocity,
+                fiberVelocityAlongTendon, tendonVelocity;
+        std::vector<double> fiberStateClamped;
+        std::vector<double> fiberForce, fiberForceAlongTendon,
+                activeFiberForce, elasticFiberForce, dampingFiberForce;
+        std::vector<double> fiberStiffness, fiberStiffnessAlongTendon,
+                tendonStiffness, muscleStiffness;
+        void resize(int n);
+    };
+    mutable Workspace _lengthWork;
+    mutable Workspace _velocityWork;
+    mutable Workspace _dynamicsWork;
+
+//==============================================================================
+};  // END of class Millard2012EquilibriumMuscleBatch
+//==============================================================================
+//==============================================================================
+
+} // end of namespace OpenSim
+
+#endif // OPENSIM_MILLARD2012EQUILIBRIUMMUSCLEBATCH_H_
@@ -57,6 +57,7 @@
 
 #include "Millard2012EquilibriumMuscle.h"
 #include "Millard2012AccelerationMuscle.h"
+#include "Millard2012EquilibriumMuscleBatch.h"
 
 // Awaiting new component architecture that supports subcomponents with states.
 //#include "ConstantMuscleActivation.h"
@@ -106,6 +107,7 @@ OSIMACTUATORS_API void RegisterTypes_osimActuators()
 
     Object::RegisterType(Millard2012EquilibriumMuscle());
     Object::RegisterType(Millard2012AccelerationMuscle());
+    Object::RegisterType(Millard2012EquilibriumMuscleBatch());
 
     //Object::RegisterType( ConstantMuscleActivation() );
     //Object::RegisterType( ZerothOrderMuscleActivationDynamics() );
@@ -0,0 +1,300 @@
+/* -------------------------------------------------------------------------- *
+ *         OpenSim:  testMillard2012EquilibriumMuscleBatch.cpp                *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*  Tests that a Millard2012EquilibriumMuscleBatch computes the same muscle
+    quantities as the Millard2012EquilibriumMuscles do on their own, for all
+    three configurations of the muscle (rigid tendon, elastic tendon without
+    fiber damping, and elastic tendon with fiber damping), and reports the time
+    to realize a model with as many muscles as a full-body gait model. */
+
+#include <OpenSim/Actuators/osimActuators.h>
+#include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
+#include <OpenSim/Common/Stopwatch.h>
+#include <OpenSim/Simulation/osimSimulation.h>
+
+#include <memory>
+
+using namespace OpenSim;
+using namespace std;
+
+// Create a model with a body on a slider that is spanned by
+// `numPerConfiguration` muscles of each configuration.
+std::unique_ptr<Model> createModel(int numPerConfiguration, bool withBatch)
+{
+    std::unique_ptr<Model> model(new Model());
+    model->setName("millard_muscles");
+    auto* body = new OpenSim::Body("body", 10.0, SimTK::Vec3(0),
+            SimTK::Inertia(0.1));
+    auto* slider = new SliderJoint("slider", model->getGround(),
+            SimTK::Vec3(0), SimTK::Vec3(0), *body, SimTK::Vec3(0),
+            SimTK::Vec3(0));
+    slider->updCoordinate().setName("x");
+    model->addBody(body);
+    model->addJoint(slider);
+
+    for (int i = 0; i < numPerConfiguration; ++i) {
+        for (int c = 0; c < 3; ++c) {
+            const double optimalFiberLength = 0.08 + 0.002 * i;
+            const double tendonSlackLength = 0.15 + 0.004 * i;
+            const double pennation = 0.05 + 0.01 * (i % 20);
+            auto* muscle = new Millard2012EquilibriumMuscle(
+                    "muscle" + std::to_string(c) + "_" + std::to_string(i),
+                    500.0 + 20.0 * i, optimalFiberLength, tendonSlackLength,
+                    pennation);
+            muscle->set_ignore_tendon_compliance(c == 0);
+            if (c == 1) {
+                muscle->set_fiber_damping(0.0);
+                muscle->set_minimum_activation(0.01);
+                muscle->setMinControl(0.01);
+            }
+            const double length = optimalFiberLength * cos(pennation)
+                                  + tendonSlackLength * (1.0 + 0.01 * c);
+            muscle->addNewPathPoint("origin", model->updGround(),
+                    SimTK::Vec3(-length, 0.001 * i, 0));
+            muscle->addNewPathPoint("insertion", *body, SimTK::Vec3(0));
+            model->addForce(muscle);
+        }
+    }
+    if (withBatch) {
+        model->addModelComponent(new Millard2012EquilibriumMuscleBatch());
+    }
+    return model;
+}
+
+void compareMuscles(const Model& model, const SimTK::State& s,
+        const Model& batchModel, const SimTK::State& sb)
+{
+    const double tol = 1e-12;
+    for (const auto& muscle :
+            model.getComponentList<Millard2012EquilibriumMuscle>()) {
+        const auto& batchMuscle =
+                batchModel.getComponent<Millard2012EquilibriumMuscle>(
+                        muscle.getAbsolutePath());
+
+        const Muscle::MuscleLengthInfo& mli = muscle.getMuscleLengthInfo(s);
+        const Muscle::MuscleLengthInfo& bmli =
+                batchMuscle.getMuscleLengthInfo(sb);
+        ASSERT_EQUAL(mli.fiberLength, bmli.fiberLength, tol);
+        ASSERT_EQUAL(mli.normFiberLength, bmli.normFiberLength, tol);
+        ASSERT_EQUAL(mli.pennationAngle, bmli.pennationAngle, tol);
+        ASSERT_EQUAL(mli.fiberLengthAlongTendon, bmli.fiberLengthAlongTendon,
+                tol);
+        ASSERT_EQUAL(mli.tendonLength, bmli.tendonLength, tol);
+        ASSERT_EQUAL(mli.tendonStrain, bmli.tendonStrain, tol);
+        ASSERT_EQUAL(mli.fiberPassiveForceLengthMultiplier,
+                bmli.fiberPassiveForceLengthMultiplier, tol);
+        ASSERT_EQUAL(mli.fiberActiveForceLengthMultiplier,
+                bmli.fiberActiveForceLengthMultiplier, tol);
+
+        const Muscle::FiberVelocityInfo& fvi = muscle.getFiberVelocityInfo(s);
+        const Muscle::FiberVelocityInfo& bfvi =
+                batchMuscle.getFiberVelocityInfo(sb);
+        ASSERT_EQUAL(fvi.fiberVelocity, bfvi.fiberVelocity, tol);
+        ASSERT_EQUAL(fvi.normFiberVelocity, bfvi.normFiberVelocity, tol);
+        ASSERT_EQUAL(fvi.fiberVelocityAlongTendon,
+                bfvi.fiberVelocityAlongTendon, tol);
+        ASSERT_EQUAL(fvi.pennationAngularVelocity,
+                bfvi.pennationAngularVelocity, tol);
+        ASSERT_EQUAL(fvi.tendonVelocity, bfvi.tendonVelocity, tol);
+        ASSERT_EQUAL(fvi.normTendonVelocity, bfvi.normTendonVelocity, tol);
+        ASSERT_EQUAL(fvi.fiberForceVelocityMultiplier,
+                bfvi.fiberForceVelocityMultiplier, tol);
+        ASSERT_EQUAL(fvi.userDefinedVelocityExtras[0],
+                bfvi.userDefinedVelocityExtras[0], tol);
+
+        const Muscle::MuscleDynamicsInfo& mdi =
+                muscle.getMuscleDynamicsInfo(s);
+        const Muscle::MuscleDynamicsInfo& bmdi =
+                batchMuscle.getMuscleDynamicsInfo(sb);
+        ASSERT_EQUAL(mdi.activation, bmdi.activation, tol);
+        ASSERT_EQUAL(mdi.fiberForce, bmdi.fiberForce, tol);
+        ASSERT_EQUAL(mdi.fiberForceAlongTendon, bmdi.fiberForceAlongTendon,
+                tol);
+        ASSERT_EQUAL(mdi.activeFiberForce, bmdi.activeFiberForce, tol);
+        ASSERT_EQUAL(mdi.passiveFiberForce, bmdi.passiveFiberForce, tol);
+        ASSERT_EQUAL(mdi.tendonForce, bmdi.tendonForce, tol);
+        ASSERT_EQUAL(mdi.fiberStiffness, bmdi.fiberStiffness, tol);
+        ASSERT_EQUAL(mdi.fiberStiffnessAlongTendon,
+                bmdi.fiberStiffnessAlongTendon, tol);
+        ASSERT_EQUAL(mdi.tendonStiffness, bmdi.tendonStiffness, tol);
+        ASSERT_EQUAL(mdi.muscleStiffness, bmdi.muscleStiffness, tol);
+        ASSERT_EQUAL(mdi.fiberActivePower, bmdi.fiberActivePower, tol);
+        ASSERT_EQUAL(mdi.fiberPassivePower, bmdi.fiberPassivePower, tol);
+        ASSERT_EQUAL(mdi.tendonPower, bmdi.tendonPower, tol);
+        ASSERT_EQUAL(mdi.musclePower, bmdi.musclePower, tol);
+        ASSERT_EQUAL(mdi.userDefinedDynamicsExtras[0],
+                bmdi.userDefinedDynamicsExtras[0], tol);
+        ASSERT_EQUAL(mdi.userDefinedDynamicsExtras[1],
+                bmdi.userDefinedDynamicsExtras[1], tol);
+    }
+}
+
+void testBatchMatchesMuscles()
+{
+    auto model = createModel(4, false);
+    auto batchModel = createModel(4, true);
+    SimTK::State& s = model->initSystem();
+    SimTK::State& sb = batchModel->initSystem();
+    ASSERT(batchModel->getComponentList<Millard2012EquilibriumMuscleBatch>()
+            .begin()->getNumMuscles() == 12);
+
+    const Coordinate& x = model->getCoordinateSet().get("x");
+    for (double position : {-0.02, 0.0, 0.01}) {
+        for (double speed : {-0.3, 0.0, 0.2}) {
+            for (double activation : {0.02, 0.5, 1.0}) {
+                x.setValue(s, position);
+                x.setSpeedValue(s, speed);
+                for (const auto& muscle :
+                        model->getComponentList<Millard2012EquilibriumMuscle>())
+                    muscle.setActivation(s, activation);
+                model->equilibrateMuscles(s);
+
+                sb.setTime(s.getTime());
+                sb.updY() = s.getY();
+                model->realizeAcceleration(s);
+                batchModel->realizeAcceleration(sb);
+
+                compareMuscles(*model, s, *batchModel, sb);
+                SimTK_TEST_EQ_TOL(s.getYDot(), sb.getYDot(), 1e-10);
+            }
+        }
+    }
+
+    // Requesting the quantities of one muscle computes those of all muscles.
+    sb.updY() = s.getY();
+    batchModel->realizeVelocity(sb);
+    const auto& muscles =
+            batchModel->getComponentList<Millard2012EquilibriumMuscle>();
+    for (const auto& muscle : muscles) {
+        ASSERT(!muscle.isCacheVariableValid(sb, "lengthInfo"));
+        ASSERT(!muscle.isCacheVariableValid(sb, "velInfo"));
+    }
+    muscles.begin()->getFiberVelocityInfo(sb);
+    for (const auto& muscle : muscles) {
+        ASSERT(muscle.isCacheVariableValid(sb, "lengthInfo"));
+        ASSERT(muscle.isCacheVariableValid(sb, "velInfo"));
+    }
+}
+
+// Equilibrating the muscles and editing the state of a single muscle give the
+// same results with a batch, including when the first quantity requested is
+// the MuscleDynamicsInfo, whose computation requests the FiberVelocityInfo
+// and MuscleLengthInfo of the other muscles.
+void testEditMuscleStates()
+{
+    auto model = createModel(4, false);
+    auto batchModel = createModel(4, true);
+    SimTK::State& s = model->initSystem();
+    SimTK::State& sb = batchModel->initSystem();
+    for (auto* m : {model.get(), batchModel.get()}) {
+        SimTK::State& state = m == model.get() ? s : sb;
+        const Coordinate& x = m->getCoordinateSet().get("x");
+        x.setValue(state, 0.01);
+        x.setSpeedValue(state, -0.1);
+        for (const auto& muscle :
+                m->getComponentList<Millard2012EquilibriumMuscle>())
+            muscle.setActivation(state, 0.4);
+        m->equilibrateMuscles(state);
+    }
+    SimTK_TEST_EQ_TOL(s.getY(), sb.getY(), 1e-10);
+    model->realizeAcceleration(s);
+    batchModel->realizeAcceleration(sb);
+    compareMuscles(*model, s, *batchModel, sb);
+    SimTK_TEST_EQ_TOL(s.getYDot(), sb.getYDot(), 1e-10);
+
+    // Edit the activation of an elastic tendon muscle and the fiber length
+    // of a damped elastic tendon muscle.
+    for (auto* m : {model.get(), batchModel.get()}) {
+        SimTK::State& state = m == model.get() ? s : sb;
+        const auto& elastic =
+                m->getComponent<Millard2012EquilibriumMuscle>(
+                        "/forceset/muscle1_2");
+        elastic.setActivation(state, 0.7);
+        const auto& damped =
+                m->getComponent<Millard2012EquilibriumMuscle>(
+                        "/forceset/muscle2_1");
+        damped.setFiberLength(state, damped.getFiberLength(state) + 0.002);
+        m->realizeVelocity(state);
+    }
+    const auto& lastMuscle =
+            batchModel->getComponent<Millard2012EquilibriumMuscle>(
+                    "/forceset/muscle2_3");
+    lastMuscle.getMuscleDynamicsInfo(sb);
+    for (const auto& muscle :
+            batchModel->getComponentList<Millard2012EquilibriumMuscle>()) {
+        ASSERT(muscle.isCacheVariableValid(sb, "lengthInfo"));
+        ASSERT(muscle.isCacheVariableValid(sb, "velInfo"));
+        ASSERT(muscle.isCacheVariableValid(sb, "dynamicsInfo"));
+    }
+    compareMuscles(*model, s, *batchModel, sb);
+    model->realizeAcceleration(s);
+    batchModel->realizeAcceleration(sb);
+    SimTK_TEST_EQ_TOL(s.getYDot(), sb.getYDot(), 1e-10);
+}
+
+void testOneBatchPerModel()
+{
+    auto model = createModel(1, true);
+    model->addModelComponent(new Millard2012EquilibriumMuscleBatch());
+    ASSERT_THROW(OpenSim::Exception, model->initSystem());
+}
+
+// Time realizing a model with 81 muscles (about as many as the 80 muscles of
+// the Rajagopal et al. (2016) full-body model) to Stage::Dynamics, with and
+// without a batch.
+void benchmarkBatch()
+{
+    const int numRealizations = 2000;
+    double timePerRealization[2];
+    for (bool withBatch : {false, true}) {
+        auto model = createModel(27, withBatch);
+        SimTK::State& s = model->initSystem();
+        model->equilibrateMuscles(s);
+        const Coordinate& x = model->getCoordinateSet().get("x");
+
+        Stopwatch watch;
+        for (int i = 0; i < numRealizations; ++i) {
+            x.setSpeedValue(s, 0.1 * (i % 5));
+            model->realizeDynamics(s);
+        }
+        timePerRealization[withBatch] =
+                watch.getElapsedTime() / numRealizations;
+    }
+    cout << "Time to realize Dynamics with 81 muscles: "
+         << Stopwatch::formatNs(
+                    (long long)(1e9 * timePerRealization[false]))
+         << " without a batch, "
+         << Stopwatch::formatNs((long long)(1e9 * timePerRealization[true]))
+         << " with a batch (speedup: "
+         << timePerRealization[false] / timePerRealization[true] << ")."
+         << endl;
+}
+
+int main()
+{
+    SimTK_START_TEST("testMillard2012EquilibriumMuscleBatch");
+        SimTK_SUBTEST(testBatchMatchesMuscles);
+        SimTK_SUBTEST(testEditMuscleStates);
+        SimTK_SUBTEST(testOneBatchPerModel);
+        SimTK_SUBTEST(benchmarkBatch);
+    SimTK_END_TEST();
+}
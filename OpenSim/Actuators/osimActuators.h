@@ -39,6 +39,7 @@
 #include "RigidTendonMuscle.h"
 #include "Millard2012EquilibriumMuscle.h"
 #include "Millard2012AccelerationMuscle.h"
+#include "Millard2012EquilibriumMuscleBatch.h"
 
 #include "McKibbenActuator.h"
 
@@ -32,6 +32,19 @@
 using namespace OpenSim;
 using namespace std;
 
+namespace {
+    // Acceleration in ground of a station (expressed in the body frame) of a
+    // mobilized body with spatial acceleration A_GB in ground.
+    SimTK::Vec3 calcStationAcceleration(const SimTK::State& s,
+            const SimTK::MobilizedBody& mobod, const SimTK::SpatialVec& A_GB,
+            const SimTK::Vec3& station)
+    {
+        const SimTK::Vec3 r = mobod.getBodyRotation(s) * station;
+        const SimTK::Vec3& w = mobod.getBodyAngularVelocity(s);
+        return A_GB[1] + A_GB[0] % r + w % (w % r);
+    }
+}
+
 //=============================================================================
 // CONSTANTS
 //=============================================================================
@@ -498,7 +511,6 @@ void InducedAccelerations::setModel(Model &aModel)
  */
 int InducedAccelerations::record(const SimTK::State& s)
 {
-    int nu = _model->getNumSpeeds();
     double aT = s.getTime();
     log_info("time = {}", aT);
 
@@ -539,203 +551,444 @@ int InducedAccelerations::record(const SimTK::State& s)
     //Use same conditions on constraints
     s_analysis.setTime(aT);
 
-    // Cycle through the force contributors to the system acceleration
-    for(int c=0; c< _contributors.getSize(); c++){          
-        //cout << "Solving for contributor: " << _contributors[c] << endl;
-        // Need to be at the dynamics stage to disable a force
-        _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Dynamics);
-        
-        if(_contributors[c] == "total"){
-            // Set gravity ON
-            _model->getGravityForce().enable(s_analysis);
-
-            // Set the configuration (gen. coords and speeds) of the model.
-            s_analysis.setQ(Q);
-            s_analysis.setU(s.getU());
-            s_analysis.setZ(s.getZ());
-
-            //Make sure all the actuators are on!
-            for(int f=0; f<_model->getActuators().getSize(); f++){
-                _model->updActuators().get(f).setAppliesForce(s_analysis, true);
-            }
+    // Each contributor must be realized on its own to report its constraint
+    // reactions (multipliers). Otherwise, solve for the accelerations induced
+    // by all contributors together.
+    if(_reportConstraintReactions){
+        for(int c=0; c<_contributors.getSize(); c++)
+            solveContributor(s_analysis, s, c, constraintOn);
+    }
+    else{
+        // The total acceleration also determines which of the unilateral
+        // contact constraints hold, so it is solved on its own first.
+        int first = 0;
+        if(_contributors.getSize() && _contributors[0] == "total"){
+            solveContributor(s_analysis, s, 0, constraintOn);
+            first = 1;
+        }
+        solveContributorsTogether(s_analysis, s, first);
+    }
+
+    // Set the accelerations of coordinates into their storages
+    int nc = _coordSet.getSize();
+    for(int i=0; i<nc; i++) {
+        _storeInducedAccelerations[i]->append(aT, _coordIndAccs[i]->getSize(),&(_coordIndAccs[i]->get(0)));
+    }
+
+    // Set the accelerations of bodies into their storages
+    int nb = _bodySet.getSize();
+    for(int i=0; i<nb; i++) {
+        _storeInducedAccelerations[nc+i]->append(aT, _bodyIndAccs[i]->getSize(),&(_bodyIndAccs[i]->get(0)));
+    }
+
+    // Set the accelerations of system center of mass into a storage
+    if(_includeCOM){
+        _storeInducedAccelerations[nc+nb]->append(aT, _comIndAccs.getSize(), &_comIndAccs[0]);
+    }
+    if(_reportConstraintReactions){
+        _storeConstraintReactions->append(aT, _constraintReactions.getSize(), &_constraintReactions[0]);
+    }
+
+    return(0);
+}
+
+//_____________________________________________________________________________
+/**
+ * Solve for the accelerations induced by one contributor, by enabling only
+ * the forces of that contributor and realizing the model to Acceleration,
+ * and append them (and the constraint reactions, if reported) to the
+ * accelerations at this time step.
+ *
+ * @param s_analysis State with the contact constraints for this time step.
+ * @param s Current state of the simulation.
+ * @param c Index of the contributor.
+ * @param constraintOn Whether each contact constraint should be enforced.
+ */
+void InducedAccelerations::solveContributor(SimTK::State& s_analysis,
+        const SimTK::State& s, int c, const Array<bool>& constraintOn)
+{
+    int nu = _model->getNumSpeeds();
+    SimTK::Vector Q = s.getQ();
 
-            // Get to  the point where we can evaluate unilateral constraint conditions
-             _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
+    //cout << "Solving for contributor: " << _contributors[c] << endl;
+    // Need to be at the dynamics stage to disable a force
+    _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Dynamics);
+    
+    if(_contributors[c] == "total"){
+        // Set gravity ON
+        _model->getGravityForce().enable(s_analysis);
+
+        // Set the configuration (gen. coords and speeds) of the model.
+        s_analysis.setQ(Q);
+        s_analysis.setU(s.getU());
+        s_analysis.setZ(s.getZ());
+
+        //Make sure all the actuators are on!
+        for(int f=0; f<_model->getActuators().getSize(); f++){
+            _model->updActuators().get(f).setAppliesForce(s_analysis, true);
+        }
 
-            /* *********************************** ERROR CHECKING *******************************
-            SimTK::Vec3 pcom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterLocationInGround(s_analysis);
-            SimTK::Vec3 vcom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterVelocityInGround(s_analysis);
-            SimTK::Vec3 acom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterAccelerationInGround(s_analysis);
+        // Get to  the point where we can evaluate unilateral constraint conditions
+         _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
 
-            SimTK::Matrix M;
-            _model->getMultibodySystem().getMatterSubsystem().calcM(s_analysis, M);
-            cout << "mass matrix: " << M << endl;
+        /* *********************************** ERROR CHECKING *******************************
+        SimTK::Vec3 pcom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterLocationInGround(s_analysis);
+        SimTK::Vec3 vcom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterVelocityInGround(s_analysis);
+        SimTK::Vec3 acom =_model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterAccelerationInGround(s_analysis);
 
-            SimTK::Inertia sysInertia = _model->getMultibodySystem().getMatterSubsystem().calcSystemCentralInertiaInGround(s_analysis);
-            cout << "system inertia: " << sysInertia << endl;
+        SimTK::Matrix M;
+        _model->getMultibodySystem().getMatterSubsystem().calcM(s_analysis, M);
+        cout << "mass matrix: " << M << endl;
 
-            SimTK::SpatialVec sysMomentum =_model->getMultibodySystem().getMatterSubsystem().calcSystemMomentumAboutGroundOrigin(s_analysis);
-            cout << "system momentum: " << sysMomentum << endl;
+        SimTK::Inertia sysInertia = _model->getMultibodySystem().getMatterSubsystem().calcSystemCentralInertiaInGround(s_analysis);
+        cout << "system inertia: " << sysInertia << endl;
 
-            const SimTK::Vector &appliedMobilityForces = _model->getMultibodySystem().getMobilityForces(s_analysis, SimTK::Stage::Dynamics);
-            appliedMobilityForces.dump("All Applied Mobility Forces");
-        
-            // Get all applied body forces like those from contact
-            const SimTK::Vector_<SimTK::SpatialVec>& appliedBodyForces = _model->getMultibodySystem().getRigidBodyForces(s_analysis, SimTK::Stage::Dynamics);
-            appliedBodyForces.dump("All Applied Body Forces");
-
-            SimTK::Vector ucUdot;
-            SimTK::Vector_<SimTK::SpatialVec> ucA_GB;
-            _model->getMultibodySystem().getMatterSubsystem().calcAccelerationIgnoringConstraints(s_analysis, appliedMobilityForces, appliedBodyForces, ucUdot, ucA_GB) ;
-            ucUdot.dump("Udots Ignoring Constraints");
-            ucA_GB.dump("Body Accelerations");
-
-            SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces(_constraintSet.getSize(), SimTK::SpatialVec(SimTK::Vec3(0)));
-            SimTK::Vector constraintMobilityForces(0);
-
-            int nc = _model->getMultibodySystem().getMatterSubsystem().getNumConstraints();
-            for (SimTK::ConstraintIndex cx(0); cx < nc; ++cx) {
-                if (!_model->getMultibodySystem().getMatterSubsystem().isConstraintDisabled(s_analysis, cx)){
-                    cout << "Constraint " << cx << " enabled!" << endl;
-                }
-            }
-            //int nMults = _model->getMultibodySystem().getMatterSubsystem().getTotalMultAlloc();
+        SimTK::SpatialVec sysMomentum =_model->getMultibodySystem().getMatterSubsystem().calcSystemMomentumAboutGroundOrigin(s_analysis);
+        cout << "system momentum: " << sysMomentum << endl;
 
-            for(int i=0; i<constraintOn.getSize(); i++) {
-                if(constraintOn[i])
-                    _constraintSet[i].calcConstraintForces(s_analysis, constraintBodyForces, constraintMobilityForces);
-            }
-            constraintBodyForces.dump("Constraint Body Forces");
-            constraintMobilityForces.dump("Constraint Mobility Forces");
-            // ******************************* end ERROR CHECKING *******************************/
+        const SimTK::Vector &appliedMobilityForces = _model->getMultibodySystem().getMobilityForces(s_analysis, SimTK::Stage::Dynamics);
+        appliedMobilityForces.dump("All Applied Mobility Forces");
     
-            for(int i=0; i<constraintOn.getSize(); i++) {
-                _constraintSet.get(i).setIsEnforced(s_analysis,
-                                                    constraintOn[i]);
-                // Make sure we stay at Dynamics so each constraint can evaluate its conditions
-                _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
+        // Get all applied body forces like those from contact
+        const SimTK::Vector_<SimTK::SpatialVec>& appliedBodyForces = _model->getMultibodySystem().getRigidBodyForces(s_analysis, SimTK::Stage::Dynamics);
+        appliedBodyForces.dump("All Applied Body Forces");
+
+        SimTK::Vector ucUdot;
+        SimTK::Vector_<SimTK::SpatialVec> ucA_GB;
+        _model->getMultibodySystem().getMatterSubsystem().calcAccelerationIgnoringConstraints(s_analysis, appliedMobilityForces, appliedBodyForces, ucUdot, ucA_GB) ;
+        ucUdot.dump("Udots Ignoring Constraints");
+        ucA_GB.dump("Body Accelerations");
+
+        SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces(_constraintSet.getSize(), SimTK::SpatialVec(SimTK::Vec3(0)));
+        SimTK::Vector constraintMobilityForces(0);
+
+        int nc = _model->getMultibodySystem().getMatterSubsystem().getNumConstraints();
+        for (SimTK::ConstraintIndex cx(0); cx < nc; ++cx) {
+            if (!_model->getMultibodySystem().getMatterSubsystem().isConstraintDisabled(s_analysis, cx)){
+                cout << "Constraint " << cx << " enabled!" << endl;
             }
+        }
+        //int nMults = _model->getMultibodySystem().getMatterSubsystem().getTotalMultAlloc();
 
-            // This should also push changes to defaults for unilateral conditions
-            _model->setPropertiesFromState(s_analysis);
+        for(int i=0; i<constraintOn.getSize(); i++) {
+            if(constraintOn[i])
+                _constraintSet[i].calcConstraintForces(s_analysis, constraintBodyForces, constraintMobilityForces);
+        }
+        constraintBodyForces.dump("Constraint Body Forces");
+        constraintMobilityForces.dump("Constraint Mobility Forces");
+        // ******************************* end ERROR CHECKING *******************************/
 
+        for(int i=0; i<constraintOn.getSize(); i++) {
+            _constraintSet.get(i).setIsEnforced(s_analysis,
+                                                constraintOn[i]);
+            // Make sure we stay at Dynamics so each constraint can evaluate its conditions
+            _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
         }
-        else if(_contributors[c] == "gravity"){
-            // Set gravity ON
-            _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), false);
 
-            s_analysis.setQ(Q);
+        // This should also push changes to defaults for unilateral conditions
+        _model->setPropertiesFromState(s_analysis);
 
-            // zero velocity
-            s_analysis.setU(SimTK::Vector(nu,0.0));
-            s_analysis.setZ(s.getZ());
+    }
+    else if(_contributors[c] == "gravity"){
+        // Set gravity ON
+        _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), false);
 
-            // disable actuator forces
-            for(int f=0; f<_model->getActuators().getSize(); f++){
-                _model->updActuators().get(f).setAppliesForce(s_analysis,
-                                                              false);
-            }
+        s_analysis.setQ(Q);
+
+        // zero velocity
+        s_analysis.setU(SimTK::Vector(nu,0.0));
+        s_analysis.setZ(s.getZ());
+
+        // disable actuator forces
+        for(int f=0; f<_model->getActuators().getSize(); f++){
+            _model->updActuators().get(f).setAppliesForce(s_analysis,
+                                                          false);
         }
-        else if(_contributors[c] == "velocity"){        
-            // Set gravity off
-            _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), true);
-
-            s_analysis.setQ(Q);
-
-            // non-zero velocity
-            s_analysis.setU(s.getU());
-            s_analysis.setZ(s.getZ());
-            
-            // zero actuator forces
-            for(int f=0; f<_model->getActuators().getSize(); f++){
-                _model->updActuators().get(f).setAppliesForce(s_analysis,
-                                                              false);
-            }
-            // Set the configuration (gen. coords and speeds) of the model.
-            _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Velocity);
+    }
+    else if(_contributors[c] == "velocity"){        
+        // Set gravity off
+        _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), true);
+
+        s_analysis.setQ(Q);
+
+        // non-zero velocity
+        s_analysis.setU(s.getU());
+        s_analysis.setZ(s.getZ());
+        
+        // zero actuator forces
+        for(int f=0; f<_model->getActuators().getSize(); f++){
+            _model->updActuators().get(f).setAppliesForce(s_analysis,
+                                                          false);
         }
-        else{ //The rest are actuators      
-            // Set gravity OFF
-            _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), true);
-
-            // zero actuator forces
-            for(int f=0; f<_model->getActuators().getSize(); f++){
-                _model->updActuators().get(f).setAppliesForce(s_analysis,
-                                                              false);
-            }
+        // Set the configuration (gen. coords and speeds) of the model.
+        _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Velocity);
+    }
+    else{ //The rest are actuators      
+        // Set gravity OFF
+        _model->updForceSubsystem().setForceIsDisabled(s_analysis, _model->getGravityForce().getForceIndex(), true);
+
+        // zero actuator forces
+        for(int f=0; f<_model->getActuators().getSize(); f++){
+            _model->updActuators().get(f).setAppliesForce(s_analysis,
+                                                          false);
+        }
+
+        s_analysis.setQ(Q);
 
-            s_analysis.setQ(Q);
-
-            // zero velocity
-            SimTK::Vector U(nu,0.0);
-            s_analysis.setU(U);
-            s_analysis.setZ(s.getZ());
-            // light up the one actuator who's contribution we are looking for
-            int ai = _model->getActuators().getIndex(_contributors[c]);
-            if(ai<0)
-                throw Exception("InducedAcceleration: ERR- Could not find actuator '"+_contributors[c],__FILE__,__LINE__);
-            
-            Actuator &actuator = _model->getActuators().get(ai);
-            ScalarActuator* act = dynamic_cast<ScalarActuator*>(&actuator);
-            act->setAppliesForce(s_analysis, true);
-            act->overrideActuation(s_analysis, false);
-            Muscle *muscle = dynamic_cast<Muscle *>(&actuator);
-            if(muscle){
-                if(_computePotentialsOnly){
-                    muscle->overrideActuation(s_analysis, true);
-                    muscle->setOverrideActuation(s_analysis, 1.0);
-                }
+        // zero velocity
+        SimTK::Vector U(nu,0.0);
+        s_analysis.setU(U);
+        s_analysis.setZ(s.getZ());
+        // light up the one actuator who's contribution we are looking for
+        int ai = _model->getActuators().getIndex(_contributors[c]);
+        if(ai<0)
+            throw Exception("InducedAcceleration: ERR- Could not find actuator '"+_contributors[c],__FILE__,__LINE__);
+        
+        Actuator &actuator = _model->getActuators().get(ai);
+        ScalarActuator* act = dynamic_cast<ScalarActuator*>(&actuator);
+        act->setAppliesForce(s_analysis, true);
+        act->overrideActuation(s_analysis, false);
+        Muscle *muscle = dynamic_cast<Muscle *>(&actuator);
+        if(muscle){
+            if(_computePotentialsOnly){
+                muscle->overrideActuation(s_analysis, true);
+                muscle->setOverrideActuation(s_analysis, 1.0);
             }
+        }
 
-            // Set the configuration (gen. coords and speeds) of the model.
-            _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Model);
-            _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Velocity);
+        // Set the configuration (gen. coords and speeds) of the model.
+        _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Model);
+        _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Velocity);
 
-        }// End of if to select contributor 
+    }// End of if to select contributor 
 
-        // cout << "Constraint 0 is of "<< _constraintSet[0].getConcreteClassName() << " and should be " << constraintOn[0] << " and is actually " <<  (_constraintSet[0].isDisabled(s_analysis) ? "off" : "on") << endl;
-        // cout << "Constraint 1 is of "<< _constraintSet[1].getConcreteClassName() << " and should be " << constraintOn[1] << " and is actually " <<  (_constraintSet[1].isDisabled(s_analysis) ? "off" : "on") << endl;
+    // cout << "Constraint 0 is of "<< _constraintSet[0].getConcreteClassName() << " and should be " << constraintOn[0] << " and is actually " <<  (_constraintSet[0].isDisabled(s_analysis) ? "off" : "on") << endl;
+    // cout << "Constraint 1 is of "<< _constraintSet[1].getConcreteClassName() << " and should be " << constraintOn[1] << " and is actually " <<  (_constraintSet[1].isDisabled(s_analysis) ? "off" : "on") << endl;
 
-        // After setting the state of the model and applying forces
-        // Compute the derivative of the multibody system (speeds and accelerations)
-        _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
+    // After setting the state of the model and applying forces
+    // Compute the derivative of the multibody system (speeds and accelerations)
+    _model->getMultibodySystem().realize(s_analysis, SimTK::Stage::Acceleration);
 
-        // Sanity check that constraints hasn't totally changed the configuration of the model
-        // double error = (Q-s_analysis.getQ()).norm();
+    // Sanity check that constraints hasn't totally changed the configuration of the model
+    // double error = (Q-s_analysis.getQ()).norm();
 
-        // Report reaction forces for debugging
-        /*
-        SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces(_constraintSet.getSize());
-        SimTK::Vector mobilityForces(0);
+    // Report reaction forces for debugging
+    /*
+    SimTK::Vector_<SimTK::SpatialVec> constraintBodyForces(_constraintSet.getSize());
+    SimTK::Vector mobilityForces(0);
 
-        for(int i=0; i<constraintOn.getSize(); i++) {
-            if(constraintOn[i])
-                _constraintSet.get(i).calcConstraintForces(s_analysis, constraintBodyForces, mobilityForces);
-        }*/
+    for(int i=0; i<constraintOn.getSize(); i++) {
+        if(constraintOn[i])
+            _constraintSet.get(i).calcConstraintForces(s_analysis, constraintBodyForces, mobilityForces);
+    }*/
+
+    // VARIABLES
+    SimTK::Vec3 vec,angVec;
+
+    // Get Accelerations for kinematics of bodies
+    for(int i=0;i<_coordSet.getSize();i++) {
+        double acc = _coordSet.get(i).getAccelerationValue(s_analysis);
+
+        if(getInDegrees()) 
+            acc *= SimTK_RADIAN_TO_DEGREE;  
+        _coordIndAccs[i]->append(1, &acc);
+    }
 
-        // VARIABLES
-        SimTK::Vec3 vec,angVec;
+    // cout << "Input Body Names: "<< _bodyNames << endl;
+
+    // Get Accelerations for kinematics of bodies
+    for(int i=0;i<_bodySet.getSize();i++) {
+        Body &body = _bodySet.get(i);
+        // cout << "Body Name: "<< body->getName() << endl;
+        const SimTK::Vec3& com = body.get_mass_center();
+        
+        // Get the body acceleration
+        vec = body.findStationAccelerationInGround(s_analysis, com);
+        angVec = body.getAccelerationInGround(s_analysis)[0];
+
+        // CONVERT TO DEGREES?
+        if(getInDegrees()) 
+            angVec *= SimTK_RADIAN_TO_DEGREE;   
+
+        // FILL KINEMATICS ARRAY
+        _bodyIndAccs[i]->append(3, &vec[0]);
+        _bodyIndAccs[i]->append(3, &angVec[0]);
+    }
+
+    // Get Accelerations for kinematics of COM
+    if(_includeCOM){
+        // Get the body acceleration in ground
+        vec = _model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterAccelerationInGround(s_analysis);
+
+        // FILL KINEMATICS ARRAY
+        _comIndAccs.append(3, &vec[0]);
+    }
+
+    // Get induced constraint reactions for contributor
+    if(_reportConstraintReactions){
+        for(int j=0; j<_constraintSet.getSize(); j++){
+            _constraintReactions.append(_constraintSet[j].getRecordValues(s_analysis));
+        }
+    }
+
+}
+
+//_____________________________________________________________________________
+/**
+ * Solve for the accelerations induced by the contributors starting with
+ * index first, together, and append them to the accelerations at this time
+ * step.
+ *
+ * The generalized forces (less the velocity-dependent inertial forces) of
+ * each contributor are computed separately, in a state with zero speeds for
+ * the actuators and gravity and in a state with the actual speeds for the
+ * velocity contributor, and the constrained equations of motion
+ *
+ *     [ M  ~G ] [  udot  ]   [  f ]
+ *     [ G   0 ] [ lambda ] = [ -b ]
+ *
+ * are factored once and solved for all contributors. As when each contributor
+ * is realized on its own, the forces that are not actuators (e.g., passive
+ * and contact forces) are included in every contributor.
+ *
+ * @param s_analysis State with the contact constraints for this time step.
+ * @param s Current state of the simulation.
+ * @param first Index of the first contributor to solve for.
+ */
+void InducedAccelerations::solveContributorsTogether(SimTK::State& s_analysis,
+        const SimTK::State& s, int first)
+{
+    int ncontrib = _contributors.getSize() - first;
+    if(ncontrib <= 0) return;
+
+    const SimTK::MultibodySystem& system = _model->getMultibodySystem();
+    const SimTK::SimbodyMatterSubsystem& matter = _model->getMatterSubsystem();
+    int nu = _model->getNumSpeeds();
+    int nb = matter.getNumBodies();
+
+    // State with the actual speeds (already set if the total was solved).
+    if(first == 0){
+        s_analysis.setQ(s.getQ());
+        s_analysis.setU(s.getU());
+        s_analysis.setZ(s.getZ());
+    }
+    system.realize(s_analysis, SimTK::Stage::Velocity);
+
+    // State with zero speeds in which every actuator applies its force.
+    SimTK::State s_zeroU = s_analysis;
+    s_zeroU.setU(SimTK::Vector(nu, 0.0));
+    for(int f=0; f<_model->getActuators().getSize(); f++){
+        const Actuator& actuator = _model->getActuators().get(f);
+        actuator.setAppliesForce(s_zeroU, true);
+        const ScalarActuator* act =
+                dynamic_cast<const ScalarActuator*>(&actuator);
+        if(act)
+            act->overrideActuation(s_zeroU, false);
+        const Muscle* muscle = dynamic_cast<const Muscle*>(&actuator);
+        if(muscle && _computePotentialsOnly){
+            muscle->overrideActuation(s_zeroU, true);
+            muscle->setOverrideActuation(s_zeroU, 1.0);
+        }
+    }
+    system.realize(s_zeroU, SimTK::Stage::Velocity);
+
+    // Forces that are not actuators, at the actual and at zero speeds.
+    SimTK::Vector_<SimTK::SpatialVec> passiveBodyForces, passiveBodyForcesZeroU;
+    SimTK::Vector passiveMobilityForces, passiveMobilityForcesZeroU;
+    calcNonActuatorForces(s_analysis, passiveBodyForces, passiveMobilityForces);
+    calcNonActuatorForces(s_zeroU, passiveBodyForcesZeroU,
+            passiveMobilityForcesZeroU);
+
+    // The constraints (and so G) are the same in both states; the bias b of
+    // the constraints depends on the speeds.
+    SimTK::Matrix M, G;
+    matter.calcM(s_analysis, M);
+    matter.calcG(s_analysis, G);
+    int m = G.nrow();
+    SimTK::Vector bias, biasZeroU;
+    matter.calcBiasForAccelerationConstraints(s_analysis, bias);
+    matter.calcBiasForAccelerationConstraints(s_zeroU, biasZeroU);
+
+    SimTK::Matrix K(nu+m, nu+m, 0.0);
+    K.updBlock(0, 0, nu, nu) = M;
+    if(m > 0){
+        K.updBlock(0, nu, nu, m) = ~G;
+        K.updBlock(nu, 0, m, nu) = G;
+    }
+
+    // One right-hand side per contributor.
+    SimTK::Matrix rhs(nu+m, ncontrib);
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces;
+    SimTK::Vector_<SimTK::Vec3> particleForces;
+    SimTK::Vector mobilityForces, residual;
+    for(int j=0; j<ncontrib; j++){
+        const string& contributor = _contributors[first+j];
+        bool atActualSpeeds = (contributor == "velocity");
+        if(atActualSpeeds){
+            bodyForces = passiveBodyForces;
+            mobilityForces = passiveMobilityForces;
+        }
+        else{
+            if(contributor == "gravity"){
+                _model->getGravityForce().calcForceContribution(s_zeroU,
+                        bodyForces, particleForces, mobilityForces);
+            }
+            else{ //The rest are actuators
+                int ai = _model->getActuators().getIndex(contributor);
+                if(ai<0)
+                    throw Exception("InducedAcceleration: ERR- Could not find actuator '"+contributor,__FILE__,__LINE__);
+                _model->getActuators().get(ai).calcForceContribution(s_zeroU,
+                        bodyForces, mobilityForces);
+            }
+            bodyForces += passiveBodyForcesZeroU;
+            mobilityForces += passiveMobilityForcesZeroU;
+        }
+
+        // f is the applied forces less the velocity-dependent inertial forces.
+        matter.calcResidualForceIgnoringConstraints(
+                atActualSpeeds ? s_analysis : s_zeroU,
+                mobilityForces, bodyForces, SimTK::Vector(), residual);
+        const SimTK::Vector& b = atActualSpeeds ? bias : biasZeroU;
+        for(int i=0; i<nu; i++)
+            rhs(i, j) = -residual[i];
+        for(int i=0; i<m; i++)
+            rhs(nu+i, j) = -b[i];
+    }
+
+    SimTK::Matrix solution;
+    SimTK::FactorQTZ factor(K);
+    factor.solve(rhs, solution);
+
+    // VARIABLES
+    SimTK::Vec3 vec,angVec;
+    SimTK::Vector_<SimTK::SpatialVec> A_GB;
+    for(int j=0; j<ncontrib; j++){
+        const SimTK::State& sj =
+                (_contributors[first+j] == "velocity") ? s_analysis : s_zeroU;
+        SimTK::Vector udot = solution.col(j)(0, nu);
+        matter.calcBodyAccelerationFromUDot(sj, udot, A_GB);
 
         // Get Accelerations for kinematics of bodies
         for(int i=0;i<_coordSet.getSize();i++) {
-            double acc = _coordSet.get(i).getAccelerationValue(s_analysis);
+            const Coordinate& coord = _coordSet.get(i);
+            double acc = matter.getMobilizedBody(coord.getBodyIndex())
+                    .getOneFromUPartition(sj, coord.getMobilizerQIndex(), udot);
 
             if(getInDegrees()) 
                 acc *= SimTK_RADIAN_TO_DEGREE;  
             _coordIndAccs[i]->append(1, &acc);
         }
 
-        // cout << "Input Body Names: "<< _bodyNames << endl;
-
         // Get Accelerations for kinematics of bodies
         for(int i=0;i<_bodySet.getSize();i++) {
-            Body &body = _bodySet.get(i);
-            // cout << "Body Name: "<< body->getName() << endl;
-            const SimTK::Vec3& com = body.get_mass_center();
-            
+            const Body &body = _bodySet.get(i);
+            const SimTK::MobilizedBody& mobod =
+                    matter.getMobilizedBody(body.getMobilizedBodyIndex());
+            const SimTK::SpatialVec& A = A_GB[body.getMobilizedBodyIndex()];
+
             // Get the body acceleration
-            vec = body.findStationAccelerationInGround(s_analysis, com);
-            angVec = body.getAccelerationInGround(s_analysis)[0];
+            vec = calcStationAcceleration(sj, mobod, A, body.get_mass_center());
+            angVec = A[0];
 
             // CONVERT TO DEGREES?
             if(getInDegrees()) 
@@ -748,43 +1001,45 @@ int InducedAccelerations::record(const SimTK::State& s)
 
         // Get Accelerations for kinematics of COM
         if(_includeCOM){
-            // Get the body acceleration in ground
-            vec = _model->getMultibodySystem().getMatterSubsystem().calcSystemMassCenterAccelerationInGround(s_analysis);
+            // Mass-weighted average of the accelerations of the body centers
+            // of mass in ground
+            vec = SimTK::Vec3(0);
+            for(SimTK::MobilizedBodyIndex mbx(1); mbx<nb; ++mbx){
+                const SimTK::MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+                vec += mobod.getBodyMass(sj) * calcStationAcceleration(sj,
+                        mobod, A_GB[mbx], mobod.getBodyMassCenterStation(sj));
+            }
+            vec /= matter.calcSystemMass(sj);
 
             // FILL KINEMATICS ARRAY
             _comIndAccs.append(3, &vec[0]);
         }
-
-        // Get induced constraint reactions for contributor
-        if(_reportConstraintReactions){
-            for(int j=0; j<_constraintSet.getSize(); j++){
-                _constraintReactions.append(_constraintSet[j].getRecordValues(s_analysis));
-            }
-        }
-
-    } // End cycling through contributors at this time step
-
-    // Set the accelerations of coordinates into their storages
-    int nc = _coordSet.getSize();
-    for(int i=0; i<nc; i++) {
-        _storeInducedAccelerations[i]->append(aT, _coordIndAccs[i]->getSize(),&(_coordIndAccs[i]->get(0)));
-    }
-
-    // Set the accelerations of bodies into their storages
-    int nb = _bodySet.getSize();
-    for(int i=0; i<nb; i++) {
-        _storeInducedAccelerations[nc+i]->append(aT, _bodyIndAccs[i]->getSize(),&(_bodyIndAccs[i]->get(0)));
     }
+}
 
-    // Set the accelerations of system center of mass into a storage
-    if(_includeCOM){
-        _storeInducedAccelerations[nc+nb]->append(aT, _comIndAccs.getSize(), &_comIndAccs[0]);
-    }
-    if(_reportConstraintReactions){
-        _storeConstraintReactions->append(aT, _constraintReactions.getSize(), &_constraintReactions[0]);
+//_____________________________________________________________________________
+/**
+ * Compute the body and generalized forces of the forces that are applied in
+ * the state and that are not actuators.
+ */
+void InducedAccelerations::calcNonActuatorForces(const SimTK::State& s,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& mobilityForces) const
+{
+    bodyForces.resize(_model->getMatterSubsystem().getNumBodies());
+    bodyForces.setToZero();
+    mobilityForces.resize(_model->getNumSpeeds());
+    mobilityForces.setToZero();
+
+    SimTK::Vector_<SimTK::SpatialVec> forceBodyForces;
+    SimTK::Vector forceMobilityForces;
+    for(const Force& force : _model->getComponentList<Force>()){
+        if(dynamic_cast<const Actuator*>(&force) || !force.appliesForce(s))
+            continue;
+        force.calcForceContribution(s, forceBodyForces, forceMobilityForces);
+        bodyForces += forceBodyForces;
+        mobilityForces += forceMobilityForces;
     }
-
-    return(0);
 }
 
 /**
@@ -208,6 +208,13 @@ public:
 protected:
     //========================== Internal Methods =============================
     int record(const SimTK::State& s);
+    void solveContributor(SimTK::State& s_analysis, const SimTK::State& s,
+        int c, const Array<bool>& constraintOn);
+    void solveContributorsTogether(SimTK::State& s_analysis,
+        const SimTK::State& s, int first);
+    void calcNonActuatorForces(const SimTK::State& s,
+        SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+        SimTK::Vector& mobilityForces) const;
     void constructDescription();
     void assembleContributors();
     Array<std::string> constructColumnLabelsForCoordinate();
@@ -169,6 +169,9 @@ setNull()
 
     _storeActuation = NULL;
 
+    // The reaction loads are the only results of the analysis
+    _storageList.setSize(0);
+    _storageList.append(&_storeReactionLoads);
 }
 //_____________________________________________________________________________
 /**
@@ -430,6 +430,7 @@ void MuscleAnalysis::setModel(Model& aModel)
 {
     Super::setModel(aModel);
     allocateStorageObjects();
+    _momentArmSolver.reset();
 }
 //_____________________________________________________________________________
 /**
@@ -641,23 +642,33 @@ int MuscleAnalysis::record(const SimTK::State& s)
 
     if (_computeMoments){
         // LOOP OVER ACTIVE MOMENT ARM STORAGE OBJECTS
-        Coordinate *q = NULL;
         Storage *maStore=NULL, *mStore=NULL;
         int nq = _momentArmStorageArray.getSize();
         Array<double> ma(0.0,nm),m(0.0,nm);
 
+        _model->getMultibodySystem().realize(s, s.getSystemStage());
+
+        // Solve for the moment arms of all muscles about all coordinates in
+        // one sweep rather than one muscle-coordinate pair at a time.
+        std::vector<const Coordinate*> coords(nq);
+        for(int i=0; i<nq; i++)
+            coords[i] = _momentArmStorageArray[i]->q;
+        std::vector<const GeometryPath*> paths(nm);
+        for(int j=0; j<nm; j++)
+            paths[j] = &_muscleArray[j]->getGeometryPath();
+        if (!_momentArmSolver)
+            _momentArmSolver.reset(new MomentArmSolver(*_model));
+        const SimTK::Matrix momentArms =
+                _momentArmSolver->solve(s, coords, paths);
+
         for(int i=0; i<nq; i++) {
 
-            q = _momentArmStorageArray[i]->q;
             maStore = _momentArmStorageArray[i]->momentArmStore;
             mStore = _momentArmStorageArray[i]->momentStore;
-           
-            // bool locked = q->getLocked(s);
 
-            _model->getMultibodySystem().realize(s, s.getSystemStage());
             // LOOP OVER MUSCLES
             for(int j=0; j<nm; j++) {
-                ma[j] = _muscleArray[j]->computeMomentArm(s,*q);
+                ma[j] = momentArms(j, i);
                 m[j] = ma[j] * force[j];
             }
             maStore->append(s.getTime(),nm,&ma[0]);
@@ -686,6 +697,8 @@ int MuscleAnalysis::begin(const SimTK::State&s )
     if(!proceed()) return 0;
 
     allocateStorageObjects();
+    // The model's system may have been re-created since the last run.
+    _momentArmSolver.reset();
 
     // RESET STORAGE
     Storage *store;
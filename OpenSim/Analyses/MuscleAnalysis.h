@@ -140,6 +140,11 @@ private:
 #endif
     /** Array of active muscles. */
     ArrayPtrs<Muscle> _muscleArray;
+#ifndef SWIG
+    /** Solves for the moment arms of all active muscles about all active
+    coordinates at once. Created when first needed. */
+    SimTK::ResetOnCopy<std::unique_ptr<MomentArmSolver> > _momentArmSolver;
+#endif
 
 //=============================================================================
 // METHODS
@@ -230,6 +235,7 @@ public:
         step(const SimTK::State& s, int setNumber ) override;
     int
         end( const SimTK::State& s ) override;
+    bool isFrameIndependent() const override { return true; }
 protected:
     virtual int
         record(const SimTK::State& s );
@@ -25,6 +25,7 @@
 //=============================================================================
 // INCLUDES
 //=============================================================================
+#include <OpenSim/Common/CommonUtilities.h>
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Actuators/CoordinateActuator.h>
@@ -61,6 +62,7 @@ StaticOptimization::StaticOptimization(Model *aModel) :
     _useMusclePhysiology(_useMusclePhysiologyProp.getValueBool()),
     _convergenceCriterion(_convergenceCriterionProp.getValueDbl()),
     _maximumIterations(_maximumIterationsProp.getValueInt()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _modelWorkingCopy(NULL)
 {
     setNull();
@@ -82,6 +84,7 @@ StaticOptimization::StaticOptimization(const StaticOptimization &aStaticOptimiza
     _useMusclePhysiology(_useMusclePhysiologyProp.getValueBool()),
     _convergenceCriterion(_convergenceCriterionProp.getValueDbl()),
     _maximumIterations(_maximumIterationsProp.getValueInt()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _modelWorkingCopy(NULL)
 {
     setNull();
@@ -114,6 +117,7 @@ operator=(const StaticOptimization &aStaticOptimization)
     _activationExponent=aStaticOptimization._activationExponent;
     _convergenceCriterion=aStaticOptimization._convergenceCriterion;
     _maximumIterations=aStaticOptimization._maximumIterations;
+    _numThreads=aStaticOptimization._numThreads;
     _forceReporter = nullptr;
     _useMusclePhysiology=aStaticOptimization._useMusclePhysiology;
     return(*this);
@@ -138,6 +142,7 @@ void StaticOptimization::setNull()
     _numCoordinateActuators = 0;
     _convergenceCriterion = 1e-4;
     _maximumIterations = 100;
+    _numThreads = 1;
     _forceReporter = nullptr;
     setName("StaticOptimization");
 }
@@ -173,6 +178,14 @@ setupProperties()
         "An integer for setting the maximum number of iterations the optimizer can use at each time.  ");
     _maximumIterationsProp.setName("optimizer_max_iterations");
     _propertySet.append(&_maximumIterationsProp);
+
+    _numThreadsProp.setComment(
+        "Number of threads used to solve different time frames concurrently "
+        "(each with its own copy of the model). With 1 (default), each frame "
+        "is solved as it is recorded. A value of 0 or less uses all "
+        "available hardware threads.");
+    _numThreadsProp.setName("num_threads");
+    _propertySet.append(&_numThreadsProp);
 }
 
 //=============================================================================
@@ -300,70 +313,69 @@ setStorageCapacityIncrements(int aIncrement)
 //=============================================================================
 //_____________________________________________________________________________
 /**
- * Record the results.
+ * Set the state of a working copy of the model to the given time, coordinates,
+ * and speeds. The other state variables (e.g., muscle activations) take the
+ * model's default values, which are not updated from frame to frame, so the
+ * solution of a frame does not depend on the frames solved before it or on
+ * which copy of the model solves it.
  */
-int StaticOptimization::
-record(const SimTK::State& s)
+void StaticOptimization::
+setWorkingState(Model& model, SimTK::State& s, double time,
+        const SimTK::Vector& q, const SimTK::Vector& u) const
 {
-    if(!_modelWorkingCopy) return -1;
-
-    // Set model to whatever defaults have been updated to from the last iteration
-    SimTK::State& sWorkingCopy = _modelWorkingCopy->updWorkingState();
-    sWorkingCopy.setTime(s.getTime());
-    _modelWorkingCopy->initStateWithoutRecreatingSystem(sWorkingCopy); 
+    s.setTime(time);
+    model.initStateWithoutRecreatingSystem(s);
 
-    // update Q's and U's
-    sWorkingCopy.setQ(s.getQ());
-    sWorkingCopy.setU(s.getU());
+    s.setQ(q);
+    s.setU(u);
 
-    _modelWorkingCopy->getMultibodySystem().realize(sWorkingCopy, SimTK::Stage::Velocity);
-    //_modelWorkingCopy->equilibrateMuscles(sWorkingCopy);
+    model.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+}
 
-    const Set<Actuator>& fs = _modelWorkingCopy->getActuators();
+/**
+ * Solve the optimization problem for the state s of a working copy of the
+ * model. On input, parameters is the initial guess; on output, it holds the
+ * solution, and forces holds the corresponding actuator forces.
+ *
+ * @return 0 on success, -1 if the optimizer failed and the model appears too
+ * weak, -2 if the optimizer failed otherwise.
+ */
+int StaticOptimization::
+solveFrame(Model& model, SimTK::State& s, SimTK::Vector& parameters,
+        SimTK::Vector& forces) const
+{
+    const Set<Actuator>& fs = model.getActuators();
 
     int na = fs.getSize();
     int nacc = _accelerationIndices.getSize();
 
-    // IPOPT
-    _numericalDerivativeStepSize = 0.0001;
-    _optimizerAlgorithm = "ipopt";
-    _printLevel = 0;
-    //_optimizationConvergenceTolerance = 1e-004;
-    //_maxIterations = 2000;
+    const double numericalDerivativeStepSize = 0.0001;
+    const int printLevel = 0;
 
-    // Optimization target
-    _modelWorkingCopy->setAllControllersEnabled(false);
-    StaticOptimizationTarget target(sWorkingCopy,_modelWorkingCopy,na,nacc,_useMusclePhysiology);
+    model.setAllControllersEnabled(false);
+    StaticOptimizationTarget target(s,&model,na,nacc,_useMusclePhysiology);
     target.setStatesStore(_statesStore);
     target.setStatesSplineSet(_statesSplineSet);
     target.setActivationExponent(_activationExponent);
-    target.setDX(_numericalDerivativeStepSize);
+    target.setDX(numericalDerivativeStepSize);
 
-    // Pick optimizer algorithm
     SimTK::OptimizerAlgorithm algorithm = SimTK::InteriorPoint;
-    //SimTK::OptimizerAlgorithm algorithm = SimTK::CFSQP;
 
-    // Optimizer
-    SimTK::Optimizer *optimizer = new SimTK::Optimizer(target, algorithm);
+    std::unique_ptr<SimTK::Optimizer> optimizer(
+            new SimTK::Optimizer(target, algorithm));
 
-    // Optimizer options
-    //cout<<"\nSetting optimizer print level to "<<_printLevel<<".\n";
-    optimizer->setDiagnosticsLevel(_printLevel);
-    //cout<<"Setting optimizer convergence criterion to "<<_convergenceCriterion<<".\n";
+    optimizer->setDiagnosticsLevel(printLevel);
     optimizer->setConvergenceTolerance(_convergenceCriterion);
-    //cout<<"Setting optimizer maximum iterations to "<<_maximumIterations<<".\n";
     optimizer->setMaxIterations(_maximumIterations);
     optimizer->useNumericalGradient(false);
     optimizer->useNumericalJacobian(false);
     if(algorithm == SimTK::InteriorPoint) {
-        // Some IPOPT-specific settings
         optimizer->setLimitedMemoryHistory(500); // works well for our small systems
         optimizer->setAdvancedBoolOption("warm_start",true);
         optimizer->setAdvancedRealOption("obj_scaling_factor",1);
         optimizer->setAdvancedRealOption("nlp_scaling_max_gradient",1);
     }
 
-    // Parameter bounds
     SimTK::Vector lowerBounds(na), upperBounds(na);
     for(int i=0,j=0;i<fs.getSize();i++) {
         ScalarActuator* act = dynamic_cast<ScalarActuator*>(&fs.get(i));
@@ -376,22 +388,14 @@ record(const SimTK::State& s)
     
     target.setParameterLimits(lowerBounds, upperBounds);
 
-    _parameters = 0; // Set initial guess to zeros
+    model.getMultibodySystem().realize(s,SimTK::Stage::Velocity);
+    target.prepareToOptimize(s, &parameters[0]);
 
-    // Static optimization
-    _modelWorkingCopy->getMultibodySystem().realize(sWorkingCopy,SimTK::Stage::Velocity);
-    target.prepareToOptimize(sWorkingCopy, &_parameters[0]);
-
-    //LARGE_INTEGER start;
-    //LARGE_INTEGER stop;
-    //LARGE_INTEGER frequency;
-
-    //QueryPerformanceFrequency(&frequency);
-    //QueryPerformanceCounter(&start);
+    int status = 0;
 
     try {
-        target.setCurrentState( &sWorkingCopy );
-        optimizer->optimize(_parameters);
+        target.setCurrentState( &s );
+        optimizer->optimize(parameters);
     }
     catch (const SimTK::Exception::Base& ex) {
         log_warn(ex.getMessage());
@@ -400,15 +404,16 @@ record(const SimTK::State& s)
                  "solution at time = {}.",
                 s.getTime());
 
+        const ForceSet& forceSet = model.getForceSet();
         double tolBounds = 1e-1;
         bool weakModel = false;
         string msgWeak = "The model appears too weak for static optimization.\nTry increasing the strength and/or range of the following force(s):\n";
         for(int a=0;a<na;a++) {
-            Actuator* act = dynamic_cast<Actuator*>(&_forceSet->get(a));
+            const Actuator* act = dynamic_cast<const Actuator*>(&forceSet.get(a));
             if( act ) {
-                Muscle*  mus = dynamic_cast<Muscle*>(&_forceSet->get(a));
+                const Muscle*  mus = dynamic_cast<const Muscle*>(&forceSet.get(a));
                 if(mus==NULL) {
-                    if(_parameters(a) < (lowerBounds(a)+tolBounds)) {
+                    if(parameters(a) < (lowerBounds(a)+tolBounds)) {
                         msgWeak += "   ";
                         msgWeak += act->getName();
                         msgWeak += " approaching lower bound of ";
@@ -417,7 +422,7 @@ record(const SimTK::State& s)
                         msgWeak += oLower.str();
                         msgWeak += "\n";
                         weakModel = true;
-                    } else if(_parameters(a) > (upperBounds(a)-tolBounds)) {
+                    } else if(parameters(a) > (upperBounds(a)-tolBounds)) {
                         msgWeak += "   ";
                         msgWeak += act->getName();
                         msgWeak += " approaching upper bound of ";
@@ -428,7 +433,7 @@ record(const SimTK::State& s)
                         weakModel = true;
                     } 
                 } else {
-                    if(_parameters(a) > (upperBounds(a)-tolBounds)) {
+                    if(parameters(a) > (upperBounds(a)-tolBounds)) {
                         msgWeak += "   ";
                         msgWeak += mus->getName();
                         msgWeak += " approaching upper bound of ";
@@ -442,15 +447,16 @@ record(const SimTK::State& s)
             }
         }
         if(weakModel) log_warn(msgWeak);
+        status = -1;
 
         if(!weakModel) {
             double tolConstraints = 1e-6;
             bool incompleteModel = false;
             string msgIncomplete = "The model appears unsuitable for static optimization.\nTry appending the model with additional force(s) or locking joint(s) to reduce the following acceleration constraint violation(s):\n";
             SimTK::Vector constraints;
-            target.constraintFunc(_parameters,true,constraints);
+            target.constraintFunc(parameters,true,constraints);
 
-            auto coordinates = _modelWorkingCopy->getCoordinatesInMultibodyTreeOrder();
+            auto coordinates = model.getCoordinatesInMultibodyTreeOrder();
 
             for(int acc=0;acc<nacc;acc++) {
                 if(fabs(constraints(acc)) > tolConstraints) {
@@ -465,39 +471,135 @@ record(const SimTK::State& s)
                     incompleteModel = true;
                 }
             }
-            _forceReporter->step(sWorkingCopy, 1);
             if(incompleteModel) log_warn(msgIncomplete);
+            status = -2;
         }
     }
 
-    //QueryPerformanceCounter(&stop);
-    //double duration = (double)(stop.QuadPart-start.QuadPart)/(double)frequency.QuadPart;
-    //cout << "optimizer time = " << (duration*1.0e3) << " milliseconds" << endl;
 
     if (Logger::shouldLog(Logger::Level::Info)) {
-        target.printPerformance(sWorkingCopy, &_parameters[0]);
+        target.printPerformance(s, &parameters[0]);
     }
 
-    //update defaults for use in the next step
+    forces.resize(na);
+    target.getActuation(s, parameters, forces);
 
+    return status;
+}
+
+/**
+ * Record the solution (and the resulting forces) for a frame whose state has
+ * been set on the working copy of the model.
+ */
+void StaticOptimization::
+recordSolution(SimTK::State& s, int status, const SimTK::Vector& parameters,
+        const SimTK::Vector& forces)
+{
     const Set<Actuator>& actuators = _modelWorkingCopy->getActuators();
-    for(int k=0; k < actuators.getSize(); ++k){
-        ActivationFiberLengthMuscle *mus = dynamic_cast<ActivationFiberLengthMuscle*>(&actuators[k]);
-        if(mus){
-            mus->setDefaultActivation(_parameters[k]);
-        }
+    int na = actuators.getSize();
+
+    // The forces of the solution (or of the last iterate, if the optimizer
+    // failed) are applied as they were when the frame was solved.
+    for(int k=0; k < na; ++k) {
+        ScalarActuator* act = dynamic_cast<ScalarActuator*>(&actuators[k]);
+        if(act) act->setOverrideActuation(s, forces[k]);
     }
 
-    _activationStorage->append(sWorkingCopy.getTime(),na,&_parameters[0]);
+    // If the optimizer failed and the model is not too weak, the forces of
+    // the last iterate are reported an extra time.
+    if(status == -2) _forceReporter->step(s, 1);
 
-    SimTK::Vector forces(na);
-    target.getActuation(const_cast<SimTK::State&>(sWorkingCopy), _parameters,forces);
+    _activationStorage->append(s.getTime(),na,&parameters[0]);
 
-    _forceReporter->step(sWorkingCopy, 1);
+    _forceReporter->step(s, 1);
+}
+
+/**
+ * Record the results.
+ */
+int StaticOptimization::
+record(const SimTK::State& s)
+{
+    if(!_modelWorkingCopy) return -1;
+
+    if(_numThreads != 1) {
+        _bufferedTimes.push_back(s.getTime());
+        _bufferedQ.push_back(s.getQ());
+        _bufferedU.push_back(s.getU());
+        return 0;
+    }
+
+    SimTK::State& sWorkingCopy = _modelWorkingCopy->updWorkingState();
+    setWorkingState(*_modelWorkingCopy, sWorkingCopy, s.getTime(),
+            s.getQ(), s.getU());
+
+    _parameters = 0; // Set initial guess to zeros
+
+    SimTK::Vector forces;
+    int status = solveFrame(*_modelWorkingCopy, sWorkingCopy, _parameters,
+            forces);
+    recordSolution(sWorkingCopy, status, _parameters, forces);
 
     return 0;
 }
-//_____________________________________________________________________________
+
+/**
+ * Solve the frames buffered by record() in parallel. The frames are divided
+ * into contiguous blocks, one per thread, and each thread solves its block in
+ * order with its own copy of the working model. As in record(), the initial
+ * guess of every frame is zero, so the solutions do not depend on how the
+ * frames are divided. The solutions are then recorded in order.
+ */
+void StaticOptimization::solveBufferedFrames()
+{
+    const int numFrames = (int)_bufferedTimes.size();
+    if(numFrames == 0) return;
+    const int numThreads = getNumThreadsForTasks(_numThreads, numFrames);
+
+    // Copy and initialize the models on this thread.
+    std::vector<std::unique_ptr<Model>> models(numThreads);
+    for(auto& model : models) {
+        model.reset(_modelWorkingCopy->clone());
+        model->updAnalysisSet().setSize(0);
+        SimTK::State& state = model->initSystem();
+        const Set<Actuator>& actuators = model->getActuators();
+        for(int k=0; k < actuators.getSize(); ++k) {
+            ScalarActuator* act = dynamic_cast<ScalarActuator*>(&actuators[k]);
+            if(act) act->overrideActuation(state, true);
+        }
+    }
+
+    std::vector<int> statuses(numFrames);
+    std::vector<SimTK::Vector> parameters(numFrames);
+    std::vector<SimTK::Vector> forces(numFrames);
+
+    log_info("StaticOptimization: solving {} frames using {} threads.",
+            numFrames, numThreads);
+    executeInParallelBlocks(0, numFrames, numThreads,
+            [&](int thread, int blockBegin, int blockEnd) {
+        Model& model = *models[thread];
+        SimTK::State& s = model.updWorkingState();
+        for(int i = blockBegin; i < blockEnd; ++i) {
+            setWorkingState(model, s, _bufferedTimes[i], _bufferedQ[i],
+                    _bufferedU[i]);
+            parameters[i].resize(_parameters.size());
+            parameters[i] = 0; // Set initial guess to zeros
+            statuses[i] = solveFrame(model, s, parameters[i], forces[i]);
+        }
+    });
+
+    SimTK::State& sWorkingCopy = _modelWorkingCopy->updWorkingState();
+    for(int i = 0; i < numFrames; ++i) {
+        setWorkingState(*_modelWorkingCopy, sWorkingCopy, _bufferedTimes[i],
+                _bufferedQ[i], _bufferedU[i]);
+        recordSolution(sWorkingCopy, statuses[i], parameters[i], forces[i]);
+    }
+    _parameters = parameters.back();
+
+    _bufferedTimes.clear();
+    _bufferedQ.clear();
+    _bufferedU.clear();
+}
 /**
  * This method is called at the beginning of an analysis so that any
  * necessary initializations may be performed.
@@ -665,6 +767,8 @@ int StaticOptimization::end( const SimTK::State& s )
 
     record(s);
 
+    if(_numThreads != 1) solveBufferedFrames();
+
     return(0);
 }
 
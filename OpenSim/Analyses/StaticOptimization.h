@@ -29,6 +29,7 @@
 //=============================================================================
 #include "osimAnalysesDLL.h"
 #include <memory>
+#include <vector>
 #include <OpenSim/Simulation/Model/Analysis.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 #include "ForceReporter.h"
@@ -76,6 +77,9 @@ protected:
     PropertyInt _maximumIterationsProp;
     int &_maximumIterations;
 
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
+
     Storage *_activationStorage;
     Storage *_forceStorage;
     GCVSplineSet _statesSplineSet;
@@ -93,6 +97,12 @@ protected:
 
     Model *_modelWorkingCopy;
 
+    // Frames buffered by record() when solving in parallel; they are solved
+    // together when the analysis ends.
+    std::vector<double> _bufferedTimes;
+    std::vector<SimTK::Vector> _bufferedQ;
+    std::vector<SimTK::Vector> _bufferedU;
+
 //=============================================================================
 // METHODS
 //=============================================================================
@@ -135,6 +145,13 @@ public:
     double getConvergenceCriterion() { return _convergenceCriterion; }
     void setMaxIterations( const int maxIt) { _maximumIterations = maxIt; }
     int getMaxIterations() {return _maximumIterations; }
+    /** Set the number of threads used to solve the optimization problems of
+    different frames concurrently. With 1 (the default), each frame is solved
+    when it is recorded. Otherwise, frames are buffered and solved when end()
+    is called, using a separate copy of the model for each thread; a value
+    of 0 or less uses all available hardware threads. */
+    void setNumThreads(int numThreads) { _numThreads = numThreads; }
+    int getNumThreads() const { return _numThreads; }
     //--------------------------------------------------------------------------
     // ANALYSIS
     //--------------------------------------------------------------------------
@@ -147,6 +164,14 @@ public:
 protected:
     virtual int
         record(const SimTK::State& s );
+private:
+    void setWorkingState(Model& model, SimTK::State& s, double time,
+            const SimTK::Vector& q, const SimTK::Vector& u) const;
+    int solveFrame(Model& model, SimTK::State& s,
+            SimTK::Vector& parameters, SimTK::Vector& forces) const;
+    void recordSolution(SimTK::State& s, int status,
+            const SimTK::Vector& parameters, const SimTK::Vector& forces);
+    void solveBufferedFrames();
     //--------------------------------------------------------------------------
     // IO
     //--------------------------------------------------------------------------
@@ -30,6 +30,7 @@
 // INCLUDES
 //=============================================================================
 #include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/Model/PathActuator.h>
 #include "StaticOptimizationTarget.h"
 
 using namespace OpenSim;
@@ -121,23 +122,81 @@ prepareToOptimize(SimTK::State& s, double *x)
     _constraintMatrix.resize(nc,np);
     _constraintVector.resize(nc);
 
-    Vector pVector(np), cVector(nc);
+    Vector pVector(np);
 
-    // Build linear constraint matrix and constant constraint vector
+    // Build constant constraint vector (all actuators off)
     pVector = 0;
     computeConstraintVector(s, pVector,_constraintVector);
 
+    // Build linear constraint matrix. Rather than realizing the whole system
+    // once per actuator (perturbing one activation at a time), compute the
+    // generalized force produced by each actuator at unit activation, then
+    // the resulting change in accelerations. Accelerations are linear in the
+    // applied generalized forces, and actuator forces are linear in the
+    // activations since the actuation is overridden.
+    const SimTK::SimbodyMatterSubsystem& matter = _model->getMatterSubsystem();
+    const int nu = s.getNU();
+    Matrix unitForces(nu, np);
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces(matter.getNumBodies());
+    Vector mobilityForces(nu), generalizedForces(nu);
+    for(int i=0, j=0;i<fSet.getSize();i++) {
+        ScalarActuator* act = dynamic_cast<ScalarActuator*>(&fSet.get(i));
+        if(!act) continue;
+        bodyForces.setToZero();
+        mobilityForces.setToZero();
+        if(act->appliesForce(s)) {
+            if(PathActuator* pathAct = dynamic_cast<PathActuator*>(act)) {
+                pathAct->getGeometryPath().addInEquivalentForces(s,
+                        _optimalForce[j], bodyForces, mobilityForces);
+            } else {
+                act->setOverrideActuation(s, _optimalForce[j]);
+                _model->getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+                act->computeForce(s, bodyForces, mobilityForces);
+                act->setOverrideActuation(s, 0);
+            }
+        }
+        _model->getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+        matter.multiplyBySystemJacobianTranspose(s, bodyForces,
+                generalizedForces);
+        unitForces(j++) = generalizedForces + mobilityForces;
+    }
+
+    _model->getMultibodySystem().realize(s, SimTK::Stage::Dynamics);
+    Vector udotOff(nu), udot(nu);
+    SimTK::Vector_<SimTK::SpatialVec> A_GB(matter.getNumBodies());
+    bodyForces.setToZero();
+    mobilityForces.setToZero();
+    matter.calcAcceleration(s, mobilityForces, bodyForces, udotOff, A_GB);
     for(int p=0; p<np; p++) {
-        pVector[p] = 1;
-        computeConstraintVector(s, pVector, cVector);
-        for(int c=0; c<nc; c++) _constraintMatrix(c,p) = (cVector[c] - _constraintVector[c]);
-        pVector[p] = 0;
+        matter.calcAcceleration(s, unitForces(p), bodyForces, udot, A_GB);
+        for(int c=0; c<nc; c++) {
+            const int ind = _accelerationIndices[c];
+            _constraintMatrix(c,p) = udotOff[ind] - udot[ind];
+        }
     }
 #endif
 
     // return false to indicate that we still need to proceed with optimization
     return false;
 }
+
+void StaticOptimizationTarget::
+computeConstraintMatrixByPerturbation(SimTK::State& s, Matrix& matrix) const
+{
+    const int np = getNumParameters();
+    const int nc = getNumConstraints();
+    matrix.resize(nc,np);
+
+    Vector pVector(np), accelOff(nc), accel(nc);
+    pVector = 0;
+    computeAcceleration(s, pVector, accelOff);
+    for(int p=0; p<np; p++) {
+        pVector[p] = 1;
+        computeAcceleration(s, pVector, accel);
+        for(int c=0; c<nc; c++) matrix(c,p) = accelOff[c] - accel[c];
+        pVector[p] = 0;
+    }
+}
 //==============================================================================
 // SET AND GET
 //==============================================================================
@@ -113,6 +113,18 @@ public:
 
     bool prepareToOptimize(SimTK::State& s, double *x);
 
+    /** The linear constraint matrix computed by prepareToOptimize(): the
+    change in each constraint per unit change in each parameter. */
+    const SimTK::Matrix& getConstraintMatrix() const
+    {   return _constraintMatrix; }
+    /** Compute the linear constraint matrix by setting one parameter at a
+    time to 1 (the others 0) and realizing the accelerations of the model.
+    prepareToOptimize() computes the same matrix without realizing the
+    accelerations once per parameter; this is slower and is meant for
+    testing. prepareToOptimize() must have been invoked. */
+    void computeConstraintMatrixByPerturbation(SimTK::State& s,
+            SimTK::Matrix& matrix) const;
+
     //--------------------------------------------------------------------------
     // REQUIRED OPTIMIZATION TARGET METHODS
     //--------------------------------------------------------------------------
@@ -0,0 +1,360 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  BinaryFileAdapter.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "BinaryFileAdapter.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+
+namespace OpenSim {
+
+const std::string BinaryFileAdapter::_signature{"OSIMSTOB"};
+const unsigned    BinaryFileAdapter::_versionNumber{1};
+const std::string BinaryFileAdapter::_timeColumnLabel{"time"};
+
+namespace {
+
+// How the values of a column are stored.
+enum ColumnEncoding : std::uint8_t {
+    // One float64 per row.
+    Raw = 0,
+    // A single float64, shared by all rows.
+    Constant = 1
+};
+
+// An entry in the column directory.
+struct ColumnEntry {
+    std::uint64_t offset = 0;
+    std::uint64_t size = 0;
+    std::uint8_t encoding = Raw;
+};
+
+struct BinaryFileHeader {
+    unsigned version = 0;
+    AbstractDataTable::TableMetaData metadata;
+    std::uint64_t numRows = 0;
+    std::vector<std::string> labels;
+    // Time column first, then the columns in the order of labels.
+    std::vector<ColumnEntry> columns;
+};
+
+bool isLittleEndian() {
+    const std::uint16_t one = 1;
+    return *reinterpret_cast<const unsigned char*>(&one) == 1;
+}
+
+template <typename T>
+void swapBytes(T& value) {
+    auto* bytes = reinterpret_cast<unsigned char*>(&value);
+    std::reverse(bytes, bytes + sizeof(T));
+}
+
+template <typename T>
+void writeValue(std::ostream& out, T value) {
+    if (!isLittleEndian()) swapBytes(value);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void writeString(std::ostream& out, const std::string& str) {
+    writeValue(out, static_cast<std::uint32_t>(str.size()));
+    out.write(str.data(), str.size());
+}
+
+void writeDoubles(std::ostream& out, std::vector<double>& values) {
+    if (!isLittleEndian()) {
+        for (auto& value : values) swapBytes(value);
+    }
+    out.write(reinterpret_cast<const char*>(values.data()),
+            values.size() * sizeof(double));
+}
+
+// Reads from a binary file, throwing if the file ends prematurely.
+class BinaryReader {
+public:
+    BinaryReader(std::istream& in, const std::string& fileName) :
+            _in(in), _fileName(fileName) {}
+
+    void readBytes(char* dest, std::uint64_t numBytes) {
+        _in.read(dest, static_cast<std::streamsize>(numBytes));
+        OPENSIM_THROW_IF(!_in, InvalidBinaryFile, _fileName,
+                "Unexpected end of file.");
+    }
+    template <typename T>
+    T readValue() {
+        T value;
+        readBytes(reinterpret_cast<char*>(&value), sizeof(T));
+        if (!isLittleEndian()) swapBytes(value);
+        return value;
+    }
+    std::string readString() {
+        const auto size = readValue<std::uint32_t>();
+        std::string str(size, '\0');
+        if (size) readBytes(&str[0], size);
+        return str;
+    }
+    // Read the values of a column into dest, which must have room for
+    // numRows values.
+    void readColumn(const ColumnEntry& entry, std::uint64_t numRows,
+            double* dest) {
+        _in.seekg(static_cast<std::streamoff>(entry.offset));
+        if (entry.encoding == Constant) {
+            const double value = readValue<double>();
+            std::fill(dest, dest + numRows, value);
+        } else {
+            readBytes(reinterpret_cast<char*>(dest), numRows * sizeof(double));
+            if (!isLittleEndian()) {
+                for (std::uint64_t i = 0; i < numRows; ++i)
+                    swapBytes(dest[i]);
+            }
+        }
+    }
+    const std::string& getFileName() const { return _fileName; }
+
+private:
+    std::istream& _in;
+    const std::string& _fileName;
+};
+
+BinaryFileHeader readHeader(BinaryReader& reader, const std::string& signature,
+        unsigned latestVersion) {
+    const auto& fileName = reader.getFileName();
+    BinaryFileHeader header;
+
+    std::string fileSignature(signature.size(), '\0');
+    reader.readBytes(&fileSignature[0], fileSignature.size());
+    OPENSIM_THROW_IF(fileSignature != signature, InvalidBinaryFile, fileName,
+            "The file does not start with '" + signature + "'.");
+    header.version = reader.readValue<std::uint32_t>();
+    OPENSIM_THROW_IF(header.version > latestVersion, InvalidBinaryFile,
+            fileName,
+            "File format version " + std::to_string(header.version) +
+                    " is newer than the latest supported version (" +
+                    std::to_string(latestVersion) + ").");
+
+    const auto numMetadata = reader.readValue<std::uint32_t>();
+    for (std::uint32_t i = 0; i < numMetadata; ++i) {
+        const auto key = reader.readString();
+        const auto value = reader.readString();
+        header.metadata.setValueForKey(key, value);
+    }
+
+    header.numRows = reader.readValue<std::uint64_t>();
+    const auto numColumns = reader.readValue<std::uint32_t>();
+    header.labels.reserve(numColumns);
+    for (std::uint32_t i = 0; i < numColumns; ++i)
+        header.labels.push_back(reader.readString());
+
+    header.columns.resize(numColumns + 1);
+    for (auto& entry : header.columns) {
+        entry.offset = reader.readValue<std::uint64_t>();
+        entry.size = reader.readValue<std::uint64_t>();
+        entry.encoding = reader.readValue<std::uint8_t>();
+        const std::uint64_t expectedSize =
+                entry.encoding == Constant ? sizeof(double)
+                                           : header.numRows * sizeof(double);
+        OPENSIM_THROW_IF(
+                (entry.encoding != Raw && entry.encoding != Constant) ||
+                        (header.numRows > 0 && entry.size != expectedSize),
+                InvalidBinaryFile, fileName, "Invalid column directory.");
+    }
+    return header;
+}
+
+} // anonymous namespace
+
+BinaryFileAdapter*
+BinaryFileAdapter::clone() const {
+    return new BinaryFileAdapter{*this};
+}
+
+const std::string
+BinaryFileAdapter::tableString() {
+    return "table";
+}
+
+void
+BinaryFileAdapter::write(const TimeSeriesTable& table,
+                         const std::string& fileName) {
+    InputTables tables{};
+    tables.emplace(tableString(), &table);
+    BinaryFileAdapter{}.extendWrite(tables, fileName);
+}
+
+std::vector<std::string>
+BinaryFileAdapter::readColumnLabels(const std::string& fileName) {
+    OPENSIM_THROW_IF(fileName.empty(), EmptyFileName);
+    std::ifstream in_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!in_stream.good(), FileDoesNotExist, fileName);
+    BinaryReader reader(in_stream, fileName);
+    return readHeader(reader, _signature, _versionNumber).labels;
+}
+
+SimTK::Vector
+BinaryFileAdapter::readColumn(const std::string& fileName,
+                              const std::string& columnLabel) {
+    OPENSIM_THROW_IF(fileName.empty(), EmptyFileName);
+    std::ifstream in_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!in_stream.good(), FileDoesNotExist, fileName);
+    BinaryReader reader(in_stream, fileName);
+    const auto header = readHeader(reader, _signature, _versionNumber);
+
+    size_t index = 0;
+    if (columnLabel != _timeColumnLabel) {
+        auto it = std::find(header.labels.begin(), header.labels.end(),
+                columnLabel);
+        OPENSIM_THROW_IF(it == header.labels.end(), KeyMissing, columnLabel);
+        index = 1 + (it - header.labels.begin());
+    }
+    SimTK::Vector column(static_cast<int>(header.numRows));
+    if (header.numRows)
+        reader.readColumn(header.columns[index], header.numRows, &column[0]);
+    return column;
+}
+
+BinaryFileAdapter::OutputTables
+BinaryFileAdapter::extendRead(const std::string& fileName) const {
+    OPENSIM_THROW_IF(fileName.empty(), EmptyFileName);
+    std::ifstream in_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!in_stream.good(), FileDoesNotExist, fileName);
+    BinaryReader reader(in_stream, fileName);
+    const auto header = readHeader(reader, _signature, _versionNumber);
+
+    const auto numRows = header.numRows;
+    const int ncol = static_cast<int>(header.labels.size());
+    std::vector<double> timeVec(numRows);
+    if (numRows) reader.readColumn(header.columns[0], numRows, &timeVec[0]);
+
+    SimTK::Matrix matrix(static_cast<int>(numRows), ncol);
+    std::vector<double> values(numRows);
+    for (int col = 0; col < ncol; ++col) {
+        if (!numRows) break;
+        reader.readColumn(header.columns[col + 1], numRows, &values[0]);
+        auto column = matrix.updCol(col);
+        for (int row = 0; row < static_cast<int>(numRows); ++row)
+            column[row] = values[row];
+    }
+
+    auto table = std::make_shared<TimeSeriesTable>(timeVec, matrix,
+            header.labels);
+    table->updTableMetaData() = header.metadata;
+
+    OutputTables output_tables{};
+    output_tables.emplace(tableString(), table);
+    return output_tables;
+}
+
+void
+BinaryFileAdapter::extendWrite(const InputTables& absTables,
+                               const std::string& fileName) const {
+    OPENSIM_THROW_IF(absTables.empty(), NoTableFound);
+
+    const TimeSeriesTable* table{};
+    try {
+        auto abs_table = absTables.at(tableString());
+        table = dynamic_cast<const TimeSeriesTable*>(abs_table);
+    } catch(std::out_of_range&) {
+        OPENSIM_THROW(KeyMissing, tableString());
+    }
+    OPENSIM_THROW_IF(!table, IncorrectTableType,
+            "BinaryFileAdapter only writes TimeSeriesTable (of doubles).");
+    OPENSIM_THROW_IF(fileName.empty(), EmptyFileName);
+
+    std::ofstream out_stream{fileName, std::ios::binary};
+    OPENSIM_THROW_IF(!out_stream.good(), IOError);
+
+    out_stream.write(_signature.data(), _signature.size());
+    writeValue(out_stream, static_cast<std::uint32_t>(_versionNumber));
+
+    // Only metadata with string values can be written.
+    std::vector<std::pair<std::string, std::string>> metadata;
+    for (const auto& key : table->getTableMetaDataKeys()) {
+        try {
+            metadata.emplace_back(key,
+                    table->getTableMetaData<std::string>(key));
+        } catch (const InvalidTemplateArgument&) {}
+    }
+    writeValue(out_stream, static_cast<std::uint32_t>(metadata.size()));
+    for (const auto& entry : metadata) {
+        writeString(out_stream, entry.first);
+        writeString(out_stream, entry.second);
+    }
+
+    const size_t numRows = table->getNumRows();
+    const size_t numColumns = table->getNumColumns();
+    writeValue(out_stream, static_cast<std::uint64_t>(numRows));
+    writeValue(out_stream, static_cast<std::uint32_t>(numColumns));
+    for (const auto& label : table->getColumnLabels())
+        writeString(out_stream, label);
+
+    // Reserve space for the directory; it is filled in once the size of each
+    // column is known.
+    std::vector<ColumnEntry> columns(numColumns + 1);
+    const auto directoryPos = out_stream.tellp();
+    for (size_t i = 0; i < columns.size(); ++i) {
+        writeValue(out_stream, std::uint64_t(0));
+        writeValue(out_stream, std::uint64_t(0));
+        writeValue(out_stream, std::uint8_t(0));
+    }
+
+    std::vector<double> values(numRows);
+    for (size_t icol = 0; icol < columns.size(); ++icol) {
+        if (icol == 0) {
+            const auto& time = table->getIndependentColumn();
+            std::copy(time.begin(), time.end(), values.begin());
+        } else {
+            const auto column = table->getDependentColumnAtIndex(icol - 1);
+            for (size_t row = 0; row < numRows; ++row)
+                values[row] = column[static_cast<int>(row)];
+        }
+        auto& entry = columns[icol];
+        entry.offset = static_cast<std::uint64_t>(out_stream.tellp());
+        // Compare bit patterns so that NaNs and signed zeros are preserved.
+        const bool isConstant = numRows > 0 &&
+                std::all_of(values.begin(), values.end(),
+                        [&](const double& value) {
+                            return std::equal(
+                                    reinterpret_cast<const char*>(&value),
+                                    reinterpret_cast<const char*>(&value + 1),
+                                    reinterpret_cast<const char*>(&values[0]));
+                        });
+        if (isConstant) {
+            entry.encoding = Constant;
+            entry.size = sizeof(double);
+            writeValue(out_stream, values[0]);
+        } else {
+            entry.encoding = Raw;
+            entry.size = numRows * sizeof(double);
+            writeDoubles(out_stream, values);
+        }
+    }
+
+    out_stream.seekp(directoryPos);
+    for (const auto& entry : columns) {
+        writeValue(out_stream, entry.offset);
+        writeValue(out_stream, entry.size);
+        writeValue(out_stream, entry.encoding);
+    }
+    OPENSIM_THROW_IF(!out_stream.good(), IOError);
+}
+
+} // namespace OpenSim
@@ -0,0 +1,124 @@
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  BinaryFileAdapter.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#ifndef OPENSIM_BINARY_FILE_ADAPTER_H_
+#define OPENSIM_BINARY_FILE_ADAPTER_H_
+
+#include "FileAdapter.h"
+#include "TimeSeriesTable.h"
+
+namespace OpenSim {
+
+class InvalidBinaryFile : public IOError {
+public:
+    InvalidBinaryFile(const std::string& file,
+                      size_t line,
+                      const std::string& func,
+                      const std::string& filename,
+                      const std::string& reason) :
+        IOError(file, line, func) {
+        std::string msg = "Error reading binary file '" + filename + "'. ";
+        msg += reason;
+
+        addMessage(msg);
+    }
+};
+
+/** BinaryFileAdapter is a FileAdapter that reads and writes a
+TimeSeriesTable (of doubles) in a binary, column-oriented format, identified by
+the extension ".stob". It is registered with FileAdapter, so TimeSeriesTable,
+Storage, and the tools read and write .stob files just as they do .sto files.
+Compared to .sto files, .stob files are smaller, store every value exactly,
+and are much faster to read and write since no text is parsed or formatted.
+
+The file contains (all integers unsigned, and all numbers little-endian; a
+string is a 32-bit length followed by that many bytes):
+  - the 8-byte signature "OSIMSTOB",
+  - the format version (32 bits),
+  - the number of metadata entries (32 bits), followed by a key string and a
+    value string for each entry,
+  - the number of rows (64 bits) and the number of columns, excluding time
+    (32 bits), followed by a string for each column label,
+  - a directory with one entry for the time column and for each column: the
+    position of the column's data in the file (64 bits), the size of that
+    data in bytes (64 bits), and its encoding (8 bits),
+  - the data of each column, contiguously.
+
+A column is encoded either as one 64-bit float per row, or, if all of its
+values are equal (e.g., the coordinate of a locked joint), as a single 64-bit
+float. Only metadata whose values are strings are written (as with .sto
+files).
+
+Because each column is stored contiguously and its position is recorded in
+the directory, readColumn() loads one column without reading the data of the
+other columns.                                                               */
+class OSIMCOMMON_API BinaryFileAdapter : public FileAdapter {
+public:
+    BinaryFileAdapter()                                    = default;
+    BinaryFileAdapter(const BinaryFileAdapter&)            = default;
+    BinaryFileAdapter(BinaryFileAdapter&&)                 = default;
+    BinaryFileAdapter& operator=(const BinaryFileAdapter&) = default;
+    BinaryFileAdapter& operator=(BinaryFileAdapter&&)      = default;
+    ~BinaryFileAdapter()                                   = default;
+
+    BinaryFileAdapter* clone() const override;
+
+    /** Write a table to a binary file. The filename provided need not
+    contain ".stob".                                                          */
+    static
+    void write(const TimeSeriesTable& table, const std::string& fileName);
+
+    /** Read the labels of the columns (excluding time) from a binary file,
+    without reading any data.                                                 */
+    static
+    std::vector<std::string> readColumnLabels(const std::string& fileName);
+
+    /** Read one column from a binary file. Use "time" to read the time
+    column. Only the header of the file and the data of this column are
+    read.                                                                     */
+    static
+    SimTK::Vector readColumn(const std::string& fileName,
+                             const std::string& columnLabel);
+
+    /** Key used for table associative array returned/accepted by write/read. */
+    static const std::string tableString();
+
+protected:
+    /** Implementation of the read functionality.                             */
+    OutputTables extendRead(const std::string& fileName) const override;
+
+    /** Implementation of the write functionality.                            */
+    void extendWrite(const InputTables& tables,
+                     const std::string& fileName) const override;
+
+private:
+    /** Signature at the start of every file.                                 */
+    static const std::string _signature;
+    /** Version of the file format written by this adapter.                   */
+    static const unsigned    _versionNumber;
+    /** Label used to request the time column from readColumn().              */
+    static const std::string _timeColumnLabel;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_BINARY_FILE_ADAPTER_H_
@@ -23,14 +23,19 @@
 
 #include "CommonUtilities.h"
 
+#include "Logger.h"
 #include "PiecewiseLinearFunction.h"
 #include "STOFileAdapter.h"
 #include "TimeSeriesTable.h"
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <ctime>
 #include <iomanip>
 #include <memory>
+#include <mutex>
 #include <sstream>
+#include <thread>
 
 #include <SimTKcommon/internal/Pathname.h>
 
@@ -183,3 +188,95 @@ SimTK::Real OpenSim::solveBisection(
     }
     return midpoint;
 }
+
+int OpenSim::getNumThreadsForTasks(int requested, int numTasks) {
+    int numThreads = requested;
+    if (numThreads <= 0) {
+        numThreads = (int)std::thread::hardware_concurrency();
+    }
+    if (numThreads > numTasks) numThreads = numTasks;
+    if (numThreads < 1) numThreads = 1;
+    return numThreads;
+}
+
+namespace {
+// Invoke task(threadIndex) on each of numThreads threads. The first exception
+// thrown by any invocation is rethrown after all threads have finished. Each
+// thread buffers the messages it logs so that the threads do not contend for
+// the sinks of the logger, and tags them with the tag of the calling thread.
+void runOnThreads(int numThreads, const std::function<void(int)>& task) {
+    std::exception_ptr firstException;
+    std::mutex exceptionMutex;
+    // The messages that the calling thread logged so far precede those of
+    // the threads.
+    Logger::ThreadContext::flushAll();
+    const std::string logTag = Logger::getThreadTag();
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads);
+    for (int ithread = 0; ithread < numThreads; ++ithread) {
+        threads.emplace_back([&task, &firstException, &exceptionMutex,
+                                     &logTag, ithread]() {
+                    Logger::setThreadTag(logTag);
+                    Logger::ThreadContext logContext;
+                    try {
+                        task(ithread);
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(exceptionMutex);
+                        if (!firstException)
+                            firstException = std::current_exception();
+                    }
+                });
+    }
+    for (auto& thread : threads) thread.join();
+    if (firstException) std::rethrow_exception(firstException);
+}
+} // anonymous namespace
+
+void OpenSim::executeInParallelBlocks(int begin, int end, int numThreads,
+        const std::function<void(int, int, int)>& task) {
+    OPENSIM_THROW_IF(end < begin, Exception,
+            "Expected end ({}) to be greater than or equal to begin ({}).",
+            end, begin);
+    const int numItems = end - begin;
+    numThreads = getNumThreadsForTasks(numThreads, numItems);
+    if (numThreads == 1) {
+        task(0, begin, end);
+        return;
+    }
+
+    const int blockSize = numItems / numThreads;
+    const int remainder = numItems % numThreads;
+    runOnThreads(numThreads, [&](int ithread) {
+        // The first `remainder` blocks get one extra item.
+        const int blockBegin = begin + ithread * blockSize +
+                               std::min(ithread, remainder);
+        const int blockEnd =
+                blockBegin + blockSize + (ithread < remainder ? 1 : 0);
+        task(ithread, blockBegin, blockEnd);
+    });
+}
+
+void OpenSim::executeInParallel(int numTasks, int numThreads,
+        const std::function<void(int, int)>& task) {
+    OPENSIM_THROW_IF(numTasks < 0, Exception,
+            "Expected numTasks to be non-negative, but got {}.", numTasks);
+    numThreads = getNumThreadsForTasks(numThreads, numTasks);
+    if (numThreads == 1) {
+        for (int itask = 0; itask < numTasks; ++itask) task(0, itask);
+        return;
+    }
+
+    std::atomic<int> nextTask(0);
+    std::atomic<bool> failed(false);
+    runOnThreads(numThreads, [&](int ithread) {
+        try {
+            int itask;
+            while (!failed && (itask = nextTask++) < numTasks) {
+                task(ithread, itask);
+            }
+        } catch (...) {
+            failed = true;
+            throw;
+        }
+    });
+}
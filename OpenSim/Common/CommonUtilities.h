@@ -113,6 +113,40 @@ SimTK::Real solveBisection(std::function<double(const double&)> calcResidual,
         double left, double right, const double& tolerance = 1e-6,
         int maxIterations = 1000);
 
+/// Determine the number of threads to use for work that can be divided into
+/// `numTasks` independent pieces. A `requested` value of 0 or less means "use
+/// all hardware threads". The result is at least 1 and at most numTasks.
+OSIMCOMMON_API
+int getNumThreadsForTasks(int requested, int numTasks);
+
+/// Divide the index range [begin, end) into `numThreads` contiguous blocks of
+/// (nearly) equal size and invoke `task(threadIndex, blockBegin, blockEnd)`
+/// for each block on its own thread. Blocks are assigned to threads in order,
+/// so block `threadIndex` always precedes block `threadIndex + 1`. If
+/// numThreads is 1, the task is invoked on the calling thread.
+/// If any invocation throws, the first exception is rethrown on the calling
+/// thread after all threads have finished. Each thread logs its messages
+/// through a Logger::ThreadContext, with the tag of the calling thread
+/// (Logger::setThreadTag()).
+OSIMCOMMON_API
+void executeInParallelBlocks(int begin, int end, int numThreads,
+        const std::function<void(int, int, int)>& task);
+
+/// Invoke `task(threadIndex, taskIndex)` for each taskIndex in [0, numTasks)
+/// using `numThreads` threads. Tasks are handed out one at a time: a thread
+/// takes the next unclaimed task as soon as it finishes its current one, so
+/// this balances the load well when tasks have very different costs. Tasks
+/// are started in increasing order but may finish in any order. A numThreads
+/// of 0 or less uses all hardware threads. If numThreads is 1, the tasks are
+/// invoked on the calling thread. If any invocation throws, no new tasks are
+/// started and the first exception is rethrown on the calling thread after
+/// all threads have finished. Each thread logs its messages through a
+/// Logger::ThreadContext, with the tag of the calling thread
+/// (Logger::setThreadTag()).
+OSIMCOMMON_API
+void executeInParallel(int numTasks, int numThreads,
+        const std::function<void(int, int)>& task);
+
 } // namespace OpenSim
 
 #endif // OPENSIM_COMMONUTILITIES_H_
@@ -24,6 +24,8 @@
 
 // INCLUDES
 #include "Component.h"
+#include "ComponentProfiler.h"
+#include "StateVariableLayout.h"
 #include "OpenSim/Common/IO.h"
 #include "XMLDocument.h"
 #include <unordered_map>
@@ -79,29 +81,49 @@ public:
     {   return this->getValueZero(); }
 
     void realizeMeasureTopologyVirtual(SimTK::State& s) const override final
-    {   _Component.extendRealizeTopology(s); }
+    {   if (ComponentProfiler* profiler = _Component.getProfiler())
+            profiler->forgetComponent(_Component);
+        ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeTopology", SimTK::Stage::Topology);
+        _Component.extendRealizeTopology(s); }
     void realizeMeasureModelVirtual(SimTK::State& s) const override final
-    {   _Component.extendRealizeModel(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeModel", SimTK::Stage::Model);
+        _Component.extendRealizeModel(s); }
     void realizeMeasureInstanceVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizeInstance(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeInstance", SimTK::Stage::Instance);
+        _Component.extendRealizeInstance(s); }
     void realizeMeasureTimeVirtual(const SimTK::State& s) const override final
-    {   _Component.extendRealizeTime(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeTime", SimTK::Stage::Time);
+        _Component.extendRealizeTime(s); }
     void realizeMeasurePositionVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizePosition(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizePosition", SimTK::Stage::Position);
+        _Component.extendRealizePosition(s); }
     void realizeMeasureVelocityVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizeVelocity(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeVelocity", SimTK::Stage::Velocity);
+        _Component.extendRealizeVelocity(s); }
     void realizeMeasureDynamicsVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizeDynamics(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeDynamics", SimTK::Stage::Dynamics);
+        _Component.extendRealizeDynamics(s); }
     void realizeMeasureAccelerationVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizeAcceleration(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeAcceleration", SimTK::Stage::Acceleration);
+        _Component.extendRealizeAcceleration(s); }
     void realizeMeasureReportVirtual(const SimTK::State& s)
         const override final
-    {   _Component.extendRealizeReport(s); }
+    {   ComponentProfiler::Scope scope(_Component.getProfiler(),
+            _Component, "realizeReport", SimTK::Stage::Report);
+        _Component.extendRealizeReport(s); }
 
 private:
     const Component& _Component;
@@ -127,6 +149,13 @@ Component::Component(SimTK::Xml::Element& element) : Object(element)
     constructProperty_components();
 }
 
+void Component::setProfiler(ComponentProfiler* profiler) {
+    _profiler = profiler;
+    for (auto& comp : updComponentList()) {
+        comp._profiler = profiler;
+    }
+}
+
 bool Component::isComponentInOwnershipTree(const Component* subcomponent) const {
     //get to the root Component
     const Component* root = this;
@@ -177,6 +206,8 @@ void Component::prependComponentPathToConnecteePath(
 
 void Component::finalizeFromProperties()
 {
+    // The subcomponents of this component are about to be rebuilt.
+    clearComponentIndex();
     reset();
 
     // last opportunity to modify Object names based on properties
@@ -224,6 +255,22 @@ void Component::finalizeFromProperties()
     }
 
     markPropertiesAsSubcomponents();
+
+    // Subcomponents are profiled by the profiler of their owner. A root
+    // component without a profiler uses the default profiler, if any.
+    if (!hasOwner() && _profiler.empty()) {
+        _profiler = ComponentProfiler::getDefault();
+    }
+    for (auto& comp : _memberSubcomponents) {
+        comp->_profiler = _profiler.get();
+    }
+    for (auto& comp : _propertySubcomponents) {
+        comp->_profiler = _profiler.get();
+    }
+    for (auto& comp : _adoptedSubcomponents) {
+        comp->_profiler = _profiler.get();
+    }
+
     componentsFinalizeFromProperties();
 
     // The following block is used to ensure that deserialized names of 
@@ -263,6 +310,7 @@ void Component::finalizeFromProperties()
             // Now rename the subcomponent with its verified unique name
             Component* mutableSub = const_cast<Component *>(sub.get());
             mutableSub->setName(uniqueName);
+            clearComponentIndex();
         }
 
         // keep track of unique names
@@ -334,6 +382,9 @@ void Component::finalizeConnections(Component& root)
     // Allow subcomponents to form their connections
     componentsFinalizeConnections(root);
 
+    // The tree is complete; index it for finding components by path.
+    if (this == &root) getComponentIndex();
+
     // Forming connections changes the Socket which is a property
     // Remark as upToDate.
     setObjectIsUpToDateWithProperties();
@@ -408,9 +459,9 @@ void Component::baseAddToSystem(SimTK::MultibodySystem& system) const
         throw Exception(msg);
     }
 
-    // Clear cached list of all related StateVariables if any from a previous
-    // System.
-    _allStateVariables.clear();
+    // Clear cached layout of all related StateVariables if any from a
+    // previous System.
+    _stateVariableLayouts.clear();
 
     // Briefly get write access to the Component to record some
     // information associated with the System; that info is const after this.
@@ -698,6 +749,200 @@ const Component& Component::getRoot() const {
     return *root;
 }
 
+//------------------------------------------------------------------------------
+//                          COMPONENT INDEX
+//------------------------------------------------------------------------------
+struct Component::ComponentIndex {
+    // All components in the tree except the root, by absolute path.
+    std::unordered_map<std::string, const Component*> byPath;
+    // All components in the tree except the root, by name, in tree pre-order.
+    std::unordered_map<std::string, std::vector<const Component*>> byName;
+};
+
+namespace {
+    // A path is normalized if it is not empty and has no empty, "." or ".."
+    // elements (other than the empty element before the slash of an absolute
+    // path). Normalized paths can be looked up in the component index as is.
+    bool isNormalizedPath(const std::string& path) {
+        size_t begin = (!path.empty() && path[0] == '/') ? 1 : 0;
+        while (true) {
+            size_t end = path.find('/', begin);
+            if (end == std::string::npos) end = path.size();
+            const size_t length = end - begin;
+            if (length == 0) return false;
+            if (path[begin] == '.' &&
+                    (length == 1 || (length == 2 && path[begin + 1] == '.')))
+                return false;
+            if (end == path.size()) return true;
+            begin = end + 1;
+        }
+    }
+
+    // Check that the owners of `component` have the names in the normalized
+    // path `path.substr(begin)`, up to `base`. Components could have been
+    // renamed since the index was built.
+    bool isAtPath(const Component& component, const Component& base,
+            const std::string& path, size_t begin) {
+        const Component* current = &component;
+        size_t end = path.size();
+        while (true) {
+            const size_t slash = path.rfind('/', end - 1);
+            const size_t elementBegin =
+                    (slash == std::string::npos || slash < begin) ? begin
+                                                                  : slash + 1;
+            if (current == &base ||
+                    current->getName().compare(0, std::string::npos, path,
+                            elementBegin, end - elementBegin) != 0 ||
+                    !current->hasOwner())
+                return false;
+            current = &current->getOwner();
+            if (elementBegin == begin) return current == &base;
+            end = elementBegin - 1;
+        }
+    }
+}
+
+std::shared_ptr<const Component::ComponentIndex>
+Component::getComponentIndex() const {
+    std::shared_ptr<const ComponentIndex>& indexPtr = _componentIndex;
+    std::shared_ptr<const ComponentIndex> index = std::atomic_load(&indexPtr);
+    if (index) return index;
+
+    // Building the index only reads the tree, so threads can search the
+    // same tree concurrently; each may build (an identical) index.
+    struct Builder {
+        static void add(const Component& comp, const std::string& path,
+                ComponentIndex& index) {
+            for (const auto& sub : comp.getImmediateSubcomponents()) {
+                std::string subPath = path + "/" + sub->getName();
+                index.byPath.emplace(subPath, sub.get());
+                index.byName[sub->getName()].push_back(sub.get());
+                add(*sub, subPath, index);
+            }
+        }
+    };
+    auto newIndex = std::make_shared<ComponentIndex>();
+    Builder::add(*this, "", *newIndex);
+    index = newIndex;
+    std::atomic_store(&indexPtr, index);
+    return index;
+}
+
+void Component::clearComponentIndex() const {
+    std::shared_ptr<const ComponentIndex>& indexPtr = getRoot()._componentIndex;
+    std::atomic_store(&indexPtr, std::shared_ptr<const ComponentIndex>());
+}
+
+const Component* Component::findInComponentIndex(const std::string& path,
+        size_t begin) const {
+    const Component& root = getRoot();
+    const auto index = root.getComponentIndex();
+
+    // The index uses absolute paths.
+    std::string absolutePath;
+    const std::string* key = &path;
+    if (this != &root || begin != 1) {
+        if (this != &root) absolutePath = getAbsolutePathString();
+        absolutePath += '/';
+        absolutePath.append(path, begin, std::string::npos);
+        key = &absolutePath;
+    }
+    const auto it = index->byPath.find(*key);
+    if (it != index->byPath.end() && isAtPath(*it->second, *this, path, begin))
+        return it->second;
+    return nullptr;
+}
+
+const Component* Component::resolveComponentPath(
+        const std::string& path) const {
+    if (isNormalizedPath(path)) {
+        const Component* found = path[0] == '/'
+                ? getRoot().findInComponentIndex(path, 1)
+                : findInComponentIndex(path, 0);
+        if (found) return found;
+    }
+    return resolveComponentPath(ComponentPath(path));
+}
+
+const Component* Component::resolveComponentPath(ComponentPath path) const {
+    // Get rid of all the ".."'s that are not at the front of the path.
+    path.trimDotAndDotDotElements();
+
+    // Move up either to the root component or just enough to resolve all
+    // the ".."'s.
+    size_t iPathEltStart = 0u;
+    const Component* current = this;
+    if (path.isAbsolute()) {
+        current = &current->getRoot();
+    } else {
+        while (iPathEltStart < path.getNumPathLevels() &&
+                path.getSubcomponentNameAtLevel(iPathEltStart) == "..") {
+            // The path sends us up farther than the root.
+            if (!current->hasOwner()) return nullptr;
+            current = &current->getOwner();
+            ++iPathEltStart;
+        }
+    }
+    if (iPathEltStart == path.getNumPathLevels()) return current;
+
+    // Look up the rest of the path in the index.
+    std::string remainingPath;
+    for (size_t i = iPathEltStart; i < path.getNumPathLevels(); ++i) {
+        if (i > iPathEltStart) remainingPath += '/';
+        remainingPath += path.getSubcomponentNameAtLevel(i);
+    }
+    if (const Component* found =
+            current->findInComponentIndex(remainingPath, 0)) {
+        return found;
+    }
+
+    // The tree may have changed since the index was built (e.g., a
+    // component was renamed), so search the tree itself.
+    using RefComp = SimTK::ReferencePtr<const Component>;
+    for (size_t i = iPathEltStart; i < path.getNumPathLevels(); ++i) {
+        // At this depth in the tree, is there a component whose name
+        // matches the corresponding path element?
+        const auto& currentPathElement =
+            path.getSubcomponentNameAtLevel(i);
+        const auto& currentSubs = current->getImmediateSubcomponents();
+        const auto it = std::find_if(currentSubs.begin(), currentSubs.end(),
+                [currentPathElement](const RefComp& sub)
+                { return sub->getName() == currentPathElement; });
+        if (it != currentSubs.end())
+            current = it->get();
+        else
+            return nullptr;
+    }
+    return current;
+}
+
+std::vector<const Component*> Component::findDescendantsByName(
+        const std::string& name) const {
+    std::vector<const Component*> found;
+    const Component& root = getRoot();
+    const auto index = root.getComponentIndex();
+    const auto it = index->byName.find(name);
+    if (it != index->byName.end()) {
+        for (const Component* comp : it->second) {
+            if (comp->getName() != name) continue; // Renamed.
+            for (const Component* owner = comp; owner->hasOwner();) {
+                owner = &owner->getOwner();
+                if (owner == this) {
+                    found.push_back(comp);
+                    break;
+                }
+            }
+        }
+    }
+    if (found.empty()) {
+        // The component may have been renamed since the index was built.
+        for (const Component& comp : getComponentList()) {
+            if (comp.getName() == name) found.push_back(&comp);
+        }
+    }
+    return found;
+}
+
 void Component::setOwner(const Component& owner)
 {
     if (&owner == this) {
@@ -766,6 +1011,16 @@ const Component::StateVariable* Component::
     // Must have already called initSystem.
     OPENSIM_THROW_IF_FRMOBJ(!hasSystem(), ComponentHasNoSystem);
 
+    // Avoid parsing the path if the component can be found in the index.
+    const size_t slash = pathName.rfind('/');
+    if (slash != std::string::npos && slash > 0 &&
+            isNormalizedPath(pathName)) {
+        const Component* comp =
+                resolveComponentPath(pathName.substr(0, slash));
+        if (!comp) return nullptr;
+        return comp->traverseToStateVariable(pathName.substr(slash + 1));
+    }
+
     ComponentPath svPath(pathName);
 
     const StateVariable* found = nullptr;
@@ -888,15 +1143,14 @@ void Component::
     throw Exception(msg.str(),__FILE__,__LINE__);
 }
 
-bool Component::isAllStatesVariablesListValid() const
+bool Component::isStateVariableLayoutValid() const
 {
-    int nsv = getNumStateVariables();
-    // Consider the list of all StateVariables to be valid if all of 
+    // Consider the layouts of all StateVariables to be valid if all of
     // the following conditions are true:
     // 1. Component is up-to-date with its Properties
-    // 2. a System has been associated with the list of StateVariables
-    // 3. The list of all StateVariables is correctly sized (initialized)
-    // 4. The System associated with the StateVariables is the current System
+    // 2. a System has been associated with the layouts
+    // 3. The layouts have the correct number of StateVariables
+    // 4. The System associated with the layouts is the current System
     // TODO: Enable the isObjectUpToDateWithProperties() check when computing
     // the path of the GeomtryPath does not involve updating its PathPointSet.
     // This change dirties the GeometryPath which is a property of a Muscle which
@@ -906,41 +1160,42 @@ bool Component::isAllStatesVariablesListValid() const
     // addressed before we can re-enable the isObjectUpToDateWithProperties
     // check.
     // It has been verified that the adding Components will invalidate the state
-    // variables associated with the Model and force the list to be rebuilt.
+    // variables associated with the Model and force the layout to be rebuilt.
     bool valid = //isObjectUpToDateWithProperties() &&                  // 1.
         !_statesAssociatedSystem.empty() &&                             // 2.
-        (int)_allStateVariables.size() == nsv &&                        // 3.
+        !_stateVariableLayouts.empty() &&
+        _stateVariableLayouts[0]->getNumStateVariables() ==
+                getNumStateVariables() &&                               // 3.
         getSystem().isSameSystem(_statesAssociatedSystem.getRef());     // 4.
 
     return valid;
 }
 
-
-// Get all values of the state variables allocated by this Component. Includes
-// state variables allocated by its subcomponents.
-SimTK::Vector Component::
-    getStateVariableValues(const SimTK::State& state) const
+const StateVariableLayout& Component::
+    getStateVariableLayout(const SimTK::State& state) const
 {
     // Must have already called initSystem.
     OPENSIM_THROW_IF_FRMOBJ(!hasSystem(), ComponentHasNoSystem);
 
-    int nsv = getNumStateVariables();
-    // if the StateVariables are invalid (see above) rebuild the list
-    if (!isAllStatesVariablesListValid()) {
+    // if the layouts are invalid (see above) discard them
+    if (!isStateVariableLayoutValid()) {
         _statesAssociatedSystem.reset(&getSystem());
-        _allStateVariables.clear();
-        _allStateVariables.resize(nsv);
-        Array<std::string> names = getStateVariableNames();
-        for (int i = 0; i < nsv; ++i)
-            _allStateVariables[i].reset(traverseToStateVariable(names[i]));
+        _stateVariableLayouts.clear();
     }
-
-    Vector stateVariableValues(nsv, SimTK::NaN);
-    for(int i=0; i<nsv; ++i){
-        stateVariableValues[i]= _allStateVariables[i]->getValue(state);
+    for (const auto& layout : _stateVariableLayouts) {
+        if (layout->isCompatible(state)) return *layout;
     }
+    _stateVariableLayouts.push_back(
+            std::make_shared<const StateVariableLayout>(*this, state));
+    return *_stateVariableLayouts.back();
+}
 
-    return stateVariableValues;
+// Get all values of the state variables allocated by this Component. Includes
+// state variables allocated by its subcomponents.
+SimTK::Vector Component::
+    getStateVariableValues(const SimTK::State& state) const
+{
+    return getStateVariableLayout(state).getValues(state);
 }
 
 // Set all values of the state variables allocated by this Component. Includes
@@ -949,28 +1204,13 @@ void Component::
     setStateVariableValues(SimTK::State& state,
                            const SimTK::Vector& values) const
 {
-    // Must have already called initSystem.
-    OPENSIM_THROW_IF_FRMOBJ(!hasSystem(), ComponentHasNoSystem);
-
-    int nsv = getNumStateVariables();
+    const StateVariableLayout& layout = getStateVariableLayout(state);
 
-    SimTK_ASSERT(values.size() == nsv,
+    SimTK_ASSERT(values.size() == layout.getNumStateVariables(),
         "Component::setStateVariableValues() number values does not match the "
         "number of state variables.");
 
-    // if the StateVariables are invalid (see above) rebuild the list 
-    if (!isAllStatesVariablesListValid()) {
-        _statesAssociatedSystem.reset(&getSystem());
-        _allStateVariables.clear();
-        _allStateVariables.resize(nsv);
-        Array<std::string> names = getStateVariableNames();
-        for (int i = 0; i < nsv; ++i)
-            _allStateVariables[i].reset(traverseToStateVariable(names[i]));
-    }
-
-    for(int i=0; i<nsv; ++i){
-        _allStateVariables[i]->setValue(state, values[i]);
-    }
+    layout.setValues(state, values);
 }
 
 // Set the derivative of a state variable computed by this Component by name.
@@ -1282,8 +1522,10 @@ void Component::adoptSubcomponent(Component* subcomponent)
             subcomponent->getName(), comp.getName());
     }
 
+    subcomponent->clearComponentIndex();
     subcomponent->setOwner(*this);
     _adoptedSubcomponents.push_back(SimTK::ClonePtr<Component>(subcomponent));
+    clearComponentIndex();
 }
 
 std::vector<SimTK::ReferencePtr<const Component>> 
@@ -1521,7 +1763,12 @@ void Component::extendRealizeAcceleration(const SimTK::State& s) const
         const SimTK::Subsystem& subSys = getDefaultSubsystem();
 
         // evaluate and set component state derivative values (in cache) 
-        computeStateVariableDerivatives(s);
+        {
+            ComponentProfiler::Scope scope(getProfiler(), *this,
+                    "computeStateVariableDerivatives",
+                    SimTK::Stage::Acceleration);
+            computeStateVariableDerivatives(s);
+        }
     
         std::map<std::string, StateVariableInfo>::const_iterator it;
 
@@ -1594,6 +1841,17 @@ void Component::AddedStateVariable::setValue(SimTK::State& state, double value)
     throw Exception(msg.str(),__FILE__,__LINE__);
 }
 
+SimTK::SystemYIndex Component::AddedStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    ZIndex zix(getVarIndex());
+    if(getSubsysIndex().isValid() && zix.isValid()){
+        return SimTK::SystemYIndex((int)state.getZStart() +
+                (int)state.getZStart(getSubsysIndex()) + (int)zix);
+    }
+    return SimTK::SystemYIndex();
+}
+
 double Component::AddedStateVariable::
     getDerivative(const SimTK::State& state) const
 {
@@ -50,13 +50,16 @@
 #include "OpenSim/Common/ComponentSocket.h"
 #include "OpenSim/Common/Object.h"
 #include "simbody/internal/MultibodySystem.h"
+#include <memory>
 #include <unordered_map>
 
 #include <OpenSim/Common/osimCommonDLL.h>
 
 namespace OpenSim {
 
+class ComponentProfiler;
 class Model;
+class StateVariableLayout;
 class ModelDisplayHints;
 
 //==============================================================================
@@ -564,6 +567,17 @@ public:
     * Component has not added itself to the System.  */
     bool hasSystem() const { return !_system.empty(); }
 
+    /** Time the operations (e.g., realize methods and force computations) of
+    this component and all of its subcomponents with `profiler`; see
+    ComponentProfiler. Use nullptr to stop profiling. Subcomponents that are
+    added later use the profiler of their owner once they are finalized. The
+    profiler is not owned by this component, and is not copied when the
+    component is copied. */
+    void setProfiler(ComponentProfiler* profiler);
+    /** The profiler timing the operations of this component, or nullptr if
+    the component is not being profiled. */
+    ComponentProfiler* getProfiler() const { return _profiler.get(); }
+
     /** Does the provided component already exist anywhere in the ownership
      * tree (not just subcomponents of this component)? */
     bool isComponentInOwnershipTree(const Component* component) const;
@@ -675,6 +689,9 @@ public:
     /** Class to iterate over ComponentList returned by getComponentList(). */
     template <typename T>
     friend class ComponentListIterator;
+    /** Class that accesses the StateVariables of a component and its
+     * subcomponents in bulk. */
+    friend class StateVariableLayout;
 
 
     /** Get the complete (absolute) pathname for this Component to its ancestral
@@ -727,8 +744,8 @@ public:
     bool hasComponent(const std::string& pathname) const {
         static_assert(std::is_base_of<Component, C>::value,
             "Template parameter 'C' must be derived from Component.");
-        const C* comp = this->template traversePathToComponent<C>({pathname});
-        return comp != nullptr;
+        return dynamic_cast<const C*>(resolveComponentPath(pathname)) !=
+                nullptr;
     }
 
     /**
@@ -753,7 +770,18 @@ public:
      */
     template <class C = Component>
     const C& getComponent(const std::string& pathname) const {
-        return getComponent<C>(ComponentPath(pathname));
+        static_assert(std::is_base_of<Component, C>::value,
+            "Template parameter 'CompType' must be derived from Component.");
+
+        const C* comp = dynamic_cast<const C*>(resolveComponentPath(pathname));
+        if (comp) {
+            return *comp;
+        }
+
+        // Only error cases remain
+        OPENSIM_THROW(ComponentNotFoundOnSpecifiedPath,
+                      ComponentPath(pathname).toString(), C::getClassName(),
+                      getName());
     }
     template <class C = Component>
     const C& getComponent(const ComponentPath& pathname) const {
@@ -1338,6 +1366,24 @@ public:
     void setStateVariableValues(SimTK::State& state,
                                 const SimTK::Vector& values) const;
 
+    /**
+     * Get the layout of the state variables allocated by this Component and
+     * its subcomponents in states like `state`, which reads and writes all
+     * or a subset of the state variables without looking them up by name
+     * (see StateVariableLayout). The layout is created from `state` the first
+     * time it is requested after the System is built, and is reused for all
+     * compatible states (see StateVariableLayout::isCompatible()). Layouts
+     * are discarded when the System is rebuilt (e.g., by
+     * Model::initSystem()), at which point the returned reference is no
+     * longer valid.
+     *
+     * @param state   a State realized to Stage::Model
+     * @throws ComponentHasNoSystem if this Component has not been added to a
+     *         System (i.e., if initSystem has not been called)
+     */
+    const StateVariableLayout& getStateVariableLayout(
+            const SimTK::State& state) const;
+
     /**
      * Get the value of a state variable derivative computed by this Component.
      *
@@ -2503,16 +2549,13 @@ public:
                 foundCs.push_back(found);
         }
 
-        ComponentList<const C> compsList = this->template getComponentList<C>();
-
-        for (const C& comp : compsList) {
+        for (const Component* candidate : findDescendantsByName(subname)) {
+            const C* comp = dynamic_cast<const C*>(candidate);
+            if (!comp) continue;
             // if a child of this Component, one should not need
             // to specify this Component's absolute path name
-            ComponentPath compAbsPath = comp.getAbsolutePath();
-            ComponentPath thisAbsPathPlusSubname = getAbsolutePath();
-            thisAbsPathPlusSubname.pushBack(subname);
-            if (compAbsPath == thisAbsPathPlusSubname) {
-                foundCs.push_back(&comp);
+            if (&comp->getOwner() == this) {
+                foundCs.push_back(comp);
                 break;
             }
 
@@ -2520,17 +2563,14 @@ public:
             // which we may need to support for compatibility with older models
             // where only names were used (not path or type)
             // TODO replace with an exception -aseth
-            std::string compName = comp.getName();
-            if (compName == subname) {
-                foundCs.push_back(&comp);
-                // TODO Revisit why the exact match isn't found when
-                // when what appears to be the complete path.
-                log_debug("{} Found '{}' as a match for: Component '{}' of "
-                          "type {}, but it is not on the specified path.",
-                          msg, compAbsPath.toString(),
-                          comp.getConcreteClassName());
-                //throw Exception(details, __FILE__, __LINE__);
-            }
+            foundCs.push_back(comp);
+            // TODO Revisit why the exact match isn't found when
+            // when what appears to be the complete path.
+            log_debug("{} Found '{}' as a match for: Component '{}' of "
+                      "type {}, but it is not on the specified path.",
+                      msg, comp->getAbsolutePathString(),
+                      comp->getConcreteClassName());
+            //throw Exception(details, __FILE__, __LINE__);
         }
 
         if (foundCs.size() == 1) {
@@ -2562,47 +2602,31 @@ protected:
     template<class C>
     const C* traversePathToComponent(ComponentPath path) const
     {
-        // Get rid of all the ".."'s that are not at the front of the path.
-        path.trimDotAndDotDotElements();
-
-        // Move up either to the root component or just enough to resolve all
-        // the ".."'s.
-        size_t iPathEltStart = 0u;
-        const Component* current = this;
-        if (path.isAbsolute()) {
-            current = &current->getRoot();
-        } else {
-            while (iPathEltStart < path.getNumPathLevels() &&
-                    path.getSubcomponentNameAtLevel(iPathEltStart) == "..") {
-                // The path sends us up farther than the root.
-                if (!current->hasOwner()) return nullptr;
-                current = &current->getOwner();
-                ++iPathEltStart;
-            }
-        }
-
-        using RefComp = SimTK::ReferencePtr<const Component>;
-
-        // Skip over the root component name.
-        for (size_t i = iPathEltStart; i < path.getNumPathLevels(); ++i) {
-            // At this depth in the tree, is there a component whose name
-            // matches the corresponding path element?
-            const auto& currentPathElement =
-                path.getSubcomponentNameAtLevel(i);
-            const auto& currentSubs = current->getImmediateSubcomponents();
-            const auto it = std::find_if(currentSubs.begin(), currentSubs.end(),
-                    [currentPathElement](const RefComp& sub)
-                    { return sub->getName() == currentPathElement; });
-            if (it != currentSubs.end())
-                current = it->get();
-            else
-                return nullptr;
-        }
-        if (const C* comp = dynamic_cast<const C*>(current))
-            return comp;
-        return nullptr;
+        return dynamic_cast<const C*>(resolveComponentPath(std::move(path)));
     }
 
+private:
+    struct ComponentIndex;
+
+    // Find the component at a path (absolute, or relative to this
+    // component), using the index of the root component when possible.
+    // Returns nullptr if there is no component at that path.
+    const Component* resolveComponentPath(const std::string& path) const;
+    const Component* resolveComponentPath(ComponentPath path) const;
+    // Look up the normalized path `path.substr(begin)`, relative to this
+    // component, in the index of the root component. Returns nullptr if the
+    // path is not in the index.
+    const Component* findInComponentIndex(const std::string& path,
+                                          size_t begin) const;
+    // The components with the given name that this component owns (directly
+    // or indirectly), in tree pre-order.
+    std::vector<const Component*> findDescendantsByName(
+            const std::string& name) const;
+    // The index of the tree of this (root) component, built if necessary.
+    std::shared_ptr<const ComponentIndex> getComponentIndex() const;
+    // Discard the index of the tree that this component belongs to.
+    void clearComponentIndex() const;
+
 public:
 #ifndef SWIG // StateVariable is protected.
     /**
@@ -2960,6 +2984,16 @@ protected:
         // change the state
         virtual void setDerivative(const SimTK::State& state, double deriv) const = 0;
 
+        // Concrete StateVariables that are stored in the continuous state
+        // variables (Y) of the State return the index of their value in Y,
+        // given a State realized to Stage::Model. The default is an invalid
+        // index, in which case the value is only accessed via getValue() and
+        // setValue().
+        virtual SimTK::SystemYIndex findSystemYIndex(
+                const SimTK::State& state) const {
+            return SimTK::SystemYIndex();
+        }
+
     private:
         std::string name;
         SimTK::ReferencePtr<const Component> owner;
@@ -3025,6 +3059,17 @@ private:
     // Reference pointer to the system that this component belongs to.
     SimTK::ReferencePtr<SimTK::MultibodySystem> _system;
 
+    // Index of the components in this Component's tree, by absolute path and
+    // by name. Only the root component holds an index; it is built when
+    // first needed (or when the root's connections are finalized) and is
+    // discarded whenever a component in the tree is finalized or adopts a
+    // subcomponent. See getComponentIndex().
+    mutable SimTK::ResetOnCopy<std::shared_ptr<const ComponentIndex>>
+        _componentIndex;
+
+    // Profiler timing this component's operations, if any.
+    SimTK::ReferencePtr<ComponentProfiler> _profiler;
+
     // propertiesTable maintained by Object
 
     // Table of Component's structural Sockets indexed by name.
@@ -3102,6 +3147,9 @@ private:
         double getDerivative(const SimTK::State& state) const override;
         void setDerivative(const SimTK::State& state, double deriv) const override;
 
+        SimTK::SystemYIndex findSystemYIndex(
+                const SimTK::State& state) const override;
+
         private: // DATA
         // Changes in state variables trigger recalculation of appropriate cache
         // variables by automatically invalidating the realization stage specified
@@ -3200,12 +3248,15 @@ private:
     // cache information.
     mutable SimTK::ResetOnCopy<std::unordered_map<std::string, StoredCacheVariable>> _namedCacheVariables;
 
-    // Check that the list of _allStateVariables is valid
-    bool isAllStatesVariablesListValid() const;
+    // Check that the _stateVariableLayouts are valid
+    bool isStateVariableLayoutValid() const;
 
-    // Array of all state variables for fast access during simulation
-    mutable SimTK::Array_<SimTK::ReferencePtr<const StateVariable> >
-                                                            _allStateVariables;
+    // Layouts of all state variables for fast access during simulation; there
+    // is one for each layout of Y (e.g., quaternions vs. Euler angles) used
+    // since the System was built, and usually only one.
+    mutable SimTK::ResetOnCopy<
+            std::vector<std::shared_ptr<const StateVariableLayout>>>
+                                                        _stateVariableLayouts;
     // A handle the System associated with the above state variables
     mutable SimTK::ReferencePtr<const SimTK::System> _statesAssociatedSystem;
 
@@ -0,0 +1,297 @@
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  ComponentProfiler.cpp                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ComponentProfiler.h"
+
+#include "Component.h"
+#include "Exception.h"
+#include "Logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <sstream>
+
+using namespace OpenSim;
+
+namespace {
+    // The innermost Scope that is timing an operation on this thread; used
+    // to compute self times.
+    thread_local ComponentProfiler::Scope* currentScope = nullptr;
+
+    std::atomic<ComponentProfiler*> defaultProfiler{nullptr};
+
+    std::string escapeJSON(const std::string& str) {
+        std::string escaped;
+        escaped.reserve(str.size());
+        for (const char c : str) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            if ((unsigned char)c < 0x20) {
+                escaped += fmt::format("\\u{:04x}", (int)c);
+            } else {
+                escaped += c;
+            }
+        }
+        return escaped;
+    }
+}
+
+//==============================================================================
+//                                   SCOPE
+//==============================================================================
+void ComponentProfiler::Scope::start(const Component& component,
+        const char* operation, SimTK::Stage stage) {
+    _component = &component;
+    _operation = operation;
+    _stage = stage;
+    _parent = currentScope;
+    currentScope = this;
+    _startTime = SimTK::realTimeInNs();
+}
+
+void ComponentProfiler::Scope::stop() {
+    const long long duration = SimTK::realTimeInNs() - _startTime;
+    currentScope = _parent;
+    if (_parent) _parent->_childTime += duration;
+    _profiler->record(*_component, _operation, _stage, _startTime, duration,
+            _childTime);
+}
+
+//==============================================================================
+//                             COMPONENT PROFILER
+//==============================================================================
+ComponentProfiler::ComponentProfiler() :
+        _creationTime(SimTK::realTimeInNs()) {}
+
+void ComponentProfiler::record(const Component& component,
+        const char* operation, SimTK::Stage stage, long long startTime,
+        long long duration, long long childDuration) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto& cachedEntries = _cachedEntries[&component];
+    int index = -1;
+    for (const auto& cached : cachedEntries) {
+        if (cached.operation == operation && cached.stage == (int)stage) {
+            index = cached.entry;
+            break;
+        }
+    }
+    if (index < 0) {
+        Key key{component.getAbsolutePathString(), operation, (int)stage};
+        auto it = _entryIndices.find(key);
+        if (it == _entryIndices.end()) {
+            Statistics stats;
+            stats.componentPath = key.componentPath;
+            stats.operation = operation;
+            stats.stage = stage;
+            _entries.push_back(stats);
+            it = _entryIndices.emplace(std::move(key),
+                    (int)_entries.size() - 1).first;
+        }
+        index = it->second;
+        cachedEntries.push_back({operation, (int)stage, index});
+    }
+    Statistics& stats = _entries[index];
+    ++stats.numCalls;
+    stats.totalTime += duration;
+    stats.selfTime += duration - childDuration;
+    stats.maxTime = std::max(stats.maxTime, duration);
+
+    if (_recordTrace || !_traceFileName.empty()) {
+        if ((int)_traceEvents.size() < _maxNumTraceEvents) {
+            auto thread = _threadIndices.emplace(std::this_thread::get_id(),
+                    (int)_threadIndices.size()).first->second;
+            _traceEvents.push_back({index, thread,
+                    startTime - _creationTime, duration});
+        } else {
+            ++_numDroppedTraceEvents;
+        }
+    }
+}
+
+void ComponentProfiler::reset() {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _entryIndices.clear();
+    _cachedEntries.clear();
+    _entries.clear();
+    _traceEvents.clear();
+    _numDroppedTraceEvents = 0;
+    _threadIndices.clear();
+}
+
+void ComponentProfiler::forgetComponent(const Component& component) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _cachedEntries.erase(&component);
+}
+
+std::vector<ComponentProfilerEntry> ComponentProfiler::getEntries() const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<ComponentProfilerEntry> entries;
+    entries.reserve(_entries.size());
+    for (const auto& stats : _entries) {
+        ComponentProfilerEntry entry;
+        entry.componentPath = stats.componentPath;
+        entry.operation = stats.operation;
+        entry.stage = stats.stage;
+        entry.numCalls = stats.numCalls;
+        entry.totalTime = SimTK::nsToSec(stats.totalTime);
+        entry.selfTime = SimTK::nsToSec(stats.selfTime);
+        entry.maxTime = SimTK::nsToSec(stats.maxTime);
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+std::vector<ComponentProfilerEntry>
+ComponentProfiler::getEntriesSortedBySelfTime() const {
+    auto entries = getEntries();
+    std::stable_sort(entries.begin(), entries.end(),
+            [](const ComponentProfilerEntry& a,
+                    const ComponentProfilerEntry& b) {
+                return a.selfTime > b.selfTime;
+            });
+    return entries;
+}
+
+void ComponentProfiler::printReport(std::ostream& stream) const {
+    const auto entries = getEntriesSortedBySelfTime();
+
+    // Aggregate per realize stage.
+    const int numStages = SimTK::Stage::NValid;
+    std::vector<double> stageTimes(numStages, 0);
+    std::vector<long long> stageCalls(numStages, 0);
+    double totalTime = 0;
+    long long totalCalls = 0;
+    for (const auto& entry : entries) {
+        stageTimes[entry.stage] += entry.selfTime;
+        stageCalls[entry.stage] += entry.numCalls;
+        totalTime += entry.selfTime;
+        totalCalls += entry.numCalls;
+    }
+
+    stream << fmt::format("Component profile: {:.6f} s in {} timed calls.\n",
+            totalTime, totalCalls);
+    stream << fmt::format("{:<14}{:>14}{:>12}{:>8}\n",
+            "stage", "self (s)", "calls", "%");
+    for (int i = 0; i < numStages; ++i) {
+        if (stageCalls[i] == 0) continue;
+        stream << fmt::format("{:<14}{:>14.6f}{:>12}{:>8.1f}\n",
+                std::string(SimTK::Stage(i).getName()), stageTimes[i],
+                stageCalls[i],
+                totalTime > 0 ? 100 * stageTimes[i] / totalTime : 0.0);
+    }
+    stream << "\n";
+    stream << fmt::format("{:>12}{:>12}{:>12}{:>12}{:>12}  {:<14}{:<32}{}\n",
+            "self (ms)", "total (ms)", "calls", "mean (us)", "max (us)",
+            "stage", "operation", "component");
+    for (const auto& entry : entries) {
+        stream << fmt::format(
+                "{:>12.3f}{:>12.3f}{:>12}{:>12.3f}{:>12.3f}  {:<14}{:<32}{}\n",
+                1e3 * entry.selfTime, 1e3 * entry.totalTime, entry.numCalls,
+                1e6 * entry.totalTime / entry.numCalls, 1e6 * entry.maxTime,
+                std::string(entry.stage.getName()), entry.operation,
+                entry.componentPath);
+    }
+}
+
+std::string ComponentProfiler::getReport() const {
+    std::ostringstream stream;
+    printReport(stream);
+    return stream.str();
+}
+
+void ComponentProfiler::writeChromeTrace(const std::string& fileName) const {
+    std::ofstream stream(fileName);
+    OPENSIM_THROW_IF(!stream.good(), Exception,
+            "Could not open file '{}' to write the component profile trace.",
+            fileName);
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<std::string> names(_entries.size());
+    for (int i = 0; i < (int)_entries.size(); ++i) {
+        names[i] = fmt::format("\"name\":\"{} {}\",\"cat\":\"{}\"",
+                escapeJSON(_entries[i].componentPath),
+                escapeJSON(_entries[i].operation),
+                std::string(_entries[i].stage.getName()));
+    }
+    stream << "{\"traceEvents\":[";
+    for (int i = 0; i < (int)_traceEvents.size(); ++i) {
+        const TraceEvent& event = _traceEvents[i];
+        // Times are in microseconds.
+        stream << (i == 0 ? "\n" : ",\n")
+               << fmt::format("{{{},\"ph\":\"X\",\"pid\":0,\"tid\":{},"
+                              "\"ts\":{:.3f},\"dur\":{:.3f}}}",
+                       names[event.entry], event.thread,
+                       1e-3 * event.startTime, 1e-3 * event.duration);
+    }
+    stream << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{"
+           << fmt::format("\"numDroppedEvents\":{}", _numDroppedTraceEvents)
+           << "}}\n";
+    if (_numDroppedTraceEvents > 0) {
+        log_warn("ComponentProfiler: {} calls were not written to the trace "
+                 "'{}' since the maximum number of trace events ({}) was "
+                 "reached.", _numDroppedTraceEvents, fileName,
+                 _maxNumTraceEvents);
+    }
+}
+
+void ComponentProfiler::dump() const {
+    if (_reportFileName.empty()) {
+        log_info("{}", getReport());
+    } else {
+        std::ofstream stream(_reportFileName);
+        OPENSIM_THROW_IF(!stream.good(), Exception,
+                "Could not open file '{}' to write the component profile "
+                "report.", _reportFileName);
+        printReport(stream);
+    }
+    if (!_traceFileName.empty()) writeChromeTrace(_traceFileName);
+}
+
+void ComponentProfiler::setReportFileName(const std::string& fileName) {
+    _reportFileName = fileName;
+}
+
+void ComponentProfiler::setTraceFileName(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _traceFileName = fileName;
+}
+
+void ComponentProfiler::setRecordTrace(bool recordTrace) {
+    std::lock_guard<std::mutex> lock(_mutex);
+    _recordTrace = recordTrace;
+}
+
+void ComponentProfiler::setMaxNumTraceEvents(int maxNumTraceEvents) {
+    OPENSIM_THROW_IF(maxNumTraceEvents < 0, Exception,
+            "Expected the maximum number of trace events to be non-negative, "
+            "but it is {}.", maxNumTraceEvents);
+    std::lock_guard<std::mutex> lock(_mutex);
+    _maxNumTraceEvents = maxNumTraceEvents;
+}
+
+void ComponentProfiler::setDefault(ComponentProfiler* profiler) {
+    defaultProfiler = profiler;
+}
+
+ComponentProfiler* ComponentProfiler::getDefault() {
+    return defaultProfiler;
+}
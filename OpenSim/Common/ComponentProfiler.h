@@ -0,0 +1,266 @@
+#ifndef OPENSIM_COMPONENT_PROFILER_H_
+#define OPENSIM_COMPONENT_PROFILER_H_
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  ComponentProfiler.h                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "osimCommonDLL.h"
+#include <SimTKcommon/internal/Stage.h>
+#include <SimTKcommon/internal/Timing.h>
+
+#include <iosfwd>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenSim {
+
+class Component;
+
+/** The time spent in one operation of one Component, as recorded by a
+ComponentProfiler. Times are in seconds. */
+struct OSIMCOMMON_API ComponentProfilerEntry {
+    /** Absolute path of the component. */
+    std::string componentPath;
+    /** The operation that was timed (e.g., "computeForce"). */
+    std::string operation;
+    /** The realize stage during which the operation is (usually) performed. */
+    SimTK::Stage stage;
+    /** Number of times the operation was performed. */
+    long long numCalls = 0;
+    /** Time spent in the operation, including time spent in operations
+    (of this or other components) that it invoked and that were also
+    timed. */
+    double totalTime = 0;
+    /** Time spent in the operation, excluding time spent in other timed
+    operations that it invoked. The sum of the self times of all entries is
+    the time spent in all timed operations. */
+    double selfTime = 0;
+    /** Longest time spent in a single call. */
+    double maxTime = 0;
+};
+
+/** Record the wall time spent and the number of calls in the computations
+that dominate the cost of realizing a Model: each Component's realize
+methods (extendRealizeTopology() through extendRealizeReport()),
+Force::computeForce(), computeStateVariableDerivatives(),
+GeometryPath::computePath(), the equilibrium and cache variable
+computations of Muscles, etc. Times are aggregated per component path,
+operation, and realize stage, so the times of a component whose model is
+rebuilt (or of components with the same path in different copies of a model)
+are added together.
+
+Profiling is off unless a profiler is given to a model:
+@code
+ComponentProfiler profiler;
+profiler.setTraceFileName("arm26_trace.json");
+Model model("arm26.osim");
+model.setProfiler(&profiler);
+SimTK::State& state = model.initSystem();
+Manager manager(model, state);
+manager.integrate(1.0);
+profiler.dump(); // Logs the report and writes the trace.
+@endcode
+
+The tools that run or analyze a model (e.g., ForwardTool, CMCTool,
+InverseKinematicsTool, InverseDynamicsTool, AnalyzeTool) call dump() on the
+model's profiler once they are done. dump() logs a report of the entries,
+sorted by self time, along with the time spent in each realize stage
+(or writes the report to a file; see setReportFileName()). If a trace file
+name is set, dump() also writes a trace of every timed call in the Chrome
+trace event format, which can be viewed with chrome://tracing or
+https://ui.perfetto.dev. To profile models that are loaded by a tool, use
+setDefault().
+
+When a Model has no profiler, the cost of profiling is a check for a null
+pointer in each instrumented method. When profiling, each timed call costs
+two reads of the clock and a lock of a mutex; the profiler can be shared by
+models that are used on different threads. The profiler must outlive the
+models that use it, or the models must be given a null profiler before the
+profiler is destroyed.
+
+To time an operation of your own Component, use a Scope:
+@code
+void MyForce::computeForce(const SimTK::State& s, ...) const {
+    ComponentProfiler::Scope scope(getProfiler(), *this, "computeForce",
+            SimTK::Stage::Dynamics);
+    ...
+}
+@endcode
+*/
+class OSIMCOMMON_API ComponentProfiler {
+public:
+    /** Times the lifetime of this object, and records it with the profiler
+    (if the profiler is not null) when it is destroyed. The operation is
+    identified by the address of `operation`, which should be a string
+    literal. */
+    class OSIMCOMMON_API Scope {
+    public:
+        Scope(ComponentProfiler* profiler, const Component& component,
+                const char* operation, SimTK::Stage stage) :
+                _profiler(profiler) {
+            if (_profiler) start(component, operation, stage);
+        }
+        ~Scope() { if (_profiler) stop(); }
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+    private:
+        void start(const Component& component, const char* operation,
+                SimTK::Stage stage);
+        void stop();
+        ComponentProfiler* _profiler;
+        const Component* _component = nullptr;
+        const char* _operation = nullptr;
+        SimTK::Stage _stage;
+        long long _startTime = 0;
+        long long _childTime = 0;
+        Scope* _parent = nullptr;
+    };
+
+    ComponentProfiler();
+    ComponentProfiler(const ComponentProfiler&) = delete;
+    ComponentProfiler& operator=(const ComponentProfiler&) = delete;
+
+    /** Record a call to an operation of a component that took `duration`
+    nanoseconds, of which `childDuration` nanoseconds were spent in other
+    timed operations, and that started at time `startTime` (from
+    SimTK::realTimeInNs()). Usually, you would use a Scope instead. */
+    void record(const Component& component, const char* operation,
+            SimTK::Stage stage, long long startTime, long long duration,
+            long long childDuration);
+
+    /** Discard everything recorded so far. */
+    void reset();
+
+    /** Look up the path of `component` again the next time one of its
+    operations is recorded. Entries are found from the address of the
+    component, so this is called whenever the component's system is built
+    (when the component is realized at the Topology stage), in case the
+    component was renamed or moved, or is a new component at the address of
+    a deleted one. The entries recorded so far are kept. */
+    void forgetComponent(const Component& component);
+
+    /** The entries recorded so far, in no particular order. */
+    std::vector<ComponentProfilerEntry> getEntries() const;
+
+    /** Write the report of the entries recorded so far: the time spent in
+    each realize stage, followed by the entries, sorted by self time. */
+    void printReport(std::ostream& stream) const;
+    /** The report from printReport() as a string. */
+    std::string getReport() const;
+
+    /** Write the calls recorded so far as a JSON file in the Chrome trace
+    event format. Calls are recorded only if a trace file name is set (see
+    setTraceFileName()) or setRecordTrace(true) was called. */
+    void writeChromeTrace(const std::string& fileName) const;
+
+    /** Log the report (or write it to the report file, if a report file name
+    is set) and write the trace file (if a trace file name is set). */
+    void dump() const;
+
+    /** Write the report to this file instead of logging it in dump(). Use an
+    empty string (the default) to log the report. */
+    void setReportFileName(const std::string& fileName);
+    const std::string& getReportFileName() const { return _reportFileName; }
+    /** Record each call and write them to this file in dump() (see
+    writeChromeTrace()). Use an empty string (the default) to not write a
+    trace. */
+    void setTraceFileName(const std::string& fileName);
+    const std::string& getTraceFileName() const { return _traceFileName; }
+    /** Record each call (for writeChromeTrace()) even if no trace file name
+    is set. */
+    void setRecordTrace(bool recordTrace);
+    bool getRecordTrace() const { return _recordTrace; }
+    /** The maximum number of calls kept for the trace (default: 1,000,000);
+    later calls are only counted in the entries. */
+    void setMaxNumTraceEvents(int maxNumTraceEvents);
+    int getMaxNumTraceEvents() const { return _maxNumTraceEvents; }
+
+    /** Models that are finalized (e.g., by initSystem()) without a profiler
+    use this profiler. This allows profiling models that are loaded by tools.
+    Use nullptr (the default) to disable. */
+    static void setDefault(ComponentProfiler* profiler);
+    static ComponentProfiler* getDefault();
+
+private:
+    struct Key {
+        std::string componentPath;
+        const char* operation;
+        int stage;
+        bool operator==(const Key& other) const {
+            return componentPath == other.componentPath &&
+                    operation == other.operation && stage == other.stage;
+        }
+    };
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            size_t h = std::hash<std::string>()(key.componentPath);
+            h ^= std::hash<const void*>()(key.operation) + 0x9e3779b9 +
+                    (h << 6) + (h >> 2);
+            return h ^ (size_t(key.stage) << 1);
+        }
+    };
+    // The index of the entry for an operation of a component whose address
+    // is known; avoids computing the component's path for each call.
+    struct CachedEntry {
+        const char* operation;
+        int stage;
+        int entry;
+    };
+    struct Statistics {
+        std::string componentPath;
+        const char* operation;
+        SimTK::Stage stage;
+        long long numCalls = 0;
+        long long totalTime = 0;
+        long long selfTime = 0;
+        long long maxTime = 0;
+    };
+    struct TraceEvent {
+        int entry;
+        int thread;
+        long long startTime;
+        long long duration;
+    };
+
+    std::vector<ComponentProfilerEntry> getEntriesSortedBySelfTime() const;
+
+    mutable std::mutex _mutex;
+    long long _creationTime;
+    std::unordered_map<Key, int, KeyHash> _entryIndices;
+    std::unordered_map<const Component*, std::vector<CachedEntry>>
+            _cachedEntries;
+    std::vector<Statistics> _entries;
+    std::vector<TraceEvent> _traceEvents;
+    long long _numDroppedTraceEvents = 0;
+    std::unordered_map<std::thread::id, int> _threadIndices;
+
+    std::string _reportFileName;
+    std::string _traceFileName;
+    bool _recordTrace = false;
+    int _maxNumTraceEvents = 1000000;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_COMPONENT_PROFILER_H_
@@ -34,7 +34,9 @@ in-memory container for data access and manipulation.                         */
 #include "SimTKcommon/internal/Quaternion.h"
 #include <OpenSim/Common/IO.h>
 
+#include <atomic>
 #include <iomanip>
+#include <mutex>
 #include <numeric>
 
 namespace OpenSim {
@@ -662,15 +664,41 @@ public:
                              static_cast<size_t>(depRow.ncol()));
         }
 
-        _indData.push_back(indRow);
+        if(_indData.empty())
+            _depData.resize(0, depRow.ncol());
+
+        OPENSIM_THROW_IF(depRow.ncol() != _depData.ncol(),
+                         IncorrectNumColumns,
+                         static_cast<size_t>(_depData.ncol()),
+                         static_cast<size_t>(depRow.ncol()));
 
-        if(_depData.nrow() == 0) {
-            _depData.resize(1, depRow.size());
+        // Resizing _depData copies the entire matrix, so the matrix keeps
+        // spare rows and grows along with the capacity of _indData
+        // (geometrically, or as given to reserveRows()).
+        _indData.push_back(indRow);
+        const int numRows = static_cast<int>(_indData.size());
+        if(numRows > _depData.nrow()) {
+            _depData.resizeKeep(static_cast<int>(_indData.capacity()),
+                                _depData.ncol());
+            _spareRows.mayExist.store(true);
+        }
+        _depData.updRow(numRows - 1) = depRow;
+    }
+
+    /** Reserve memory for a total of `numRows` rows so that appending rows up
+    to that number does not reallocate. This is only a hint; appending more
+    rows than reserved is allowed. Tables that are populated one row at a time
+    (e.g., by a reporter during a simulation) can use this to avoid repeated
+    reallocation when the number of rows is known in advance.                 */
+    void reserveRows(size_t numRows) {
+        _indData.reserve(numRows);
+        // An empty table allocates its matrix on the first appendRow(), using
+        // the capacity of _indData.
+        if(!_indData.empty() &&
+                static_cast<int>(numRows) > _depData.nrow()) {
+            _depData.resizeKeep(static_cast<int>(numRows), _depData.ncol());
+            _spareRows.mayExist.store(true);
         }
-        else 
-            _depData.resizeKeep(_depData.nrow() + 1, _depData.ncol());
-            
-        _depData.updRow(_depData.nrow() - 1) = depRow;
     }
 
     /** Get row at index.                                                     
@@ -789,7 +817,7 @@ public:
             for(size_t r = index; r < getNumRows() - 1; ++r)
                 _depData.updRow((int)r) = _depData.row((int)(r + 1));
         
-        _depData.resizeKeep(_depData.nrow() - 1, _depData.ncol());
+        _depData.resizeKeep((int)getNumRows() - 1, _depData.ncol());
         _indData.erase(_indData.begin() + index);
     }
 
@@ -943,6 +971,7 @@ public:
                          static_cast<size_t>(getNumRows()),
                          static_cast<size_t>(depCol.nrow()));
         
+        removeSpareRows();
         _depData.resizeKeep(_depData.nrow(), _depData.ncol() + 1);
         _depData.updCol(_depData.ncol() - 1) = depCol;
         appendColumnLabel(columnLabel);
@@ -993,6 +1022,7 @@ public:
     \throws ColumnIndexOutOfRange If index is out of range for number of columns
                                   in the table.                               */
     VectorView getDependentColumnAtIndex(size_t index) const {
+        removeSpareRows();
         OPENSIM_THROW_IF(isEmpty(), EmptyTable);
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(index),
                          ColumnIndexOutOfRange, index, 0,
@@ -1006,6 +1036,7 @@ public:
     \throws KeyNotFound If columnLabel is not found to be label of any existing
                         column.                                               */
     VectorView getDependentColumn(const std::string& columnLabel) const {
+        removeSpareRows();
         return _depData.col(static_cast<int>(getColumnIndex(columnLabel)));
     }
 
@@ -1015,6 +1046,7 @@ public:
     \throws ColumnIndexOutOfRange If index is out of range for number of columns
                                   in the table.                               */
     VectorView updDependentColumnAtIndex(size_t index) {
+        removeSpareRows();
         OPENSIM_THROW_IF(isEmpty(), EmptyTable);
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(index),
                          ColumnIndexOutOfRange, index, 0,
@@ -1028,6 +1060,7 @@ public:
     \throws KeyNotFound If columnLabel is not found to be label of any existing
                         column.                                               */
     VectorView updDependentColumn(const std::string& columnLabel) {
+        removeSpareRows();
         return _depData.updCol(static_cast<int>(getColumnIndex(columnLabel)));
     }
 
@@ -1057,6 +1090,7 @@ public:
 
     /** Get a read-only view to the underlying matrix.                        */
     const MatrixView& getMatrix() const {
+        removeSpareRows();
         return _depData.getAsMatrixView();
     }
 
@@ -1079,11 +1113,11 @@ public:
         OPENSIM_THROW_IF(isRowIndexOutOfRange(rowStart),
                          RowIndexOutOfRange,
                          rowStart, 0, 
-                         static_cast<unsigned>(_depData.nrow() - 1));
+                         static_cast<unsigned>(_indData.size() - 1));
         OPENSIM_THROW_IF(isRowIndexOutOfRange(rowStart + numRows - 1),
                          RowIndexOutOfRange,
                          rowStart + numRows - 1, 0, 
-                         static_cast<unsigned>(_depData.nrow() - 1));
+                         static_cast<unsigned>(_indData.size() - 1));
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(columnStart),
                          ColumnIndexOutOfRange,
                          columnStart, 0, 
@@ -1101,6 +1135,7 @@ public:
 
     /** Get a writable view to the underlying matrix.                         */
     MatrixView& updMatrix() {
+        removeSpareRows();
         return _depData.updAsMatrixView();
     }
 
@@ -1123,11 +1158,11 @@ public:
         OPENSIM_THROW_IF(isRowIndexOutOfRange(rowStart),
                          RowIndexOutOfRange,
                          rowStart, 0, 
-                         static_cast<unsigned>(_depData.nrow() - 1));
+                         static_cast<unsigned>(_indData.size() - 1));
         OPENSIM_THROW_IF(isRowIndexOutOfRange(rowStart + numRows - 1),
                          RowIndexOutOfRange,
                          rowStart + numRows - 1, 0, 
-                         static_cast<unsigned>(_depData.nrow() - 1));
+                         static_cast<unsigned>(_indData.size() - 1));
         OPENSIM_THROW_IF(isColumnIndexOutOfRange(columnStart),
                          ColumnIndexOutOfRange,
                          columnStart, 0, 
@@ -1557,7 +1592,7 @@ protected:
 
     /** Get number of rows.                                                   */
     size_t implementGetNumRows() const override {
-        return _depData.nrow();
+        return _indData.size();
     }
 
     /** Get number of columns.                                                */
@@ -1661,8 +1696,44 @@ protected:
         return M * N;
     }
 
+    /** Shrink the dependent data matrix to the number of rows in the table,
+    dropping the spare rows kept by appendRow() and reserveRows(). It is
+    invoked by the member functions that expose whole columns or the whole
+    matrix; the row accessors do not need it. Concurrent calls from const
+    member functions are safe: the first one shrinks the matrix while the
+    others wait, and calls on a table without spare rows do not lock.         */
+    void removeSpareRows() const {
+        if(!_spareRows.mayExist.load()) return;
+        std::lock_guard<std::mutex> lock(_spareRows.mutex);
+        if(!_spareRows.mayExist.load()) return;
+        const int numRows = static_cast<int>(_indData.size());
+        if(_depData.nrow() != numRows)
+            _depData.resizeKeep(numRows, _depData.ncol());
+        _spareRows.mayExist.store(false);
+    }
+
+    /** Whether the dependent data matrix may have spare rows, and the mutex
+    that removeSpareRows() holds while removing them. Copying a table copies
+    the flag but not the mutex.                                               */
+    struct SpareRows {
+        SpareRows() = default;
+        SpareRows(const SpareRows& other)
+            : mayExist(other.mayExist.load()) {}
+        SpareRows& operator=(const SpareRows& other) {
+            mayExist.store(other.mayExist.load());
+            return *this;
+        }
+        std::atomic<bool>  mayExist{false};
+        mutable std::mutex mutex;
+    };
+
     std::vector<ETX>    _indData;
-    SimTK::Matrix_<ETY> _depData;
+    // The rows of _depData beyond the number of rows in the table are spare
+    // capacity for appendRow(). Mutable so that the spare rows can be removed
+    // before a const member function exposes whole columns. See
+    // removeSpareRows().
+    mutable SimTK::Matrix_<ETY> _depData;
+    mutable SpareRows           _spareRows;
 };  // DataTable_
 
 
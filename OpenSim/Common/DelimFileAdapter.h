@@ -29,6 +29,9 @@
 #include "TimeSeriesTable.h"
 #include "OpenSim/Common/IO.h"
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <string>
 #include <fstream>
 #include <regex>
@@ -173,6 +176,43 @@ private:
     inline void writeElem_impl(std::ostream& stream,
                                const SimTK::Vec<M>& elem,
                                const unsigned& prec) const;
+
+    /** Characters [first, second) of a token in the file buffer.             */
+    typedef std::pair<const char*, const char*> TokenRange;
+    /** Whether each (unsigned) character is a delimiter.                     */
+    typedef std::array<bool, 256> DelimiterTable;
+
+    static inline DelimiterTable makeDelimiterTable(const std::string& delims);
+
+    /** Same as tokenize(), but without copying the tokens. The tokens are
+    written to `tokens`, whose capacity is reused across lines.               */
+    static inline void tokenizeRange(const char* begin,
+                                     const char* end,
+                                     const DelimiterTable& isDelimiter,
+                                     std::vector<TokenRange>& tokens);
+
+    /** Parse the N components of an element (e.g., "1,2,3" for a Vec3).    */
+    template<int N>
+    static inline SimTK::Vec<N> readComponents(
+            const TokenRange& token, const DelimiterTable& isCompDelimiter);
+
+    /** Following overloads parse one element from a token, in place.        */
+    static inline void readElem_impl(const TokenRange& token,
+                                     const DelimiterTable& isCompDelimiter,
+                                     double& elem);
+    static inline void readElem_impl(const TokenRange& token,
+                                     const DelimiterTable& isCompDelimiter,
+                                     SimTK::UnitVec3& elem);
+    static inline void readElem_impl(const TokenRange& token,
+                                     const DelimiterTable& isCompDelimiter,
+                                     SimTK::Quaternion& elem);
+    static inline void readElem_impl(const TokenRange& token,
+                                     const DelimiterTable& isCompDelimiter,
+                                     SimTK::SpatialVec& elem);
+    template<int M>
+    static inline void readElem_impl(const TokenRange& token,
+                                     const DelimiterTable& isCompDelimiter,
+                                     SimTK::Vec<M>& elem);
       
     /** Trim string -- remove specified leading and trailing characters from 
     string. Trims out whitespace by default.                                  */
@@ -310,7 +350,7 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
     OPENSIM_THROW_IF(fileName.empty(),
                      EmptyFileName);
 
-    std::ifstream in_stream{fileName};
+    std::ifstream in_stream{fileName, std::ios::binary};
     OPENSIM_THROW_IF(!in_stream.good(),
                      FileDoesNotExist,
                      fileName);
@@ -319,31 +359,61 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
                      FileIsEmpty,
                      fileName);
 
+    // Read the whole file with one call and parse it in place, rather than
+    // copying each line and each token into a std::string.
+    std::string buffer{};
+    in_stream.seekg(0, std::ios::end);
+    buffer.resize(static_cast<size_t>(in_stream.tellg()));
+    in_stream.seekg(0, std::ios::beg);
+    in_stream.read(&buffer[0], buffer.size());
+    buffer.resize(static_cast<size_t>(in_stream.gcount()));
+    in_stream.close();
+
+    const char* cursor = buffer.data();
+    const char* const bufferEnd = buffer.data() + buffer.size();
+    // Callable to get the next line, excluding the line ending. Returns
+    // false at the end of the file.
+    const char* lineBegin{};
+    const char* lineEnd{};
+    auto nextLine = [&] {
+        if(cursor == bufferEnd)
+            return false;
+        lineBegin = cursor;
+        auto newline = static_cast<const char*>(
+                std::memchr(cursor, '\n', bufferEnd - cursor));
+        lineEnd = newline ? newline : bufferEnd;
+        cursor = newline ? newline + 1 : bufferEnd;
+        // We might be parsing a file with CRLF (\r\n) line endings on a
+        // platform that uses only LF (\n) line endings, in which case we
+        // must remove the \r manually.
+        if(lineEnd != lineBegin && *(lineEnd - 1) == '\r')
+            --lineEnd;
+        return true;
+    };
+
     size_t line_num{};
     // All the lines until "endheader" is header.
-    std::regex endheader{R"([ \t]*)" + _endHeaderString + R"([ \t]*)"};
-    std::regex keyvalue{R"((.*)=(.*))"};
     std::string header{};
-    std::string line{};
     ValueArrayDictionary keyValuePairs;
-    while(std::getline(in_stream, line)) {
+    while(nextLine()) {
         ++line_num;
-
-        // We might be parsing a file with CRLF (\r\n) line endings on a
-        // platform that uses only LF (\n) line endings, in which case the \r
-        // is part of `line` and we must remove it manually.
-        if (!line.empty() && line.back() == '\r') 
-            line.pop_back();
-
-        if(std::regex_match(line, endheader))
+        const std::string line{lineBegin, lineEnd};
+
+        // The line is "endheader", possibly surrounded by spaces and tabs.
+        const auto first = line.find_first_not_of(" \t");
+        if(first != std::string::npos &&
+                line.compare(first, _endHeaderString.size(),
+                             _endHeaderString) == 0 &&
+                line.find_first_not_of(" \t",
+                        first + _endHeaderString.size()) == std::string::npos)
             break;
 
         // Detect Key value pairs of the form "key = value" and add them to
-        // metadata.
-        std::smatch matchRes{};
-        if(std::regex_match(line, matchRes, keyvalue)) {
-            auto key = matchRes[1].str();
-            auto value = matchRes[2].str();
+        // metadata. The key is everything before the last '='.
+        const auto equals = line.rfind('=');
+        if(equals != std::string::npos) {
+            auto key = line.substr(0, equals);
+            auto value = line.substr(equals + 1);
             IO::TrimWhitespace(value);
             if(!key.empty() && !value.empty()) {
                 const auto trimmed_key = trim(key);
@@ -374,16 +444,13 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
     }
     keyValuePairs.setValueForKey("header", header);
 
-    // Callable to get the next line in form of vector of tokens.
-    auto nextLine = [&] {
-        return getNextLine(in_stream, _delimitersRead);
-    };
-
     // Read the line containing column labels and fill up the column labels
     // container.
     std::vector<std::string> column_labels{};
-    while (column_labels.size() == 0) { // keep going down rows to find labels
-        column_labels = nextLine();
+    while (column_labels.size() == 0 && nextLine()) {
+        // keep going down rows to find labels
+        column_labels = tokenize(std::string{lineBegin, lineEnd},
+                                 _delimitersRead);
         // for labels we never expect empty elements, so remove them
         IO::eraseEmptyElements(column_labels);
         ++line_num;
@@ -401,49 +468,38 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
                      column_labels[0]);
     column_labels.erase(column_labels.begin());
 
-    // Read the rows one at a time and fill up the time column container and
-    // the data container. Start with a reasonable initial capacity for
-    // tradeoff between a small file and larger files. 100 worked well for
-    // a 50 MB file with ~80000 lines.
+    // The remaining lines bound the number of rows, so the containers are
+    // allocated once and filled in place.
+    const int maxRows = 1 + static_cast<int>(
+            std::count(cursor, bufferEnd, '\n'));
+    const int ncol = static_cast<int>(column_labels.size());
     std::vector<double> timeVec;
-    int initCapacity = 100;
-    int ncol = static_cast<int>(column_labels.size());
-    timeVec.reserve(initCapacity);
-    SimTK::Matrix_<T> matrix(initCapacity, ncol);
-    
-    // Initialize current row and capacity
-    int curCapacity = initCapacity;
-    int curRow = 0;
+    timeVec.reserve(maxRows);
+    SimTK::Matrix_<T> matrix(maxRows, ncol);
 
-    // Start looping through each line
-    auto row = nextLine();
-    while (!row.empty()) {
-        ++line_num;
-        
-        // Double capacity if we reach the end of the containers.
-        // This is necessary until Simbody issue #401 is addressed.
-        if (curRow+1 > curCapacity) {
-            curCapacity *= 2;
-            timeVec.reserve(curCapacity);
-            matrix.resizeKeep(curCapacity, ncol);
-        }
-
-        // Time is column 0.
-        timeVec.push_back(std::stod(row.front()));
-        row.erase(row.begin());
+    const auto isDelimiter = makeDelimiterTable(_delimitersRead);
+    const auto isCompDelimiter = makeDelimiterTable(_compDelimRead);
+    std::vector<TokenRange> row{};
+    row.reserve(ncol + 1);
 
-        auto row_vector = readElems(row);
+    // Read the rows one at a time until the end of the file or an empty line.
+    int curRow = 0;
+    while(nextLine() && lineBegin != lineEnd) {
+        ++line_num;
+        tokenizeRange(lineBegin, lineEnd, isDelimiter, row);
 
-        OPENSIM_THROW_IF(row_vector.size() != (int)column_labels.size(),
+        OPENSIM_THROW_IF(row.size() != column_labels.size() + 1,
             RowLengthMismatch,
             fileName,
             line_num,
             column_labels.size(),
-            static_cast<size_t>(row_vector.size()));
-        
-        matrix.updRow(curRow) = std::move(row_vector);
+            row.size() - 1);
 
-        row = nextLine();
+        // Time is column 0.
+        timeVec.push_back(parseDouble(row[0].first, row[0].second));
+        for(int col = 0; col < ncol; ++col)
+            readElem_impl(row[col + 1], isCompDelimiter,
+                          matrix.updElt(curRow, col));
         ++curRow;
     }
 
@@ -462,6 +518,114 @@ DelimFileAdapter<T>::extendRead(const std::string& fileName) const {
     return output_tables;
 }
 
+template<typename T>
+typename DelimFileAdapter<T>::DelimiterTable
+DelimFileAdapter<T>::makeDelimiterTable(const std::string& delims) {
+    DelimiterTable isDelimiter{};
+    for(const char ch : delims)
+        isDelimiter[static_cast<unsigned char>(ch)] = true;
+    return isDelimiter;
+}
+
+template<typename T>
+void
+DelimFileAdapter<T>::tokenizeRange(const char* begin,
+                                   const char* end,
+                                   const DelimiterTable& isDelimiter,
+                                   std::vector<TokenRange>& tokens) {
+    // Leading and trailing whitespace is trimmed by parseDouble().
+    tokens.clear();
+    const char* tokenBegin = begin;
+    for(const char* ch = begin; ch != end; ++ch) {
+        if(isDelimiter[static_cast<unsigned char>(*ch)]) {
+            tokens.emplace_back(tokenBegin, ch);
+            tokenBegin = ch + 1;
+        }
+    }
+    // As in tokenize(), a delimiter at the end of the line does not start
+    // another token.
+    if(tokenBegin != end)
+        tokens.emplace_back(tokenBegin, end);
+}
+
+template<typename T>
+template<int N>
+SimTK::Vec<N>
+DelimFileAdapter<T>::readComponents(const TokenRange& token,
+                                    const DelimiterTable& isCompDelimiter) {
+    std::array<TokenRange, N> comps{};
+    int numComps = 0;
+    const char* compBegin = token.first;
+    for(const char* ch = token.first; ch != token.second; ++ch) {
+        if(isCompDelimiter[static_cast<unsigned char>(*ch)]) {
+            if(numComps < N)
+                comps[numComps] = TokenRange{compBegin, ch};
+            ++numComps;
+            compBegin = ch + 1;
+        }
+    }
+    if(compBegin != token.second) {
+        if(numComps < N)
+            comps[numComps] = TokenRange{compBegin, token.second};
+        ++numComps;
+    }
+    OPENSIM_THROW_IF(numComps != N,
+                     IncorrectNumTokens,
+                     "Expected " + std::to_string(N) +
+                     "x (multiple of " + std::to_string(N) +
+                     ") number of tokens.");
+
+    SimTK::Vec<N> values;
+    for(int i = 0; i < N; ++i)
+        values[i] = parseDouble(comps[i].first, comps[i].second);
+    return values;
+}
+
+template<typename T>
+void
+DelimFileAdapter<T>::readElem_impl(const TokenRange& token,
+                                   const DelimiterTable&,
+                                   double& elem) {
+    elem = parseDouble(token.first, token.second);
+}
+
+template<typename T>
+void
+DelimFileAdapter<T>::readElem_impl(const TokenRange& token,
+                                   const DelimiterTable& isCompDelimiter,
+                                   SimTK::UnitVec3& elem) {
+    const auto comps = readComponents<3>(token, isCompDelimiter);
+    elem = SimTK::UnitVec3{comps[0], comps[1], comps[2]};
+}
+
+template<typename T>
+void
+DelimFileAdapter<T>::readElem_impl(const TokenRange& token,
+                                   const DelimiterTable& isCompDelimiter,
+                                   SimTK::Quaternion& elem) {
+    const auto comps = readComponents<4>(token, isCompDelimiter);
+    elem = SimTK::Quaternion{comps[0], comps[1], comps[2], comps[3]};
+}
+
+template<typename T>
+void
+DelimFileAdapter<T>::readElem_impl(const TokenRange& token,
+                                   const DelimiterTable& isCompDelimiter,
+                                   SimTK::SpatialVec& elem) {
+    const auto comps = readComponents<6>(token, isCompDelimiter);
+    elem = SimTK::SpatialVec{{comps[0], comps[1], comps[2]},
+                             {comps[3], comps[4], comps[5]}};
+}
+
+template<typename T>
+template<int M>
+void
+DelimFileAdapter<T>::readElem_impl(const TokenRange& token,
+                                   const DelimiterTable& isCompDelimiter,
+                                   SimTK::Vec<M>& elem) {
+    elem = readComponents<M>(token, isCompDelimiter);
+}
+
 template<typename T>
 SimTK::RowVector_<T>
 DelimFileAdapter<T>::readElems(const std::vector<std::string>& tokens) const {
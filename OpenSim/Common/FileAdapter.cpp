@@ -2,6 +2,11 @@
 #include <OpenSim/Common/IO.h>
 #include "STOFileAdapter.h"
 
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <stdexcept>
+
 namespace OpenSim {
 
 std::shared_ptr<DataAdapter>
@@ -64,6 +69,90 @@ FileAdapter::tokenize(const std::string& str,
     return tokens;
 }
 
+double
+FileAdapter::parseDouble(const char* begin, const char* end) {
+    const auto isSpace = [](char ch) {
+        return ch == ' ' || ch == '\t' || ch == '\r' || ch == '\n';
+    };
+    while(begin != end && isSpace(*begin)) ++begin;
+    while(end != begin && isSpace(*(end - 1))) --end;
+
+    // Fast path: the decimal significand fits exactly in a double and the
+    // power of 10 is exact, so a single multiplication or division gives the
+    // correctly rounded result (Clinger's algorithm).
+    static const double powersOf10[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                        1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17,
+                                        1e18, 1e19, 1e20, 1e21, 1e22};
+    const char* p = begin;
+    bool negative = false;
+    if(p != end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    std::uint64_t significand = 0;
+    int numSignificantDigits = 0;
+    int exponent = 0;
+    bool hasDigits = false;
+    bool fast = true;
+    const auto addDigit = [&](char ch) {
+        if(significand != 0 || ch != '0') {
+            if(++numSignificantDigits > 19) fast = false;
+        }
+        significand = 10 * significand + static_cast<unsigned>(ch - '0');
+        hasDigits = true;
+    };
+    while(fast && p != end && *p >= '0' && *p <= '9') addDigit(*p++);
+    if(fast && p != end && *p == '.') {
+        ++p;
+        while(fast && p != end && *p >= '0' && *p <= '9') {
+            addDigit(*p++);
+            --exponent;
+        }
+    }
+    if(fast && hasDigits && p != end && (*p == 'e' || *p == 'E')) {
+        ++p;
+        bool negativeExponent = false;
+        if(p != end && (*p == '-' || *p == '+')) {
+            negativeExponent = *p == '-';
+            ++p;
+        }
+        int explicitExponent = 0;
+        const char* exponentBegin = p;
+        while(p != end && *p >= '0' && *p <= '9' && p - exponentBegin < 4) {
+            explicitExponent = 10 * explicitExponent + (*p++ - '0');
+        }
+        if(p == exponentBegin) fast = false;
+        exponent += negativeExponent ? -explicitExponent : explicitExponent;
+    }
+    if(fast && hasDigits && p == end) {
+        if(significand == 0)
+            return negative ? -0.0 : 0.0;
+        if(significand <= (std::uint64_t(1) << 53) &&
+                exponent >= -22 && exponent <= 22) {
+            double value = static_cast<double>(significand);
+            if(exponent < 0)
+                value /= powersOf10[-exponent];
+            else
+                value *= powersOf10[exponent];
+            return negative ? -value : value;
+        }
+    }
+
+    // Slow path (long significands, large exponents, nan, inf, trailing
+    // characters): defer to the C library, as std::stod() does. Copy the
+    // token so that strtod() cannot read past its end.
+    const std::string token(begin, end);
+    char* parsedEnd = nullptr;
+    errno = 0;
+    const double value = std::strtod(token.c_str(), &parsedEnd);
+    OPENSIM_THROW_IF(parsedEnd == token.c_str(), Exception,
+            "Could not parse '" + token + "' as a number.");
+    if(errno == ERANGE)
+        throw std::out_of_range("Number '" + token + "' is out of range.");
+    return value;
+}
+
 std::vector<std::string>
 FileAdapter::getNextLine(std::istream& stream,
                          const std::string& delims) {
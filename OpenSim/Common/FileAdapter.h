@@ -213,6 +213,20 @@ public:
     specifies that either a space or a tab can act as the delimiter.          */
     static std::vector<std::string> tokenize(const std::string& str, 
                                       const std::string& delims);
+
+    /** Parse a number from the characters [begin, end), ignoring leading and
+    trailing whitespace. Like std::stod(), only the longest prefix that forms
+    a number is used, and "nan" and "inf" are accepted. Unlike std::stod(),
+    no std::string is needed, and numbers with at most 19 significant digits
+    and a small exponent (the common case in data files) are converted
+    without calling the C library. The result is the same as that of
+    std::stod(), including for numbers that are out of range.
+
+    \throws Exception If no number could be parsed.
+    \throws std::out_of_range If the number overflows or underflows a double
+                              (as std::stod() does).                        */
+    static double parseDouble(const char* begin, const char* end);
+
     /** Create a concerte FileAdapter based on the extension of the passed in file and return it.
      This serves as a Factory of FileAdapters so clients don't need to know specific concrete 
      subclasses, as long as the generic base class read interface is used */
@@ -173,6 +173,30 @@ double Function::calcDerivative(const std::vector<int>& derivComponents, const V
     return _function->calcDerivative(derivComponents, x);
 }
 
+void Function::calcValues(const double* x, double* y, int n) const
+{
+    Vector arg(1);
+    for (int i = 0; i < n; ++i) {
+        arg[0] = x[i];
+        y[i] = calcValue(arg);
+    }
+}
+
+void Function::calcDerivatives(const double* x, double* y, int n,
+                               int order) const
+{
+    if (order == 0) {
+        calcValues(x, y, n);
+        return;
+    }
+    const std::vector<int> derivComponents(order, 0);
+    Vector arg(1);
+    for (int i = 0; i < n; ++i) {
+        arg[0] = x[i];
+        y[i] = calcDerivative(derivComponents, arg);
+    }
+}
+
 int Function::getArgumentSize() const
 {
     if (_function == NULL)
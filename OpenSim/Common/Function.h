@@ -114,6 +114,27 @@ public:
      * @param x                the Vector of input arguments.  Its size must equal the value returned by getArgumentSize().
      */
     virtual double calcDerivative(const std::vector<int>& derivComponents, const SimTK::Vector& x) const;
+#ifndef SWIG
+    /**
+     * Calculate the value of this function of one argument at each of n
+     * points. This gives the same results as calling calcValue() for each
+     * point, but the argument Vector is allocated once for all points, which
+     * matters when a function is evaluated at many points (e.g., at all time
+     * frames of a trial).
+     *
+     * @param x the n points.
+     * @param y the n values of the function.
+     * @param n the number of points.
+     */
+    virtual void calcValues(const double* x, double* y, int n) const;
+    /**
+     * Calculate a derivative of this function of one argument at each of n
+     * points, as calcDerivative() does for one point. An order of 0
+     * calculates the value of the function.
+     */
+    virtual void calcDerivatives(const double* x, double* y, int n,
+                                 int order) const;
+#endif
     /**
      * Get the number of components expected in the input vector.
      */
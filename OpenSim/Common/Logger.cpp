@@ -26,8 +26,17 @@
 #include "IO.h"
 #include "LogSink.h"
 
+#include "spdlog/details/null_mutex.h"
+#include "spdlog/sinks/base_sink.h"
 #include "spdlog/sinks/stdout_color_sinks.h"
 
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
 using namespace OpenSim;
 
 std::shared_ptr<spdlog::logger> Logger::m_cout_logger = 
@@ -35,11 +44,218 @@ std::shared_ptr<spdlog::logger> Logger::m_cout_logger =
 std::shared_ptr<spdlog::sinks::basic_file_sink_mt> Logger::m_filesink = {};
 std::shared_ptr<spdlog::logger> Logger::m_default_logger;
 
+namespace {
+// The innermost Logger::ThreadContext of each thread.
+thread_local Logger::ThreadContext* threadContext = nullptr;
+
+// The tag of each thread (Logger::setThreadTag()), and, while a thread writes
+// a message to the sinks, the tag of that message.
+thread_local std::string threadTag;
+thread_local const std::string* writingTag = nullptr;
+
+// A logged message, with the time at which, the thread by which, and the tag
+// with which it was logged, so that it can be written to the sinks later.
+struct Message {
+    explicit Message(const spdlog::details::log_msg& msg)
+            : level(msg.level), time(msg.time), threadId(msg.thread_id),
+              payload(msg.payload.data(), msg.payload.size()),
+              tag(threadTag) {}
+    spdlog::level::level_enum level;
+    spdlog::log_clock::time_point time;
+    size_t threadId;
+    std::string payload;
+    std::string tag;
+};
+
+// The sinks of one of the loggers. Each logger has a SinkList as its only
+// sink, and the loggers are never replaced: adding and removing sinks, and
+// turning asynchronous logging on and off, only change SinkLists and the
+// AsyncWriter, under their mutexes, so that threads can keep logging.
+class SinkList : public spdlog::sinks::sink {
+public:
+    SinkList(std::string loggerName, std::vector<spdlog::sink_ptr> sinks)
+            : m_loggerName(std::move(loggerName)), m_sinks(std::move(sinks)) {}
+    void add(const spdlog::sink_ptr& sink) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sinks.push_back(sink);
+    }
+    void remove(const spdlog::sink_ptr& sink) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto toErase = std::find(m_sinks.begin(), m_sinks.end(), sink);
+        if (toErase != m_sinks.end()) m_sinks.erase(toErase);
+    }
+    /// Write the message to the sinks, or queue it for the background thread
+    /// if logging is asynchronous.
+    void dispatch(Message message);
+    /// Write the message to the sinks now.
+    void write(const Message& message) {
+        spdlog::details::log_msg msg(
+                m_loggerName, message.level, message.payload);
+        msg.time = message.time;
+        msg.thread_id = message.threadId;
+        const std::string* previousTag = writingTag;
+        writingTag = &message.tag;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            for (auto& sink : m_sinks) {
+                if (sink->should_log(msg.level)) sink->log(msg);
+            }
+        }
+        writingTag = previousTag;
+    }
+    void flushSinks() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& sink : m_sinks) sink->flush();
+    }
+
+    void log(const spdlog::details::log_msg& msg) override {
+        dispatch(Message(msg));
+    }
+    /// While logging is asynchronous, the background thread flushes the
+    /// sinks after writing the queued messages.
+    void flush() override;
+    void set_pattern(const std::string& pattern) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& sink : m_sinks) sink->set_pattern(pattern);
+    }
+    void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto& sink : m_sinks) sink->set_formatter(formatter->clone());
+    }
+private:
+    const std::string m_loggerName;
+    std::mutex m_mutex;
+    std::vector<spdlog::sink_ptr> m_sinks;
+};
+
+// Writes the messages of the SinkLists on a background thread while logging
+// is asynchronous (Logger::setAsync()).
+class AsyncWriter {
+public:
+    ~AsyncWriter() { stop(); }
+    void start(size_t queueSize) {
+        std::lock_guard<std::mutex> control(m_controlMutex);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_running) return;
+        m_capacity = queueSize;
+        m_running = true;
+        m_stopping = false;
+        m_thread = std::thread(&AsyncWriter::run, this);
+    }
+    /// Write the queued messages (and any that are queued meanwhile), then
+    /// stop the background thread.
+    void stop() {
+        std::lock_guard<std::mutex> control(m_controlMutex);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) return;
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_thread.join();
+    }
+    bool isRunning() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_running;
+    }
+    /// Queue the message, dropping the oldest queued message if the queue is
+    /// full. Returns false, without queuing it, if the background thread is
+    /// not running.
+    bool push(SinkList& sinks, Message&& message) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_running) return false;
+            if (m_queue.size() >= m_capacity) m_queue.pop_front();
+            m_queue.emplace_back(&sinks, std::move(message));
+        }
+        m_wake.notify_one();
+        return true;
+    }
+    /// Wait until the messages queued so far have been written.
+    void wait() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this] { return m_queue.empty() && !m_writing; });
+    }
+private:
+    using Entry = std::pair<SinkList*, Message>;
+    void run() {
+        std::deque<Entry> batch;
+        std::vector<SinkList*> written;
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (true) {
+            m_wake.wait(lock, [this] { return !m_queue.empty() || m_stopping; });
+            if (m_queue.empty()) {
+                // Messages logged from now on are written synchronously.
+                m_running = false;
+                m_idle.notify_all();
+                return;
+            }
+            batch.swap(m_queue);
+            m_writing = true;
+            lock.unlock();
+            for (const auto& entry : batch) {
+                entry.first->write(entry.second);
+                if (std::find(written.begin(), written.end(), entry.first) ==
+                        written.end())
+                    written.push_back(entry.first);
+            }
+            for (SinkList* sinks : written) sinks->flushSinks();
+            batch.clear();
+            written.clear();
+            lock.lock();
+            m_writing = false;
+            if (m_queue.empty()) m_idle.notify_all();
+        }
+    }
+
+    /// Serializes start() and stop().
+    std::mutex m_controlMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_idle;
+    std::deque<Entry> m_queue;
+    size_t m_capacity = 0;
+    bool m_running = false;
+    bool m_stopping = false;
+    bool m_writing = false;
+    std::thread m_thread;
+};
+
+AsyncWriter& getAsyncWriter() {
+    static AsyncWriter writer;
+    return writer;
+}
+
+void SinkList::dispatch(Message message) {
+    if (!getAsyncWriter().push(*this, std::move(message))) write(message);
+}
+
+void SinkList::flush() {
+    if (!getAsyncWriter().isRunning()) flushSinks();
+}
+
+// Give `logger` a SinkList with its sinks as its only sink.
+void useSinkList(spdlog::logger& logger) {
+    auto sinks = std::make_shared<SinkList>(logger.name(), logger.sinks());
+    logger.sinks().clear();
+    logger.sinks().push_back(sinks);
+}
+
+SinkList& getSinkList(spdlog::logger& logger) {
+    return static_cast<SinkList&>(*logger.sinks().front());
+}
+} // anonymous namespace
+
 // Force creation of the Logger instane to initialize spdlog::loggers
 std::shared_ptr<OpenSim::Logger> Logger::m_osimLogger = Logger::getInstance();
 
 Logger::Logger() {
     m_default_logger = spdlog::default_logger();
+    useSinkList(*m_default_logger);
+    useSinkList(*m_cout_logger);
+    // Create the background thread's writer after the loggers, so that it
+    // is destroyed (writing the queued messages) before them.
+    getAsyncWriter();
     m_default_logger->set_level(spdlog::level::info);
     m_default_logger->set_pattern("[%l] %v");
     m_cout_logger->set_level(spdlog::level::info);
@@ -179,23 +395,153 @@ void Logger::removeSink(const std::shared_ptr<LogSink> sink) {
 }
 
 void Logger::addSinkInternal(std::shared_ptr<spdlog::sinks::sink> sink) {
-    m_default_logger->sinks().push_back(sink);
-    m_cout_logger->sinks().push_back(sink);
+    // Messages that were logged before the sink was added are not written to
+    // it, even if they are still queued.
+    getAsyncWriter().wait();
+    getSinkList(*m_default_logger).add(sink);
+    getSinkList(*m_cout_logger).add(sink);
 }
 
 void Logger::removeSinkInternal(const std::shared_ptr<spdlog::sinks::sink> sink)
 {
-    {
-        auto& sinks = m_default_logger->sinks();
-        auto to_erase = std::find(sinks.cbegin(), sinks.cend(), sink);
-        if (to_erase != sinks.cend()) sinks.erase(to_erase);
+    getAsyncWriter().wait();
+    getSinkList(*m_default_logger).remove(sink);
+    getSinkList(*m_cout_logger).remove(sink);
+}
+
+spdlog::logger& Logger::getThreadLogger() {
+    return threadContext ? *threadContext->m_logger : *m_default_logger;
+}
+
+void Logger::setAsync(bool async, size_t queueSize) {
+    if (async) {
+        OPENSIM_THROW_IF(queueSize == 0, Exception,
+                "Expected queueSize to be positive.");
+        getAsyncWriter().start(queueSize);
+    } else {
+        getAsyncWriter().stop();
     }
-    {
-        auto& sinks = m_cout_logger->sinks();
-        auto to_erase = std::find(sinks.cbegin(), sinks.cend(), sink);
-        if (to_erase != sinks.cend()) sinks.erase(to_erase);
+}
+
+bool Logger::isAsync() {
+    return getAsyncWriter().isRunning();
+}
+
+void Logger::flush() {
+    getAsyncWriter().wait();
+    getSinkList(*m_default_logger).flushSinks();
+    getSinkList(*m_cout_logger).flushSinks();
+}
+
+void Logger::setThreadTag(std::string tag) {
+    threadTag = std::move(tag);
+}
+
+const std::string& Logger::getThreadTag() {
+    return writingTag ? *writingTag : threadTag;
+}
+
+//=============================================================================
+// ThreadContext
+//=============================================================================
+// Holds the messages of a ThreadContext. Only the thread that owns the
+// context uses the sink, so the sink does not need a mutex.
+class Logger::ThreadContext::BufferSink
+        : public spdlog::sinks::base_sink<spdlog::details::null_mutex> {
+public:
+    BufferSink(size_t capacity, double flushInterval, BufferSink* parent)
+            : m_capacity(capacity),
+              m_interval(std::chrono::duration_cast<
+                      spdlog::log_clock::duration>(
+                      std::chrono::duration<double>(flushInterval))),
+              m_parent(parent) {
+        m_messages.reserve(capacity);
+    }
+    /// Buffer the message; forward the buffered messages if the buffer is
+    /// full, if the message is a warning or an error, or if the oldest
+    /// buffered message is older than the interval.
+    void append(Message message) {
+        m_messages.push_back(std::move(message));
+        const Message& latest = m_messages.back();
+        if (m_messages.size() >= m_capacity ||
+                latest.level >= spdlog::level::warn ||
+                latest.time - m_messages.front().time >= m_interval)
+            forward();
+    }
+    /// Pass the buffered messages to the enclosing context, or write them to
+    /// the sinks of the default logger, with their original times.
+    void forward() {
+        for (auto& message : m_messages) {
+            if (m_parent) m_parent->append(std::move(message));
+            else getSinkList(*m_default_logger).dispatch(std::move(message));
+        }
+        m_messages.clear();
+    }
+protected:
+    void sink_it_(const spdlog::details::log_msg& msg) override {
+        append(Message(msg));
+    }
+    void flush_() override {}
+private:
+    size_t m_capacity;
+    spdlog::log_clock::duration m_interval;
+    BufferSink* m_parent;
+    std::vector<Message> m_messages;
+};
+
+Logger::ThreadContext::ThreadContext(size_t bufferSize, double flushInterval)
+        : m_sink(std::make_shared<BufferSink>(
+                  std::max(bufferSize, size_t(1)), flushInterval,
+                  threadContext ? threadContext->m_sink.get() : nullptr)),
+          m_logger(std::make_shared<spdlog::logger>("thread", m_sink)),
+          m_previous(threadContext) {
+    m_logger->set_level(getThreadLogger().level());
+    threadContext = this;
+}
+
+Logger::ThreadContext::~ThreadContext() {
+    flush();
+    threadContext = m_previous;
+}
+
+void Logger::ThreadContext::flush() {
+    m_sink->forward();
+}
+
+void Logger::ThreadContext::flushAll() {
+    // Each context forwards its messages to the enclosing context, so flush
+    // from the innermost context outwards.
+    for (ThreadContext* context = threadContext; context;
+            context = context->m_previous) {
+        context->flush();
     }
 }
 
+//=============================================================================
+// ProgressLogger
+//=============================================================================
+ProgressLogger::ProgressLogger(std::string description, int numFrames,
+        double interval)
+        : m_description(std::move(description)), m_numFrames(numFrames),
+          m_interval(std::chrono::duration_cast<Clock::duration>(
+                  std::chrono::duration<double>(interval))),
+          m_start(Clock::now()), m_nextMessage(m_start + m_interval) {}
 
+void ProgressLogger::update(int numFramesDone) {
+    const auto now = Clock::now();
+    if (numFramesDone < m_numFrames && now < m_nextMessage) return;
+    if (!Logger::shouldLog(Logger::Level::Info)) return;
+    m_nextMessage = now + m_interval;
 
+    const double percent =
+            m_numFrames > 0 ? 100.0 * numFramesDone / m_numFrames : 100.0;
+    const double elapsed =
+            std::chrono::duration<double>(now - m_start).count();
+    if (elapsed > 0) {
+        log_info("{} {}/{} frames ({:.0f}%), {:.1f} frames/s.", m_description,
+                numFramesDone, m_numFrames, percent, numFramesDone / elapsed);
+    } else {
+        log_info("{} {}/{} frames ({:.0f}%).", m_description, numFramesDone,
+                m_numFrames, percent);
+    }
+}
@@ -23,6 +23,7 @@
  * -------------------------------------------------------------------------- */
 
 #include "osimCommonDLL.h"
+#include <chrono>
 #include <set>
 #include <spdlog/spdlog.h>
 #include <spdlog/sinks/basic_file_sink.h>
@@ -104,32 +105,32 @@ public:
 
     template <typename... Args>
     static void critical(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->critical(fmt, args...);
+        getThreadLogger().critical(fmt, args...);
     }
 
     template <typename... Args>
     static void error(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->error(fmt, args...);
+        getThreadLogger().error(fmt, args...);
     }
 
     template <typename... Args>
     static void warn(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->warn(fmt, args...);
+        getThreadLogger().warn(fmt, args...);
     }
 
     template <typename... Args>
     static void info(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->info(fmt, args...);
+        getThreadLogger().info(fmt, args...);
     }
 
     template <typename... Args>
     static void debug(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->debug(fmt, args...);
+        getThreadLogger().debug(fmt, args...);
     }
 
     template <typename... Args>
     static void trace(spdlog::string_view_t fmt, const Args&... args) {
-        m_default_logger->trace(fmt, args...);
+        getThreadLogger().trace(fmt, args...);
     }
 
     /// Use this function to log messages that would normally be sent to
@@ -162,15 +163,86 @@ public:
     static void removeFileSink();
 
     /// Start reporting messages to the provided sink.
-    /// @note This function is not thread-safe. Do not invoke this function
-    /// concurrently, or concurrently with addLogFile() or removeSink().
+    /// Other threads may log while this function is invoked.
     static void addSink(const std::shared_ptr<LogSink> sink);
 
     /// Remove a sink. If it doesn't exist, do nothing.
-    /// @note This function is not thread-safe. Do not invoke this function
-    /// concurrently, or concurrently with addLogFile() or addSink().
+    /// Other threads may log while this function is invoked.
     static void removeSink(const std::shared_ptr<LogSink> sink);
 
+    /// Write logged messages to the sinks on a background thread instead of
+    /// on the thread that logs them, so that formatting the messages and
+    /// writing them to the console and the log file does not slow down the
+    /// code that logs. Messages wait in a queue of `queueSize` messages; if
+    /// the queue is full, the oldest message is dropped so that logging never
+    /// blocks. Turning asynchronous logging off writes all messages still in
+    /// the queue before returning. Other threads may log while this function
+    /// is invoked.
+    /// @note While logging is asynchronous, addSink(), removeSink(),
+    /// addFileSink(), and removeFileSink() first wait for the messages in
+    /// the queue to be written, so that a sink receives exactly the messages
+    /// logged while it is in use.
+    static void setAsync(bool async, size_t queueSize = 8192);
+    static bool isAsync();
+
+    /// Wait until the background thread (setAsync()) has written the messages
+    /// logged so far, and flush the sinks.
+    static void flush();
+
+    /// Tag the messages that the calling thread logs from now on (e.g., with
+    /// the name of the task that the thread is running). The tag stays with
+    /// each message until it is written, even if the message is written
+    /// later or by another thread (see setAsync() and ThreadContext), so
+    /// that a sink can tell which task logged it. executeInParallel() and
+    /// executeInParallelBlocks() give their threads the tag of the thread
+    /// that calls them. The tag is empty by default.
+    static void setThreadTag(std::string tag);
+    /// The tag of the calling thread (see setThreadTag()). While a sink
+    /// writes a message, this is the tag of that message.
+    static const std::string& getThreadTag();
+
+    /// While an object of this class exists, the messages that the thread
+    /// that created it logs with log_info(), log_warn(), etc. are collected
+    /// in a buffer that belongs to the thread, instead of being written to
+    /// the sinks, which are shared by all threads and each protected by a
+    /// mutex. The buffered messages are logged, in order, with the times at
+    /// which they were logged, and without messages from other threads in
+    /// between, when flush() is called, when the buffer holds `bufferSize`
+    /// messages, when a warning or an error is logged, when a message is
+    /// logged `flushInterval` seconds or more after the oldest buffered
+    /// message, and when the object is destroyed.
+    /// executeInParallel() and executeInParallelBlocks() create one on each
+    /// of their threads:
+    /// @code
+    /// std::thread worker([]() {
+    ///     Logger::ThreadContext context;
+    ///     for (int i = 0; i < 100; ++i) log_debug("Solved frame {}.", i);
+    /// });
+    /// @endcode
+    /// Messages below the level getLevel() had when the context was created
+    /// are not logged. Messages logged with log_cout() are not buffered.
+    class OSIMCOMMON_API ThreadContext {
+    public:
+        explicit ThreadContext(size_t bufferSize = 1000,
+                double flushInterval = 0.1);
+        ~ThreadContext();
+        ThreadContext(const ThreadContext&) = delete;
+        ThreadContext& operator=(const ThreadContext&) = delete;
+        /// Log the buffered messages.
+        void flush();
+        /// Log the buffered messages of all of the contexts of the calling
+        /// thread (e.g., before a sink stops accepting the messages of this
+        /// thread). This does nothing if the thread has no context.
+        static void flushAll();
+    private:
+        friend class Logger;
+        class BufferSink;
+        std::shared_ptr<BufferSink> m_sink;
+        std::shared_ptr<spdlog::logger> m_logger;
+        /// The innermost context of the thread before this one was created.
+        ThreadContext* m_previous;
+    };
+
     /// This returns the singleton instance of the Log class, but users never
     /// need to invoke this function. The member functions in this class are
     /// static.
@@ -191,6 +263,11 @@ private:
     static void removeSinkInternal(
             const std::shared_ptr<spdlog::sinks::sink> sink);
 
+    /// The logger that critical(), error(), warn(), info(), debug(), and
+    /// trace() use on the calling thread: that of its innermost
+    /// ThreadContext, or m_default_logger if it has none.
+    static spdlog::logger& getThreadLogger();
+
     /// This is the logger used in log_cout.
     static std::shared_ptr<spdlog::logger> m_cout_logger;
 
@@ -203,6 +280,35 @@ private:
     static std::shared_ptr<spdlog::sinks::basic_file_sink_mt> m_filesink;
 };
 
+/// Logs the progress of a loop over a known number of frames at most once
+/// every `interval` seconds, so that loops that solve frames at high rates
+/// (e.g., IMU data sampled at 1 kHz) do not spend their time logging. Each
+/// message, logged at the Info level, reports the number of frames done and
+/// the rate at which they were solved:
+/// @code
+/// ProgressLogger progress("Solved", numFrames);
+/// for (int i = 0; i < numFrames; ++i) {
+///     solveFrame(i);
+///     progress.update(i + 1);
+/// }
+/// @endcode
+/// logs messages like "Solved 1520/6000 frames (25%), 1519.8 frames/s.". The
+/// message for the last frame is always logged.
+class OSIMCOMMON_API ProgressLogger {
+public:
+    ProgressLogger(std::string description, int numFrames,
+            double interval = 1.0);
+    /// Report that `numFramesDone` frames are done.
+    void update(int numFramesDone);
+private:
+    using Clock = std::chrono::steady_clock;
+    std::string m_description;
+    int m_numFrames;
+    Clock::duration m_interval;
+    Clock::time_point m_start;
+    Clock::time_point m_nextMessage;
+};
+
 /// @name Logging functions
 /// @{
 
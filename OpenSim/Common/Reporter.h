@@ -202,6 +202,14 @@ public:
         }
     }
 
+    /** Reserve memory for the given number of rows in the report. This is a
+    hint that avoids reallocation during a simulation whose number of reported
+    time points is known in advance (e.g., when reporting at a fixed interval).
+    See DataTable_::reserveRows().                                            */
+    void reserveRows(size_t numRows) {
+        _outputTable.reserveRows(numRows);
+    }
+
 protected:
     void implementReport(const SimTK::State& state) const override {
         const auto& input = this->template getInput<InputT>("inputs");
@@ -0,0 +1,107 @@
+#ifndef OPENSIM_SPSC_RING_BUFFER_H_
+#define OPENSIM_SPSC_RING_BUFFER_H_
+/* -------------------------------------------------------------------------- *
+ *                         OpenSim:  SPSCRingBuffer.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Exception.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace OpenSim {
+
+/** A fixed-capacity, lock-free queue for passing values from one thread (the
+producer) to another thread (the consumer), such as samples from a sensor
+stream to a thread that processes them. Neither push() nor pop() blocks or
+allocates memory (values are copy-assigned into and out of preallocated
+slots), so the producer is never delayed by the consumer; if the queue is
+full, push() returns false and the caller decides what to do with the value.
+
+At most one thread may call push() and at most one (other) thread may call
+pop() concurrently. size() and empty() may be called from either thread, and
+the result may be out of date as soon as it is returned.
+
+@tparam T a copy-assignable type. For types that own memory (e.g.,
+std::vector), provide a prototype to the constructor so that each slot
+allocates its memory once, up front. */
+template <typename T>
+class SPSCRingBuffer {
+public:
+    /** Create a queue that holds up to `capacity` values, each slot being
+    initialized to a copy of `prototype`. */
+    explicit SPSCRingBuffer(size_t capacity, const T& prototype = T()) :
+            _slots(capacity + 1, prototype) {
+        OPENSIM_THROW_IF(capacity == 0, Exception,
+                "Expected a capacity of at least 1.");
+    }
+    SPSCRingBuffer(const SPSCRingBuffer&) = delete;
+    SPSCRingBuffer& operator=(const SPSCRingBuffer&) = delete;
+
+    size_t capacity() const { return _slots.size() - 1; }
+
+    /** (Producer) Copy `value` to the back of the queue.
+    @returns false, without copying, if the queue is full. */
+    bool push(const T& value) {
+        const size_t tail = _tail.load(std::memory_order_relaxed);
+        const size_t next = increment(tail);
+        if (next == _head.load(std::memory_order_acquire)) return false;
+        _slots[tail] = value;
+        _tail.store(next, std::memory_order_release);
+        return true;
+    }
+
+    /** (Consumer) Copy the value at the front of the queue to `value` and
+    remove it from the queue.
+    @returns false, leaving `value` unchanged, if the queue is empty. */
+    bool pop(T& value) {
+        const size_t head = _head.load(std::memory_order_relaxed);
+        if (head == _tail.load(std::memory_order_acquire)) return false;
+        value = _slots[head];
+        _head.store(increment(head), std::memory_order_release);
+        return true;
+    }
+
+    size_t size() const {
+        const size_t head = _head.load(std::memory_order_acquire);
+        const size_t tail = _tail.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + _slots.size() - head;
+    }
+    bool empty() const { return size() == 0; }
+
+private:
+    size_t increment(size_t index) const {
+        return index + 1 == _slots.size() ? 0 : index + 1;
+    }
+
+    // One slot is always left empty, to distinguish a full queue from an
+    // empty one.
+    std::vector<T> _slots;
+    // Index of the next value to pop; written only by the consumer.
+    std::atomic<size_t> _head{0};
+    // Index of the next slot to push to; written only by the producer.
+    std::atomic<size_t> _tail{0};
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_SPSC_RING_BUFFER_H_
@@ -24,6 +24,9 @@
 // INCLUDES
 //=============================================================================
 #include "SmoothSegmentedFunction.h"
+#include "Logger.h"
+#include <algorithm>
+#include <cmath>
 #include <fstream>
 #include "simmath/internal/SplineFitter.h"
 
@@ -39,6 +42,12 @@ static double UTOL = (double)SimTK::Eps*1e2;
 static double INTTOL = (double)SimTK::Eps*1e2;
 static int MAXITER = 20;
 static int NUM_SAMPLE_PTS = 100;
+//Number of points per Bezier section used to find the scale of the value
+//and derivatives of a curve when it is compiled
+static int NUM_COMPILE_SCALE_PTS = 20;
+//Maximum number of times an interval of a compiled curve is bisected
+static int MAX_COMPILE_DEPTH = 14;
+static double defaultCompileTolerance = 0;
 //=============================================================================
 // UTILITY FUNCTIONS
 //=============================================================================
@@ -161,6 +170,12 @@ _x0(x0),_x1(x1),_y0(y0),_y1(y1),_dydx0(dydx0),_dydx1(dydx1),
         _mXVec[s] = mX(s); 
         _mYVec[s] = mY(s); 
     }
+
+    if(defaultCompileTolerance > 0 && !compile(defaultCompileTolerance)){
+        log_debug("SmoothSegmentedFunction: could not compile '{}' to a "
+                  "tolerance of {}; it is evaluated from its Bezier sections.",
+                  _name, defaultCompileTolerance);
+    }
 }
 
  SmoothSegmentedFunction::SmoothSegmentedFunction():
@@ -202,6 +217,7 @@ double SmoothSegmentedFunction::calcValue(double x) const
     double yVal = 0;
     if(x >= _x0 && x <= _x1 )
     {
+        if(!_compiledX.empty()) return calcCompiledDerivative(x,0);
         int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
         double u = SegmentedQuinticBezierToolkit::
                  calcU(x,_mXVec[idx], _arraySplineUX[idx], UTOL,MAXITER);
@@ -270,6 +286,8 @@ double SmoothSegmentedFunction::calcDerivative(double x, int order) const
                 yVal = calcValue(x);
     }else{
             if(x >= _x0 && x <= _x1){        
+                if(!_compiledX.empty() && order <= 2)
+                    return calcCompiledDerivative(x,order);
                 int idx  = SegmentedQuinticBezierToolkit::calcIndex(x,_mXVec);
                 double u = SegmentedQuinticBezierToolkit::
                                 calcU(x,_mXVec[idx], _arraySplineUX[idx], 
@@ -431,6 +449,239 @@ SimTK::Vec2 SmoothSegmentedFunction::getCurveDomain() const
     return xrange;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Compiled curve
+///////////////////////////////////////////////////////////////////////////////
+
+namespace {
+//The point of a Bezier section at u, with the value and first two
+//derivatives of y(x) there.
+struct CompileNode {
+    double u, x, y, dydx, d2ydx2;
+};
+}
+
+static CompileNode calcCompileNode(double u, const SimTK::Vector& bezierPtsX,
+                                   const SimTK::Vector& bezierPtsY)
+{
+    CompileNode node;
+    node.u = u;
+    node.x = SegmentedQuinticBezierToolkit::
+                calcQuinticBezierCurveVal(u,bezierPtsX);
+    node.y = SegmentedQuinticBezierToolkit::
+                calcQuinticBezierCurveVal(u,bezierPtsY);
+    node.dydx = SegmentedQuinticBezierToolkit::
+                calcQuinticBezierCurveDerivDYDX(u,bezierPtsX,bezierPtsY,1);
+    node.d2ydx2 = SegmentedQuinticBezierToolkit::
+                calcQuinticBezierCurveDerivDYDX(u,bezierPtsX,bezierPtsY,2);
+    return node;
+}
+
+static bool isCompileNodeFinite(const CompileNode& node)
+{
+    return SimTK::isFinite(node.x) && SimTK::isFinite(node.y)
+        && SimTK::isFinite(node.dydx) && SimTK::isFinite(node.d2ydx2);
+}
+
+//The coefficients c0,...,c5 (and 1/h) of the quintic in t=(x-a.x)/h, with
+//h=b.x-a.x, that matches the value and the first two derivatives of the
+//curve at a and b.
+static void calcCompiledCoefficients(const CompileNode& a,
+                                     const CompileNode& b, double* c)
+{
+    const double h = b.x - a.x;
+    c[0] = a.y;
+    c[1] = h*a.dydx;
+    c[2] = 0.5*h*h*a.d2ydx2;
+    const double A = b.y - c[0] - c[1] - c[2];
+    const double B = h*b.dydx - c[1] - 2*c[2];
+    const double C = h*h*b.d2ydx2 - 2*c[2];
+    c[3] =  10*A - 4*B + 0.5*C;
+    c[4] = -15*A + 7*B -     C;
+    c[5] =   6*A - 3*B + 0.5*C;
+    c[6] = 1/h;
+}
+
+static double calcCompiledPolynomial(const double* c, double t, int order)
+{
+    switch(order){
+    case 0:
+        return ((((c[5]*t + c[4])*t + c[3])*t + c[2])*t + c[1])*t + c[0];
+    case 1:
+        return ((((5*c[5]*t + 4*c[4])*t + 3*c[3])*t + 2*c[2])*t + c[1])*c[6];
+    default:
+        return (((20*c[5]*t + 12*c[4])*t + 6*c[3])*t + 2*c[2])*c[6]*c[6];
+    }
+}
+
+bool SmoothSegmentedFunction::compile(double tolerance)
+{
+    SimTK_ERRCHK2_ALWAYS( tolerance > 0,
+        "SmoothSegmentedFunction::compile",
+        "%s: tolerance must be positive, but it is %f",
+        _name.c_str(), tolerance);
+    clearCompiled();
+    if(_numBezierSections < 1) return false;
+
+    //The scale of the value and derivatives over the curve, to which the
+    //errors are relative.
+    double scale[3] = {1, 1, 1};
+    for(int s=0; s < _numBezierSections; s++){
+        for(int i=0; i <= NUM_COMPILE_SCALE_PTS; i++){
+            CompileNode node = calcCompileNode(
+                    (double)i/NUM_COMPILE_SCALE_PTS, _mXVec[s], _mYVec[s]);
+            if(!isCompileNodeFinite(node)) return false;
+            scale[0] = std::max(scale[0], std::abs(node.y));
+            scale[1] = std::max(scale[1], std::abs(node.dydx));
+            scale[2] = std::max(scale[2], std::abs(node.d2ydx2));
+        }
+    }
+
+    std::vector<double> breaks;
+    std::vector<double> coefs;
+    double maxError = 0;
+    double c[7];
+    for(int s=0; s < _numBezierSections; s++){
+        //Fit intervals from left to right. pending holds the right ends
+        //(and their depths) of the intervals still to be fit, the next one
+        //last.
+        CompileNode a = calcCompileNode(0, _mXVec[s], _mYVec[s]);
+        std::vector<std::pair<CompileNode,int> > pending;
+        pending.push_back(std::make_pair(
+                calcCompileNode(1, _mXVec[s], _mYVec[s]), 0));
+        if(s == 0) breaks.push_back(a.x);
+        while(!pending.empty()){
+            const CompileNode b = pending.back().first;
+            const int depth = pending.back().second;
+            if(!(b.x > a.x) || !isCompileNodeFinite(b)) return false;
+
+            calcCompiledCoefficients(a, b, c);
+            double error = 0;
+            for(double f : {0.25, 0.5, 0.75}){
+                CompileNode m = calcCompileNode(a.u + f*(b.u-a.u),
+                                                _mXVec[s], _mYVec[s]);
+                const double t = (m.x - a.x)*c[6];
+                error = std::max(error,
+                    std::abs(calcCompiledPolynomial(c,t,0) - m.y)/scale[0]);
+                error = std::max(error,
+                    std::abs(calcCompiledPolynomial(c,t,1) - m.dydx)/scale[1]);
+                error = std::max(error,
+                    std::abs(calcCompiledPolynomial(c,t,2) - m.d2ydx2)/scale[2]);
+            }
+            if(!SimTK::isFinite(error)) return false;
+
+            if(error > tolerance){
+                if(depth >= MAX_COMPILE_DEPTH) return false;
+                //Bisect: fit [a, mid] next, then [mid, b].
+                pending.back().second = depth+1;
+                pending.push_back(std::make_pair(
+                    calcCompileNode(0.5*(a.u+b.u), _mXVec[s], _mYVec[s]),
+                    depth+1));
+            }else{
+                maxError = std::max(maxError, error);
+                breaks.push_back(b.x);
+                coefs.insert(coefs.end(), c, c+7);
+                a = b;
+                pending.pop_back();
+            }
+        }
+    }
+
+    //Buckets of equal width, each recording the first interval that
+    //overlaps it.
+    const int numIntervals = (int)breaks.size()-1;
+    std::vector<int> buckets(numIntervals);
+    const double width = (breaks.back() - breaks.front())/numIntervals;
+    int interval = 0;
+    for(int b=0; b < numIntervals; b++){
+        const double bucketStart = breaks.front() + b*width;
+        while(interval+1 < numIntervals && breaks[interval+1] <= bucketStart)
+            interval++;
+        buckets[b] = interval;
+    }
+
+    _compiledX.swap(breaks);
+    _compiledCoefs.swap(coefs);
+    _compiledBuckets.swap(buckets);
+    _compiledInvBucketWidth = 1/width;
+    _compiledError = maxError;
+    return true;
+}
+
+void SmoothSegmentedFunction::clearCompiled()
+{
+    _compiledX.clear();
+    _compiledCoefs.clear();
+    _compiledBuckets.clear();
+    _compiledInvBucketWidth = 0;
+    _compiledError = SimTK::NaN;
+}
+
+bool SmoothSegmentedFunction::isCompiled() const
+{
+    return !_compiledX.empty();
+}
+
+int SmoothSegmentedFunction::getNumCompiledIntervals() const
+{
+    return (int)_compiledBuckets.size();
+}
+
+double SmoothSegmentedFunction::getCompiledError() const
+{
+    return isCompiled() ? _compiledError : SimTK::NaN;
+}
+
+void SmoothSegmentedFunction::setDefaultCompileTolerance(double tolerance)
+{
+    defaultCompileTolerance = tolerance;
+}
+
+double SmoothSegmentedFunction::getDefaultCompileTolerance()
+{
+    return defaultCompileTolerance;
+}
+
+int SmoothSegmentedFunction::findCompiledInterval(double x) const
+{
+    const int numIntervals = (int)_compiledBuckets.size();
+    int b = (int)((x - _compiledX[0])*_compiledInvBucketWidth);
+    if(b < 0) b = 0;
+    if(b >= numIntervals) b = numIntervals-1;
+    int interval = _compiledBuckets[b];
+    while(interval+1 < numIntervals && x >= _compiledX[interval+1])
+        interval++;
+    return interval;
+}
+
+double SmoothSegmentedFunction::calcCompiledDerivative(double x,
+                                                       int order) const
+{
+    const int interval = findCompiledInterval(x);
+    const double* c = &_compiledCoefs[7*interval];
+    return calcCompiledPolynomial(c, (x - _compiledX[interval])*c[6], order);
+}
+
+void SmoothSegmentedFunction::calcValues(const double* x, double* y,
+                                         int n) const
+{
+    calcDerivatives(x, y, n, 0);
+}
+
+void SmoothSegmentedFunction::calcDerivatives(const double* x, double* y,
+                                              int n, int order) const
+{
+    if(_compiledX.empty() || order > 2){
+        for(int i=0; i < n; i++) y[i] = calcDerivative(x[i], order);
+        return;
+    }
+    for(int i=0; i < n; i++){
+        const double xi = x[i];
+        if(xi >= _x0 && xi <= _x1) y[i] = calcCompiledDerivative(xi, order);
+        else                       y[i] = calcDerivative(xi, order);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // Utility functions
 ///////////////////////////////////////////////////////////////////////////////
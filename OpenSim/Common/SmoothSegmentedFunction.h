@@ -24,6 +24,7 @@
  * -------------------------------------------------------------------------- */
 #include "osimCommonDLL.h"
 #include "SegmentedQuinticBezierToolkit.h"
+#include <vector>
 
 namespace OpenSim { 
 
@@ -132,6 +133,82 @@ namespace OpenSim {
        using Function_<double>::calcDerivative;
 #endif
 
+       /**Compiles this curve into a piecewise quintic polynomial in x, so
+       that calcValue() and calcDerivative() (up to the second derivative)
+       look up an interval in a table and evaluate a polynomial, instead of
+       searching for the Bezier section that contains x and solving x(u)=x
+       for u with Newton's method.
+
+       The polynomial of each interval matches the value and the first two
+       derivatives of the Bezier curve at both ends of the interval, so the
+       compiled curve is also C2 continuous. The intervals are bisected (in
+       u) until the value and the first two derivatives of each interval's
+       polynomial, at points between its ends, differ from those of the
+       Bezier curve by no more than the tolerance. The error of each is
+       relative to the largest magnitude of the value (or derivative) over
+       the curve, or 1, whichever is larger.
+
+       @param tolerance The largest relative error allowed.
+       @returns true if the curve was compiled. If the tolerance cannot be
+                met (e.g., because it approaches the precision to which the
+                derivatives of a steep Bezier section can be computed), false
+                is returned and the curve continues to be evaluated from its
+                Bezier sections.
+
+       Derivatives above the second order, the integral, and the linear
+       extrapolation outside of the curve domain are not affected.
+
+       <B>Computational Costs</B>
+       \verbatim
+            x in curve domain  : ~25 flops
+       \endverbatim
+       */
+       bool compile(double tolerance = 1e-8);
+
+       /**Discards the compiled polynomial (see compile()), so that the curve
+       is evaluated from its Bezier sections.*/
+       void clearCompiled();
+
+       /**@returns true if the curve is evaluated from a compiled polynomial
+       (see compile()).*/
+       bool isCompiled() const;
+
+       /**@returns the number of polynomial intervals of the compiled curve,
+       or 0 if the curve is not compiled.*/
+       int getNumCompiledIntervals() const;
+
+       /**@returns the largest relative error of the compiled polynomial that
+       was found by compile() (see compile() for how the error is measured),
+       or NaN if the curve is not compiled.*/
+       double getCompiledError() const;
+
+       /**Curves created by SmoothSegmentedFunctionFactory (and therefore the
+       muscle curves, e.g., ActiveForceLengthCurve) after this call are
+       compiled (see compile()) with the given tolerance. A tolerance of 0
+       or less (the default) leaves new curves uncompiled. Set this before
+       creating or loading models; it is not synchronized across threads.*/
+       static void setDefaultCompileTolerance(double tolerance);
+       static double getDefaultCompileTolerance();
+
+#ifndef SWIG
+       /**Calculates the value of the curve at each of n domain points.
+       This is equivalent to calling calcValue() for each point, but avoids
+       the per-call overhead when a curve is evaluated at many points (e.g.,
+       for many muscles or time frames).
+
+       @param x The n domain points of interest.
+       @param y The n values of the curve.
+       @param n The number of points.
+       */
+       void calcValues(const double* x, double* y, int n) const;
+
+       /**Calculates a derivative of the curve at each of n domain points,
+       as calcDerivative(double x, int order) does for one point. An order
+       of 0 calculates the value of the curve.*/
+       void calcDerivatives(const double* x, double* y, int n,
+                            int order) const;
+#endif
+
 
        /**This will return the value of the integral of this objects curve 
        evaluated at x. 
@@ -344,6 +421,29 @@ namespace OpenSim {
         bool _intx0x1;
         /**The name of the function**/
         std::string _name;
+
+        /**The breakpoints, in x, of the intervals of the compiled curve (one
+        more than the number of intervals). Empty if the curve is not
+        compiled.*/
+        std::vector<double> _compiledX;
+        /**For each interval of the compiled curve, the coefficients
+        c0,...,c5 of its polynomial in t = (x-x_i)/h_i, where x_i is the
+        start of the interval and h_i its width, followed by 1/h_i.*/
+        std::vector<double> _compiledCoefs;
+        /**The first interval that overlaps each of a set of buckets of equal
+        width spanning the compiled curve, used to find the interval
+        containing x with few comparisons.*/
+        std::vector<int> _compiledBuckets;
+        /**The reciprocal of the width of the buckets.*/
+        double _compiledInvBucketWidth = 0;
+        /**The largest relative error found by compile().*/
+        double _compiledError = SimTK::NaN;
+
+        /**Returns the index of the compiled interval containing x.*/
+        int findCompiledInterval(double x) const;
+        /**Evaluates the compiled polynomial (order <= 2) at x, which must
+        be in the curve domain.*/
+        double calcCompiledDerivative(double x, int order) const;
             
         /**No human should be constructing a SmoothSegmentedFunction, so the
         constructor is made private so that mere mortals cannot look at it. 
@@ -0,0 +1,185 @@
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  StateVariableLayout.cpp                      *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "StateVariableLayout.h"
+
+using namespace OpenSim;
+
+StateVariableLayout::StateVariableLayout(const Component& component,
+        const SimTK::State& state) :
+        _nq(state.getNQ()), _nu(state.getNU()), _nz(state.getNZ()) {
+    const Array<std::string> names = component.getStateVariableNames();
+    const int nsv = names.size();
+    _names.reserve(nsv);
+    _variables.reserve(nsv);
+    _indexByName.reserve(nsv);
+    const int uStart = state.getUStart();
+    const int zStart = state.getZStart();
+    for (int i = 0; i < nsv; ++i) {
+        const Component::StateVariable* sv =
+                component.traverseToStateVariable(names[i]);
+        OPENSIM_THROW_IF(!sv, Exception,
+                "Could not find state variable '{}'.", names[i]);
+
+        Variable var;
+        var.stateVariable = sv;
+        var.yIndex = sv->findSystemYIndex(state);
+        var.index = -1;
+        var.location = Location::Other;
+        if (var.yIndex.isValid()) {
+            if ((int)var.yIndex < uStart) {
+                var.location = Location::Q;
+                var.index = (int)var.yIndex;
+            } else if ((int)var.yIndex < zStart) {
+                var.location = Location::U;
+                var.index = (int)var.yIndex - uStart;
+                _hasU = true;
+            } else {
+                var.location = Location::Z;
+                var.index = (int)var.yIndex - zStart;
+                _hasZ = true;
+            }
+        }
+        _names.push_back(names[i]);
+        _variables.push_back(var);
+        _indexByName[names[i]] = i;
+    }
+}
+
+int StateVariableLayout::findIndex(const std::string& name) const {
+    auto it = _indexByName.find(name);
+    return it == _indexByName.end() ? -1 : it->second;
+}
+
+std::vector<int> StateVariableLayout::getIndices(
+        const std::vector<std::string>& names) const {
+    std::vector<int> indices;
+    indices.reserve(names.size());
+    for (const auto& name : names) {
+        const int index = findIndex(name);
+        OPENSIM_THROW_IF(index < 0, Exception,
+                "Could not find state variable '{}'.", name);
+        indices.push_back(index);
+    }
+    return indices;
+}
+
+bool StateVariableLayout::isCompatible(const SimTK::State& state) const {
+    return state.getNQ() == _nq && state.getNU() == _nu &&
+           state.getNZ() == _nz;
+}
+
+void StateVariableLayout::checkCompatible(const SimTK::State& state) const {
+    OPENSIM_THROW_IF(!isCompatible(state), Exception,
+            "Expected a state with {} generalized coordinates, {} generalized "
+            "speeds, and {} auxiliary state variables, but the state has {}, "
+            "{}, and {}, respectively.",
+            _nq, _nu, _nz, state.getNQ(), state.getNU(), state.getNZ());
+}
+
+SimTK::Vector StateVariableLayout::getValues(
+        const SimTK::State& state) const {
+    SimTK::Vector values;
+    getValues(state, values);
+    return values;
+}
+
+void StateVariableLayout::getValues(const SimTK::State& state,
+        SimTK::Vector& values) const {
+    checkCompatible(state);
+    const int nsv = getNumStateVariables();
+    values.resize(nsv);
+    const SimTK::Vector& y = state.getY();
+    for (int i = 0; i < nsv; ++i) {
+        const Variable& var = _variables[i];
+        values[i] = var.yIndex.isValid() ? y[var.yIndex]
+                                         : var.stateVariable->getValue(state);
+    }
+}
+
+void StateVariableLayout::setValues(SimTK::State& state,
+        const SimTK::Vector& values) const {
+    OPENSIM_THROW_IF(values.size() != getNumStateVariables(), Exception,
+            "Expected {} values, but got {}.", getNumStateVariables(),
+            values.size());
+    checkCompatible(state);
+    // Obtain write access to U and Z once (which invalidates the dependent
+    // stages), rather than once per state variable.
+    SimTK::Vector* u = _hasU ? &state.updU() : nullptr;
+    SimTK::Vector* z = _hasZ ? &state.updZ() : nullptr;
+    for (int i = 0; i < getNumStateVariables(); ++i) {
+        const Variable& var = _variables[i];
+        switch (var.location) {
+        case Location::U: (*u)[var.index] = values[i]; break;
+        case Location::Z: (*z)[var.index] = values[i]; break;
+        default: var.stateVariable->setValue(state, values[i]);
+        }
+    }
+}
+
+SimTK::Vector StateVariableLayout::getValues(const SimTK::State& state,
+        const std::vector<int>& indices) const {
+    checkCompatible(state);
+    const int n = (int)indices.size();
+    SimTK::Vector values(n);
+    const SimTK::Vector& y = state.getY();
+    for (int i = 0; i < n; ++i) {
+        const Variable& var = _variables.at(indices[i]);
+        values[i] = var.yIndex.isValid() ? y[var.yIndex]
+                                         : var.stateVariable->getValue(state);
+    }
+    return values;
+}
+
+void StateVariableLayout::setValues(SimTK::State& state,
+        const std::vector<int>& indices, const SimTK::Vector& values) const {
+    OPENSIM_THROW_IF(values.size() != (int)indices.size(), Exception,
+            "Expected {} values, but got {}.", indices.size(), values.size());
+    checkCompatible(state);
+    for (int i = 0; i < (int)indices.size(); ++i) {
+        const Variable& var = _variables.at(indices[i]);
+        switch (var.location) {
+        case Location::U: state.updU()[var.index] = values[i]; break;
+        case Location::Z: state.updZ()[var.index] = values[i]; break;
+        default: var.stateVariable->setValue(state, values[i]);
+        }
+    }
+}
+
+double StateVariableLayout::getValue(const SimTK::State& state,
+        int index) const {
+    checkCompatible(state);
+    const Variable& var = _variables.at(index);
+    return var.yIndex.isValid() ? state.getY()[var.yIndex]
+                                : var.stateVariable->getValue(state);
+}
+
+void StateVariableLayout::setValue(SimTK::State& state, int index,
+        double value) const {
+    checkCompatible(state);
+    const Variable& var = _variables.at(index);
+    switch (var.location) {
+    case Location::U: state.updU()[var.index] = value; break;
+    case Location::Z: state.updZ()[var.index] = value; break;
+    default: var.stateVariable->setValue(state, value);
+    }
+}
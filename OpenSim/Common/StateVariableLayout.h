@@ -0,0 +1,164 @@
+#ifndef OPENSIM_STATE_VARIABLE_LAYOUT_H_
+#define OPENSIM_STATE_VARIABLE_LAYOUT_H_
+/* -------------------------------------------------------------------------- *
+ *                      OpenSim:  StateVariableLayout.h                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Component.h"
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace OpenSim {
+
+/** The names and locations of all continuous state variables of a Component
+(including those of its subcomponents), for reading and writing many state
+variables at once without looking them up by name.
+
+Obtain the layout of a Component (e.g., a Model) with
+Component::getStateVariableLayout(), which creates it once for each System.
+Component::getStateVariableValues() and
+Component::setStateVariableValues() use this layout, so code that reads or
+writes all of the state variables (e.g., Manager when recording states)
+already benefits from it. Use the layout directly to access a subset of the
+state variables repeatedly: look up the indices of the variables once, then
+pass them to getValues() and setValues() for each state.
+
+@code
+const StateVariableLayout& layout = model.getStateVariableLayout(state);
+std::vector<int> indices = layout.getIndices(
+        {"/jointset/r_shoulder/r_shoulder_elev/value",
+         "/jointset/r_shoulder/r_shoulder_elev/speed"});
+for (const auto& frame : frames) {
+    layout.setValues(state, indices, frame);
+    ...
+}
+@endcode
+
+Most state variables (the generalized coordinates and speeds of
+Coordinates, and the variables added with Component::addStateVariable()) are
+stored directly in the continuous state variables (Y) of a SimTK::State;
+the layout records their index in Y, so they are read and written with a
+single indexed access. Generalized coordinates are written through their
+Coordinate so that locked coordinates keep their value (as with
+Component::setStateVariableValue()). State variables that are not stored
+in Y are accessed through their Component.
+
+A layout is immutable. It remains valid as long as the System of the
+component is not rebuilt (e.g., by Model::initSystem()) and the component
+is not deleted. It can only be used with states whose Y has the same layout as
+the state it was created from; modeling options that change the number of
+generalized coordinates (e.g., using quaternions instead of Euler angles) make
+a state incompatible (see isCompatible()); Component::getStateVariableLayout()
+creates a separate layout for such states.                                   */
+class OSIMCOMMON_API StateVariableLayout {
+public:
+    /** Create the layout of the state variables of `component` (including
+    those of its subcomponents) from `state`, which must be realized to
+    Stage::Model.
+    @throws ComponentHasNoSystem if the component has not been added to a
+            System (i.e., if initSystem has not been called) */
+    StateVariableLayout(const Component& component, const SimTK::State& state);
+
+    /** The number of state variables. */
+    int getNumStateVariables() const { return (int)_names.size(); }
+
+    /** The names (paths) of the state variables, in the order returned by
+    Component::getStateVariableNames(). */
+    const std::vector<std::string>& getNames() const { return _names; }
+
+    /** The index of the state variable with the given name (as returned by
+    getNames()), or -1 if there is no such state variable. */
+    int findIndex(const std::string& name) const;
+
+    /** The indices of the state variables with the given names.
+    @throws Exception if there is no state variable with one of the names */
+    std::vector<int> getIndices(const std::vector<std::string>& names) const;
+
+    /** The index in the continuous state variables (Y) of a SimTK::State of
+    the state variable with index `index`, which is invalid if the state
+    variable is not stored in Y. */
+    SimTK::SystemYIndex getSystemYIndex(int index) const {
+        return _variables[index].yIndex;
+    }
+
+    /** Whether the continuous state variables of `state` have the same
+    layout as those of the state this layout was created from. */
+    bool isCompatible(const SimTK::State& state) const;
+
+    /** @name Read and write all of the state variables
+    The values are in the order of getNames().
+    @{ */
+    SimTK::Vector getValues(const SimTK::State& state) const;
+    /** This variant reuses the memory of `values` if it already has the
+    correct size. */
+    void getValues(const SimTK::State& state, SimTK::Vector& values) const;
+    void setValues(SimTK::State& state, const SimTK::Vector& values) const;
+    /** @} */
+
+    /** @name Read and write a subset of the state variables
+    `indices` are indices into getNames() (see getIndices()), and
+    `values` has one entry for each index, in the same order.
+    @{ */
+    SimTK::Vector getValues(const SimTK::State& state,
+            const std::vector<int>& indices) const;
+    void setValues(SimTK::State& state, const std::vector<int>& indices,
+            const SimTK::Vector& values) const;
+    /** @} */
+
+    /** @name Read and write one state variable
+    @{ */
+    double getValue(const SimTK::State& state, int index) const;
+    void setValue(SimTK::State& state, int index, double value) const;
+    /** @} */
+
+private:
+    // Where a state variable is stored in the State.
+    enum class Location { Q, U, Z, Other };
+
+    struct Variable {
+        Location location;
+        // Index into Y (invalid for Location::Other).
+        SimTK::SystemYIndex yIndex;
+        // Index into Q, U, or Z (according to location).
+        int index;
+        const Component::StateVariable* stateVariable;
+    };
+
+    void checkCompatible(const SimTK::State& state) const;
+
+    std::vector<std::string> _names;
+    std::vector<Variable> _variables;
+    std::unordered_map<std::string, int> _indexByName;
+
+    // The layout of Y in the state this layout was created from.
+    int _nq;
+    int _nu;
+    int _nz;
+    // Whether any state variable is stored in U or Z, respectively.
+    bool _hasU = false;
+    bool _hasZ = false;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_STATE_VARIABLE_LAYOUT_H_
@@ -46,6 +46,15 @@
 using namespace OpenSim;
 using namespace std;
 
+// Whether the file is written in the binary format of BinaryFileAdapter.
+static bool isBinaryFileName(const std::string& fileName)
+{
+    const std::string ext = ".stob";
+    const std::string lower = SimTK::String::toLower(fileName);
+    return lower.size() >= ext.size() &&
+           lower.compare(lower.size() - ext.size(), ext.size(), ext) == 0;
+}
+
 void convertTableToStorage(const AbstractDataTable* table, Storage& sto)
 {
     sto.purge();
@@ -94,6 +103,7 @@ void convertTableToStorage(const AbstractDataTable* table, Storage& sto)
     sto.setColumnLabels(labels);
 
     const auto& times = out.getIndependentColumn();
+    sto.ensureCapacity((int)out.getNumRows());
     for (unsigned i_time = 0; i_time < out.getNumRows(); ++i_time) {
         const SimTK::Vector rowVector =
             out.getRowAtIndex(i_time).transpose().getAsVector();
@@ -185,7 +195,10 @@ Storage::Storage(const string &fileName, bool readHeadersOnly) :
             "'. Verify that the file exists at the specified location." );
 
     bool isMotFile = SimTK::String::toLower(fileName).rfind(".mot") != string::npos;
-    bool isStoFile = SimTK::String::toLower(fileName).rfind(".sto") != string::npos;
+    // Binary (.stob) files are read only by the BinaryFileAdapter.
+    bool isStobFile = isBinaryFileName(fileName);
+    bool isStoFile = !isStobFile &&
+            SimTK::String::toLower(fileName).rfind(".sto") != string::npos;
     bool useFileAdpater = true;
 
     int nr = 0, nc = 0;
@@ -217,6 +230,18 @@ Storage::Storage(const string &fileName, bool readHeadersOnly) :
                         tables.begin()->first);
             }
             convertTableToStorage(tables.begin()->second.get(), *this);
+            if (isStobFile) {
+                // Restore the properties that Storage::print() recorded in
+                // the metadata.
+                const auto& table = *tables.begin()->second;
+                const auto& metadata = table.getTableMetaData();
+                if (metadata.hasKey("header"))
+                    setName(metadata.getValueAsString("header"));
+                if (metadata.hasKey("inDegrees"))
+                    _inDegrees = metadata.getValueAsString("inDegrees") == "yes";
+                if (metadata.hasKey("description"))
+                    setDescription(metadata.getValueAsString("description"));
+            }
             return;
         }
         catch (const std::exception& x) {
@@ -651,6 +676,20 @@ setCapacityIncrement(int aIncrement)
     _storage.setCapacityIncrement(aIncrement);
 }
 //_____________________________________________________________________________
+/**
+ * Ensure that this storage can hold at least aCapacity state vectors without
+ * reallocating. Growing the storage copies every state vector it holds, so
+ * reserving the capacity up front is much faster when the number of state
+ * vectors to be appended is known.
+ *
+ * @param aCapacity Desired capacity.
+ */
+void Storage::
+ensureCapacity(int aCapacity)
+{
+    _storage.ensureCapacity(aCapacity);
+}
+//_____________________________________________________________________________
 /**
  * Get the capacity increment of this storage object.
  *
@@ -1022,6 +1061,14 @@ getData(int aTimeIndex,int aN,Array<double> &rData) const
 int Storage::
 getData(int aTimeIndex,int aN,SimTK::Vector& v) const
 {
+    if(aN<=0) return(0);
+    if(v.hasContiguousData()) {
+        // Copy straight into v rather than through a temporary.
+        int r = getData(aTimeIndex,0,aN,&v[0]);
+        for (int i=r; i<aN; ++i)
+            v[i] = 0;
+        return r;
+    }
     Array<double> rData;
     rData.setSize(aN);
     int r = getData(aTimeIndex,0,aN,&rData[0]);
@@ -1132,6 +1179,15 @@ getDataAtTime(double aT,int aN,Array<double> &rData) const
 int Storage::
 getDataAtTime(double aT,int aN,SimTK::Vector& v) const
 {
+    if(aN<=0) return(0);
+    if(v.hasContiguousData()) {
+        // Interpolate straight into v rather than through a temporary.
+        double *data=&v[0];
+        int r = getDataAtTime(aT,aN,&data);
+        for (int i=r; i<aN; ++i)
+            v[i] = 0;
+        return r;
+    }
     Array<double> rData;
     rData.setSize(aN);
     int r = getDataAtTime(aT,aN,rData);
@@ -2475,10 +2531,16 @@ lowpassFIR(int aOrder,double aCutoffFrequency)
  * Find the index of the storage element that occurred immediately before
  * or at time aT ( aT <= getTime(index) ).
  *
- * This method can be much more efficient than findIndex(aT) if a good guess
- * is made for aI.
- * If aI corresponds to a state which occurred later than aT, an exhaustive
- * search is performed by calling findIndex(aT).
+ * The search starts at aI, so it is much more efficient than a search from
+ * the beginning when a good guess is made for aI. In particular, when aT
+ * increases monotonically from one call to the next (as it does when
+ * getDataAtTime() is called during an analysis), the answer is at or just
+ * after the previous one, and is found with a few comparisons. Otherwise,
+ * the search gallops forward from aI (or, if aI corresponds to a state that
+ * occurred later than aT, bisects the states before aI), so the cost is
+ * logarithmic in the distance from aI rather than linear in the size of the
+ * storage. As for the linear search this replaces, the times of the stored
+ * states are assumed to be nondecreasing.
  *
  * @param aI Index at which to start searching.
  * @param aT Time.
@@ -2489,18 +2551,34 @@ int Storage::
 findIndex(int aI,double aT) const
 {
     // MAKE SURE aI IS VALID
-    if(_storage.getSize()<=0) return(-1);
-    if((aI>=_storage.getSize())||(aI<0)) aI=0;
-    if(getStateVector(aI)->getTime()>aT) aI=0;
+    const int size = _storage.getSize();
+    if(size<=0) return(-1);
+    if((aI>=size)||(aI<0)) aI=0;
+
+    // BRACKET aT: time(lo) <= aT < time(hi), where lo=-1 and hi=size stand
+    // for times before the first and after the last state.
+    int lo, hi;
+    if(_storage[aI].getTime()>aT) {
+        lo = -1;
+        hi = aI;
+    } else {
+        lo = aI;
+        hi = aI+1;
+        int step = 1;
+        while(hi<size && _storage[hi].getTime()<=aT) {
+            lo = hi;
+            step *= 2;
+            hi = (size-lo>step) ? lo+step : size;
+        }
+    }
 
-    // SEARCH
-    //cout << "Storage.findIndex: starting at " << aI << endl;
-    int i;
-    for(i=aI;i<_storage.getSize();i++) {
-        if(aT<getStateVector(i)->getTime()) break;
+    // BISECT
+    while(hi-lo>1) {
+        int mid = lo + (hi-lo)/2;
+        if(_storage[mid].getTime()<=aT) lo = mid;
+        else hi = mid;
     }
-    _lastI = i-1;
-    if(_lastI<0) _lastI=0;
+    _lastI = (lo<0) ? 0 : lo;
     return(_lastI);
 }
 //_____________________________________________________________________________
@@ -2508,8 +2586,8 @@ findIndex(int aI,double aT) const
  * Find the index of the storage element that occurred immediately before
  * or at a specified time ( getTime(index) <= aT ).
  *
- * This method is not very efficient because it always starts its search
- * with the first stored state.
+ * The search starts with the first stored state; see findIndex(int,double)
+ * to start the search from a guess.
  *
  * @param aT Time.
  * @return Index preceding or at time aT.  If aT is less than the earliest
@@ -2518,14 +2596,7 @@ findIndex(int aI,double aT) const
 int Storage::
 findIndex(double aT) const
 {
-    if(_storage.getSize()<=0) return(-1);
-    int i;
-    for(i=0;i<_storage.getSize();i++) {
-        if(aT<getStateVector(i)->getTime()) break;
-    }
-    _lastI = i-1;
-    if(_lastI<0) _lastI=0;
-    return(_lastI);
+    return findIndex(0,aT);
 }
 //_____________________________________________________________________________
 /**
@@ -2707,6 +2778,24 @@ setOutputFileName(const std::string& aFileName)
 bool Storage::
 print(const string &aFileName,const string &aMode, const string& aComment) const
 {
+    // BINARY FILES
+    if(isBinaryFileName(aFileName)) {
+        if(aMode != "w") {
+            log_error("Storage.print: cannot append to binary file {}.",
+                    aFileName);
+            return(false);
+        }
+        try {
+            const TimeSeriesTable table = exportToTable();
+            FileAdapter::writeFile({{"table", &table}}, aFileName);
+        } catch(const std::exception& x) {
+            log_error("Storage.print: failed to write binary file {}: {}",
+                    aFileName, x.what());
+            return(false);
+        }
+        return(_storage.getSize() != 0);
+    }
+
     // OPEN THE FILE
     FILE *fp = IO::OpenFile(aFileName,aMode);
     if(fp==NULL) return(false);
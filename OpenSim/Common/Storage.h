@@ -58,6 +58,12 @@ typedef std::map<std::string, std::string, std::less<std::string> > MapKeysToVal
  * TimeIndex, and a particular state (or column) is indexed by the
  * StateIndex.
  *
+ * Each row is a separately allocated StateVector, and getStateVector()
+ * and getLastStateVector() hand out pointers to them, so a Storage is not
+ * stored by column and cannot be memory-mapped from a file. For large data
+ * sets, use a TimeSeriesTable instead; BinaryFileAdapter can read single
+ * columns of a .stob file.
+ *
  * @version 1.0
  * @author Frank C. Anderson
  */
@@ -233,6 +239,10 @@ public:
     // CAPACITY INCREMENT
     void setCapacityIncrement(int aIncrement);
     int getCapacityIncrement() const;
+    /** Allocate space for at least `aCapacity` rows, so that appending that
+    many rows does not grow the array of rows. The rows themselves are still
+    allocated one at a time as they are appended. */
+    void ensureCapacity(int aCapacity);
     // IO
     void setWriteSIMMHeader(bool aTrueFalse);
     bool getWriteSIMMHeader() const;
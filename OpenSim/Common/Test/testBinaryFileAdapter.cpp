@@ -0,0 +1,142 @@
+/* -------------------------------------------------------------------------- *
+ *                    OpenSim:  testBinaryFileAdapter.cpp                     *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2017 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "OpenSim/Common/Adapters.h"
+#include "OpenSim/Common/Storage.h"
+#include <fstream>
+#include <iterator>
+
+#define CATCH_CONFIG_MAIN
+#include <OpenSim/Auxiliary/catch.hpp>
+
+using namespace OpenSim;
+
+namespace {
+void compareTables(const TimeSeriesTable& a, const TimeSeriesTable& b) {
+    REQUIRE(a.getNumRows() == b.getNumRows());
+    REQUIRE(a.getNumColumns() == b.getNumColumns());
+    CHECK(a.getColumnLabels() == b.getColumnLabels());
+    CHECK(a.getIndependentColumn() == b.getIndependentColumn());
+    for (size_t icol = 0; icol < a.getNumColumns(); ++icol) {
+        const auto colA = a.getDependentColumnAtIndex(icol);
+        const auto colB = b.getDependentColumnAtIndex(icol);
+        for (int irow = 0; irow < colA.size(); ++irow) {
+            // The binary format stores values exactly.
+            if (SimTK::isNaN(colA[irow]))
+                CHECK(SimTK::isNaN(colB[irow]));
+            else
+                CHECK(colA[irow] == colB[irow]);
+        }
+    }
+}
+} // anonymous namespace
+
+TEST_CASE("BinaryFileAdapter round trip") {
+    TimeSeriesTable table(std::vector<double>{0.0, 0.01, 0.02, 0.03},
+            SimTK::Matrix(4, 3), {"pelvis_tx", "locked", "missing"});
+    for (int i = 0; i < 4; ++i) {
+        table.updMatrix()(i, 0) = SimTK::Pi * (i + 1) / 7.0;
+        table.updMatrix()(i, 1) = 0.25;
+        table.updMatrix()(i, 2) = i % 2 ? SimTK::NaN : -1e-300 * i;
+    }
+    table.addTableMetaData("inDegrees", std::string("no"));
+    table.addTableMetaData("description", std::string("two\nlines"));
+    table.addTableMetaData("sample-rate", 100u); // not a string; not written.
+
+    const std::string filename = "testBinaryFileAdapter.stob";
+    BinaryFileAdapter::write(table, filename);
+
+    SECTION("Reading the table") {
+        TimeSeriesTable copy(filename);
+        compareTables(table, copy);
+        CHECK(copy.getTableMetaDataAsString("inDegrees") == "no");
+        CHECK(copy.getTableMetaDataAsString("description") == "two\nlines");
+        CHECK(!copy.getTableMetaData().hasKey("sample-rate"));
+    }
+
+    SECTION("Reading single columns") {
+        CHECK(BinaryFileAdapter::readColumnLabels(filename) ==
+                table.getColumnLabels());
+        const SimTK::Vector time =
+                BinaryFileAdapter::readColumn(filename, "time");
+        const SimTK::Vector locked =
+                BinaryFileAdapter::readColumn(filename, "locked");
+        REQUIRE(time.size() == 4);
+        REQUIRE(locked.size() == 4);
+        for (int i = 0; i < 4; ++i) {
+            CHECK(time[i] == table.getIndependentColumn()[i]);
+            CHECK(locked[i] == 0.25);
+        }
+        CHECK_THROWS_AS(BinaryFileAdapter::readColumn(filename, "bogus"),
+                KeyMissing);
+    }
+
+    SECTION("Invalid files") {
+        const std::string stofile = "testBinaryFileAdapter.sto";
+        STOFileAdapter::write(table, stofile);
+        CHECK_THROWS_AS(BinaryFileAdapter::readColumnLabels(stofile),
+                InvalidBinaryFile);
+
+        // Truncate the binary file.
+        std::string contents;
+        {
+            std::ifstream in(filename, std::ios::binary);
+            contents.assign(std::istreambuf_iterator<char>(in),
+                    std::istreambuf_iterator<char>());
+        }
+        const std::string truncated = "testBinaryFileAdapter_truncated.stob";
+        {
+            std::ofstream out(truncated, std::ios::binary);
+            out.write(contents.data(), contents.size() - 4);
+        }
+        CHECK_THROWS_AS(TimeSeriesTable(truncated), InvalidBinaryFile);
+    }
+}
+
+TEST_CASE("BinaryFileAdapter and STO files contain the same data") {
+    std::vector<std::string> filenames{};
+    filenames.push_back("std_subject01_walk1_ik.mot");
+    filenames.push_back("gait10dof18musc_subject01_walk_grf.mot");
+    filenames.push_back("subject02_running_arms_ik.mot");
+    for (const auto& filename : filenames) {
+        std::cout << "  " << filename << std::endl;
+        TimeSeriesTable table(filename);
+        FileAdapter::writeFile({{"table", &table}}, "testBinaryFileAdapter.stob");
+        compareTables(table, TimeSeriesTable("testBinaryFileAdapter.stob"));
+    }
+}
+
+TEST_CASE("Storage reads and writes binary files") {
+    Storage sto("std_subject01_walk1_ik.mot");
+    REQUIRE(sto.print("testBinaryFileAdapter_storage.stob"));
+    Storage copy("testBinaryFileAdapter_storage.stob");
+    CHECK(copy.getName() == sto.getName());
+    CHECK(copy.isInDegrees() == sto.isInDegrees());
+    CHECK(copy.getColumnLabels() == sto.getColumnLabels());
+    REQUIRE(copy.getSize() == sto.getSize());
+    for (int i = 0; i < sto.getSize(); ++i) {
+        CHECK(copy.getStateVector(i)->getTime() ==
+                sto.getStateVector(i)->getTime());
+        CHECK(copy.getStateVector(i)->getData() ==
+                sto.getStateVector(i)->getData());
+    }
+}
@@ -26,6 +26,7 @@
 #include <OpenSim/Common/TableSource.h>
 #include <OpenSim/Common/STOFileAdapter.h>
 #include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/Stopwatch.h>
 #include <simbody/internal/SimbodyMatterSubsystem.h>
 #include <simbody/internal/GeneralForceSubsystem.h>
 #include <simbody/internal/Force.h>
@@ -1240,6 +1241,120 @@ void testGetStateVariableValue() {
             OpenSim::Exception);
 }
 
+void testComponentIndex() {
+    // A synthetic model with a few hundred "bodies", each with a "joint" that
+    // has a "coordinate"; every component has a state variable.
+    TheWorld top;
+    top.setName("top");
+    const int numBodies = 300;
+    std::vector<Sub*> bodies, joints, coordinates;
+    std::vector<std::string> paths;
+    for (int i = 0; i < numBodies; ++i) {
+        const std::string suffix = std::to_string(i);
+        bodies.push_back(new Sub());
+        bodies.back()->setName("body" + suffix);
+        joints.push_back(new Sub());
+        joints.back()->setName("joint" + suffix);
+        coordinates.push_back(new Sub());
+        coordinates.back()->setName("coordinate" + suffix);
+        joints.back()->addComponent(coordinates.back());
+        bodies.back()->addComponent(joints.back());
+        top.add(bodies.back());
+        paths.push_back("/body" + suffix + "/joint" + suffix + "/coordinate" +
+                suffix);
+    }
+
+    for (int i = 0; i < numBodies; ++i) {
+        const std::string suffix = std::to_string(i);
+        SimTK_TEST(&top.getComponent<Sub>(paths[i]) == coordinates[i]);
+        SimTK_TEST(&top.getComponent(paths[i].substr(1)) == coordinates[i]);
+        SimTK_TEST(&bodies[i]->getComponent(
+                "joint" + suffix + "/coordinate" + suffix) == coordinates[i]);
+        SimTK_TEST(&coordinates[i]->getComponent("../..") == bodies[i]);
+        SimTK_TEST(&coordinates[i]->getComponent(
+                "../../../body" + suffix) == bodies[i]);
+        SimTK_TEST(&joints[i]->getComponent("/body" + suffix) == bodies[i]);
+        SimTK_TEST(top.findComponent("joint" + suffix) == joints[i]);
+        SimTK_TEST(bodies[i]->findComponent<Sub>("coordinate" + suffix) ==
+                coordinates[i]);
+    }
+    SimTK_TEST(!top.hasComponent("body1/joint2"));
+    SimTK_TEST(!top.hasComponent("/joint1"));
+    SimTK_TEST(!bodies[1]->hasComponent("body1"));
+    SimTK_TEST(bodies[1]->findComponent("joint2") == nullptr);
+    SimTK_TEST_MUST_THROW(top.getComponent("body1/joint1/coordinate2"));
+
+    // Renaming a component (without finalizing) takes effect immediately.
+    joints[3]->setName("renamed");
+    SimTK_TEST(&top.getComponent("/body3/renamed/coordinate3") ==
+            coordinates[3]);
+    SimTK_TEST(!top.hasComponent("/body3/joint3/coordinate3"));
+    SimTK_TEST(top.findComponent("renamed") == joints[3]);
+    SimTK_TEST(top.findComponent("joint3") == nullptr);
+    joints[3]->setName("joint3");
+    SimTK_TEST(&top.getComponent(paths[3]) == coordinates[3]);
+
+    // Adding components updates the index.
+    Sub* extra = new Sub();
+    extra->setName("extra");
+    joints[5]->addComponent(extra);
+    SimTK_TEST(&top.getComponent("/body5/joint5/extra") == extra);
+    SimTK_TEST(top.findComponent("extra") == extra);
+
+    // A copy has its own index.
+    TheWorld copy(top);
+    copy.finalizeFromProperties();
+    const Component& extraInCopy = copy.getComponent("/body5/joint5/extra");
+    SimTK_TEST(&extraInCopy != extra);
+    SimTK_TEST(&extraInCopy.getRoot() == &copy);
+
+    // State variables by path.
+    MultibodySystem system;
+    top.buildUpSystem(system);
+    State s = system.realizeTopology();
+    for (int i = 0; i < numBodies; ++i) {
+        top.setStateVariableValue(s, paths[i] + "/subState", i);
+        SimTK_TEST(coordinates[i]->getStateVariableValue(s, "subState") == i);
+        SimTK_TEST(top.getStateVariableValue(s,
+                        paths[i].substr(1) + "/subState") == i);
+    }
+
+    // Benchmark: resolve the path of every coordinate.
+    const int numRepetitions = 100;
+    Stopwatch watch;
+    for (int r = 0; r < numRepetitions; ++r) {
+        for (const auto& path : paths) top.getComponent(path);
+    }
+    cout << "getComponent() by absolute path: "
+         << 1e-3 * watch.getElapsedTimeInNs() / (numRepetitions * numBodies)
+         << " us per call." << endl;
+    watch.reset();
+    for (int r = 0; r < numRepetitions; ++r) {
+        for (const auto& path : paths) top.getComponent(ComponentPath(path));
+    }
+    cout << "getComponent() by ComponentPath: "
+         << 1e-3 * watch.getElapsedTimeInNs() / (numRepetitions * numBodies)
+         << " us per call." << endl;
+    watch.reset();
+    for (int r = 0; r < numRepetitions; ++r) {
+        for (int i = 0; i < numBodies; ++i) {
+            top.findComponent(coordinates[i]->getName());
+        }
+    }
+    cout << "findComponent() by name: "
+         << 1e-3 * watch.getElapsedTimeInNs() / (numRepetitions * numBodies)
+         << " us per call." << endl;
+    watch.reset();
+    for (int r = 0; r < numRepetitions; ++r) {
+        for (const auto& path : paths) {
+            top.getStateVariableValue(s, path + "/subState");
+        }
+    }
+    cout << "getStateVariableValue() by path: "
+         << 1e-3 * watch.getElapsedTimeInNs() / (numRepetitions * numBodies)
+         << " us per call." << endl;
+}
+
 void testInputOutputConnections()
 {
     {
@@ -2519,6 +2634,7 @@ int main() {
         SimTK_SUBTEST(testFindComponent);
         SimTK_SUBTEST(testTraversePathToComponent);
         SimTK_SUBTEST(testGetStateVariableValue);
+        SimTK_SUBTEST(testComponentIndex);
         SimTK_SUBTEST(testInputOutputConnections);
         SimTK_SUBTEST(testInputConnecteePaths);
         SimTK_SUBTEST(testExceptionsForConnecteeTypeMismatch);
@@ -916,3 +916,78 @@ TEST_CASE("TableUtilities::resample") {
         CHECK(column[5] == Approx(0.0).margin(1e-10));
     }
 }
+
+TEST_CASE("DataTable appendRow capacity") {
+    TimeSeriesTable table;
+    table.setColumnLabels({"a", "b", "c"});
+    table.reserveRows(100);
+
+    // Rows are appended in place: while the reserved rows last, interleaved
+    // appends and reads neither reallocate nor copy the matrix.
+    table.appendRow(0, {0.0, 0.0, 0.0});
+    const double* firstElement = &table.getRowAtIndex(0)[0];
+    for (int i = 1; i < 100; ++i) {
+        table.appendRow(0.01 * i, {1.0 * i, 2.0 * i, 3.0 * i});
+        CHECK(table.getNumRows() == size_t(i + 1));
+        CHECK(table.getRowAtIndex(i)[1] == Approx(2.0 * i));
+        CHECK(&table.getRowAtIndex(0)[0] == firstElement);
+    }
+    CHECK(table.getMatrix().nrow() == 100);
+    CHECK(table.getMatrix().ncol() == 3);
+    for (int i = 0; i < 100; ++i) {
+        CHECK(table.getIndependentColumn()[i] == Approx(0.01 * i));
+        CHECK(table.getMatrix()(i, 0) == Approx(1.0 * i));
+        CHECK(table.getMatrix()(i, 2) == Approx(3.0 * i));
+    }
+
+    // Without a reservation, the matrix grows geometrically, so it is
+    // reallocated a logarithmic number of times.
+    {
+        TimeSeriesTable bigTable;
+        bigTable.setColumnLabels({"a", "b", "c", "d", "e", "f"});
+        const RowVector row(6, 1.0);
+        const double* element = nullptr;
+        int numReallocations = 0;
+        for (int i = 0; i < 100000; ++i) {
+            bigTable.appendRow(i, row);
+            if (&bigTable.getRowAtIndex(0)[0] != element) {
+                element = &bigTable.getRowAtIndex(0)[0];
+                ++numReallocations;
+            }
+        }
+        CHECK(numReallocations <= 40);
+        CHECK(bigTable.getMatrix().nrow() == 100000);
+        CHECK(bigTable.getDependentColumn("f").size() == 100000);
+    }
+
+    // Copies and column accessors do not include the spare rows.
+    table.appendRow(1.0, {-1.0, -2.0, -3.0});
+    TimeSeriesTable copy(table);
+    CHECK(copy.getNumRows() == 101);
+    CHECK(copy.getDependentColumn("c").size() == 101);
+    CHECK(copy.getDependentColumn("c")[100] == Approx(-3));
+    copy.appendColumn("d", copy.getDependentColumn("a"));
+    CHECK(copy.getDependentColumn("d")[100] == Approx(-1));
+    copy.removeRowAtIndex(0);
+    copy.appendRow(1.01, {4.0, 5.0, 6.0, 7.0});
+    CHECK(copy.getMatrix().nrow() == 101);
+    CHECK(copy.getRowAtIndex(100)[3] == Approx(7.0));
+
+    CHECK_THROWS_AS(table.appendRow(1.1, {1.0, 2.0}), IncorrectNumColumns);
+
+    // Concurrent const access to a table with spare rows is safe: the first
+    // access to a whole column removes the spare rows while the others wait.
+    for (int i = 0; i < 50; ++i)
+        table.appendRow(1.1 + 0.01 * i, {1.0 * i, 2.0 * i, 3.0 * i});
+    const TimeSeriesTable& constTable = table;
+    std::vector<int> numMismatches(4, 0);
+    executeInParallelBlocks(0, 4, 4, [&](int thread, int, int) {
+        for (int i = 0; i < 50; ++i) {
+            if (constTable.getNumRows() != 151 ||
+                    constTable.getDependentColumn("c").size() != 151 ||
+                    constTable.getRowAtIndex(101 + i)[2] != 3.0 * i)
+                ++numMismatches[thread];
+        }
+    });
+    for (int n : numMismatches) CHECK(n == 0);
+}
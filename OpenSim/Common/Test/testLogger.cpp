@@ -0,0 +1,334 @@
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  testLogger.cpp                            *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*  Tests asynchronous logging, the messages logged through a
+    Logger::ThreadContext, thread tags, and the rate limiting of
+    ProgressLogger. */
+
+#include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/LogSink.h>
+#include <OpenSim/Common/Logger.h>
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+using namespace OpenSim;
+using namespace std;
+
+int countOccurrences(const std::string& str, const std::string& sub) {
+    int count = 0;
+    for (auto pos = str.find(sub); pos != std::string::npos;
+            pos = str.find(sub, pos + sub.size()))
+        ++count;
+    return count;
+}
+
+void testAsync() {
+    auto sink = std::make_shared<StringLogSink>();
+    Logger::addSink(sink);
+
+    Logger::setAsync(true);
+    ASSERT(Logger::isAsync());
+    for (int i = 0; i < 100; ++i) log_info("async message {}", i);
+    // Turning asynchronous logging off writes the queued messages, in order.
+    Logger::setAsync(false);
+    ASSERT(!Logger::isAsync());
+    std::stringstream expected;
+    for (int i = 0; i < 100; ++i) expected << "async message " << i << "\n";
+    ASSERT(sink->getString() == expected.str());
+
+    // When the queue is full, the oldest messages are dropped, but the most
+    // recent message is always written.
+    sink->clear();
+    Logger::setAsync(true, 8);
+    for (int i = 0; i < 10000; ++i) log_info("message {}", i);
+    Logger::setAsync(false);
+    ASSERT(sink->getString().find("message 9999\n") != std::string::npos);
+
+    // The level applies to the asynchronous loggers.
+    sink->clear();
+    Logger::setAsync(true);
+    Logger::setLevel(Logger::Level::Warn);
+    ASSERT(Logger::getLevel() == Logger::Level::Warn);
+    log_info("info message");
+    log_warn("warn message");
+    Logger::setAsync(false);
+    ASSERT(Logger::getLevel() == Logger::Level::Warn);
+    ASSERT(sink->getString() == "warn message\n");
+    Logger::setLevel(Logger::Level::Info);
+
+    ASSERT_THROW(OpenSim::Exception, Logger::setAsync(true, 0));
+
+    // Adding or removing a sink writes the queued messages first.
+    sink->clear();
+    Logger::setAsync(true);
+    log_info("before adding");
+    auto otherSink = std::make_shared<StringLogSink>();
+    Logger::addSink(otherSink);
+    ASSERT(Logger::isAsync());
+    ASSERT(sink->getString() == "before adding\n");
+    log_info("before removing");
+    Logger::removeSink(otherSink);
+    ASSERT(otherSink->getString() == "before removing\n");
+    log_info("after removing");
+    Logger::setAsync(false);
+    ASSERT(sink->getString() ==
+            "before adding\nbefore removing\nafter removing\n");
+    ASSERT(otherSink->getString() == "before removing\n");
+
+    // Other threads may log while logging is made asynchronous and while
+    // sinks are added and removed; no message is lost.
+    sink->clear();
+    const int numThreads = 4;
+    const int numMessages = 1000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < numThreads; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < numMessages; ++i)
+                log_info("thread {} message {}", t, i);
+        });
+    }
+    for (int i = 0; i < 20; ++i) {
+        Logger::setAsync(i % 2 == 0);
+        Logger::addSink(otherSink);
+        Logger::removeSink(otherSink);
+    }
+    for (auto& thread : threads) thread.join();
+    Logger::setAsync(false);
+    ASSERT(countOccurrences(sink->getString(), " message ") ==
+            numThreads * numMessages);
+
+    Logger::removeSink(sink);
+}
+
+void testThreadContext() {
+    auto sink = std::make_shared<StringLogSink>();
+    Logger::addSink(sink);
+
+    // A long interval, so that only flush() and the end of the contexts
+    // forward the messages.
+    const double interval = 3600.0;
+    {
+        Logger::ThreadContext context(1000, interval);
+        log_info("buffered");
+        ASSERT(sink->getString().empty());
+        {
+            Logger::ThreadContext nested(1000, interval);
+            log_info("nested");
+        }
+        // The nested context forwards its messages to the enclosing context.
+        ASSERT(sink->getString().empty());
+        context.flush();
+        ASSERT(sink->getString() == "buffered\nnested\n");
+        log_info("after flush");
+    }
+    ASSERT(sink->getString() == "buffered\nnested\nafter flush\n");
+
+    // flushAll() logs the messages of all of the contexts of the thread.
+    sink->clear();
+    {
+        Logger::ThreadContext context(1000, interval);
+        log_info("outer");
+        Logger::ThreadContext nested(1000, interval);
+        log_info("inner");
+        Logger::ThreadContext::flushAll();
+        ASSERT(sink->getString() == "outer\ninner\n");
+    }
+    ASSERT(sink->getString() == "outer\ninner\n");
+    Logger::ThreadContext::flushAll();
+
+    // Warnings and errors are not held back; they are logged right away,
+    // after the messages buffered before them.
+    sink->clear();
+    {
+        Logger::ThreadContext context(1000, interval);
+        Logger::ThreadContext nested(1000, interval);
+        log_info("before warning");
+        log_warn("warning");
+        ASSERT(sink->getString() == "before warning\nwarning\n");
+        log_info("after warning");
+        ASSERT(sink->getString() == "before warning\nwarning\n");
+    }
+    ASSERT(sink->getString() == "before warning\nwarning\nafter warning\n");
+
+    // Messages are forwarded once the oldest buffered message is older than
+    // the interval, and when the buffer is full.
+    sink->clear();
+    {
+        Logger::ThreadContext context(1000, 0.0);
+        log_info("no interval");
+        ASSERT(sink->getString() == "no interval\n");
+    }
+    sink->clear();
+    {
+        Logger::ThreadContext context(2, interval);
+        log_info("first");
+        ASSERT(sink->getString().empty());
+        log_info("second");
+        ASSERT(sink->getString() == "first\nsecond\n");
+    }
+
+    // The messages of each thread are logged in order.
+    sink->clear();
+    const int numThreads = 4;
+    executeInParallelBlocks(0, numThreads, numThreads,
+            [](int thread, int, int) {
+                for (int i = 0; i < 5; ++i)
+                    log_info("thread {} message {}", thread, i);
+            });
+    const std::string& messages = sink->getString();
+    for (int thread = 0; thread < numThreads; ++thread) {
+        size_t previous = 0;
+        for (int i = 0; i < 5; ++i) {
+            std::stringstream expected;
+            expected << "thread " << thread << " message " << i << "\n";
+            const size_t pos = messages.find(expected.str());
+            ASSERT(pos != std::string::npos && (i == 0 || pos > previous));
+            previous = pos;
+        }
+    }
+
+    Logger::removeSink(sink);
+}
+
+// Keeps the messages of each tag (Logger::setThreadTag()) separately.
+class TagLogSink : public LogSink {
+public:
+    std::string getString(const std::string& tag) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_messages[tag];
+    }
+protected:
+    void sinkImpl(const std::string& msg) override {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_messages[Logger::getThreadTag()] += msg + "\n";
+    }
+private:
+    std::mutex m_mutex;
+    std::map<std::string, std::string> m_messages;
+};
+
+void testThreadTags() {
+    auto sink = std::make_shared<TagLogSink>();
+    Logger::addSink(sink);
+    ASSERT(Logger::getThreadTag().empty());
+
+    // Concurrent runs of a threaded "tool": each run tags its thread and
+    // starts threads of its own, and ends (changing its tag) before the
+    // background thread writes its messages. Each message is written with
+    // the tag of the run that logged it.
+    Logger::setAsync(true);
+    const int numRuns = 4;
+    const int numThreads = 3;
+    executeInParallel(numRuns, numRuns, [](int, int run) {
+        const std::string tag = "run " + std::to_string(run);
+        Logger::setThreadTag(tag);
+        ASSERT(Logger::getThreadTag() == tag);
+        log_info("{} begins", tag);
+        executeInParallelBlocks(0, numThreads, numThreads,
+                [&tag](int thread, int, int) {
+                    ASSERT(Logger::getThreadTag() == tag);
+                    log_info("{} thread {}", tag, thread);
+                    log_warn("{} thread {} warning", tag, thread);
+                });
+        log_info("{} ends", tag);
+        Logger::ThreadContext::flushAll();
+        Logger::setThreadTag("");
+    });
+    Logger::setAsync(false);
+    ASSERT(Logger::getThreadTag().empty());
+    for (int run = 0; run < numRuns; ++run) {
+        const std::string tag = "run " + std::to_string(run);
+        const std::string messages = sink->getString(tag);
+        ASSERT(countOccurrences(messages, "run ") == 2 + 2 * numThreads);
+        ASSERT(messages.find(tag + " begins\n") == 0);
+        for (int thread = 0; thread < numThreads; ++thread) {
+            const std::string prefix =
+                    tag + " thread " + std::to_string(thread);
+            ASSERT(messages.find(prefix + "\n") != std::string::npos);
+            ASSERT(messages.find(prefix + " warning\n") != std::string::npos);
+        }
+    }
+    ASSERT(sink->getString("").empty());
+
+    // Logger::flush() waits for the background thread.
+    Logger::setAsync(true);
+    Logger::setThreadTag("flushed");
+    log_info("queued");
+    Logger::flush();
+    ASSERT(sink->getString("flushed") == "queued\n");
+    Logger::setThreadTag("");
+    Logger::setAsync(false);
+
+    Logger::removeSink(sink);
+}
+
+void testProgressLogger() {
+    auto sink = std::make_shared<StringLogSink>();
+    Logger::addSink(sink);
+
+    // Only the last update is logged when the updates are frequent.
+    {
+        ProgressLogger progress("Solved", 100000, 3600.0);
+        for (int i = 1; i <= 100000; ++i) progress.update(i);
+    }
+    ASSERT(countOccurrences(sink->getString(), "Solved") == 1);
+    ASSERT(sink->getString().find("Solved 100000/100000 frames (100%)") !=
+            std::string::npos);
+
+    // Every update is logged when the interval is 0.
+    sink->clear();
+    {
+        ProgressLogger progress("Processed", 4, 0.0);
+        for (int i = 1; i <= 4; ++i) progress.update(i);
+    }
+    ASSERT(countOccurrences(sink->getString(), "Processed") == 4);
+    ASSERT(sink->getString().find("Processed 2/4 frames (50%)") !=
+            std::string::npos);
+
+    // Nothing is logged if the level is above Info.
+    sink->clear();
+    Logger::setLevel(Logger::Level::Warn);
+    {
+        ProgressLogger progress("Solved", 2, 0.0);
+        progress.update(1);
+        progress.update(2);
+    }
+    Logger::setLevel(Logger::Level::Info);
+    ASSERT(sink->getString().find("Solved") == std::string::npos);
+
+    Logger::removeSink(sink);
+}
+
+int main() {
+    SimTK_START_TEST("testLogger");
+        SimTK_SUBTEST(testAsync);
+        SimTK_SUBTEST(testThreadContext);
+        SimTK_SUBTEST(testThreadTags);
+        SimTK_SUBTEST(testProgressLogger);
+    SimTK_END_TEST();
+}
@@ -22,8 +22,12 @@
 
 #include "OpenSim/Common/Adapters.h"
 #include "OpenSim/Common/CommonUtilities.h"
+#include "OpenSim/Common/Stopwatch.h"
+#include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <fstream>
+#include <random>
 #include <unordered_set>
 
 #define CATCH_CONFIG_MAIN
@@ -353,3 +357,86 @@ TEST_CASE("Trimming whitespace in metadata values") {
 
 
 
+TEST_CASE("FileAdapter::parseDouble() matches std::stod()") {
+    std::vector<std::string> tokens{"0", "-0", "0.0", "1", "-1.5", ".5", "5.",
+            "  3.25\t", "1e5", "1E-5", "-2.5e+3", "0.00000000000000000001",
+            "123456789012345678901234", "9007199254740993",
+            "1.7976931348623157e308", "nan", "NaN", "-inf", "1.5abc", "1e"};
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<double> distribution(-1000, 1000);
+    for (int i = 0; i < 10000; ++i) {
+        char buffer[64];
+        std::snprintf(buffer, sizeof(buffer), i % 2 ? "%.8f" : "%.17g",
+                distribution(generator) * std::pow(10.0, i % 41 - 20));
+        tokens.push_back(buffer);
+    }
+    for (const auto& token : tokens) {
+        const double expected = std::stod(token);
+        const double actual = FileAdapter::parseDouble(
+                token.data(), token.data() + token.size());
+        INFO(token);
+        if (SimTK::isNaN(expected))
+            CHECK(SimTK::isNaN(actual));
+        else
+            CHECK(std::memcmp(&expected, &actual, sizeof(double)) == 0);
+    }
+    const std::string invalid{"abc"};
+    CHECK_THROWS_AS(FileAdapter::parseDouble(
+            invalid.data(), invalid.data() + invalid.size()), Exception);
+    // Out-of-range numbers throw, as with std::stod().
+    for (const std::string outOfRange : {"1e400", "-1e400", "1e-400"}) {
+        INFO(outOfRange);
+        CHECK_THROWS_AS(std::stod(outOfRange), std::out_of_range);
+        CHECK_THROWS_AS(FileAdapter::parseDouble(outOfRange.data(),
+                outOfRange.data() + outOfRange.size()), std::out_of_range);
+    }
+}
+
+TEST_CASE("Reading STO files matches the values parsed with std::stod()") {
+    // Also reports the time to read each file, compared to reading the lines
+    // of the file with std::getline() and parsing each token with
+    // std::stod(), as DelimFileAdapter used to do.
+    std::vector<std::string> filenames{};
+    filenames.push_back("std_subject01_walk1_ik.mot");
+    filenames.push_back("gait10dof18musc_subject01_walk_grf.mot");
+    filenames.push_back("gait10dof18musc_ik_CRLF_line_ending.mot");
+    filenames.push_back("runningModel_GRF_data.mot");
+    filenames.push_back("subject02_running_arms_ik.mot");
+    filenames.push_back("subject01_walk1_grf.mot");
+    for (const auto& filename : filenames) {
+        Stopwatch watch;
+        TimeSeriesTable table(filename);
+        const auto readTime = watch.getElapsedTimeFormatted();
+
+        watch.reset();
+        std::ifstream stream(filename);
+        std::string line;
+        while (std::getline(stream, line) &&
+                line.find("endheader") == std::string::npos) {}
+        FileAdapter::getNextLine(stream, "\t"); // column labels
+        std::vector<std::vector<double>> expected;
+        for (auto tokens = FileAdapter::getNextLine(stream, "\t");
+                !tokens.empty();
+                tokens = FileAdapter::getNextLine(stream, "\t")) {
+            expected.emplace_back();
+            for (const auto& token : tokens)
+                expected.back().push_back(std::stod(token));
+        }
+        const auto referenceTime = watch.getElapsedTimeFormatted();
+        std::cout << "  " << filename << ": " << readTime << " (std::stod: "
+                  << referenceTime << ")" << std::endl;
+
+        REQUIRE(expected.size() == table.getNumRows());
+        for (size_t irow = 0; irow < expected.size(); ++irow) {
+            REQUIRE(expected[irow].size() == table.getNumColumns() + 1);
+            CHECK(expected[irow][0] == table.getIndependentColumn()[irow]);
+            const auto row = table.getRowAtIndex(irow);
+            for (size_t icol = 0; icol < table.getNumColumns(); ++icol) {
+                if (SimTK::isNaN(expected[irow][icol + 1]))
+                    CHECK(SimTK::isNaN(row[int(icol)]));
+                else
+                    CHECK(expected[irow][icol + 1] == row[int(icol)]);
+            }
+        }
+    }
+}
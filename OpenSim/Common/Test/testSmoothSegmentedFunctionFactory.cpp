@@ -43,6 +43,7 @@
 #include <ctime>
 #include <fstream>
 #include <string>
+#include <vector>
 #include <stdio.h>
 
 
@@ -1132,6 +1133,69 @@ void testMonotonicity(SimTK::Matrix mcfSample)
     cout << endl;
 }
 
+/*
+ The compiled (piecewise polynomial) version of each curve is compared against
+ the Bezier curve, sampled from one linear extrapolation region to the other.
+*/
+void testCompiledMuscleCurve(SmoothSegmentedFunction mcf, bool mustCompile)
+{
+    cout << "   TEST: Compiled curve " << endl;
+    const double tol = 1e-8;
+    SmoothSegmentedFunction compiled = mcf;
+    bool isCompiled = compiled.compile(tol);
+    SimTK_TEST(isCompiled == compiled.isCompiled());
+    if(!isCompiled){
+        SimTK_TEST(!mustCompile);
+        cout << "   skipped: the curve could not be compiled to "
+             << tol << endl;
+        return;
+    }
+    SimTK_TEST(compiled.getNumCompiledIntervals() > 0);
+    SimTK_TEST(compiled.getCompiledError() <= tol);
+
+    SimTK::Vec2 domain = mcf.getCurveDomain();
+    double range = domain(1)-domain(0);
+    int n = 1001;
+    std::vector<double> x(n), y(n), yBezier(n);
+    for(int i=0; i<n; i++){
+        x[i] = domain(0) - 0.1*range + 1.2*range*i/(n-1);
+    }
+
+    for(int order=0; order <= 2; order++){
+        //The Bezier curve, evaluated point by point and as a batch.
+        double scale = 1;
+        for(int i=0; i<n; i++){
+            y[i] = mcf.calcDerivative(x[i],order);
+            scale = std::max(scale, std::abs(y[i]));
+        }
+        mcf.calcDerivatives(&x[0], &yBezier[0], n, order);
+        for(int i=0; i<n; i++){
+            SimTK_TEST(yBezier[i] == y[i]);
+        }
+
+        //The compiled curve, as a batch and point by point.
+        compiled.calcDerivatives(&x[0], &y[0], n, order);
+        for(int i=0; i<n; i++){
+            SimTK_TEST_EQ_TOL(y[i], yBezier[i], 10*tol*scale);
+            SimTK_TEST(y[i] == compiled.calcDerivative(x[i],order));
+        }
+    }
+    compiled.calcValues(&x[0], &y[0], n);
+    for(int i=0; i<n; i++){
+        SimTK_TEST(y[i] == compiled.calcValue(x[i]));
+    }
+    //Higher derivatives are computed from the Bezier curve.
+    SimTK_TEST(compiled.calcDerivative(x[n/2],3) == mcf.calcDerivative(x[n/2],3));
+
+    compiled.clearCompiled();
+    SimTK_TEST(!compiled.isCompiled());
+    SimTK_TEST(compiled.calcValue(x[n/2]) == mcf.calcValue(x[n/2]));
+
+    printf("   passed: compiled curve with %i intervals is within %e\n",
+           compiled.getNumCompiledIntervals(), tol);
+    cout << endl;
+}
+
 //______________________________________________________________________________
 /**
  * Create a muscle bench marking system. The bench mark consists of a single muscle 
@@ -1217,6 +1281,14 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(tendonCurve,tendonCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(tendonCurve,true);
+            SmoothSegmentedFunction::setDefaultCompileTolerance(1e-8);
+            auto compiledTendonCurve_ptr = std::unique_ptr<SmoothSegmentedFunction>{
+                SmoothSegmentedFunctionFactory::
+                createTendonForceLengthCurve(e0,kiso,ftoe,c,false,"test")};
+            SmoothSegmentedFunction::setDefaultCompileTolerance(0);
+            SimTK_TEST(compiledTendonCurve_ptr->isCompiled());
         //4. Test for monotonicity where appropriate
             testMonotonicity(tendonCurveSample);
 
@@ -1286,6 +1358,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberFLCurve,fiberFLCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberFLCurve,false);
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFLCurveSample);
@@ -1355,6 +1429,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberCECurve,fiberCECurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberCECurve,false);
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberCECurveSample);
@@ -1420,6 +1496,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberCEPhiCurve,fiberCEPhiCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberCEPhiCurve,false);
         //4. Test for monotonicity where appropriate
             testMonotonicity(fiberCEPhiCurveSample);
         //5. Testing Exceptions
@@ -1492,6 +1570,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberCECosPhiCurve,fiberCECosPhiCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberCECosPhiCurve,false);
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberCECosPhiCurveSample);
@@ -1582,6 +1662,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberFVCurve,fiberFVCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberFVCurve,false);
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFVCurveSample);
@@ -1693,6 +1775,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberFVInvCurve,fiberFVInvCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberFVInvCurve,false);
         //4. Test for monotonicity where appropriate
 
             testMonotonicity(fiberFVInvCurveSample);
@@ -1842,6 +1926,8 @@ int main(int argc, char* argv[])
 
         //3. Test numerically to see if the curve is C2 continuous
             testMuscleCurveC2Continuity(fiberfalCurve,fiberfalCurveSample);
+        //   Test the compiled curve against the Bezier curve
+            testCompiledMuscleCurve(fiberfalCurve,true);
 
             //fiberfalCurve.MuscleCurveToCSVFile("C:/mjhmilla/Stanford/dev");
        
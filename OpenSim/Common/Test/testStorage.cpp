@@ -20,6 +20,7 @@
  * limitations under the License.                                             *
  * -------------------------------------------------------------------------- */
 
+#include <algorithm>
 #include <fstream>
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
@@ -170,6 +171,46 @@ void testStorageGetStateIndexBackwardsCompatibility() {
     // TODO: Put XML document version in Storage header.
 }
 
+void testStorageFindIndex() {
+    // Times with repeated values, as in a storage that has duplicate rows.
+    Storage sto;
+    std::vector<double> times;
+    for (int i = 0; i < 500; ++i) {
+        const double time = 0.01 * (i / 3 * 2 + i % 3 / 2);
+        times.push_back(time);
+        sto.append(time, SimTK::Vector(2, 2 * time));
+    }
+    // Reference: the linear search that findIndex() used to perform.
+    auto linearFindIndex = [&](double t) {
+        int i = 0;
+        while (i < (int)times.size() && !(t < times[i])) ++i;
+        return std::max(i - 1, 0);
+    };
+
+    std::vector<double> queries{-1, times.front(), times.back(), 10};
+    for (int i = 0; i < 2000; ++i) queries.push_back(-0.1 + 0.0005 * i);
+    for (double t : queries) {
+        const int expected = linearFindIndex(t);
+        ASSERT(sto.findIndex(t) == expected);
+        for (int hint : {-1, 0, 1, expected - 1, expected, expected + 1,
+                     expected + 7, 250, 499, 500}) {
+            ASSERT(sto.findIndex(hint, t) == expected);
+        }
+    }
+
+    // Monotone and non-monotone lookups through getDataAtTime(), which
+    // starts its search from the previous result.
+    SimTK::Vector data(2);
+    for (double t : {0.0, 0.105, 0.31, 0.2, 0.005, 3.0}) {
+        sto.getDataAtTime(t, 2, data);
+        ASSERT_EQUAL(2 * SimTK::clamp(0.0, t, times.back()), data[0], 1e-12);
+    }
+
+    Storage empty;
+    ASSERT(empty.findIndex(0.5) == -1);
+    ASSERT(empty.findIndex(3, 0.5) == -1);
+}
+
 int main() {
     SimTK_START_TEST("testStorage");
 
@@ -194,6 +235,8 @@ int main() {
         SimTK_SUBTEST(testStorageLegacy);
 
         SimTK_SUBTEST(testStorageGetStateIndexBackwardsCompatibility);
+
+        SimTK_SUBTEST(testStorageFindIndex);
     SimTK_END_TEST();
 }
 
@@ -348,6 +348,37 @@ public:
         return candidate;
     }
 
+    /** Get index of the last row whose time is at or before the given value,
+    or of the first row if the value precedes the time column. The search
+    starts from the row with index `hint`: when looking up increasing values
+    with the index returned for the previous value as the hint (a cursor),
+    each lookup takes constant time. Other values fall back to a binary
+    search.
+
+    \param time Value to search for.
+    \param hint Index of the row from which to start the search.
+
+    \throws EmptyTable If the table is empty.                                 */
+    size_t getRowIndexAtOrBeforeTime(const double time, size_t hint) const {
+        using DT = DataTable_<double, ETY>;
+        const auto& timeCol = DT::getIndependentColumn();
+        OPENSIM_THROW_IF(timeCol.size() == 0,
+            EmptyTable);
+        // Step forward from the hint over a few rows before resorting to a
+        // binary search.
+        const size_t maxSteps = 4;
+        if (hint < timeCol.size() && timeCol[hint] <= time) {
+            for (size_t step = 0; step < maxSteps; ++step, ++hint) {
+                if (hint + 1 == timeCol.size() || timeCol[hint + 1] > time)
+                    return hint;
+            }
+        }
+        auto iter = std::upper_bound(timeCol.begin(), timeCol.end(), time);
+        if (iter == timeCol.begin())
+            return 0;
+        return std::distance(timeCol.begin(), iter) - 1;
+    }
+
     /** Get row whose time column is nearest/closest to the given value. 
 
     \param time Value to search for. 
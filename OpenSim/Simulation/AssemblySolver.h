@@ -84,6 +84,8 @@ public:
         Note, setting the accuracy will invalidate the AssemblySolver and one
         must call assemble() before being able to track().*/
     void setAccuracy(double accuracy);
+    /** Get the unitless accuracy of the assembly solution. */
+    double getAccuracy() const { return _accuracy; }
 
     /** %Set the relative weighting for constraints. Use Infinity to identify the 
         strict enforcement of constraints, otherwise any positive weighting will
@@ -23,8 +23,12 @@
 
 #include "InverseDynamicsSolver.h"
 #include "Model/Model.h"
+#include <OpenSim/Common/CommonUtilities.h>
 #include <OpenSim/Common/FunctionSet.h>
 
+#include <memory>
+#include <vector>
+
 using namespace std;
 using namespace SimTK;
 
@@ -141,4 +145,99 @@ void InverseDynamicsSolver::solve(SimTK::State &s, const FunctionSet &Qs, const
     }
 }
 
+/** Same as above, but solving contiguous blocks of time frames on separate
+    threads, each with its own copy of the model and of the functions. */
+void InverseDynamicsSolver::solve(SimTK::State &s, const FunctionSet &Qs,
+        const Array_<double> &times, Array_<Vector> &genForceTrajectory,
+        int numThreads)
+{
+    const Model& model = getModel();
+    const int nq = model.getNumCoordinates();
+    const int nt = times.size();
+
+    if(Qs.getSize() != nq){
+        throw Exception("InverseDynamicsSolver::solve invalid number of q functions.");
+    }
+    if( nq != model.getNumSpeeds()){
+        throw Exception("InverseDynamicsSolver::solve using FunctionSet, nq != nu not supported.");
+    }
+
+    numThreads = getNumThreadsForTasks(numThreads, nt);
+    if(numThreads == 1){
+        solve(s, Qs, times, genForceTrajectory);
+        return;
+    }
+
+    genForceTrajectory.resize(nt, Vector(nq));
+
+    // Copy and initialize the models on this thread. The forces disabled in
+    // s and the auxiliary states (e.g., activations) are carried over to the
+    // state of each copy.
+    const ForceSet& forces = model.getForceSet();
+    std::vector<std::unique_ptr<Model>> models(numThreads);
+    std::vector<std::unique_ptr<FunctionSet>> functions(numThreads);
+    for(int t = 0; t < numThreads; ++t){
+        models[t].reset(model.clone());
+        models[t]->updAnalysisSet().setSize(0);
+        SimTK::State& state = models[t]->initSystem();
+        const ForceSet& copiedForces = models[t]->getForceSet();
+        for(int k = 0; k < forces.getSize(); ++k){
+            copiedForces[k].setAppliesForce(state, forces[k].appliesForce(s));
+        }
+        state.updZ() = s.getZ();
+        functions[t].reset(Qs.clone());
+    }
+
+    executeInParallelBlocks(0, nt, numThreads,
+            [&](int thread, int blockBegin, int blockEnd) {
+        Model& threadModel = *models[thread];
+        const FunctionSet& threadQs = *functions[thread];
+        SimTK::State& state = threadModel.updWorkingState();
+        InverseDynamicsSolver solver(threadModel);
+
+        // Evaluate the values, speeds, and accelerations of each coordinate
+        // for all frames of the block at once.
+        const int n = blockEnd - blockBegin;
+        const double* blockTimes = &times[blockBegin];
+        std::vector<double> values(3 * nq * n);
+        for(int j = 0; j < nq; ++j){
+            for(int order = 0; order < 3; ++order){
+                threadQs.get(j).calcDerivatives(blockTimes,
+                        &values[(3 * j + order) * n], n, order);
+            }
+        }
+
+        for(int i = 0; i < n; ++i){
+            state.updTime() = blockTimes[i];
+            Vector &q = state.updQ();
+            Vector &u = state.updU();
+            Vector &udot = state.updUDot();
+            for(int j = 0; j < nq; ++j){
+                q[j] = values[(3 * j) * n + i];
+                u[j] = values[(3 * j + 1) * n + i];
+                udot[j] = values[(3 * j + 2) * n + i];
+            }
+            genForceTrajectory[blockBegin + i] = solver.solve(state, udot);
+        }
+    });
+
+    // Step the analyses through the frames in order, as the serial solve
+    // does, and leave the state at the last frame.
+    AnalysisSet& analysisSet = const_cast<AnalysisSet&>(model.getAnalysisSet());
+    const int firstFrame = analysisSet.getSize() ? 0 : nt - 1;
+    for(int i = firstFrame; i < nt; ++i){
+        s.updTime() = times[i];
+        Vector &q = s.updQ();
+        Vector &u = s.updU();
+        Vector &udot = s.updUDot();
+        for(int j = 0; j < nq; ++j){
+            q[j] = Qs.evaluate(j, 0, times[i]);
+            u[j] = Qs.evaluate(j, 1, times[i]);
+            udot[j] = Qs.evaluate(j, 2, times[i]);
+        }
+        model.getMultibodySystem().realize(s, SimTK::Stage::Dynamics);
+        analysisSet.step(s, i);
+    }
+}
+
 } // end of namespace OpenSim
\ No newline at end of file
@@ -98,6 +98,22 @@ public:
     virtual void solve(SimTK::State& s, const FunctionSet& Qs, 
                  const SimTK::Array_<double>&  times,
                  SimTK::Array_<SimTK::Vector>& genForceTrajectory);
+
+    /** Same as above, but the time frames are divided into contiguous
+        blocks that are solved concurrently on `numThreads` threads (0 or less
+        uses all available hardware threads). Each thread has its own copy of
+        the model, with the forces that do not apply forces in `s` disabled,
+        and its own copy of the coordinate functions, which it evaluates for
+        all frames of its block at once. The generalized forces are identical
+        to those of the serial solve. Afterwards, the analyses of the model
+        are stepped through the frames in order, and `s` is left at the last
+        frame. The copies of the model are created with Model::clone() and
+        Model::initSystem(), so this pays off only for trials with many
+        frames. */
+    void solve(SimTK::State& s, const FunctionSet& Qs,
+               const SimTK::Array_<double>& times,
+               SimTK::Array_<SimTK::Vector>& genForceTrajectory,
+               int numThreads);
 #endif
 //=============================================================================
 };  // END of class InverseDynamicsSolver
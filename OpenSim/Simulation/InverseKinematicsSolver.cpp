@@ -28,6 +28,8 @@
 #include "simbody/internal/AssemblyCondition_Markers.h"
 #include "simbody/internal/AssemblyCondition_OrientationSensors.h"
 
+#include <algorithm>
+
 using namespace std;
 using namespace SimTK;
 
@@ -178,6 +180,19 @@ void InverseKinematicsSolver::updateOrientationWeights(const SimTK::Array_<doubl
         throw Exception("InverseKinematicsSolver::updateOrientationWeights: invalid size of weights.");
 }
 
+void InverseKinematicsSolver::setOrientationValues(
+        const SimTK::Array_<SimTK::Rotation>& values)
+{
+    OPENSIM_THROW_IF(
+            int(values.size()) != _orientationsReference.getNumRefs(),
+            Exception,
+            "Expected {} orientations (one per OrientationsReference name), "
+            "but got {}.",
+            _orientationsReference.getNumRefs(), values.size());
+    _orientationValues = values;
+    _useOrientationValues = true;
+}
+
 /* Compute and return the spatial location of a marker in ground. */
 SimTK::Vec3 InverseKinematicsSolver::computeCurrentMarkerLocation(const std::string &markerName)
 {
@@ -339,6 +354,26 @@ std::string InverseKinematicsSolver::
 }
 
 
+void InverseKinematicsSolver::assemble(SimTK::State &s)
+{
+    AssemblySolver::assemble(s);
+    setupLevenbergMarquardt(s);
+}
+
+void InverseKinematicsSolver::track(SimTK::State &s)
+{
+    _numIterations = 0;
+    if (!_levenbergMarquardt.enabled) {
+        AssemblySolver::track(s);
+        return;
+    }
+    OPENSIM_THROW_IF(!getAssembler().isInitialized(), Exception,
+        "InverseKinematicsSolver::track() failed: assemble() must be called "
+        "first.");
+    updateGoals(s);
+    trackWithLevenbergMarquardt(s);
+}
+
 /* Internal method to convert the MarkerReferences into additional goals of the 
     of the base assembly solver, that is going to do the assembly.  */
 void InverseKinematicsSolver::setupGoals(SimTK::State &s)
@@ -441,6 +476,320 @@ void InverseKinematicsSolver::setupOrientationsGoal(SimTK::State &s)
     _orientationAssemblyCondition->defineObservationOrder(osensorNames);
 }
 
+void InverseKinematicsSolver::setupLevenbergMarquardt(const SimTK::State &s)
+{
+    LevenbergMarquardtGoals& lm = _levenbergMarquardt;
+    lm = LevenbergMarquardtGoals();
+    if (!_useLevenbergMarquardt) return;
+
+    const Model& model = getModel();
+    const CoordinateSet& coordinates = model.getCoordinateSet();
+    bool supported = _orientationsReference.getNumRefs() == 0 &&
+                     s.getNQ() == s.getNU();
+    for (int i = 0; supported && i < model.getConstraintSet().getSize(); ++i)
+        supported = !model.getConstraintSet()[i].isEnforced(s);
+    for (int i = 0; supported && i < coordinates.getSize(); ++i)
+        supported = !coordinates[i].isPrescribed(s);
+    if (!supported) {
+        log_warn("InverseKinematicsSolver: the Levenberg-Marquardt solver does "
+                 "not support enforced constraints, prescribed coordinates, "
+                 "quaternions, or orientations. Tracking with the "
+                 "SimTK::Assembler instead.");
+        return;
+    }
+
+    const SimTK::Assembler& assembler = getAssembler();
+    const SimTK::SimbodyMatterSubsystem& matter = model.getMatterSubsystem();
+    for (SimTK::Assembler::FreeQIndex fx(0); fx < assembler.getNumFreeQs();
+            ++fx)
+        lm.qIndices.push_back(assembler.getQIndexOfFreeQ(fx));
+
+    auto findFreeQ = [&](SimTK::MobilizedBodyIndex bx, int mobilizerQIndex) {
+        const SimTK::QIndex qx(
+            matter.getMobilizedBody(bx).getFirstQIndex(s) + mobilizerQIndex);
+        const SimTK::Assembler::FreeQIndex fx = assembler.getFreeQIndexOfQ(qx);
+        return fx.isValid() ? int(fx) : -1;
+    };
+
+    if (_markersReference.getNumRefs() > 0) {
+        const SimTK::Markers& markers = *_markerAssemblyCondition;
+        for (SimTK::Markers::MarkerIx mx(0); mx < markers.getNumMarkers();
+                ++mx) {
+            lm.markerBodies.push_back(markers.getMarkerBody(mx));
+            lm.markerStations.push_back(markers.getMarkerStation(mx));
+            const SimTK::Markers::ObservationIx ox =
+                markers.getObservationIxForMarker(mx);
+            lm.markerObservations.push_back(ox.isValid() ? int(ox) : -1);
+
+            // The station Jacobian of a marker is zero except for the
+            // mobilities of the bodies between its body and ground.
+            std::vector<int> freeQs;
+            const SimTK::MobilizedBody* mobod =
+                &matter.getMobilizedBody(markers.getMarkerBody(mx));
+            while (!mobod->isGround()) {
+                for (int k = 0; k < mobod->getNumQ(s); ++k) {
+                    const int fx = findFreeQ(mobod->getMobilizedBodyIndex(), k);
+                    if (fx >= 0) freeQs.push_back(fx);
+                }
+                mobod = &mobod->getParentMobilizedBody();
+            }
+            lm.markerFreeQs.push_back(freeQs);
+        }
+    }
+
+    const SimTK::Array_<CoordinateReference>& coordinateReferences =
+        getCoordinateReferences();
+    for (int i = 0; i < int(coordinateReferences.size()); ++i) {
+        const Coordinate& coord =
+            coordinates.get(coordinateReferences[i].getName());
+        if (coord.get_is_free_to_satisfy_constraints()) continue;
+        const int fx = findFreeQ(coord.getBodyIndex(),
+                                 coord.getMobilizerQIndex());
+        if (fx < 0) continue;
+        lm.coordinateReferences.push_back(i);
+        lm.coordinateFreeQs.push_back(fx);
+    }
+
+    for (int i = 0; i < coordinates.getSize(); ++i) {
+        const Coordinate& coord = coordinates[i];
+        if (!coord.getClamped(s)) continue;
+        const int fx = findFreeQ(coord.getBodyIndex(),
+                                 coord.getMobilizerQIndex());
+        if (fx < 0) continue;
+        lm.clampedFreeQs.push_back(fx);
+        lm.clampedRanges.push_back(
+            SimTK::Vec2(coord.getRangeMin(), coord.getRangeMax()));
+    }
+
+    lm.enabled = true;
+    lm.numPreviousFrames = 1;
+    lm.previousTimes[0] = s.getTime();
+    getFreeQs(s, lm.previousFreeQs[0]);
+}
+
+void InverseKinematicsSolver::trackWithLevenbergMarquardt(SimTK::State &s)
+{
+    LevenbergMarquardtGoals& lm = _levenbergMarquardt;
+    const SimTK::MultibodySystem& system = getModel().getMultibodySystem();
+
+    lm.totalMarkerWeight = 0;
+    for (int m = 0; m < int(lm.markerBodies.size()); ++m)
+        lm.totalMarkerWeight += _markerAssemblyCondition->getMarkerWeight(
+            SimTK::Markers::MarkerIx(m));
+
+    auto clampToRanges = [&](SimTK::Vector& freeQs) {
+        for (int i = 0; i < int(lm.clampedFreeQs.size()); ++i) {
+            double& q = freeQs[lm.clampedFreeQs[i]];
+            q = std::min(std::max(q, lm.clampedRanges[i][0]),
+                         lm.clampedRanges[i][1]);
+        }
+    };
+
+    // Start from the configuration of the state or, if it is closer to the
+    // solution, from the configuration extrapolated from the velocity of the
+    // last two frames.
+    SimTK::Vector q;
+    getFreeQs(s, q);
+    system.realize(s, SimTK::Stage::Position);
+    double cost = calcLevenbergMarquardtCost(s);
+    const double previousStep = lm.previousTimes[0] - lm.previousTimes[1];
+    if (lm.numPreviousFrames == 2 && previousStep > 0) {
+        SimTK::Vector predicted = lm.previousFreeQs[0] - lm.previousFreeQs[1];
+        predicted *= (s.getTime() - lm.previousTimes[0]) / previousStep;
+        predicted += lm.previousFreeQs[0];
+        clampToRanges(predicted);
+        setFreeQs(predicted, s);
+        system.realize(s, SimTK::Stage::Position);
+        const double predictedCost = calcLevenbergMarquardtCost(s);
+        if (predictedCost < cost) {
+            q = predicted;
+            cost = predictedCost;
+        }
+        else
+            setFreeQs(q, s);
+    }
+
+    const int maxIterations = 100;
+    const double tolerance = getAccuracy();
+    double lambda = 1e-3;
+    SimTK::Matrix H, A;
+    SimTK::Vector g, step, trial;
+    while (_numIterations < maxIterations) {
+        ++_numIterations;
+        system.realize(s, SimTK::Stage::Position);
+        calcLevenbergMarquardtNormalEquations(s, H, g);
+        g *= -1;
+
+        // Increase the damping until a step does not increase the cost.
+        bool accepted = false;
+        double stepSize = 0;
+        while (!accepted && lambda < 1e10) {
+            A = H;
+            for (int i = 0; i < A.nrow(); ++i)
+                A(i, i) += lambda * std::max(H(i, i), 1e-8);
+            SimTK::FactorLU lu(A);
+            lu.solve(g, step);
+            trial = q + step;
+            clampToRanges(trial);
+            setFreeQs(trial, s);
+            system.realize(s, SimTK::Stage::Position);
+            const double trialCost = calcLevenbergMarquardtCost(s);
+            if (trialCost <= cost) {
+                accepted = true;
+                stepSize = max(abs(trial - q));
+                q = trial;
+                cost = trialCost;
+                lambda = std::max(0.1 * lambda, 1e-12);
+            }
+            else
+                lambda *= 10;
+        }
+        if (!accepted) {
+            setFreeQs(q, s);
+            break;
+        }
+        if (stepSize < tolerance) break;
+    }
+    system.realize(s, SimTK::Stage::Position);
+
+    // Keep the Assembler's internal state at the solution so that the
+    // locations and errors of the markers are those of this frame.
+    updAssembler().setInternalStateFromFreeQs(q);
+
+    lm.previousTimes[1] = lm.previousTimes[0];
+    lm.previousFreeQs[1] = lm.previousFreeQs[0];
+    lm.previousTimes[0] = s.getTime();
+    lm.previousFreeQs[0] = q;
+    lm.numPreviousFrames = std::min(lm.numPreviousFrames + 1, 2);
+
+    log_debug("Tracking: t= {} (iterations={}, cost={})", s.getTime(),
+        _numIterations, cost);
+}
+
+double InverseKinematicsSolver::calcLevenbergMarquardtCost(
+        const SimTK::State &s) const
+{
+    const LevenbergMarquardtGoals& lm = _levenbergMarquardt;
+    const SimTK::SimbodyMatterSubsystem& matter =
+        getModel().getMatterSubsystem();
+
+    double markersCost = 0;
+    for (int m = 0; m < int(lm.markerBodies.size()); ++m) {
+        const int ox = lm.markerObservations[m];
+        // Markers without an observation in this frame are ignored.
+        if (ox < 0 || !_markerValues[ox].isFinite()) continue;
+        const SimTK::Vec3 error = matter.getMobilizedBody(lm.markerBodies[m])
+            .findStationLocationInGround(s, lm.markerStations[m]) -
+            _markerValues[ox];
+        markersCost += _markerAssemblyCondition->getMarkerWeight(
+            SimTK::Markers::MarkerIx(m)) * error.normSqr();
+    }
+
+    double cost = lm.totalMarkerWeight > 0 ?
+        markersCost / lm.totalMarkerWeight : 0;
+    const SimTK::Array_<CoordinateReference>& coordinateReferences =
+        getCoordinateReferences();
+    for (int i = 0; i < int(lm.coordinateReferences.size()); ++i) {
+        const CoordinateReference& ref =
+            coordinateReferences[lm.coordinateReferences[i]];
+        const double error =
+            s.getQ()[lm.qIndices[lm.coordinateFreeQs[i]]] - ref.getValue(s);
+        cost += ref.getWeight(s) * error * error;
+    }
+    return cost;
+}
+
+void InverseKinematicsSolver::calcLevenbergMarquardtNormalEquations(
+        const SimTK::State &s, SimTK::Matrix &H, SimTK::Vector &g) const
+{
+    const LevenbergMarquardtGoals& lm = _levenbergMarquardt;
+    const SimTK::SimbodyMatterSubsystem& matter =
+        getModel().getMatterSubsystem();
+    const int nfq = int(lm.qIndices.size());
+    H.resize(nfq, nfq);
+    H.setToZero();
+    g.resize(nfq);
+    g.setToZero();
+
+    // Station Jacobians (with respect to the mobilities) of all markers that
+    // have an observation in this frame.
+    SimTK::Array_<SimTK::MobilizedBodyIndex> bodies;
+    SimTK::Array_<SimTK::Vec3> stations;
+    std::vector<int> observed;
+    for (int m = 0; m < int(lm.markerBodies.size()); ++m) {
+        const int ox = lm.markerObservations[m];
+        if (ox < 0 || !_markerValues[ox].isFinite()) continue;
+        bodies.push_back(lm.markerBodies[m]);
+        stations.push_back(lm.markerStations[m]);
+        observed.push_back(m);
+    }
+    SimTK::Matrix JS;
+    if (!observed.empty() && lm.totalMarkerWeight > 0)
+        matter.calcStationJacobian(s, bodies, stations, JS);
+    else
+        observed.clear();
+
+    const int nq = s.getNQ();
+    SimTK::Vector Ju(nq), Jq[3];
+    std::vector<SimTK::Vec3> J;
+    for (int k = 0; k < int(observed.size()); ++k) {
+        const int m = observed[k];
+        const double weight = _markerAssemblyCondition->getMarkerWeight(
+            SimTK::Markers::MarkerIx(m)) / lm.totalMarkerWeight;
+        const SimTK::Vec3 error = matter.getMobilizedBody(bodies[k])
+            .findStationLocationInGround(s, stations[k]) -
+            _markerValues[lm.markerObservations[m]];
+
+        // Rows of the Jacobian with respect to the Qs: JS*NInv.
+        for (int d = 0; d < 3; ++d) {
+            Ju = ~JS[3 * k + d];
+            matter.multiplyByNInv(s, true, Ju, Jq[d]);
+        }
+
+        // Accumulate only over the columns of the Jacobian that can be
+        // nonzero: the free Qs between the marker's body and ground.
+        const std::vector<int>& freeQs = lm.markerFreeQs[m];
+        J.resize(freeQs.size());
+        for (int a = 0; a < int(freeQs.size()); ++a) {
+            const int qx = lm.qIndices[freeQs[a]];
+            J[a] = SimTK::Vec3(Jq[0][qx], Jq[1][qx], Jq[2][qx]);
+        }
+        for (int a = 0; a < int(freeQs.size()); ++a) {
+            g[freeQs[a]] += weight * dot(J[a], error);
+            for (int b = 0; b < int(freeQs.size()); ++b)
+                H(freeQs[a], freeQs[b]) += weight * dot(J[a], J[b]);
+        }
+    }
+
+    const SimTK::Array_<CoordinateReference>& coordinateReferences =
+        getCoordinateReferences();
+    for (int i = 0; i < int(lm.coordinateReferences.size()); ++i) {
+        const CoordinateReference& ref =
+            coordinateReferences[lm.coordinateReferences[i]];
+        const int fx = lm.coordinateFreeQs[i];
+        const double weight = ref.getWeight(s);
+        H(fx, fx) += weight;
+        g[fx] += weight * (s.getQ()[lm.qIndices[fx]] - ref.getValue(s));
+    }
+}
+
+void InverseKinematicsSolver::getFreeQs(const SimTK::State &s,
+        SimTK::Vector &freeQs) const
+{
+    const std::vector<int>& qIndices = _levenbergMarquardt.qIndices;
+    freeQs.resize(int(qIndices.size()));
+    for (int i = 0; i < int(qIndices.size()); ++i)
+        freeQs[i] = s.getQ()[qIndices[i]];
+}
+
+void InverseKinematicsSolver::setFreeQs(const SimTK::Vector &freeQs,
+        SimTK::State &s) const
+{
+    const std::vector<int>& qIndices = _levenbergMarquardt.qIndices;
+    for (int i = 0; i < int(qIndices.size()); ++i)
+        s.updQ()[qIndices[i]] = freeQs[i];
+}
+
 /* Internal method to update the time, reference values and/or their weights based
     on the state */
 void InverseKinematicsSolver::updateGoals(const SimTK::State &s)
@@ -456,7 +805,8 @@ void InverseKinematicsSolver::updateGoals(const SimTK::State &s)
 
     // specify the orientation observations to be matched
     if (_orientationsReference.getNumRefs() > 0) {
-        _orientationsReference.getValues(s, _orientationValues);
+        if (!_useOrientationValues)
+            _orientationsReference.getValues(s, _orientationValues);
         _orientationAssemblyCondition->moveAllObservations(_orientationValues);
     }
 }
@@ -27,6 +27,8 @@
 #include "MarkersReference.h"
 #include "OrientationsReference.h"
 
+#include <vector>
+
 namespace SimTK {
 class Markers;
 class OrientationSensors;
@@ -63,6 +65,17 @@ namespace OpenSim {
  *
  * See SimTK::Assembler for more algorithmic details of the underlying solver.
  *
+ * Alternatively, track() can minimize the objective with a Levenberg-Marquardt
+ * solver specialized for markers (see setUseLevenbergMarquardt()). Each
+ * iteration forms the station Jacobians of the markers from the matter
+ * subsystem and accumulates the normal equations only over the coordinates
+ * of the bodies between each marker and ground. Each frame starts from the
+ * configuration predicted from the previous two frames (or from the state, if
+ * that is closer to the solution). The Levenberg-Marquardt solver applies to
+ * markers and coordinate references only: for models with enforced
+ * constraints, prescribed coordinates, or quaternions, or when tracking
+ * orientations, track() uses the SimTK::Assembler.
+ *
  * @author Ajay Seth
  */
 class OSIMSIMULATION_API InverseKinematicsSolver: public AssemblySolver
@@ -87,18 +100,32 @@ public:
                         SimTK::Array_<CoordinateReference> &coordinateReferences,
                         double constraintWeight = SimTK::Infinity);
     
-    /* Assemble a model configuration that meets the InverseKinematics conditions  
-        (desired values and constraints) starting from an initial state that  
-        does not have to satisfy the constraints. */
-    //virtual void assemble(SimTK::State &s);
-
-    /* Obtain a model configuration that meets the InverseKinematics conditions  
-        (desired values and constraints) given a state that satisfies or
-        is close to satisfying the constraints. Note there can be no change
-        in the number of constraints or desired coordinates. Desired
+    /** Assemble a model configuration that meets the InverseKinematics
+        conditions (desired values and constraints) starting from an initial
+        state that does not have to satisfy the constraints. This always uses
+        the SimTK::Assembler. */
+    void assemble(SimTK::State &s) override;
+
+    /** Obtain a model configuration that meets the InverseKinematics
+        conditions (desired values and constraints) given a state that
+        satisfies or is close to satisfying the constraints. Note there can be
+        no change in the number of constraints or desired coordinates. Desired
         coordinate values can and should be updated between repeated calls
         to track a desired trajectory of coordinate values. */
-    //virtual void track(SimTK::State &s);
+    void track(SimTK::State &s) override;
+
+    /** Track frames with the Levenberg-Marquardt solver instead of the
+        SimTK::Assembler, when the model and goals allow it (see the class
+        description). Takes effect when assemble() is called next. */
+    void setUseLevenbergMarquardt(bool flag) { _useLevenbergMarquardt = flag; }
+    bool getUseLevenbergMarquardt() const { return _useLevenbergMarquardt; }
+    /** Whether track() uses the Levenberg-Marquardt solver, as determined by
+        the last call to assemble(). */
+    bool isTrackingWithLevenbergMarquardt() const
+    {   return _levenbergMarquardt.enabled; }
+    /** The number of Levenberg-Marquardt iterations taken by the last call to
+        track(), or 0 if the frame was tracked by the SimTK::Assembler. */
+    int getNumIterations() const { return _numIterations; }
 
     /** Return the number of markers used to solve for model coordinates.
         It is a count of the number of markers in the intersection of 
@@ -138,6 +165,16 @@ public:
     passed in when the solver was constructed. */
     void updateOrientationWeights(const SimTK::Array_<double> &weights);
 
+    /** Match the given orientations, instead of the values of the
+    OrientationsReference at the time of the state, when assemble() or track()
+    is called next and thereafter. The orientations are in the same order as
+    the names of the OrientationsReference that was passed in when the solver
+    was constructed. This is useful to track orientations that are not known
+    in advance (e.g., streamed from IMUs). */
+    void setOrientationValues(const SimTK::Array_<SimTK::Rotation>& values);
+    /** Return to matching the values of the OrientationsReference. */
+    void clearOrientationValues() { _useOrientationValues = false; }
+
     /** Compute and return a marker's spatial location in the ground frame,
         given the marker's name. */
     SimTK::Vec3 computeCurrentMarkerLocation(const std::string &markerName);
@@ -221,6 +258,22 @@ private:
         assembly problem. */
     void setupOrientationsGoal(SimTK::State &s);
 
+    /** Determine whether track() can use the Levenberg-Marquardt solver and,
+        if so, the free Qs that each of its goals depends on. */
+    void setupLevenbergMarquardt(const SimTK::State &s);
+    /** Track the goals with the Levenberg-Marquardt solver. */
+    void trackWithLevenbergMarquardt(SimTK::State &s);
+    /** The weighted sum of squared goal errors (as for the SimTK::Assembler)
+        for the configuration of `s`, which must be realized to Position. */
+    double calcLevenbergMarquardtCost(const SimTK::State &s) const;
+    /** Form the normal equations H = ~J*J and g = ~J*r of the goal residuals
+        r with respect to the free Qs for the configuration of `s`. */
+    void calcLevenbergMarquardtNormalEquations(const SimTK::State &s,
+            SimTK::Matrix &H, SimTK::Vector &g) const;
+    /** Copy the free Qs from or into the Qs of a state. */
+    void getFreeQs(const SimTK::State &s, SimTK::Vector &freeQs) const;
+    void setFreeQs(const SimTK::Vector &freeQs, SimTK::State &s) const;
+
     // The marker reference values and weightings
     MarkersReference _markersReference;
 
@@ -236,11 +289,47 @@ private:
 
     // Private cache of the orientation values to be matched at a given state
     SimTK::Array_<SimTK::Rotation> _orientationValues;
+    // Whether _orientationValues were provided with setOrientationValues()
+    // rather than obtained from _orientationsReference.
+    bool _useOrientationValues = false;
 
     // OrientationSensors collectively form a single assembly condition for
     // the SimTK::Assembler and the memory is managed by the Assembler
     SimTK::ReferencePtr<SimTK::OrientationSensors> _orientationAssemblyCondition;
 
+    // Whether the user asked to track with the Levenberg-Marquardt solver.
+    bool _useLevenbergMarquardt = false;
+    // The number of Levenberg-Marquardt iterations of the last track().
+    int _numIterations = 0;
+
+    // The goals of the Levenberg-Marquardt solver in terms of the free Qs of
+    // the Assembler (in the order of its FreeQIndex).
+    struct LevenbergMarquardtGoals {
+        bool enabled = false;
+        // The QIndex of each free Q.
+        std::vector<int> qIndices;
+        // For each marker (in the order of its MarkerIx): its body, station,
+        // observation, and the free Qs of the mobilizers between its body and
+        // ground, which are the only nonzero columns of its Jacobian.
+        SimTK::Array_<SimTK::MobilizedBodyIndex> markerBodies;
+        SimTK::Array_<SimTK::Vec3> markerStations;
+        std::vector<int> markerObservations;
+        std::vector<std::vector<int>> markerFreeQs;
+        // The sum of the marker weights, which normalizes the marker errors.
+        double totalMarkerWeight = 0;
+        // For each coordinate goal: its reference and free Q.
+        std::vector<int> coordinateReferences;
+        std::vector<int> coordinateFreeQs;
+        // The free Qs of clamped coordinates and their ranges.
+        std::vector<int> clampedFreeQs;
+        std::vector<SimTK::Vec2> clampedRanges;
+        // The solutions of the last two frames, to predict the next one.
+        int numPreviousFrames = 0;
+        double previousTimes[2] = {0, 0};
+        SimTK::Vector previousFreeQs[2];
+    };
+    LevenbergMarquardtGoals _levenbergMarquardt;
+
 //=============================================================================
 };  // END of class InverseKinematicsSolver
 //=============================================================================
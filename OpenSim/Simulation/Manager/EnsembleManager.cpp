@@ -0,0 +1,137 @@
+/* -------------------------------------------------------------------------- *
+ *                       OpenSim:  EnsembleManager.cpp                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "EnsembleManager.h"
+
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/Stopwatch.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <memory>
+#include <mutex>
+
+using namespace OpenSim;
+
+EnsembleManager::EnsembleManager(const Model& model) : _model(model) {
+    OPENSIM_THROW_IF(!model.hasSystem(), Exception,
+            "Expected the model to have a System; call initSystem() on the "
+            "model before creating an EnsembleManager.");
+}
+
+int EnsembleManager::addMember(const SimTK::State& initialState,
+        double finalTime, ModelModifier modifyModel) {
+    OPENSIM_THROW_IF(finalTime < initialState.getTime(), Exception,
+            "Expected the final time ({}) to be no earlier than the time of "
+            "the initial state ({}).",
+            finalTime, initialState.getTime());
+    OPENSIM_THROW_IF(initialState.getNY() != _model.getWorkingState().getNY(),
+            Exception,
+            "Expected the initial state to have {} continuous state "
+            "variables, but it has {}.",
+            _model.getWorkingState().getNY(), initialState.getNY());
+    _members.push_back({initialState, finalTime, std::move(modifyModel)});
+    return (int)_members.size() - 1;
+}
+
+std::vector<EnsembleMemberResult> EnsembleManager::integrate() const {
+    const int numMembers = getNumMembers();
+    std::vector<EnsembleMemberResult> results(numMembers);
+    if (numMembers == 0) return results;
+    const int numThreads = getNumThreadsForTasks(_numThreads, numMembers);
+
+    // Copy the model for each thread on this thread. Members that modify
+    // the model get their own copy, made (serially) when they start.
+    std::mutex copyMutex;
+    auto copyModel = [&]() {
+        std::unique_ptr<Model> copy;
+        {
+            std::lock_guard<std::mutex> lock(copyMutex);
+            copy.reset(_model.clone());
+        }
+        copy->updAnalysisSet().setSize(0);
+        return copy;
+    };
+    std::vector<std::unique_ptr<Model>> models(numThreads);
+    for (auto& model : models) model = copyModel();
+    std::vector<SimTK::State> defaultStates(numThreads);
+
+    executeInParallel(numMembers, numThreads, [&](int thread, int imember) {
+        const Member& member = _members[imember];
+        results[imember].threadIndex = thread;
+        if (member.modifyModel) {
+            std::unique_ptr<Model> model = copyModel();
+            member.modifyModel(*model);
+            SimTK::State defaultState = model->initSystem();
+            integrateMember(*model, defaultState, member, results[imember]);
+        } else {
+            Model& model = *models[thread];
+            if (!model.hasSystem()) defaultStates[thread] = model.initSystem();
+            integrateMember(model, defaultStates[thread], member,
+                    results[imember]);
+        }
+    });
+    return results;
+}
+
+void EnsembleManager::integrateMember(Model& model,
+        const SimTK::State& defaultState, const Member& member,
+        EnsembleMemberResult& result) const {
+    OPENSIM_THROW_IF(member.initialState.getNY() != defaultState.getNY(),
+            Exception,
+            "Expected the model to have {} continuous state variables after "
+            "modification, but it has {}.",
+            member.initialState.getNY(), defaultState.getNY());
+    SimTK::State state = defaultState;
+    state.setTime(member.initialState.getTime());
+    state.updY() = member.initialState.getY();
+    model.getMultibodySystem().realize(state, SimTK::Stage::Velocity);
+
+    Manager manager(model);
+    manager.setPerformAnalyses(false);
+    manager.setWriteToStorage(false);
+    manager.setIntegratorMethod(_integratorMethod);
+    if (_integratorAccuracy > 0)
+        manager.setIntegratorAccuracy(_integratorAccuracy);
+    if (_integratorMaximumStepSize > 0)
+        manager.setIntegratorMaximumStepSize(_integratorMaximumStepSize);
+
+    Stopwatch watch;
+    manager.initialize(state);
+    result.states.append(manager.getState());
+    if (_reportingInterval > 0) {
+        const double initialTime = state.getTime();
+        for (int i = 1;; ++i) {
+            const double time = initialTime + i * _reportingInterval;
+            if (time >= member.finalTime) break;
+            result.states.append(manager.integrate(time));
+        }
+    }
+    if (member.finalTime > state.getTime()) {
+        result.states.append(manager.integrate(member.finalTime));
+    }
+    result.realTime = watch.getElapsedTime();
+
+    const SimTK::Integrator& integrator = manager.getIntegrator();
+    result.numStepsTaken = integrator.getNumStepsTaken();
+    result.numStepsAttempted = integrator.getNumStepsAttempted();
+    result.numRealizations = integrator.getNumRealizations();
+}
@@ -0,0 +1,156 @@
+#ifndef OPENSIM_ENSEMBLE_MANAGER_H_
+#define OPENSIM_ENSEMBLE_MANAGER_H_
+/* -------------------------------------------------------------------------- *
+ *                        OpenSim:  EnsembleManager.h                         *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "Manager.h"
+#include <OpenSim/Simulation/StatesTrajectory.h>
+
+#include <functional>
+#include <vector>
+
+namespace OpenSim {
+
+class Model;
+
+/** The outcome of simulating one member of an EnsembleManager. */
+struct OSIMSIMULATION_API EnsembleMemberResult {
+    /** The states at the start of the simulation, at each reporting time
+    (see EnsembleManager::setReportingInterval()), and at the final time. */
+    StatesTrajectory states;
+    /** Wall-clock time spent integrating this member (seconds), excluding
+    the time to copy and initialize its model. */
+    double realTime = 0;
+    /** Integrator statistics (see SimTK::Integrator). */
+    int numStepsTaken = 0;
+    int numStepsAttempted = 0;
+    int numRealizations = 0;
+    /** Index of the thread that simulated this member. */
+    int threadIndex = 0;
+};
+
+/** Run many forward simulations of the same Model concurrently, without
+re-reading the model for each simulation. This is useful for sweeps over
+initial conditions or model parameters (e.g., muscle properties).
+
+Each member of the ensemble has its own initial state and final time, and can
+optionally modify the model before it is simulated. Members are integrated by
+a pool of threads: each thread takes the next member that has not been
+started, so members that take longer to simulate do not hold up the others.
+Each thread integrates with its own copy of the model, using a Manager
+configured with the integrator settings of this EnsembleManager. Analyses in
+the model are not run and the Manager does not record a state Storage; use the
+StatesTrajectory of each member's result instead.
+
+@code
+Model model("arm26.osim");
+SimTK::State& state = model.initSystem();
+EnsembleManager ensemble(model);
+for (int i = 0; i < 100; ++i) {
+    model.getCoordinateSet().get(0).setValue(state, 0.01 * i);
+    ensemble.addMember(state, 1.0);
+}
+ensemble.addMember(state, 1.0, [](Model& m) {
+    m.updComponent<Muscle>("/forceset/BIClong").set_max_isometric_force(0);
+});
+std::vector<EnsembleMemberResult> results = ensemble.integrate();
+@endcode
+
+The initial state of each member must be a state of the model passed to the
+constructor (after initSystem()); its time and continuous state variables
+(Q, U, and Z) are copied into the state of the model copy used for the
+simulation. A function that modifies the model must not change the model's
+state variables (e.g., by adding or removing components with states).
+
+The model must not be modified while integrate() is running. */
+class OSIMSIMULATION_API EnsembleManager {
+public:
+    /** A function that edits a copy of the model before the member is
+    simulated. The copy is (re)initialized afterwards. */
+    typedef std::function<void(Model&)> ModelModifier;
+
+    /** The model must have been finalized (e.g., with initSystem()) and
+    must outlive this EnsembleManager. */
+    explicit EnsembleManager(const Model& model);
+
+    /** Add a member that starts from `initialState` and is integrated until
+    `finalTime`. If `modifyModel` is provided, it is applied to a fresh copy
+    of the model that is used only for this member.
+    @returns the index of the member, which is also its index in the vector
+    returned by integrate(). */
+    int addMember(const SimTK::State& initialState, double finalTime,
+            ModelModifier modifyModel = nullptr);
+    int getNumMembers() const { return (int)_members.size(); }
+    /** Remove all members. */
+    void clearMembers() { _members.clear(); }
+
+    /** The number of threads used to integrate members concurrently. A value
+    of 0 or less (the default) uses all available hardware threads. */
+    void setNumThreads(int numThreads) { _numThreads = numThreads; }
+    int getNumThreads() const { return _numThreads; }
+
+    /** Record the state of each member every `interval` seconds (in addition
+    to the initial and final states). A value of 0 or less (the default)
+    records only the initial and final states. */
+    void setReportingInterval(double interval) { _reportingInterval = interval; }
+    double getReportingInterval() const { return _reportingInterval; }
+
+    /** @name Configure the integrator used for each member
+    See the corresponding methods on Manager.
+    @{ */
+    void setIntegratorMethod(Manager::IntegratorMethod method)
+    {   _integratorMethod = method; }
+    void setIntegratorAccuracy(double accuracy)
+    {   _integratorAccuracy = accuracy; }
+    void setIntegratorMaximumStepSize(double hmax)
+    {   _integratorMaximumStepSize = hmax; }
+    /** @} */
+
+    /** Integrate all members. The results are in the same order as the
+    members. If the simulation of any member throws an exception, no further
+    members are started and the first exception is rethrown once the members
+    in progress have finished. */
+    std::vector<EnsembleMemberResult> integrate() const;
+
+private:
+    struct Member {
+        SimTK::State initialState;
+        double finalTime;
+        ModelModifier modifyModel;
+    };
+
+    void integrateMember(Model& model, const SimTK::State& defaultState,
+            const Member& member, EnsembleMemberResult& result) const;
+
+    const Model& _model;
+    std::vector<Member> _members;
+    int _numThreads = 0;
+    double _reportingInterval = 0;
+    Manager::IntegratorMethod _integratorMethod =
+            Manager::IntegratorMethod::RungeKuttaMerson;
+    double _integratorAccuracy = -1;
+    double _integratorMaximumStepSize = -1;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_ENSEMBLE_MANAGER_H_
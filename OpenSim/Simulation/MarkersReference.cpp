@@ -132,6 +132,7 @@ populateFromMarkerData(const TimeSeriesTable_<SimTK::Vec3>& markerTable,
     }
 
     // Names must be assigned before weights can be updated
+    clearObjectIsUpToDateWithProperties();
     updateInternalWeights();
 }
 
@@ -157,11 +158,33 @@ const SimTK::Array_<std::string>& MarkersReference::getNames() const {
 
 void MarkersReference::getValues(const SimTK::State& s,
                                   SimTK::Array_<Vec3>& values) const {
-    double time = s.getTime();
-    const auto rowView = _markerTable.getNearestRow(time);
-    values.clear();
-    for(int i = 0; i < rowView.ncol(); ++i)
-        values.push_back(rowView[i]);
+    const double time = s.getTime();
+    _cursor = _markerTable.getRowIndexAtOrBeforeTime(time, _cursor);
+    const auto& times = _markerTable.getIndependentColumn();
+    const SimTK::Real eps = SimTK::SignificantReal;
+    OPENSIM_THROW_IF(time < times.front() - eps || time > times.back() + eps,
+                     TimeOutOfRange, time, times.front(), times.back());
+
+    const int nc = int(_markerTable.getNumColumns());
+    values.resize(nc);
+    size_t row = _cursor;
+    if (row + 1 < times.size()) {
+        const double before = time - times[row];
+        const double after = times[row + 1] - time;
+        if (_interpolateValues && before > 0) {
+            const double alpha = before / (before + after);
+            const auto rowBefore = _markerTable.getRowAtIndex(row);
+            const auto rowAfter = _markerTable.getRowAtIndex(row + 1);
+            for (int i = 0; i < nc; ++i)
+                values[i] = (1 - alpha) * rowBefore[i] + alpha * rowAfter[i];
+            return;
+        }
+        // Same choice of the nearest frame as getNearestRow().
+        if (after <= before) ++row;
+    }
+    const auto rowView = _markerTable.getRowAtIndex(row);
+    for (int i = 0; i < nc; ++i)
+        values[i] = rowView[i];
 }
 
 // void
@@ -219,6 +242,9 @@ MarkersReference::updateInternalWeights() const {
             _weights[ix] = get_marker_weights()[wix].getWeight();
         ++ix;
     }
+    // The weights are a cache of the properties, which remains valid until a
+    // property is changed.
+    const_cast<MarkersReference*>(this)->setObjectIsUpToDateWithProperties();
 }
 
 int
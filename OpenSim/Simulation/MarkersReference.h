@@ -141,7 +141,13 @@ public:
     SimTK::Vec2 getValidTimeRange() const override;
     /** get the names of the markers serving as references */
     const SimTK::Array_<std::string>& getNames() const override;
-    /** get the value of the MarkersReference */
+    /** get the value of the MarkersReference at the time of the state: the
+        marker locations of the nearest frame or, if interpolating (see
+        setInterpolateValues()), interpolated linearly between the frames
+        before and after. A marker is NaN if it is missing from either of
+        those frames. The frame is found from the one found by the previous
+        call, so that successive times are found in constant time, and
+        `values` is only reallocated if it is too small. */
     void getValues(const SimTK::State &s,
         SimTK::Array_<SimTK::Vec3> &values) const override;
     // The following two methods are commented out as they are not implemented
@@ -154,7 +160,8 @@ public:
     // virtual void getAccelerationValues(const SimTK::State &s,
     //     SimTK::Array_<SimTK::Vec3> &accValues) const;
     /** get the weighting (importance) of meeting this MarkersReference in the
-        same order as names*/
+        same order as names. The weights are only rebuilt when the properties
+        of this MarkersReference have changed. */
     void getWeights(const SimTK::State &s,
                     SimTK::Array_<double> &weights) const override;
     /** get the marker trajectories in a table*/
@@ -173,6 +180,12 @@ public:
         no effect on the marker weights associated with this Reference. */
     void setMarkerWeightSet(const Set<MarkerWeight>& markerWeights);
     void setDefaultWeight(double weight);
+    /** Interpolate the marker locations linearly for times between frames,
+        instead of using the nearest frame (the default). This allows solving
+        at times other than those of the marker data. */
+    void setInterpolateValues(bool interpolate)
+    {   _interpolateValues = interpolate; }
+    bool getInterpolateValues() const { return _interpolateValues; }
     size_t getNumFrames() const;
 
 private:
@@ -189,6 +202,10 @@ private:
     //    TimeSeriesTable_<SimTK::Vec3> _markerTable;
     // List of weights guaranteed to be in the same order as marker names.
     mutable SimTK::Array_<double> _weights;
+    // Whether getValues() interpolates between frames.
+    bool _interpolateValues = false;
+    // Index of the frame at or before the time of the last getValues().
+    mutable size_t _cursor = 0;
 //=============================================================================
 };  // END of class MarkersReference
 //=============================================================================
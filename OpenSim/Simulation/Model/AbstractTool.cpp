@@ -32,6 +32,7 @@
 #include "Model.h"
 #include <OpenSim/Simulation/SimbodyEngine/SimbodyEngine.h>
 #include <OpenSim/Simulation/Control/ControlSetController.h>
+#include <OpenSim/Simulation/SimulationUtilities.h>
 using namespace OpenSim;
 using namespace SimTK;
 using namespace std;
@@ -395,7 +396,7 @@ loadModel(const string &aToolSetupFileName, ForceSet *rOriginalForceSet )
     Model *model = 0;
 
     try {
-        model = new Model(_modelFile);
+        model = loadToolModel(_modelFile).release();
         model->finalizeFromProperties();
         if (rOriginalForceSet!=NULL)
             *rOriginalForceSet = model->getForceSet();
@@ -188,6 +188,16 @@ public:
 
     virtual bool proceed(int aStep=0);
 
+    /**
+     * Whether the results of this analysis at each step depend only on the
+     * state at that step, so that different steps can be analyzed
+     * concurrently by copies of the analysis (each with its own copy of the
+     * model) whose results are then appended in order (see AnalyzeTool).
+     * An analysis that returns true must list every storage it records into
+     * in getStorageList(). The default is false.
+     */
+    virtual bool isFrameIndependent() const { return false; }
+
     //--------------------------------------------------------------------------
     // GET AND SET
     //--------------------------------------------------------------------------
@@ -99,25 +99,24 @@ SimTK::ContactGeometry::TriangleMesh* ContactMesh::
     SimTK::PolygonalMesh mesh;
     std::ifstream file;
     assert (_model);
-    const std::string& savedCwd = IO::getCwd();
-    bool restoreDirectory = false;
+    // The mesh file is relative to the model file (unless it is absolute).
+    // Do not change the working directory to find it, since other threads
+    // may be using it.
+    std::string path = filename;
     if ((_model->getInputFileName()!="")
             && (_model->getInputFileName()!="Unassigned")) {
-        std::string parentDirectory = IO::getParentDirectory(
-                _model->getInputFileName());
-        IO::chDir(parentDirectory);
-        restoreDirectory=true;
+        const std::string besideModel =
+                IO::getParentDirectory(_model->getInputFileName()) + filename;
+        if (IO::FileExists(besideModel)) path = besideModel;
     }
-    file.open(filename.c_str());
+    file.open(path.c_str());
     if (file.fail()){
-        if (restoreDirectory) IO::chDir(savedCwd);
         throw Exception("Error loading mesh file: "+filename+". "
                 "The file should exist in same folder with model.\n "
                 "Loading is aborted.");
     }
     file.close();
-    mesh.loadFile(filename);
-    if (restoreDirectory) IO::chDir(savedCwd);
+    mesh.loadFile(path);
     _decorativeGeometry.reset(new SimTK::DecorativeMesh(mesh));
     return new SimTK::ContactGeometry::TriangleMesh(mesh);
 }
@@ -32,6 +32,13 @@ using namespace std;
 using namespace SimTK;
 using namespace OpenSim;
 
+// Variables of the stiffness expressions, in the order of the deflections
+// returned by computeDeflection().
+static const std::vector<std::string>& getDeflectionVariableNames() {
+    static const std::vector<std::string> names{
+        "theta_x", "theta_y", "theta_z", "delta_x", "delta_y", "delta_z"};
+    return names;
+}
 
 // string formatting helper utility
 
@@ -221,7 +228,7 @@ void ExpressionBasedBushingForce::setMxExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_Mx_expression(expression);
-    MxProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    MxProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 
 /** Set the expression for the My function and create it's lepton program */
@@ -231,7 +238,7 @@ void ExpressionBasedBushingForce::setMyExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_My_expression(expression);
-    MyProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    MyProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 
 /** Set the expression for the Mz function and create it's lepton program */
@@ -240,7 +247,7 @@ void ExpressionBasedBushingForce::setMzExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_Mz_expression(expression);
-    MzProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    MzProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 
 /** Set the expression for the Fx function and create it's lepton program */
@@ -249,7 +256,7 @@ void ExpressionBasedBushingForce::setFxExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_Fx_expression(expression);
-    FxProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    FxProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 
 /** Set the expression for the Fy function and create it's lepton program */
@@ -258,7 +265,7 @@ void ExpressionBasedBushingForce::setFyExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_Fy_expression(expression);
-    FyProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    FyProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 
 /** Set the expression for the Fz function and create it's lepton program */
@@ -267,7 +274,7 @@ void ExpressionBasedBushingForce::setFzExpression(std::string expression)
     expression.erase( remove_if(expression.begin(), expression.end(), ::isspace), 
                         expression.end() );
     set_Fz_expression(expression);
-    FzProg = Lepton::Parser::parse(expression).optimize().createProgram();
+    FzProg = ExpressionEvaluator(expression, getDeflectionVariableNames());
 }
 //=============================================================================
 // COMPUTATION
@@ -282,21 +289,13 @@ SimTK::Vec6 ExpressionBasedBushingForce::
 
     Vec6 fk = Vec6(0.0);
 
-    std::map<std::string, double> deflectionVars;
-    deflectionVars["theta_x"] = dq[0];
-    deflectionVars["theta_y"] = dq[1];
-    deflectionVars["theta_z"] = dq[2];
-    deflectionVars["delta_x"] = dq[3];
-    deflectionVars["delta_y"] = dq[4];
-    deflectionVars["delta_z"] = dq[5];
-
-
-    fk[0] = MxProg.evaluate(deflectionVars);
-    fk[1] = MyProg.evaluate(deflectionVars);
-    fk[2] = MzProg.evaluate(deflectionVars);
-    fk[3] = FxProg.evaluate(deflectionVars);
-    fk[4] = FyProg.evaluate(deflectionVars);
-    fk[5] = FzProg.evaluate(deflectionVars);
+    // The deflections are ordered as in getDeflectionVariableNames().
+    fk[0] = MxProg.evaluate(&dq[0]);
+    fk[1] = MyProg.evaluate(&dq[0]);
+    fk[2] = MzProg.evaluate(&dq[0]);
+    fk[3] = FxProg.evaluate(&dq[0]);
+    fk[4] = FyProg.evaluate(&dq[0]);
+    fk[5] = FzProg.evaluate(&dq[0]);
 
     return -fk;
 }
@@ -26,6 +26,7 @@
 
 // INCLUDE
 #include "Force.h"
+#include "ExpressionEvaluator.h"
 #include <OpenSim/Simulation/Model/TwoFrameLinker.h>
 
 namespace OpenSim {
@@ -272,8 +273,10 @@ private:
 
     SimTK::Mat66 _dampingMatrix{ 0.0 };
 
-    // parser programs for efficiently evaluating the expressions
-    Lepton::ExpressionProgram MxProg, MyProg, MzProg, FxProg, FyProg, FzProg;
+    // compiled expressions for efficiently evaluating the stiffness forces
+    // with the deflection variables theta_x, theta_y, theta_z, delta_x,
+    // delta_y, delta_z (in that order)
+    ExpressionEvaluator MxProg, MyProg, MzProg, FxProg, FyProg, FzProg;
 
 //==============================================================================
 };  // END of class ExpressionBasedBushingForce
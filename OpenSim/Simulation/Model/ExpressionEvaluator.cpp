@@ -0,0 +1,74 @@
+/* -------------------------------------------------------------------------- *
+ *                    OpenSim:  ExpressionEvaluator.cpp                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "ExpressionEvaluator.h"
+
+#include <lepton/Exception.h>
+#include <lepton/ParsedExpression.h>
+#include <lepton/Parser.h>
+
+#include <algorithm>
+
+using namespace OpenSim;
+
+ExpressionEvaluator::ExpressionEvaluator(const std::string& expression,
+        const std::vector<std::string>& variableNames) :
+        _compiled(Lepton::Parser::parse(expression).optimize()
+                .createCompiledExpression()),
+        _variableNames(variableNames), _hasExpression(true) {
+    // Lepton::ExpressionProgram::evaluate() checks this on every evaluation;
+    // a compiled expression would silently use the value left in its
+    // workspace.
+    for (const auto& name : _compiled.getVariables()) {
+        if (std::find(_variableNames.begin(), _variableNames.end(), name) ==
+                _variableNames.end())
+            throw Lepton::Exception(
+                    "No value specified for variable " + name);
+    }
+    bindVariables();
+}
+
+ExpressionEvaluator::ExpressionEvaluator(const ExpressionEvaluator& other) :
+        _compiled(other._compiled), _variableNames(other._variableNames),
+        _hasExpression(other._hasExpression) {
+    bindVariables();
+}
+
+ExpressionEvaluator& ExpressionEvaluator::operator=(
+        const ExpressionEvaluator& other) {
+    if (&other != this) {
+        _compiled = other._compiled;
+        _variableNames = other._variableNames;
+        _hasExpression = other._hasExpression;
+        bindVariables();
+    }
+    return *this;
+}
+
+void ExpressionEvaluator::bindVariables() {
+    const auto& used = _compiled.getVariables();
+    _variables.assign(_variableNames.size(), nullptr);
+    for (size_t i = 0; i < _variableNames.size(); ++i) {
+        if (used.count(_variableNames[i]))
+            _variables[i] = &_compiled.getVariableReference(_variableNames[i]);
+    }
+}
@@ -0,0 +1,91 @@
+#ifndef OPENSIM_EXPRESSION_EVALUATOR_H_
+#define OPENSIM_EXPRESSION_EVALUATOR_H_
+/* -------------------------------------------------------------------------- *
+ *                     OpenSim:  ExpressionEvaluator.h                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Common/Exception.h>
+#include <OpenSim/Simulation/osimSimulationDLL.h>
+#include <lepton/CompiledExpression.h>
+
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace OpenSim {
+
+/** (Internal use only) A mathematical expression (parsed by Lepton) that is
+compiled for repeated evaluation with a fixed, ordered list of variables.
+Evaluating a Lepton::ExpressionProgram requires a std::map from variable name
+to value, which is built and searched on every evaluation. Here, the memory
+location of each variable in the compiled expression is resolved once, so
+evaluate() involves no string lookup or allocation.
+
+Variables in the list that do not appear in the expression are ignored, but
+every variable in the expression must be in the list. Like
+Lepton::CompiledExpression, an ExpressionEvaluator must not be evaluated from
+two threads at the same time. */
+class OSIMSIMULATION_API ExpressionEvaluator {
+public:
+    ExpressionEvaluator() = default;
+    /** Parse, optimize, and compile `expression`. The values passed to
+    evaluate() are assigned to `variableNames` in order.
+    @throws Lepton::Exception if the expression cannot be parsed or uses a
+    variable that is not in `variableNames`. */
+    ExpressionEvaluator(const std::string& expression,
+            const std::vector<std::string>& variableNames);
+    ExpressionEvaluator(const ExpressionEvaluator& other);
+    ExpressionEvaluator& operator=(const ExpressionEvaluator& other);
+
+    /** Evaluate the expression. `values` must contain one value for each
+    of the variable names provided to the constructor, in the same order. */
+    double evaluate(const double* values) const {
+        OPENSIM_THROW_IF(!_hasExpression, Exception,
+                "ExpressionEvaluator has no expression to evaluate.");
+        for (size_t i = 0; i < _variables.size(); ++i)
+            if (_variables[i]) *_variables[i] = values[i];
+        return _compiled.evaluate();
+    }
+    /** @copydoc evaluate(const double*) const */
+    double evaluate(std::initializer_list<double> values) const {
+        return evaluate(values.begin());
+    }
+
+    /** Get the number of variables that evaluate() expects. */
+    int getNumVariables() const { return (int)_variableNames.size(); }
+
+private:
+    // Resolve the memory location of each variable in _compiled.
+    void bindVariables();
+
+    Lepton::CompiledExpression _compiled;
+    std::vector<std::string> _variableNames;
+    // Location of each variable in _compiled (nullptr if the variable does
+    // not appear in the expression). These point into _compiled, so they are
+    // re-resolved whenever _compiled is copied.
+    std::vector<double*> _variables;
+    // False for a default-constructed evaluator.
+    bool _hasExpression = false;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_EXPRESSION_EVALUATOR_H_
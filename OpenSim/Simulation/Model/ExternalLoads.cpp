@@ -157,20 +157,18 @@ void ExternalLoads::extendConnectToModel(Model& aModel)
     Storage *forceData = nullptr;
     auto loadDataFromDirectoryAdjacentToFile =
         [this, &forceData](const std::string& filepath) {
-            // Change working directory the ExternalLoads location
-            std::string savedCwd = IO::getCwd();
-            IO::chDir(IO::getParentDirectory(filepath));
+            // Read the data file relative to the ExternalLoads location,
+            // without changing the working directory, which other threads
+            // (e.g., other tools) may be using.
             try {
-                forceData = new Storage(this->_dataFileName);
+                forceData = new Storage(IO::getParentDirectory(filepath) +
+                                        this->_dataFileName);
             }
             catch (const std::exception &ex) {
                 log_error("Failed to read ExternalLoads data file '{}'.",
                         this->_dataFileName);
-                if (this->getDocument())
-                    IO::chDir(savedCwd);
                 throw(ex);
             }
-            IO::chDir(savedCwd);
     };
     if (_dataFileName.length() > 0) {
         if(IO::FileExists(_dataFileName))
@@ -421,32 +419,29 @@ void ExternalLoads::updateFromXMLNode(SimTK::Xml::Element& aNode, int versionNum
             // This is now unnecessary since we dropped supoprt for external_loads_model_kinematics_file
                 // _lowpassCutoffFrequencyForLoadKinematics = kinFilterNode->getValueAs<double>();
             }
-            bool changeWorkingDir = false;
-            std::string savedCwd;
-            // Change to directory of Document
-            if(!ifstream(_dataFileName.c_str(), ios_base::in).good()) {
+            std::string dataFileName = _dataFileName;
+            if(!ifstream(dataFileName.c_str(), ios_base::in).good()) {
             string msg =
                     "Object: Could not open file " + _dataFileName+ "IO. It may not exist or you don't have permission to read it.";
                 log_error(msg);
-                // Try switching to directory of setup file before aborting
+                // Try the directory of setup file before aborting (without
+                // changing the working directory, which other threads may
+                // be using).
                 if(getDocument()) {
-                    savedCwd = IO::getCwd();
-                    IO::chDir(IO::getParentDirectory(getDocument()->getFileName()));
-                    changeWorkingDir=true;
+                    dataFileName = IO::getParentDirectory(
+                            getDocument()->getFileName()) + _dataFileName;
                 }
-                if(!ifstream(_dataFileName.c_str(), ios_base::in).good()) {
-                    if(changeWorkingDir) IO::chDir(savedCwd);
+                if(!ifstream(dataFileName.c_str(), ios_base::in).good()) {
             throw Exception(msg,__FILE__,__LINE__);
                 }
             }
-            Storage* dataSource = new Storage(_dataFileName, true);
+            Storage* dataSource = new Storage(dataFileName, true);
             if (!dataSource->makeStorageLabelsUnique()){
-                log_info("Making labels unique in storage file {}", _dataFileName);
-                dataSource = new Storage(_dataFileName);
+                log_info("Making labels unique in storage file {}", dataFileName);
+                dataSource = new Storage(dataFileName);
                 dataSource->makeStorageLabelsUnique();
-                dataSource->print(_dataFileName);
+                dataSource->print(dataFileName);
             }
-            if(changeWorkingDir) IO::chDir(savedCwd);
             
             const Array<string> &labels = dataSource->getColumnLabels();
             // Populate data file and other things that haven't changed
@@ -82,6 +82,16 @@ public:
     /** %Set whether or not the Force is applied.                             */
     void setAppliesForce(SimTK::State& s, bool applyForce) const;
 
+    /** Compute the body forces (one per mobilized body, including Ground)
+    and generalized forces that this Force applies in the given state, as it
+    would if it were applied, without adding them to the system. The outputs
+    are resized and overwritten. Some Forces, such as a ScalarActuator, have
+    zero force when they are not applied (see appliesForce()). The state
+    must be realized to Stage::Velocity. **/
+    void calcForceContribution(const SimTK::State& s,
+            SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
+            SimTK::Vector& generalizedForces) const;
+
     /**
      * Methods to query a Force for the value actually applied during 
      * simulation. The names of the quantities (column labels) is returned by 
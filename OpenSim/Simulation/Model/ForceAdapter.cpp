@@ -25,6 +25,7 @@
 // INCLUDES
 //=============================================================================
 #include "ForceAdapter.h"
+#include <OpenSim/Common/ComponentProfiler.h>
 
 //=============================================================================
 // STATICS
@@ -46,6 +47,8 @@ void ForceAdapter::calcForce(const SimTK::State& state,
     SimTK::Vector_<SimTK::SpatialVec>& bodyForces,SimTK::Vector_<SimTK::Vec3>& particleForces,
     SimTK::Vector& mobilityForces) const
 {
+    ComponentProfiler::Scope scope(_force->getProfiler(), *_force,
+            "computeForce", SimTK::Stage::Dynamics);
     _force->computeForce(state, bodyForces, mobilityForces);
 }
 
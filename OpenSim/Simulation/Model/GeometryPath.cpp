@@ -29,7 +29,9 @@
 #include "MovingPathPoint.h"
 #include "PointForceDirection.h"
 #include <OpenSim/Simulation/Wrap/PathWrap.h>
+#include <OpenSim/Simulation/Wrap/WrapObject.h>
 #include "Model.h"
+#include <OpenSim/Common/ComponentProfiler.h>
 
 //=============================================================================
 // STATICS
@@ -107,6 +109,17 @@ void GeometryPath::extendConnectToModel(Model& aModel)
     // We consider this cache entry valid any time after it has been created
     // and first marked valid, and we won't ever invalidate it.
     this->_colorCV = addCacheVariable("color", get_Appearance().get_color(), SimTK::Stage::Topology);
+
+    // The length of a path with a surrogate is computed along with its
+    // derivatives with respect to the coordinates of the surrogate.
+    this->_lengthGradientCV = addCacheVariable("length_gradient",
+            SimTK::Vector(), SimTK::Stage::Position);
+}
+
+ void GeometryPath::extendRealizeTopology(SimTK::State& s) const
+{
+    Super::extendRealizeTopology(s);
+    clearLastPath();
 }
 
  void GeometryPath::extendInitStateFromProperties(SimTK::State& s) const
@@ -194,6 +207,8 @@ void GeometryPath::constructProperties()
     constructProperty_PathPointSet(PathPointSet());
 
     constructProperty_PathWrapSet(PathWrapSet());
+
+    constructProperty_surrogate();
     
     Appearance appearance;
     appearance.set_color(SimTK::Gray);
@@ -305,6 +320,22 @@ void GeometryPath::addInEquivalentForces(const SimTK::State& s,
     SimTK::Vector_<SimTK::SpatialVec>& bodyForces,
     SimTK::Vector& mobilityForces) const
 {
+    if (hasSurrogate()) {
+        // The generalized force on each coordinate is the tension times the
+        // moment arm, -dl/dq.
+        const GeometryPathSurrogate& surrogate = get_surrogate();
+        const SimTK::Vector& gradient = getSurrogateLengthGradient(s);
+        const SimTK::SimbodyMatterSubsystem& matter =
+                getModel().getMatterSubsystem();
+        for (int j = 0; j < surrogate.getNumCoordinates(); ++j) {
+            const Coordinate& coord = surrogate.getCoordinate(j);
+            matter.getMobilizedBody(coord.getBodyIndex()).applyOneMobilityForce(
+                    s, coord.getMobilizerQIndex(), -tension * gradient[j],
+                    mobilityForces);
+        }
+        return;
+    }
+
     AbstractPathPoint* start = NULL;
     AbstractPathPoint* end = NULL;
     const SimTK::MobilizedBody* bo = NULL;
@@ -448,6 +479,10 @@ void GeometryPath::updateGeometry(const SimTK::State& s) const
  */
 double GeometryPath::getLength( const SimTK::State& s) const
 {
+    if (hasSurrogate()) {
+        getSurrogateLengthGradient(s);
+        return getCacheVariableValue(s, _lengthCV);
+    }
     computePath(s);  // compute checks if path needs to be recomputed
     return getCacheVariableValue(s, _lengthCV);
 }
@@ -514,6 +549,7 @@ addPathPoint(const SimTK::State& s, int aIndex, const PhysicalFrame& frame)
     // Now set computed new location into the newPoint
     newPoint->setLocation(newLocation);
     upd_PathPointSet().insert(aIndex, newPoint);
+    clearLastPath();
 
     // Rename the path points starting at this new one.
     namePathPoints(aIndex);
@@ -544,6 +580,7 @@ appendNewPathPoint(const std::string& proposedName,
     newPoint->setName(proposedName);
     newPoint->setLocation(aPositionOnBody);
     upd_PathPointSet().adoptAndAppend(newPoint);
+    clearLastPath();
 
     return newPoint;
 }
@@ -648,6 +685,7 @@ bool GeometryPath::deletePathPoint(const SimTK::State& s, int aIndex)
         return false;
 
     upd_PathPointSet().remove(aIndex);
+    clearLastPath();
 
     // rename the path points starting at the deleted position
     namePathPoints(aIndex);
@@ -710,6 +748,7 @@ replacePathPoint(const SimTK::State& s, AbstractPathPoint* aOldPathPoint,
         }
         if (count >= 2 && index >= 0) {
             upd_PathPointSet().set(index, aNewPathPoint, true);
+            clearLastPath();
             //computePath(s);
             return true;
         }
@@ -730,6 +769,7 @@ void GeometryPath::addPathWrap(WrapObject& aWrapObject)
     newWrap->setMethod(PathWrap::hybrid);
     upd_PathWrapSet().adoptAndAppend(newWrap);
     finalizeFromProperties();
+    clearLastPath();
 }
 
 //_____________________________________________________________________________
@@ -749,6 +789,7 @@ void GeometryPath::moveUpPathWrap(const SimTK::State& s, int aIndex)
         upd_PathWrapSet().remove(aIndex);
         upd_PathWrapSet().insert(aIndex - 1, &wrap);
         upd_PathWrapSet().setMemoryOwner(true);
+        clearLastPath();
     }
 }
 
@@ -769,6 +810,7 @@ void GeometryPath::moveDownPathWrap(const SimTK::State& s, int aIndex)
         upd_PathWrapSet().remove(aIndex);
         upd_PathWrapSet().insert(aIndex + 1, &wrap);
         upd_PathWrapSet().setMemoryOwner(true);
+        clearLastPath();
     }
 }
 
@@ -781,7 +823,7 @@ void GeometryPath::moveDownPathWrap(const SimTK::State& s, int aIndex)
 void GeometryPath::deletePathWrap(const SimTK::State& s, int aIndex)
 {
     upd_PathWrapSet().remove(aIndex);
-
+    clearLastPath();
 }
 
 //==============================================================================
@@ -798,6 +840,7 @@ void GeometryPath::
 extendPostScale(const SimTK::State& s, const ScaleSet& scaleSet)
 {
     Super::extendPostScale(s, scaleSet);
+    clearLastPath();
     computePath(s);
 }
 
@@ -817,6 +860,26 @@ void GeometryPath::computePath(const SimTK::State& s) const
         return;
     }
 
+    // Reuse the last path if the Qs on which it depends have not changed.
+    if (!_pathQIndicesValid) findPathQIndices(s);
+    const SimTK::Vector& q = s.getQ();
+    if (_lastPathValid) {
+        bool changed = false;
+        for (int i = 0; i < (int)_pathQIndices.size() && !changed; ++i)
+            changed = q[_pathQIndices[i]] != _lastPathQ[i];
+        if (!changed) {
+            ++_numPathCacheHits;
+            updCacheVariableValue(s, _currentPathCV) = _lastPath;
+            if (!hasSurrogate()) setLength(s, _lastPathLength);
+            markCacheVariableValid(s, _currentPathCV);
+            return;
+        }
+    }
+    ++_numPathCacheMisses;
+
+    ComponentProfiler::Scope scope(getProfiler(), *this, "computePath",
+            SimTK::Stage::Position);
+
     // Clear the current path.
     Array<AbstractPathPoint*>& currentPath = updCacheVariableValue(s, _currentPathCV);
     currentPath.setSize(0);
@@ -830,9 +893,69 @@ void GeometryPath::computePath(const SimTK::State& s) const
     // Use the current path so far to check for intersection with wrap objects, 
     // which may add additional points to the path.
     applyWrapObjects(s, currentPath);
-    calcLengthAfterPathComputation(s, currentPath);
+    // The length of a path with a surrogate is computed from the surrogate
+    // only, so that it is consistent with its moment arms.
+    if (!hasSurrogate())
+        _lastPathLength = calcLengthAfterPathComputation(s, currentPath);
 
     markCacheVariableValid(s, _currentPathCV);
+
+    _lastPathQ.resize(_pathQIndices.size());
+    for (int i = 0; i < (int)_pathQIndices.size(); ++i)
+        _lastPathQ[i] = q[_pathQIndices[i]];
+    _lastPath = currentPath;
+    _lastPathValid = true;
+}
+
+//_____________________________________________________________________________
+/*
+ * Find the Qs on which the path depends: those of the mobilizers between
+ * ground and the frame of each path point and wrap object, and those of the
+ * coordinates of moving and conditional path points.
+ */
+void GeometryPath::findPathQIndices(const SimTK::State& s) const
+{
+    const SimTK::SimbodyMatterSubsystem& matter =
+            getModel().getMatterSubsystem();
+    std::vector<bool> isPathQ(s.getNQ(), false);
+    auto addFrame = [&](const PhysicalFrame& frame) {
+        SimTK::MobilizedBodyIndex mbx = frame.getMobilizedBodyIndex();
+        while (mbx != SimTK::GroundIndex) {
+            const SimTK::MobilizedBody& mobod = matter.getMobilizedBody(mbx);
+            const int firstQ = mobod.getFirstQIndex(s);
+            for (int i = 0; i < mobod.getNumQ(s); ++i)
+                isPathQ[firstQ + i] = true;
+            mbx = mobod.getParentMobilizedBody().getMobilizedBodyIndex();
+        }
+    };
+    auto addCoordinate = [&](const Coordinate& coord) {
+        const SimTK::MobilizedBody& mobod =
+                matter.getMobilizedBody(coord.getBodyIndex());
+        isPathQ[mobod.getFirstQIndex(s) + coord.getMobilizerQIndex()] = true;
+    };
+
+    for (int i = 0; i < get_PathPointSet().getSize(); ++i) {
+        const AbstractPathPoint& point = get_PathPointSet()[i];
+        addFrame(point.getParentFrame());
+        if (const auto* mpp = dynamic_cast<const MovingPathPoint*>(&point)) {
+            if (mpp->hasXCoordinate()) addCoordinate(mpp->getXCoordinate());
+            if (mpp->hasYCoordinate()) addCoordinate(mpp->getYCoordinate());
+            if (mpp->hasZCoordinate()) addCoordinate(mpp->getZCoordinate());
+        } else if (const auto* cpp =
+                dynamic_cast<const ConditionalPathPoint*>(&point)) {
+            if (cpp->hasCoordinate()) addCoordinate(cpp->getCoordinate());
+        }
+    }
+    for (int i = 0; i < get_PathWrapSet().getSize(); ++i) {
+        if (const WrapObject* wo = get_PathWrapSet()[i].getWrapObject())
+            addFrame(wo->getFrame());
+    }
+
+    _pathQIndices.clear();
+    for (int i = 0; i < (int)isPathQ.size(); ++i)
+        if (isPathQ[i]) _pathQIndices.push_back(i);
+    _pathQIndicesValid = true;
+    _lastPathValid = false;
 }
 
 //_____________________________________________________________________________
@@ -845,6 +968,16 @@ void GeometryPath::computeLengtheningSpeed(const SimTK::State& s) const
         return;
     }
 
+    if (hasSurrogate()) {
+        const GeometryPathSurrogate& surrogate = get_surrogate();
+        const SimTK::Vector& gradient = getSurrogateLengthGradient(s);
+        double speed = 0.0;
+        for (int j = 0; j < surrogate.getNumCoordinates(); ++j)
+            speed += gradient[j] * surrogate.getCoordinate(j).getSpeedValue(s);
+        setLengtheningSpeed(s, speed);
+        return;
+    }
+
     const Array<AbstractPathPoint*>& currentPath = getCurrentPath(s);
 
     double speed = 0.0;
@@ -856,6 +989,21 @@ void GeometryPath::computeLengtheningSpeed(const SimTK::State& s) const
     setLengtheningSpeed(s, speed);
 }
 
+//_____________________________________________________________________________
+/*
+ * Compute the length of the path and its derivatives from the surrogate.
+ */
+const SimTK::Vector& GeometryPath::getSurrogateLengthGradient(
+        const SimTK::State& s) const
+{
+    if (!isCacheVariableValid(s, _lengthGradientCV)) {
+        SimTK::Vector& gradient = updCacheVariableValue(s, _lengthGradientCV);
+        setLength(s, get_surrogate().calcLength(s, gradient));
+        markCacheVariableValid(s, _lengthGradientCV);
+    }
+    return getCacheVariableValue(s, _lengthGradientCV);
+}
+
 //_____________________________________________________________________________
 /*
  * Apply the wrap objects to the current path.
@@ -1147,6 +1295,17 @@ calcLengthAfterPathComputation(const SimTK::State& s,
 double GeometryPath::
 computeMomentArm(const SimTK::State& s, const Coordinate& aCoord) const
 {
+    if (hasSurrogate()) {
+        // The moment arm about a coordinate that the surrogate does not
+        // depend on is computed from the surrogate too (and is 0 unless the
+        // coordinate is coupled to one of its coordinates).
+        const GeometryPathSurrogate& surrogate = get_surrogate();
+        for (int j = 0; j < surrogate.getNumCoordinates(); ++j) {
+            if (&surrogate.getCoordinate(j) == &aCoord)
+                return -getSurrogateLengthGradient(s)[j];
+        }
+    }
+
     if (!_maSolver)
         const_cast<Self*>(this)->_maSolver.reset(new MomentArmSolver(*_model));
 
@@ -29,6 +29,7 @@
 #include "OpenSim/Simulation/Model/ModelComponent.h"
 #include "PathPointSet.h"
 #include <OpenSim/Simulation/Wrap/PathWrapSet.h>
+#include "GeometryPathSurrogate.h"
 #include <OpenSim/Simulation/MomentArmSolver.h>
 
 
@@ -79,6 +80,11 @@ private:
     OpenSim_DECLARE_UNNAMED_PROPERTY(PathWrapSet,
         "The wrap objects that are associated with this path");
 
+    OpenSim_DECLARE_OPTIONAL_PROPERTY(surrogate, GeometryPathSurrogate,
+        "Polynomial from which the length, lengthening speed, and moment "
+        "arms of the path are computed instead of from its points (see "
+        "GeometryPathSurrogate::fit()).");
+
     // used for scaling tendon and fiber lengths
     double _preScaleLength;
 
@@ -91,6 +97,21 @@ private:
     mutable CacheVariable<double> _speedCV;
     mutable CacheVariable<Array<AbstractPathPoint*>> _currentPathCV;
     mutable CacheVariable<SimTK::Vec3> _colorCV;
+    // Derivative of the length with respect to each coordinate of the
+    // surrogate.
+    mutable CacheVariable<SimTK::Vector> _lengthGradientCV;
+
+    // The path computed most recently (in any state), and the values of the
+    // Qs on which the path depends when it was computed. The path is reused
+    // if these Qs have not changed.
+    mutable bool _pathQIndicesValid = false;
+    mutable std::vector<int> _pathQIndices;
+    mutable bool _lastPathValid = false;
+    mutable std::vector<double> _lastPathQ;
+    mutable Array<AbstractPathPoint*> _lastPath;
+    mutable double _lastPathLength = SimTK::NaN;
+    mutable long long _numPathCacheHits = 0;
+    mutable long long _numPathCacheMisses = 0;
     
 //=============================================================================
 // METHODS
@@ -107,6 +128,19 @@ public:
     const PathWrapSet& getWrapSet() const { return get_PathWrapSet(); }
     void addPathWrap(WrapObject& aWrapObject);
 
+    /** Whether the length of the path is computed from a
+    GeometryPathSurrogate. */
+    bool hasSurrogate() const { return !getProperty_surrogate().empty(); }
+    const GeometryPathSurrogate& getSurrogate() const { return get_surrogate(); }
+    /** Compute the length of the path from a copy of `surrogate`. Call
+    Model::initSystem() afterwards. */
+    void setSurrogate(const GeometryPathSurrogate& surrogate) {
+        set_surrogate(surrogate);
+    }
+    /** Compute the length of the path from its points again. Call
+    Model::initSystem() afterwards. */
+    void removeSurrogate() { updProperty_surrogate().clear(); }
+
     //--------------------------------------------------------------------------
     // UTILITY
     //--------------------------------------------------------------------------
@@ -168,6 +202,25 @@ public:
     void getPointForceDirections(const SimTK::State& s, 
         OpenSim::Array<PointForceDirection*> *rPFDs) const;
 
+    /** @name Path cache
+    The path depends only on the Qs of the mobilizers between ground and the
+    frames of its points and wrap objects, and of the coordinates of its
+    MovingPathPoint%s and ConditionalPathPoint%s. When the path must be
+    recomputed for a state but none of these Qs has changed since the path
+    was last computed (e.g., when only the coordinates of other limbs
+    changed), the last path and its length are reused. A hit is such a
+    reuse; a miss is a full computation of the path and its wrapping. Call
+    Model::initSystem() after editing the properties of the path or its
+    points. */
+    /// @{
+    long long getNumPathCacheHits() const { return _numPathCacheHits; }
+    long long getNumPathCacheMisses() const { return _numPathCacheMisses; }
+    void resetPathCacheCounters() const {
+        _numPathCacheHits = 0;
+        _numPathCacheMisses = 0;
+    }
+    /// @}
+
     /** add in the equivalent body and generalized forces to be applied to the 
         multibody system resulting from a tension along the GeometryPath 
     @param state    state used to evaluate forces
@@ -211,6 +264,7 @@ protected:
     void extendConnectToModel(Model& aModel) override;
     void extendInitStateFromProperties(SimTK::State& s) const override;
     void extendAddToSystem(SimTK::MultibodySystem& system) const override;
+    void extendRealizeTopology(SimTK::State& s) const override;
 
     // Visual support GeometryPath drawing in SimTK visualizer.
     void generateDecorations(
@@ -226,6 +280,18 @@ private:
 
     void computePath(const SimTK::State& s ) const;
     void computeLengtheningSpeed(const SimTK::State& s) const;
+    // Find the indices of the Qs on which the path depends.
+    void findPathQIndices(const SimTK::State& s) const;
+    // Forget the last path (and the Qs on which it depends) after the path
+    // has been edited.
+    void clearLastPath() const {
+        _pathQIndicesValid = false;
+        _lastPathValid = false;
+    }
+    // The derivative of the length with respect to each coordinate of the
+    // surrogate, computed (along with the length) if necessary.
+    const SimTK::Vector& getSurrogateLengthGradient(
+            const SimTK::State& s) const;
     void applyWrapObjects(const SimTK::State& s, Array<AbstractPathPoint*>& path ) const;
     double calcPathLengthChange(const SimTK::State& s, const WrapObject& wo, 
                                 const WrapResult& wr, 
@@ -0,0 +1,466 @@
+/* -------------------------------------------------------------------------- *
+ *                  OpenSim:  GeometryPathSurrogate.cpp                       *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "GeometryPathSurrogate.h"
+#include "GeometryPath.h"
+#include "Model.h"
+#include <OpenSim/Simulation/SimbodyEngine/Coordinate.h>
+
+#include <algorithm>
+#include <memory>
+
+using namespace OpenSim;
+
+namespace {
+    // Append the exponents of all terms of total degree `degree` in the
+    // coordinates from `first` on to `exponents`, with the exponent of
+    // coordinate `first` increasing.
+    void appendExponents(int first, int degree, std::vector<int>& term,
+            std::vector<int>& exponents) {
+        if (first == (int)term.size() - 1) {
+            term[first] = degree;
+            exponents.insert(exponents.end(), term.begin(), term.end());
+            return;
+        }
+        for (int e = 0; e <= degree; ++e) {
+            term[first] = e;
+            appendExponents(first + 1, degree - e, term, exponents);
+        }
+    }
+
+    // A copy of a model in which no GeometryPath has a surrogate, used to
+    // compute the exact lengths and moment arms of the paths at random
+    // configurations of the coordinates that are not locked, prescribed, or
+    // dependent.
+    class ExactPathSampler {
+    public:
+        ExactPathSampler(const Model& model, int seed)
+                : _model(model.clone()), _random(0.0, 1.0) {
+            // Collect the paths first: removing a surrogate changes the
+            // subcomponents of its path.
+            std::vector<GeometryPath*> paths;
+            for (auto& path : _model->updComponentList<GeometryPath>())
+                paths.push_back(&path);
+            for (auto* path : paths) path->removeSurrogate();
+            _state = &_model->initSystem();
+
+            for (const auto& path : _model->getComponentList<GeometryPath>())
+                _paths.push_back(&path);
+            for (const auto& coord : _model->getComponentList<Coordinate>()) {
+                if (!coord.getLocked(*_state) && !coord.isPrescribed(*_state)
+                        && !coord.isDependent(*_state))
+                    _coordinates.push_back(&coord);
+            }
+            _random.setSeed(seed);
+        }
+
+        const Model& getModel() const { return *_model; }
+        const SimTK::State& getState() const { return *_state; }
+        const std::vector<const GeometryPath*>& getPaths() const {
+            return _paths;
+        }
+        const std::vector<const Coordinate*>& getCoordinates() const {
+            return _coordinates;
+        }
+
+        // Move the model to a new random configuration.
+        void sample() {
+            for (const auto* coord : _coordinates) {
+                const double min = coord->getRangeMin();
+                const double max = coord->getRangeMax();
+                coord->setValue(*_state, min + (max - min) * _random.getValue(),
+                        false);
+            }
+            if (_model->getNumConstraints() > 0) _model->assemble(*_state);
+            _model->realizePosition(*_state);
+        }
+
+    private:
+        std::unique_ptr<Model> _model;
+        SimTK::State* _state = nullptr;
+        SimTK::Random::Uniform _random;
+        std::vector<const GeometryPath*> _paths;
+        std::vector<const Coordinate*> _coordinates;
+    };
+}
+
+//=============================================================================
+// CONSTRUCTION
+//=============================================================================
+GeometryPathSurrogate::GeometryPathSurrogate()
+{
+    constructProperties();
+}
+
+void GeometryPathSurrogate::constructProperties()
+{
+    constructProperty_coordinates();
+    constructProperty_coordinate_centers();
+    constructProperty_coordinate_half_widths();
+    constructProperty_order(0);
+    constructProperty_coefficients();
+}
+
+int GeometryPathSurrogate::getNumTerms(int numCoordinates, int order)
+{
+    // The binomial coefficient (numCoordinates + order choose order); each
+    // partial product is itself a binomial coefficient, so the division is
+    // exact.
+    int numTerms = 1;
+    for (int i = 1; i <= order; ++i)
+        numTerms = numTerms * (numCoordinates + i) / i;
+    return numTerms;
+}
+
+void GeometryPathSurrogate::extendFinalizeFromProperties()
+{
+    Super::extendFinalizeFromProperties();
+
+    const int n = getNumCoordinates();
+    OPENSIM_THROW_IF_FRMOBJ(getProperty_coordinate_centers().size() != n,
+            InvalidPropertyValue, getProperty_coordinate_centers().getName(),
+            "Expected one center per coordinate.");
+    OPENSIM_THROW_IF_FRMOBJ(getProperty_coordinate_half_widths().size() != n,
+            InvalidPropertyValue,
+            getProperty_coordinate_half_widths().getName(),
+            "Expected one half-width per coordinate.");
+    OPENSIM_THROW_IF_FRMOBJ(get_order() < 0, InvalidPropertyValue,
+            getProperty_order().getName(), "Order cannot be less than 0.");
+    const int numTerms = getNumTerms(n, get_order());
+    OPENSIM_THROW_IF_FRMOBJ(getProperty_coefficients().size() != numTerms,
+            InvalidPropertyValue, getProperty_coefficients().getName(),
+            "Expected " + std::to_string(numTerms) + " coefficients for "
+            + std::to_string(n) + " coordinates and order "
+            + std::to_string(get_order()) + ", but got "
+            + std::to_string(getProperty_coefficients().size()) + ".");
+
+    _centers.resize(n);
+    _halfWidths.resize(n);
+    for (int j = 0; j < n; ++j) {
+        _centers[j] = get_coordinate_centers(j);
+        _halfWidths[j] = get_coordinate_half_widths(j);
+        OPENSIM_THROW_IF_FRMOBJ(_halfWidths[j] <= 0, InvalidPropertyValue,
+                getProperty_coordinate_half_widths().getName(),
+                "Half-widths must be greater than 0.");
+    }
+
+    _exponents.clear();
+    if (n > 0) {
+        std::vector<int> term(n);
+        for (int degree = 0; degree <= get_order(); ++degree)
+            appendExponents(0, degree, term, _exponents);
+    }
+    _coefficients.resize(numTerms);
+    for (int t = 0; t < numTerms; ++t)
+        _coefficients[t] = get_coefficients(t);
+}
+
+void GeometryPathSurrogate::extendConnectToModel(Model& model)
+{
+    Super::extendConnectToModel(model);
+
+    _coordinates.clear();
+    for (int j = 0; j < getNumCoordinates(); ++j) {
+        _coordinates.emplace_back(
+                &model.getComponent<Coordinate>(get_coordinates(j)));
+    }
+}
+
+//=============================================================================
+// EVALUATION
+//=============================================================================
+void GeometryPathSurrogate::calcPowers(const double* q, double* powers) const
+{
+    const int stride = get_order() + 1;
+    for (int j = 0; j < getNumCoordinates(); ++j) {
+        const double x = (q[j] - _centers[j]) / _halfWidths[j];
+        double* p = powers + j * stride;
+        p[0] = 1.0;
+        for (int k = 1; k < stride; ++k) p[k] = p[k - 1] * x;
+    }
+}
+
+double GeometryPathSurrogate::calcLength(const double* q, double* dldq) const
+{
+    const int n = getNumCoordinates();
+    const int stride = get_order() + 1;
+    std::vector<double> powers(n * stride);
+    calcPowers(q, powers.data());
+
+    if (dldq) std::fill(dldq, dldq + n, 0.0);
+    double length = 0;
+    for (int t = 0; t < (int)_coefficients.size(); ++t) {
+        const int* e = _exponents.data() + t * n;
+        double term = _coefficients[t];
+        for (int j = 0; j < n; ++j) term *= powers[j * stride + e[j]];
+        length += term;
+
+        if (!dldq) continue;
+        for (int j = 0; j < n; ++j) {
+            if (e[j] == 0) continue;
+            double derivative = _coefficients[t] * e[j]
+                                * powers[j * stride + e[j] - 1];
+            for (int k = 0; k < n; ++k)
+                if (k != j) derivative *= powers[k * stride + e[k]];
+            dldq[j] += derivative;
+        }
+    }
+    if (dldq) {
+        for (int j = 0; j < n; ++j) dldq[j] /= _halfWidths[j];
+    }
+    return length;
+}
+
+double GeometryPathSurrogate::calcLength(
+        const SimTK::State& s, SimTK::Vector& dldq) const
+{
+    const int n = getNumCoordinates();
+    std::vector<double> q(n);
+    for (int j = 0; j < n; ++j) q[j] = _coordinates[j]->getValue(s);
+    dldq.resize(n);
+    return calcLength(q.data(), n > 0 ? &dldq[0] : nullptr);
+}
+
+void GeometryPathSurrogate::calcTerms(const double* q, double* terms,
+        double* termDerivatives) const
+{
+    const int n = getNumCoordinates();
+    const int stride = get_order() + 1;
+    std::vector<double> powers(n * stride);
+    calcPowers(q, powers.data());
+
+    for (int t = 0; t < (int)_coefficients.size(); ++t) {
+        const int* e = _exponents.data() + t * n;
+        terms[t] = 1.0;
+        for (int j = 0; j < n; ++j) terms[t] *= powers[j * stride + e[j]];
+        for (int j = 0; j < n; ++j) {
+            double& derivative = termDerivatives[t * n + j];
+            if (e[j] == 0) {
+                derivative = 0;
+                continue;
+            }
+            derivative = e[j] * powers[j * stride + e[j] - 1] / _halfWidths[j];
+            for (int k = 0; k < n; ++k)
+                if (k != j) derivative *= powers[k * stride + e[k]];
+        }
+    }
+}
+
+//=============================================================================
+// FITTING
+//=============================================================================
+void GeometryPathSurrogate::fit(Model& model, int order, int numSamples,
+        int seed, double momentArmTolerance)
+{
+    OPENSIM_THROW_IF(order < 0, Exception,
+            "Expected a nonnegative order, but got {}.", order);
+
+    ExactPathSampler sampler(model, seed);
+    const auto& paths = sampler.getPaths();
+    const auto& coordinates = sampler.getCoordinates();
+    const SimTK::State& s = sampler.getState();
+    const int numPaths = (int)paths.size();
+    const int numCoordinates = (int)coordinates.size();
+
+    // Find the coordinates that affect each path.
+    std::vector<std::vector<int>> pathCoordinates(numPaths);
+    {
+        std::vector<std::vector<bool>> affects(numPaths,
+                std::vector<bool>(numCoordinates, false));
+        for (int k = 0; k < 20; ++k) {
+            sampler.sample();
+            for (int p = 0; p < numPaths; ++p) {
+                for (int j = 0; j < numCoordinates; ++j) {
+                    if (!affects[p][j] && std::abs(paths[p]->computeMomentArm(
+                                    s, *coordinates[j])) > momentArmTolerance)
+                        affects[p][j] = true;
+                }
+            }
+        }
+        for (int p = 0; p < numPaths; ++p) {
+            for (int j = 0; j < numCoordinates; ++j)
+                if (affects[p][j]) pathCoordinates[p].push_back(j);
+        }
+    }
+
+    if (numSamples <= 0) {
+        int maxNumTerms = 1;
+        for (const auto& pc : pathCoordinates) {
+            maxNumTerms = std::max(maxNumTerms,
+                    getNumTerms((int)pc.size(), order));
+        }
+        numSamples = 3 * maxNumTerms;
+    }
+
+    // Sample the exact values; for each sample and path, store the values of
+    // the coordinates of the path, the length, and the moment arm about each
+    // coordinate of the path.
+    std::vector<std::vector<double>> samples(numPaths);
+    for (int k = 0; k < numSamples; ++k) {
+        sampler.sample();
+        for (int p = 0; p < numPaths; ++p) {
+            for (int j : pathCoordinates[p])
+                samples[p].push_back(coordinates[j]->getValue(s));
+            samples[p].push_back(paths[p]->getLength(s));
+            for (int j : pathCoordinates[p]) {
+                samples[p].push_back(
+                        paths[p]->computeMomentArm(s, *coordinates[j]));
+            }
+        }
+    }
+
+    // Collect the paths of the model first: setting a surrogate changes the
+    // subcomponents of its path.
+    std::vector<GeometryPath*> modelPaths;
+    for (auto& path : model.updComponentList<GeometryPath>())
+        modelPaths.push_back(&path);
+    OPENSIM_THROW_IF((int)modelPaths.size() != numPaths, Exception,
+            "Expected the copy of the model to have {} paths, but it has {}.",
+            modelPaths.size(), numPaths);
+
+    for (int p = 0; p < numPaths; ++p) {
+        OPENSIM_THROW_IF(modelPaths[p]->getAbsolutePathString()
+                        != paths[p]->getAbsolutePathString(),
+                Exception, "Paths '{}' and '{}' do not match.",
+                modelPaths[p]->getAbsolutePathString(),
+                paths[p]->getAbsolutePathString());
+
+        const int n = (int)pathCoordinates[p].size();
+        const int numTerms = getNumTerms(n, order);
+        GeometryPathSurrogate surrogate;
+        surrogate.set_order(order);
+        for (int j : pathCoordinates[p]) {
+            const Coordinate& coord = *coordinates[j];
+            surrogate.append_coordinates(coord.getAbsolutePathString());
+            surrogate.append_coordinate_centers(
+                    0.5 * (coord.getRangeMax() + coord.getRangeMin()));
+            surrogate.append_coordinate_half_widths(std::max(
+                    0.5 * (coord.getRangeMax() - coord.getRangeMin()),
+                    SimTK::SignificantReal));
+        }
+        for (int t = 0; t < numTerms; ++t) surrogate.append_coefficients(0);
+        surrogate.finalizeFromProperties();
+
+        // Each sample gives one equation for the length and one for the
+        // moment arm about each coordinate.
+        SimTK::Matrix A((1 + n) * numSamples, numTerms);
+        SimTK::Vector b((1 + n) * numSamples);
+        std::vector<double> terms(numTerms), termDerivatives(numTerms * n);
+        for (int k = 0; k < numSamples; ++k) {
+            const double* sample = samples[p].data() + k * (1 + 2 * n);
+            surrogate.calcTerms(sample, terms.data(), termDerivatives.data());
+            const int row = k * (1 + n);
+            for (int t = 0; t < numTerms; ++t) {
+                A(row, t) = terms[t];
+                for (int j = 0; j < n; ++j)
+                    A(row + 1 + j, t) = -termDerivatives[t * n + j];
+            }
+            b[row] = sample[n];
+            for (int j = 0; j < n; ++j) b[row + 1 + j] = sample[n + 1 + j];
+        }
+        SimTK::Vector coefficients;
+        SimTK::FactorQTZ(A).solve(b, coefficients);
+        for (int t = 0; t < numTerms; ++t)
+            surrogate.upd_coefficients(t) = coefficients[t];
+
+        modelPaths[p]->setSurrogate(surrogate);
+    }
+
+    log_info("Fit surrogates of order {} to {} paths at {} configurations.",
+            order, numPaths, numSamples);
+}
+
+std::vector<GeometryPathSurrogate::Accuracy>
+GeometryPathSurrogate::calcAccuracy(const Model& model, int numSamples,
+        int seed)
+{
+    ExactPathSampler sampler(model, seed);
+    const SimTK::State& s = sampler.getState();
+
+    // The surrogate of each path of the model that has one, and the
+    // coordinates of the surrogate in the copy of the model.
+    std::vector<const GeometryPath*> exactPaths;
+    std::vector<const GeometryPathSurrogate*> surrogates;
+    std::vector<std::vector<const Coordinate*>> coordinates;
+    std::vector<Accuracy> accuracies;
+    for (const auto& path : model.getComponentList<GeometryPath>()) {
+        if (!path.hasSurrogate()) continue;
+        const auto& surrogate = path.getSurrogate();
+        exactPaths.push_back(&sampler.getModel().getComponent<GeometryPath>(
+                path.getAbsolutePathString()));
+        surrogates.push_back(&surrogate);
+        coordinates.emplace_back();
+        for (int j = 0; j < surrogate.getNumCoordinates(); ++j) {
+            coordinates.back().push_back(
+                    &sampler.getModel().getComponent<Coordinate>(
+                            surrogate.get_coordinates(j)));
+        }
+        accuracies.emplace_back();
+        accuracies.back().path = path.getAbsolutePathString();
+        accuracies.back().numSamples = numSamples;
+    }
+
+    std::vector<int> numMomentArms(surrogates.size(), 0);
+    for (int k = 0; k < numSamples; ++k) {
+        sampler.sample();
+        for (int p = 0; p < (int)surrogates.size(); ++p) {
+            const int n = (int)coordinates[p].size();
+            std::vector<double> q(n), dldq(n);
+            for (int j = 0; j < n; ++j) q[j] = coordinates[p][j]->getValue(s);
+            const double length = surrogates[p]->calcLength(q.data(),
+                    dldq.data());
+
+            Accuracy& accuracy = accuracies[p];
+            const double lengthError =
+                    std::abs(length - exactPaths[p]->getLength(s));
+            accuracy.maxLengthError =
+                    std::max(accuracy.maxLengthError, lengthError);
+            accuracy.rmsLengthError += lengthError * lengthError;
+            for (int j = 0; j < n; ++j) {
+                const double momentArmError = std::abs(-dldq[j] -
+                        exactPaths[p]->computeMomentArm(s, *coordinates[p][j]));
+                accuracy.maxMomentArmError =
+                        std::max(accuracy.maxMomentArmError, momentArmError);
+                accuracy.rmsMomentArmError += momentArmError * momentArmError;
+            }
+            numMomentArms[p] += n;
+        }
+    }
+
+    for (int p = 0; p < (int)accuracies.size(); ++p) {
+        Accuracy& accuracy = accuracies[p];
+        if (numSamples > 0) {
+            accuracy.rmsLengthError =
+                    std::sqrt(accuracy.rmsLengthError / numSamples);
+        }
+        if (numMomentArms[p] > 0) {
+            accuracy.rmsMomentArmError =
+                    std::sqrt(accuracy.rmsMomentArmError / numMomentArms[p]);
+        }
+        log_info("{}: length error max {:.3g} RMS {:.3g}; moment arm error "
+                 "max {:.3g} RMS {:.3g} ({} configurations).",
+                accuracy.path, accuracy.maxLengthError, accuracy.rmsLengthError,
+                accuracy.maxMomentArmError, accuracy.rmsMomentArmError,
+                accuracy.numSamples);
+    }
+    return accuracies;
+}
@@ -0,0 +1,183 @@
+#ifndef OPENSIM_GEOMETRY_PATH_SURROGATE_H_
+#define OPENSIM_GEOMETRY_PATH_SURROGATE_H_
+/* -------------------------------------------------------------------------- *
+ *                   OpenSim:  GeometryPathSurrogate.h                        *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Simulation/osimSimulationDLL.h>
+#include <OpenSim/Simulation/Model/ModelComponent.h>
+
+#include <vector>
+
+namespace OpenSim {
+
+class Coordinate;
+class Model;
+
+/** A polynomial that approximates the length of a GeometryPath as a function
+of the coordinates that affect it. When a GeometryPath has a surrogate, its
+length, lengthening speed, moment arms, and the generalized forces it applies
+(GeometryPath::addInEquivalentForces()) are computed from the polynomial
+instead of from its path points and wrap objects:
+
+- length: \f$ l = p(\hat{q}) \f$, where \f$ \hat{q}_j = (q_j - c_j) / h_j \f$
+  normalizes each coordinate by the center \f$ c_j \f$ and half-width
+  \f$ h_j \f$ of its fitted range;
+- moment arm about coordinate \f$ q_j \f$: \f$ -\partial l / \partial q_j \f$;
+- lengthening speed: \f$ \sum_j (\partial l / \partial q_j) \dot{q}_j \f$;
+- generalized force on coordinate \f$ q_j \f$ for a tension \f$ T \f$:
+  \f$ -T\, \partial l / \partial q_j \f$.
+
+The polynomial has all terms up to a total degree of `order`, in graded
+lexicographic order of their exponents (e.g., for two coordinates and order 2:
+1, q1, q0, q1^2, q0 q1, q0^2).
+
+Surrogates are generated offline with fit(), which samples each independent
+coordinate of the model uniformly within its range, computes the exact length
+and moment arms of each path, determines which coordinates affect each path,
+and fits the coefficients to the lengths and moment arms by least squares.
+They are saved with the model. Use calcAccuracy() to compare the surrogates
+against the exact paths at configurations other than those used for fitting:
+
+@code
+Model model("subject01.osim");
+model.initSystem();
+GeometryPathSurrogate::fit(model, 5);
+SimTK::State& state = model.initSystem();
+for (const auto& accuracy : GeometryPathSurrogate::calcAccuracy(model, 500))
+    std::cout << accuracy.path << ": " << accuracy.maxLengthError << std::endl;
+model.print("subject01_surrogate.osim");
+@endcode
+
+A surrogate is only valid within the fitted coordinate ranges, for the
+locked coordinates at their values when fitted, and for the geometry of the
+model when fitted; Model::scale() removes the surrogates of all paths.
+Path-based components that apply forces along the points of the path
+(Ligament and PathSpring) still do so, and the points of the path are still
+computed, on demand, for visualization and GeometryPath::getCurrentPath(). */
+class OSIMSIMULATION_API GeometryPathSurrogate : public ModelComponent {
+OpenSim_DECLARE_CONCRETE_OBJECT(GeometryPathSurrogate, ModelComponent);
+public:
+//=============================================================================
+// PROPERTIES
+//=============================================================================
+    OpenSim_DECLARE_LIST_PROPERTY(coordinates, std::string,
+        "Paths of the coordinates on which the length of the path depends.");
+    OpenSim_DECLARE_LIST_PROPERTY(coordinate_centers, double,
+        "Center of the fitted range of each coordinate.");
+    OpenSim_DECLARE_LIST_PROPERTY(coordinate_half_widths, double,
+        "Half of the width of the fitted range of each coordinate.");
+    OpenSim_DECLARE_PROPERTY(order, int,
+        "Maximum total degree of the terms of the polynomial.");
+    OpenSim_DECLARE_LIST_PROPERTY(coefficients, double,
+        "Coefficient of each term of the polynomial in the normalized "
+        "coordinates, in graded lexicographic order of the exponents.");
+
+//=============================================================================
+// METHODS
+//=============================================================================
+    GeometryPathSurrogate();
+
+    /** The number of terms of a polynomial in `numCoordinates` variables
+    with all terms up to a total degree of `order`. */
+    static int getNumTerms(int numCoordinates, int order);
+
+    int getNumCoordinates() const { return getProperty_coordinates().size(); }
+    /** The Coordinate with index `i` (available after the model has been
+    connected). */
+    const Coordinate& getCoordinate(int i) const { return *_coordinates[i]; }
+
+    /** The length of the path for the values of the coordinates in `q` (in
+    the order of the `coordinates` property), and the derivative of the
+    length with respect to each coordinate in `dldq` (if not null). */
+    double calcLength(const double* q, double* dldq = nullptr) const;
+    /** The length of the path and its derivative with respect to each
+    coordinate, for the values of the coordinates in `s`. */
+    double calcLength(const SimTK::State& s, SimTK::Vector& dldq) const;
+
+    //--------------------------------------------------------------------------
+    // FITTING
+    //--------------------------------------------------------------------------
+    /** Fit a surrogate of polynomial order `order` to each GeometryPath in
+    `model`, replacing any existing surrogates. The model must have been
+    connected (e.g., with Model::initSystem()); call Model::initSystem()
+    afterwards to use the surrogates.
+
+    The coordinates that are not locked, prescribed, or dependent are sampled
+    uniformly within their ranges (with constraints satisfied by assembling
+    the model), and the exact length and moment arms of each path are
+    computed at `numSamples` configurations (by default, three times the
+    number of terms of the largest polynomial). A coordinate affects a path
+    if the magnitude of its moment arm exceeds `momentArmTolerance` at any of
+    the first 20 configurations. */
+    static void fit(Model& model, int order = 4, int numSamples = 0,
+            int seed = 0, double momentArmTolerance = 1e-6);
+
+    /** The errors of the surrogate of one GeometryPath compared to its exact
+    length and moment arms. */
+    struct Accuracy {
+        /// The absolute path of the GeometryPath.
+        std::string path;
+        int numSamples = 0;
+        double maxLengthError = 0;
+        double rmsLengthError = 0;
+        double maxMomentArmError = 0;
+        double rmsMomentArmError = 0;
+    };
+
+    /** Compare the surrogate of each GeometryPath in `model` that has one to
+    the exact path at `numSamples` configurations, sampled as in fit() (use a
+    different `seed` than was used for fitting). The moment arms are
+    compared for the coordinates of each surrogate. The accuracy of each
+    path is also logged. The model must have been connected. */
+    static std::vector<Accuracy> calcAccuracy(const Model& model,
+            int numSamples = 200, int seed = 1);
+
+protected:
+    void extendFinalizeFromProperties() override;
+    void extendConnectToModel(Model& model) override;
+
+private:
+    void constructProperties();
+    // The value of each term of the polynomial for the coordinate values `q`,
+    // and the derivative of each term with respect to each coordinate (one
+    // row of getNumCoordinates() derivatives per term).
+    void calcTerms(const double* q, double* terms,
+            double* termDerivatives) const;
+    // The powers, from 0 to the order, of each normalized coordinate.
+    void calcPowers(const double* q, double* powers) const;
+
+    // The exponents of the normalized coordinates in each term (one row of
+    // getNumCoordinates() exponents per term).
+    std::vector<int> _exponents;
+    std::vector<double> _coefficients;
+    std::vector<double> _centers;
+    std::vector<double> _halfWidths;
+    std::vector<SimTK::ReferencePtr<const Coordinate>> _coordinates;
+
+//=============================================================================
+};  // END of class GeometryPathSurrogate
+//=============================================================================
+//=============================================================================
+
+} // end of namespace OpenSim
+
+#endif // OPENSIM_GEOMETRY_PATH_SURROGATE_H_
@@ -36,6 +36,7 @@
 #include "ControllerSet.h"
 #include "CoordinateSet.h"
 #include "ForceSet.h"
+#include "GeometryPath.h"
 #include "Ligament.h"
 #include "MarkerSet.h"
 #include "ProbeSet.h"
@@ -43,6 +44,7 @@
 #include <iostream>
 #include <string>
 
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/Constant.h>
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Common/Logger.h>
@@ -1189,6 +1191,8 @@ void Model::equilibrateMuscles(SimTK::State& state)
     for (auto& muscle : muscles) {
         if (muscle.appliesForce(state)){
             try{
+                ComponentProfiler::Scope scope(muscle.getProfiler(), muscle,
+                        "computeEquilibrium", SimTK::Stage::Velocity);
                 muscle.computeEquilibrium(state);
             }
             catch (const std::exception& e) {
@@ -1492,6 +1496,20 @@ bool Model::scale(SimTK::State& s, const ScaleSet& scaleSet,
     // Save the model's current pose.
     SimTK::Vector savedConfiguration = s.getY();
 
+    // A GeometryPathSurrogate is fit to the unscaled geometry, so compute
+    // the lengths of the paths from their points for scaling and afterwards.
+    std::vector<GeometryPath*> pathsWithSurrogates;
+    for (GeometryPath& path : updComponentList<GeometryPath>())
+        if (path.hasSurrogate()) pathsWithSurrogates.push_back(&path);
+    if (!pathsWithSurrogates.empty()) {
+        for (GeometryPath* path : pathsWithSurrogates) path->removeSurrogate();
+        log_warn("Model::scale(): removed the surrogates of {} paths; use "
+                 "GeometryPathSurrogate::fit() to fit them to the scaled "
+                 "model.", pathsWithSurrogates.size());
+        s = initSystem();
+        s.updY() = savedConfiguration;
+    }
+
     // Put the model in a default pose so that GeometryPath lengths can be
     // computed and stored. These lengths will be required for adjusting
     // properties after the rest of the model has been scaled.
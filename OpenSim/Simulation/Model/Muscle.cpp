@@ -28,6 +28,7 @@
 
 #include "GeometryPath.h"
 #include "Model.h"
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/XMLDocument.h>
 
 //=============================================================================
@@ -511,6 +512,8 @@ const Muscle::MuscleLengthInfo& Muscle::getMuscleLengthInfo(const SimTK::State&
         return getCacheVariableValue(s, _lengthInfoCV);
     }
 
+    ComponentProfiler::Scope scope(getProfiler(), *this, "calcMuscleLengthInfo",
+            SimTK::Stage::Position);
     MuscleLengthInfo& umli = updCacheVariableValue(s, _lengthInfoCV);
     calcMuscleLengthInfo(s, umli);
     markCacheVariableValid(s, _lengthInfoCV);
@@ -529,6 +532,8 @@ getFiberVelocityInfo(const SimTK::State& s) const
         return getCacheVariableValue(s, _velInfoCV);
     }
 
+    ComponentProfiler::Scope scope(getProfiler(), *this, "calcFiberVelocityInfo",
+            SimTK::Stage::Velocity);
     FiberVelocityInfo& ufvi = updCacheVariableValue(s, _velInfoCV);
     calcFiberVelocityInfo(s, ufvi);
     markCacheVariableValid(s, _velInfoCV);
@@ -548,6 +553,8 @@ getMuscleDynamicsInfo(const SimTK::State& s) const
         return getCacheVariableValue(s, _dynamicsInfoCV);
     }
 
+    ComponentProfiler::Scope scope(getProfiler(), *this, "calcMuscleDynamicsInfo",
+            SimTK::Stage::Dynamics);
     MuscleDynamicsInfo& umdi = updCacheVariableValue(s, _dynamicsInfoCV);
     calcMuscleDynamicsInfo(s, umdi);
     markCacheVariableValid(s, _dynamicsInfoCV);
@@ -566,6 +573,8 @@ getMusclePotentialEnergyInfo(const SimTK::State& s) const
         return getCacheVariableValue(s, _potentialEnergyInfoCV);
     }
 
+    ComponentProfiler::Scope scope(getProfiler(), *this, "calcMusclePotentialEnergyInfo",
+            SimTK::Stage::Velocity);
     MusclePotentialEnergyInfo& umpei = updCacheVariableValue(s, _potentialEnergyInfoCV);
     calcMusclePotentialEnergyInfo(s, umpei);
     markCacheVariableValid(s, _potentialEnergyInfoCV);
@@ -24,6 +24,7 @@
 #include "MomentArmSolver.h"
 #include "Model/PointForceDirection.h"
 #include "Model/Model.h"
+#include "Model/GeometryPath.h"
 
 using namespace std;
 using namespace SimTK;
@@ -132,6 +133,52 @@ double MomentArmSolver::solve(const State &state, const Coordinate &aCoord,
     return ~_coupling*_generalizedForces;
 }
 
+SimTK::Matrix MomentArmSolver::solve(const State &state,
+                              const std::vector<const Coordinate*>& coords,
+                              const std::vector<const GeometryPath*>& paths) const
+{
+    const int nc = int(coords.size());
+    const int np = int(paths.size());
+    Matrix momentArms(np, nc, 0.0);
+    if (nc == 0 || np == 0) return momentArms;
+
+    //Local modifiable copy of the state
+    State& s_ma = _stateCopy;
+    s_ma.updQ() = state.getQ();
+
+    // The coupling between coordinates due to constraints does not depend on
+    // the path, so compute it once for each coordinate.
+    Matrix coupling(s_ma.getNU(), nc);
+    for (int j = 0; j < nc; ++j) {
+        coupling(j) = computeCouplingVector(s_ma, *coords[j]);
+    }
+
+    // set speeds to zero
+    s_ma.updU() = 0;
+
+    const SimbodyMatterSubsystem& matter =
+        getModel().getMultibodySystem().getMatterSubsystem();
+    Vector pathDependentMobilityForces(s_ma.getNU());
+    for (int i = 0; i < np; ++i) {
+        // zero out all the forces
+        _bodyForces.setToZero();
+        pathDependentMobilityForces = 0;
+
+        // apply a tension of unity to the bodies of the path
+        paths[i]->addInEquivalentForces(s_ma, 1.0, _bodyForces,
+            pathDependentMobilityForces);
+
+        // f = ~J(q) * F, as in solve() for a single coordinate.
+        matter.multiplyBySystemJacobianTranspose(s_ma, _bodyForces,
+            _generalizedForces);
+        _generalizedForces += pathDependentMobilityForces;
+
+        // Moment-arms about all coordinates from the same generalized forces.
+        momentArms[i] = ~_generalizedForces*coupling;
+    }
+    return momentArms;
+}
+
 SimTK::Vector MomentArmSolver::computeCouplingVector(SimTK::State &state, 
         const Coordinate &coordinate) const
 {
@@ -25,6 +25,7 @@
 
 #include "Solver.h"
 #include "SimTKcommon/internal/State.h"
+#include <vector>
 
 namespace OpenSim {
 
@@ -83,6 +84,24 @@ public:
     double solve(const SimTK::State& state, const Coordinate &coordinate, 
         const Array<PointForceDirection *> &pfds) const;
 
+#ifndef SWIG
+    /** Solve for the effective moment-arms of several GeometryPaths about
+        several coordinates in one sweep. This is equivalent to calling
+        solve(state, coordinate, path) for every pair, but the constraint
+        coupling vector of each coordinate is computed only once (rather than
+        once per path) and the equivalent generalized forces of each path are
+        computed only once (rather than once per coordinate).
+    @param  state               current state of the model
+    @param  coordinates         Coordinates about which we want the moment-arms
+    @param  paths               GeometryPaths for which to calculate moment-arms
+    @return ma                  matrix of moment-arms with one row per path
+                                and one column per coordinate
+    */
+    SimTK::Matrix solve(const SimTK::State& state,
+        const std::vector<const Coordinate*>& coordinates,
+        const std::vector<const GeometryPath*>& paths) const;
+#endif
+
 private:
     // Internal state of the solver initialized as a copy of the default state
     mutable SimTK::State _stateCopy;
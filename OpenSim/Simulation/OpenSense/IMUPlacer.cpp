@@ -31,6 +31,7 @@
 #include <OpenSim/Simulation/InverseKinematicsSolver.h>
 #include <OpenSim/Simulation/MarkersReference.h>
 #include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/SimulationUtilities.h>
 
 using namespace std;
 using namespace OpenSim;
@@ -89,7 +90,9 @@ bool IMUPlacer::run(bool visualizeResults) {
     if (get_model_file().size() == 0) {
         OPENSIM_THROW(Exception, "No model file specified for IMUPlacer.");
     }
-    if (_model.empty()) { _model.reset(new Model(get_model_file())); }
+    if (_model.empty()) {
+        _model.reset(loadToolModel(get_model_file()).release());
+    }
     TimeSeriesTable_<SimTK::Quaternion> quatTable(
             get_orientation_file_for_calibration());
 
@@ -0,0 +1,302 @@
+/* -------------------------------------------------------------------------- *
+ *                OpenSim:  StreamingIMUInverseKinematics.cpp                 *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include "StreamingIMUInverseKinematics.h"
+
+#include <OpenSim/Common/Logger.h>
+#include <OpenSim/Simulation/InverseKinematicsSolver.h>
+#include <OpenSim/Simulation/Model/Model.h>
+
+#include <algorithm>
+
+using namespace OpenSim;
+
+StreamingIMUInverseKinematics::StreamingIMUInverseKinematics(
+        const Model& model, const std::vector<std::string>& sensorNames,
+        size_t bufferCapacity) :
+        _model(model.clone()), _sensorNames(sensorNames),
+        _buffer(bufferCapacity, [&]() {
+            Sample prototype;
+            prototype.orientations.resize(sensorNames.size());
+            return prototype;
+        }()) {
+    OPENSIM_THROW_IF(sensorNames.empty(), Exception,
+            "Expected at least one sensor name.");
+    _model->updAnalysisSet().setSize(0);
+    _model->finalizeFromProperties();
+    for (const auto& coord : _model->getComponentList<Coordinate>()) {
+        _coordinateNames.push_back(coord.getName());
+    }
+    _pushedSample.orientations.resize(sensorNames.size());
+}
+
+StreamingIMUInverseKinematics::~StreamingIMUInverseKinematics() {
+    if (isRunning()) {
+        try {
+            stop();
+        } catch (const std::exception& e) {
+            log_error("StreamingIMUInverseKinematics: {}", e.what());
+        }
+    }
+}
+
+void StreamingIMUInverseKinematics::throwIfRunning() const {
+    OPENSIM_THROW_IF(isRunning(), Exception,
+            "Cannot change the configuration while running; call stop() "
+            "first.");
+}
+
+void StreamingIMUInverseKinematics::setSensorToOpenSimRotations(
+        const SimTK::Vec3& rotations) {
+    throwIfRunning();
+    _sensorToOpenSim = SimTK::Rotation(
+            SimTK::BodyOrSpaceType::SpaceRotationSequence,
+            rotations[0], SimTK::XAxis, rotations[1], SimTK::YAxis,
+            rotations[2], SimTK::ZAxis);
+}
+
+void StreamingIMUInverseKinematics::setOrientationWeights(
+        const Set<OrientationWeight>& weights) {
+    throwIfRunning();
+    _orientationWeights = weights;
+}
+
+void StreamingIMUInverseKinematics::setAccuracy(double accuracy) {
+    throwIfRunning();
+    _accuracy = accuracy;
+}
+
+void StreamingIMUInverseKinematics::setSolutionListener(
+        SolutionListener listener) {
+    throwIfRunning();
+    _listener = std::move(listener);
+}
+
+void StreamingIMUInverseKinematics::start() {
+    throwIfRunning();
+
+    // Orientations cannot determine translations.
+    for (auto& coord : _model->updComponentList<Coordinate>()) {
+        if (coord.getMotionType() == Coordinate::Translational) {
+            coord.setDefaultLocked(true);
+        }
+    }
+    _state = _model->initSystem();
+
+    // The reference only provides the sensor names and weights; the
+    // orientations are given to the solver directly for each sample.
+    const int numSensors = int(_sensorNames.size());
+    TimeSeriesTable_<SimTK::Rotation> names(std::vector<double>{0.0},
+            SimTK::Matrix_<SimTK::Rotation>(1, numSensors, SimTK::Rotation()),
+            _sensorNames);
+    OrientationsReference oRefs(names, &_orientationWeights);
+    MarkersReference mRefs{};
+    SimTK::Array_<CoordinateReference> coordinateReferences;
+    _solver.reset(new InverseKinematicsSolver(
+            *_model, mRefs, oRefs, coordinateReferences));
+    _solver->setAccuracy(_accuracy);
+    _assembled = false;
+    _rotations.resize(numSensors);
+
+    {
+        std::lock_guard<std::mutex> lock(_resultMutex);
+        _latestSolution = Solution();
+        _workerStatistics = Statistics();
+    }
+    _numSamplesAccepted = 0;
+    _numSamplesDroppedBufferFull = 0;
+    _workerException = nullptr;
+    _stopRequested = false;
+    _thread = std::thread(&StreamingIMUInverseKinematics::run, this);
+}
+
+bool StreamingIMUInverseKinematics::pushSample(double time,
+        const std::vector<SimTK::Quaternion>& orientations) {
+    OPENSIM_THROW_IF(orientations.size() != _sensorNames.size(), Exception,
+            "Expected {} orientations (one per sensor), but got {}.",
+            _sensorNames.size(), orientations.size());
+    _pushedSample.time = time;
+    _pushedSample.pushTime = Clock::now();
+    // The sizes match, so this does not allocate.
+    _pushedSample.orientations = orientations;
+    if (!_buffer.push(_pushedSample)) {
+        ++_numSamplesDroppedBufferFull;
+        return false;
+    }
+    ++_numSamplesAccepted;
+    _wake.notify_one();
+    return true;
+}
+
+void StreamingIMUInverseKinematics::stop() {
+    if (!isRunning()) return;
+    {
+        std::lock_guard<std::mutex> lock(_wakeMutex);
+        _stopRequested = true;
+    }
+    _wake.notify_one();
+    _thread.join();
+    if (_workerException) {
+        auto exception = _workerException;
+        _workerException = nullptr;
+        std::rethrow_exception(exception);
+    }
+}
+
+bool StreamingIMUInverseKinematics::getLatestSolution(
+        Solution& solution) const {
+    std::lock_guard<std::mutex> lock(_resultMutex);
+    if (_workerStatistics.numSamplesSolved == 0) return false;
+    solution = _latestSolution;
+    return true;
+}
+
+StreamingIMUInverseKinematics::Statistics
+StreamingIMUInverseKinematics::getStatistics() const {
+    Statistics statistics;
+    {
+        std::lock_guard<std::mutex> lock(_resultMutex);
+        statistics = _workerStatistics;
+    }
+    statistics.numSamplesAccepted = _numSamplesAccepted;
+    statistics.numSamplesDroppedBufferFull = _numSamplesDroppedBufferFull;
+    return statistics;
+}
+
+void StreamingIMUInverseKinematics::run() {
+    // Sized like the samples in the buffer so that popping does not
+    // allocate. _pushedSample belongs to the producer thread and must not be
+    // read here.
+    Sample sample, newest;
+    sample.orientations.resize(_sensorNames.size());
+    newest.orientations.resize(_sensorNames.size());
+    try {
+        while (true) {
+            // Samples pushed before stop() was called are still processed.
+            const bool stopping = _stopRequested;
+            long long numTaken = 0;
+            while (_buffer.pop(sample)) {
+                std::swap(sample, newest);
+                ++numTaken;
+            }
+            if (numTaken == 0) {
+                if (stopping) break;
+                std::unique_lock<std::mutex> lock(_wakeMutex);
+                // The timeout covers a sample pushed between pop() and
+                // wait(), since pushSample() does not take the lock.
+                _wake.wait_for(lock, std::chrono::milliseconds(1), [this] {
+                    return _stopRequested || !_buffer.empty();
+                });
+                continue;
+            }
+            {
+                std::lock_guard<std::mutex> lock(_resultMutex);
+                _workerStatistics.numSamplesSkipped += numTaken - 1;
+            }
+            solve(newest);
+        }
+    } catch (...) {
+        _workerException = std::current_exception();
+    }
+}
+
+void StreamingIMUInverseKinematics::solve(const Sample& sample) {
+    for (int i = 0; i < int(_rotations.size()); ++i) {
+        _rotations[i] = _sensorToOpenSim *
+                SimTK::Rotation(sample.orientations[i]);
+    }
+    _solver->setOrientationValues(_rotations);
+    _state.updTime() = sample.time;
+    try {
+        // Each solution is the initial guess for the next sample.
+        if (_assembled) {
+            _solver->track(_state);
+        } else {
+            _solver->assemble(_state);
+            _assembled = true;
+        }
+    } catch (const std::exception& e) {
+        log_warn("StreamingIMUInverseKinematics: failed to solve the sample "
+                 "at time {}: {}", sample.time, e.what());
+        // Start over from the next sample.
+        _assembled = false;
+        std::lock_guard<std::mutex> lock(_resultMutex);
+        ++_workerStatistics.numSolverFailures;
+        return;
+    }
+
+    Solution solution;
+    solution.time = sample.time;
+    solution.coordinateValues.resize(int(_coordinateNames.size()));
+    int i = 0;
+    for (const auto& coord : _model->getComponentList<Coordinate>()) {
+        solution.coordinateValues[i++] = coord.getValue(_state);
+    }
+    solution.latency =
+            std::chrono::duration<double>(Clock::now() - sample.pushTime)
+                    .count();
+    {
+        std::lock_guard<std::mutex> lock(_resultMutex);
+        _latestSolution = solution;
+        auto& stats = _workerStatistics;
+        ++stats.numSamplesSolved;
+        stats.maxLatency = std::max(stats.maxLatency, solution.latency);
+        stats.meanLatency += (solution.latency - stats.meanLatency) /
+                             double(stats.numSamplesSolved);
+    }
+    if (_listener) _listener(solution);
+}
+
+IMUOrientationsReplay::IMUOrientationsReplay(
+        const TimeSeriesTable_<SimTK::Quaternion>& orientations) :
+        _orientations(orientations) {}
+
+int IMUOrientationsReplay::run(StreamingIMUInverseKinematics& ik) const {
+    OPENSIM_THROW_IF(!ik.isRunning(), Exception,
+            "Expected the StreamingIMUInverseKinematics to be started.");
+    OPENSIM_THROW_IF(_realTimeFactor <= 0, Exception,
+            "Expected a positive real-time factor, but got {}.",
+            _realTimeFactor);
+    std::vector<size_t> columns;
+    for (const auto& name : ik.getSensorNames()) {
+        columns.push_back(_orientations.getColumnIndex(name));
+    }
+    const auto& times = _orientations.getIndependentColumn();
+    std::vector<SimTK::Quaternion> sample(columns.size());
+    const auto startTime = std::chrono::steady_clock::now();
+    int numAccepted = 0;
+    for (size_t irow = 0; irow < times.size(); ++irow) {
+        if (!SimTK::isInf(_realTimeFactor)) {
+            const double elapsed = (times[irow] - times[0]) / _realTimeFactor;
+            std::this_thread::sleep_until(startTime +
+                    std::chrono::duration_cast<
+                            std::chrono::steady_clock::duration>(
+                            std::chrono::duration<double>(elapsed)));
+        }
+        const auto row = _orientations.getRowAtIndex(irow);
+        for (size_t i = 0; i < columns.size(); ++i) {
+            sample[i] = row[int(columns[i])];
+        }
+        if (ik.pushSample(times[irow], sample)) ++numAccepted;
+    }
+    return numAccepted;
+}
@@ -0,0 +1,233 @@
+#ifndef OPENSIM_STREAMING_IMU_INVERSE_KINEMATICS_H_
+#define OPENSIM_STREAMING_IMU_INVERSE_KINEMATICS_H_
+/* -------------------------------------------------------------------------- *
+ *                 OpenSim:  StreamingIMUInverseKinematics.h                  *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+#include <OpenSim/Common/SPSCRingBuffer.h>
+#include <OpenSim/Common/TimeSeriesTable.h>
+#include <OpenSim/Simulation/OrientationsReference.h>
+#include <OpenSim/Simulation/osimSimulationDLL.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace OpenSim {
+
+class Model;
+class InverseKinematicsSolver;
+
+/** The coordinate values solved for one orientation sample. */
+struct OSIMSIMULATION_API StreamingIMUInverseKinematicsSolution {
+    /** The time stamp of the sample. */
+    double time = SimTK::NaN;
+    /** The values of the model's coordinates, in the order of
+    StreamingIMUInverseKinematics::getCoordinateNames(). Rotational
+    coordinates are in radians. */
+    SimTK::Vector coordinateValues;
+    /** Wall-clock time between pushing the sample and publishing this
+    solution (seconds). */
+    double latency = SimTK::NaN;
+};
+
+/** What happened to the samples pushed to a StreamingIMUInverseKinematics.
+Every sample that was accepted is eventually solved, skipped, or failed:
+numSamplesAccepted = numSamplesSolved + numSamplesSkipped + numSolverFailures
+(once the engine is stopped). */
+struct OSIMSIMULATION_API StreamingIMUInverseKinematicsStatistics {
+    /** Samples added to the buffer by pushSample(). */
+    long long numSamplesAccepted = 0;
+    /** Samples rejected by pushSample() because the buffer was full. */
+    long long numSamplesDroppedBufferFull = 0;
+    /** Samples discarded because a newer sample arrived before the solver
+    was ready for them. */
+    long long numSamplesSkipped = 0;
+    /** Samples for which coordinates were published. */
+    long long numSamplesSolved = 0;
+    /** Samples for which the solver failed. */
+    long long numSolverFailures = 0;
+    /** Latency of the published solutions (seconds); see
+    StreamingIMUInverseKinematicsSolution::latency. */
+    double maxLatency = 0;
+    double meanLatency = 0;
+};
+
+/** Solve inverse kinematics for a live stream of IMU orientations.
+
+Samples (a time stamp and one quaternion per sensor) are pushed by one
+thread, e.g., the thread receiving data from the sensors, into a lock-free
+buffer; pushing never blocks. A worker thread started by start() repeatedly
+takes the newest sample in the buffer, solves for the coordinates that best
+match its orientations (InverseKinematicsSolver::track(), warm-started from
+the previous solution), and publishes the solution. Samples that arrive
+faster than they can be solved are skipped rather than queued, which bounds
+the latency of the published coordinates; dropped and skipped samples are
+counted in getStatistics().
+
+As in IMUInverseKinematicsTool, the orientations are rotated by the
+sensor-to-OpenSim rotations, each sensor is matched to the model frame with
+the same name, and translational coordinates are locked since they cannot be
+determined from orientations.
+
+@code
+StreamingIMUInverseKinematics ik(model, {"pelvis_imu", "femur_r_imu"});
+ik.setSensorToOpenSimRotations(SimTK::Vec3(-SimTK::Pi / 2, 0, 0));
+ik.setSolutionListener(
+        [](const StreamingIMUInverseKinematicsSolution& solution) {
+            // Runs on the worker thread; keep it short.
+        });
+ik.start();
+while (receiving) {
+    // ... read a packet ...
+    ik.pushSample(time, quaternions);
+}
+ik.stop();
+@endcode
+
+IMUOrientationsReplay pushes recorded orientations at the rate they were
+recorded, to test a streaming application without sensors. */
+class OSIMSIMULATION_API StreamingIMUInverseKinematics {
+public:
+    typedef StreamingIMUInverseKinematicsSolution Solution;
+    typedef StreamingIMUInverseKinematicsStatistics Statistics;
+    /** A function called (on the worker thread) with each solution. */
+    typedef std::function<void(const Solution&)> SolutionListener;
+
+    /** The model is copied. Each sample must contain one orientation for each
+    of the `sensorNames`, in the same order. The buffer holds up to
+    `bufferCapacity` samples that have not been taken by the worker thread. */
+    StreamingIMUInverseKinematics(const Model& model,
+            const std::vector<std::string>& sensorNames,
+            size_t bufferCapacity = 16);
+    /** Stops the worker thread if it is running. */
+    ~StreamingIMUInverseKinematics();
+
+    /** @name Configuration
+    These must be set before start(). @{ */
+    /** Space-fixed Euler angles (XYZ order) from the sensor frame to OpenSim
+    (see IMUInverseKinematicsTool). The default is (0, 0, 0). */
+    void setSensorToOpenSimRotations(const SimTK::Vec3& rotations);
+    /** Weights of the orientation sensors; the default weight is 1. */
+    void setOrientationWeights(const Set<OrientationWeight>& weights);
+    /** Accuracy of the solver (see AssemblySolver::setAccuracy()). The
+    default is 1e-4, as in IMUInverseKinematicsTool. */
+    void setAccuracy(double accuracy);
+    /** Called on the worker thread after each sample is solved. */
+    void setSolutionListener(SolutionListener listener);
+    /** @} */
+
+    /** Initialize the model and the solver and start the worker thread. */
+    void start();
+    /** (Producer thread) Add a sample to the buffer. Orientations are
+    expressed in the sensor's world frame.
+    @returns false if the sample was dropped because the buffer is full. */
+    bool pushSample(double time,
+            const std::vector<SimTK::Quaternion>& orientations);
+    /** Solve the newest sample in the buffer, if any, and stop the worker
+    thread. If the worker thread stopped because of an exception (e.g., thrown
+    by the solution listener), it is rethrown here. */
+    void stop();
+    bool isRunning() const { return _thread.joinable(); }
+
+    const std::vector<std::string>& getSensorNames() const
+    {   return _sensorNames; }
+    /** Names of the coordinates in each Solution. */
+    const std::vector<std::string>& getCoordinateNames() const
+    {   return _coordinateNames; }
+    /** The most recently published solution.
+    @returns false if no sample has been solved yet. */
+    bool getLatestSolution(Solution& solution) const;
+    Statistics getStatistics() const;
+
+private:
+    typedef std::chrono::steady_clock Clock;
+    struct Sample {
+        double time = SimTK::NaN;
+        Clock::time_point pushTime;
+        std::vector<SimTK::Quaternion> orientations;
+    };
+
+    void throwIfRunning() const;
+    void run();
+    void solve(const Sample& sample);
+
+    std::unique_ptr<Model> _model;
+    std::vector<std::string> _sensorNames;
+    std::vector<std::string> _coordinateNames;
+    SimTK::Rotation _sensorToOpenSim;
+    Set<OrientationWeight> _orientationWeights;
+    double _accuracy = 1e-4;
+    SolutionListener _listener;
+
+    // Accessed only by the worker thread while it is running.
+    std::unique_ptr<InverseKinematicsSolver> _solver;
+    SimTK::State _state;
+    bool _assembled = false;
+    SimTK::Array_<SimTK::Rotation> _rotations;
+
+    // Accessed only by the producer thread.
+    Sample _pushedSample;
+
+    SPSCRingBuffer<Sample> _buffer;
+    std::thread _thread;
+    std::atomic<bool> _stopRequested{false};
+    std::mutex _wakeMutex;
+    std::condition_variable _wake;
+    std::exception_ptr _workerException;
+
+    std::atomic<long long> _numSamplesAccepted{0};
+    std::atomic<long long> _numSamplesDroppedBufferFull{0};
+    // Guards the latest solution and the statistics set by the worker.
+    mutable std::mutex _resultMutex;
+    Solution _latestSolution;
+    Statistics _workerStatistics;
+};
+
+/** Push the orientations recorded in a table to a
+StreamingIMUInverseKinematics at the rate at which they were recorded, as if
+they were streamed from sensors. The columns of the table are matched to the
+sensors by label. */
+class OSIMSIMULATION_API IMUOrientationsReplay {
+public:
+    explicit IMUOrientationsReplay(
+            const TimeSeriesTable_<SimTK::Quaternion>& orientations);
+    /** Replay `factor` times faster than real time (default 1). Use
+    SimTK::Infinity to push samples as fast as possible. */
+    void setRealTimeFactor(double factor) { _realTimeFactor = factor; }
+    /** Push all samples, on this thread, waiting between samples to match
+    their time stamps. `ik` must have been started.
+    @returns the number of samples accepted by pushSample(). */
+    int run(StreamingIMUInverseKinematics& ik) const;
+
+private:
+    TimeSeriesTable_<SimTK::Quaternion> _orientations;
+    double _realTimeFactor = 1;
+};
+
+} // namespace OpenSim
+
+#endif // OPENSIM_STREAMING_IMU_INVERSE_KINEMATICS_H_
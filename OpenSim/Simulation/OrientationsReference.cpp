@@ -158,16 +158,38 @@ const SimTK::Array_<std::string>& OrientationsReference::getNames() const
 void  OrientationsReference::getValues(const SimTK::State &s,
     SimTK::Array_<Rotation> &values) const
 {
-    double time =  s.getTime();
-
-    // get values for time
-    SimTK::RowVector_<Rotation> row = _orientationData.getRow(time);
-
-    int n = row.size();
+    const double time = s.getTime();
+    _cursor = _orientationData.getRowIndexAtOrBeforeTime(time, _cursor);
+    const auto& times = _orientationData.getIndependentColumn();
+    const SimTK::Real eps = SimTK::SignificantReal;
+    OPENSIM_THROW_IF(time < times.front() - eps || time > times.back() + eps,
+                     TimeOutOfRange, time, times.front(), times.back());
+
+    const int n = int(_orientationData.getNumColumns());
     values.resize(n);
-
+    size_t row = _cursor;
+    if (row + 1 < times.size()) {
+        const double before = time - times[row];
+        const double after = times[row + 1] - time;
+        if (_interpolateValues && before > 0) {
+            const double alpha = before / (before + after);
+            const auto rowBefore = _orientationData.getRowAtIndex(row);
+            const auto rowAfter = _orientationData.getRowAtIndex(row + 1);
+            for (int i = 0; i < n; ++i) {
+                // Rotate by the fraction alpha of the rotation from one
+                // frame to the next, about its axis.
+                const Vec4 angleAxis =
+                    (~rowBefore[i] * rowAfter[i]).convertRotationToAngleAxis();
+                values[i] = rowBefore[i] * Rotation(alpha * angleAxis[0],
+                    UnitVec3(angleAxis[1], angleAxis[2], angleAxis[3]));
+            }
+            return;
+        }
+        if (after <= before) ++row;
+    }
+    const auto rowView = _orientationData.getRowAtIndex(row);
     for (int i = 0; i < n; ++i) {
-        values[i] = row[i];
+        values[i] = rowView[i];
     }
 }
 
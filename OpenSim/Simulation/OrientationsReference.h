@@ -120,7 +120,12 @@ public:
     const std::vector<double>& getTimes() const;
     /** get the names of the Orientations serving as references */
     const SimTK::Array_<std::string>& getNames() const override;
-    /** get the value of the OrientationsReference */
+    /** get the value of the OrientationsReference at the time of the state:
+    the orientations of the nearest frame or, if interpolating (see
+    setInterpolateValues()), interpolated by spherical linear interpolation
+    (slerp) between the frames before and after. The frame is found from the
+    one found by the previous call, so that successive times are found in
+    constant time, and `values` is only reallocated if it is too small. */
     void getValues(const SimTK::State& s,
         SimTK::Array_<SimTK::Rotation_<double>>& values) const override;
     /** get the weighting (importance) of meeting this OrientationsReference in the
@@ -141,6 +146,12 @@ public:
     InverseKinematicsSolver prior to solving at any instant in time. */
     void setOrientationWeightSet(const Set<OrientationWeight>& orientationWeights);
     void setDefaultWeight(double weight) { set_default_weight(weight); }
+    /** Interpolate the orientations (by slerp) for times between frames,
+    instead of using the nearest frame (the default). This allows solving at
+    times other than those of the orientation data. */
+    void setInterpolateValues(bool interpolate)
+    {   _interpolateValues = interpolate; }
+    bool getInterpolateValues() const { return _interpolateValues; }
 
 private:
     void constructProperties();
@@ -153,6 +164,10 @@ private:
     SimTK::Array_<std::string> _orientationNames;
     // corresponding list of weights guaranteed to be in the same order as names above
     SimTK::Array_<double> _weights;
+    // Whether getValues() interpolates between frames.
+    bool _interpolateValues = false;
+    // Index of the frame at or before the time of the last getValues().
+    mutable size_t _cursor = 0;
 
 //=============================================================================
 };  // END of class OrientationsReference
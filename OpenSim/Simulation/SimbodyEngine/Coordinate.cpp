@@ -644,6 +644,17 @@ void Coordinate::CoordinateStateVariable::
 }
 
 
+SimTK::SystemYIndex Coordinate::CoordinateStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    const Coordinate& owner = *((Coordinate *)&getOwner());
+    const SimbodyMatterSubsystem& matter = owner.getModel().getMatterSubsystem();
+    const MobilizedBody& mb = matter.getMobilizedBody(owner.getBodyIndex());
+    return SimTK::SystemYIndex((int)state.getQStart() +
+            (int)state.getQStart(matter.getMySubsystemIndex()) +
+            (int)mb.getFirstQIndex(state) + owner.getMobilizerQIndex());
+}
+
 //-----------------------------------------------------------------------------
 // Coordinate::SpeedStateVariable
 //-----------------------------------------------------------------------------
@@ -679,6 +690,17 @@ void Coordinate::SpeedStateVariable::
     throw Exception(msg);
 }
 
+SimTK::SystemYIndex Coordinate::SpeedStateVariable::
+    findSystemYIndex(const SimTK::State& state) const
+{
+    const Coordinate& owner = *((Coordinate *)&getOwner());
+    const SimbodyMatterSubsystem& matter = owner.getModel().getMatterSubsystem();
+    const MobilizedBody& mb = matter.getMobilizedBody(owner.getBodyIndex());
+    return SimTK::SystemYIndex((int)state.getUStart() +
+            (int)state.getUStart(matter.getMySubsystemIndex()) +
+            (int)mb.getFirstUIndex(state) + owner.getMobilizerQIndex());
+}
+
 //=============================================================================
 // XML Deserialization
 //=============================================================================
@@ -232,3 +232,16 @@ void OpenSim::updateSocketConnecteesBySearch(Model& model)
                   model.getName());
     }
 }
+
+namespace {
+    thread_local ToolModelLoader toolModelLoader;
+}
+
+std::unique_ptr<Model> OpenSim::loadToolModel(const std::string& fileName) {
+    if (toolModelLoader) return toolModelLoader(fileName);
+    return std::unique_ptr<Model>(new Model(fileName));
+}
+
+void OpenSim::setToolModelLoader(ToolModelLoader loader) {
+    toolModelLoader = std::move(loader);
+}
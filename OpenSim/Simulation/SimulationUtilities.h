@@ -29,6 +29,10 @@
 
 #include <OpenSim/Common/Storage.h>
 
+#include <functional>
+#include <memory>
+#include <string>
+
 namespace OpenSim {
 
 class Model;
@@ -124,6 +128,30 @@ void updatePre40KinematicsFilesFor40MotionType(const Model& model,
 OSIMSIMULATION_API
 void updateSocketConnecteesBySearch(Model& model);
 
+/// @name Loading the models of tools
+/// @{
+/// A function that returns a new Model given the name of a model file (as
+/// written in a tool's setup file, so it may be relative to the current
+/// working directory).
+typedef std::function<std::unique_ptr<Model>(const std::string& fileName)>
+        ToolModelLoader;
+
+/** Load the model that a tool (e.g., InverseKinematicsTool, AnalyzeTool, or
+the GenericModelMaker of ScaleTool) names in its setup file. By default, this
+constructs the Model from the file, as `new Model(fileName)` does. An
+application that runs many tools can obtain the models differently (e.g.,
+copy a model that it already loaded) by calling setToolModelLoader() on the
+thread that runs the tools. */
+OSIMSIMULATION_API
+std::unique_ptr<Model> loadToolModel(const std::string& fileName);
+
+/** %Set how loadToolModel() obtains models when it is called on the calling
+thread. Pass nullptr to restore the default (loading the model file). The
+loader is not used by other threads. */
+OSIMSIMULATION_API
+void setToolModelLoader(ToolModelLoader loader);
+/// @}
+
 } // end of namespace OpenSim
 
 #endif // OPENSIM_SIMULATION_UTILITIES_H_
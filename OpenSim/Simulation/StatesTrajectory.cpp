@@ -24,6 +24,7 @@
 #include "StatesTrajectory.h"
 
 #include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/StateVariableLayout.h>
 #include <OpenSim/Common/Storage.h>
 #include <OpenSim/Common/TableUtilities.h>
 #include <OpenSim/Simulation/Model/Model.h>
@@ -38,6 +39,10 @@ void StatesTrajectory::clear() {
     m_states.clear();
 }
 
+void StatesTrajectory::reserve(size_t numStates) {
+    m_states.reserve(numStates);
+}
+
 void StatesTrajectory::append(const SimTK::State& state) {
     if (!m_states.empty()) {
 
@@ -139,6 +144,13 @@ TimeSeriesTable StatesTrajectory::exportToTable(const Model& model,
     table.setColumnLabels(stateVars);
     size_t numDepColumns = stateVars.size();
 
+    // Look up the requested state variables once, rather than by name for
+    // each state.
+    std::vector<int> indices;
+    if (!requestedStateVars.empty() && getSize() > 0) {
+        indices = model.getStateVariableLayout(get(0)).getIndices(stateVars);
+    }
+
     // Fill up the table with the data.
     for (size_t itime = 0; itime < getSize(); ++itime) {
         const auto& state = get(itime);
@@ -149,10 +161,8 @@ TimeSeriesTable StatesTrajectory::exportToTable(const Model& model,
             // This is *much* faster than getting the values one-by-one.
             row = model.getStateVariableValues(state).transpose();
         } else {
-            for (unsigned icol = 0; icol < numDepColumns; ++icol) {
-                row[static_cast<int>(icol)] =
-                    model.getStateVariableValue(state, stateVars[icol]);
-            }
+            row = model.getStateVariableLayout(state)
+                    .getValues(state, indices).transpose();
         }
 
         table.appendRow(state.getTime(), row);
@@ -207,6 +207,9 @@ public:
     /// @{
     /** Clear all the states in the trajectory. */
     void clear();
+    /** Reserve memory for `numStates` states so that appending that many
+     * states does not reallocate. */
+    void reserve(size_t numStates);
     /** Append a SimTK::State to this trajectory.
      * This function ensures that the time in the new SimTK::State is greater
      * than or equal to the time in the last SimTK::State in the trajectory.
@@ -30,6 +30,10 @@ void StatesTrajectoryReporter::clear() {
     m_states.clear();
 }
 
+void StatesTrajectoryReporter::reserve(size_t numStates) {
+    m_states.reserve(numStates);
+}
+
 const StatesTrajectory& StatesTrajectoryReporter::getStates() const {
     return m_states;
 }
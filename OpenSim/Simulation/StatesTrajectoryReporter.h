@@ -45,6 +45,10 @@ public:
     const StatesTrajectory& getStates() const; 
     /** Clear the accumulated states. */ 
     void clear();
+    /** Reserve memory for the given number of states. This is a hint that
+     * avoids reallocation during a simulation whose number of reported
+     * states is known in advance. */
+    void reserve(size_t numStates);
 
 protected:
     // /** Clears the internal StatesTrajectory in preparation for a (new)
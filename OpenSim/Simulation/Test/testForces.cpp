@@ -45,6 +45,12 @@
 #include <OpenSim/Analyses/osimAnalyses.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <OpenSim/Simulation/osimSimulation.h>
+#include <OpenSim/Simulation/Model/ExpressionEvaluator.h>
+#include <OpenSim/Common/Stopwatch.h>
+#include <lepton/Exception.h>
+#include <lepton/ExpressionProgram.h>
+#include <lepton/ParsedExpression.h>
+#include <lepton/Parser.h>
 
 using namespace OpenSim;
 using namespace std;
@@ -70,6 +76,7 @@ void testCoordinateLimitForce();
 void testCoordinateLimitForceRotational();
 void testExpressionBasedPointToPointForce();
 void testExpressionBasedCoordinateForce();
+void testExpressionEvaluator();
 void testSerializeDeserialize();
 void testTranslationalDampingEffect(Model& osimModel, Coordinate& sliderCoord,
         double start_h, Component& componentWithDamping);
@@ -161,6 +168,12 @@ int main() {
         failures.push_back("testExpressionBasedCoordinateForce");
     }
 
+    try { testExpressionEvaluator(); }
+    catch (const std::exception& e){
+        cout << e.what() <<endl;
+        failures.push_back("testExpressionEvaluator");
+    }
+
     try { testSerializeDeserialize(); }
     catch (const std::exception& e){
         cout << e.what() <<endl;
@@ -188,6 +201,68 @@ int main() {
 // Test Cases
 //==============================================================================
 
+// Compare ExpressionEvaluator against evaluating the equivalent
+// Lepton::ExpressionProgram with a map of variable values (which is how the
+// expression-based forces used to evaluate their expressions).
+void testExpressionEvaluator() {
+    const std::vector<std::string> names{"theta_x", "theta_y", "theta_z",
+            "delta_x", "delta_y", "delta_z"};
+    const std::vector<std::string> expressions{
+            "-1.5*theta_x - 0.2*theta_x^3",
+            "-2*sin(theta_y) + 0.1*theta_x*theta_z",
+            "-3*theta_z",
+            "-100*delta_x - 1e4*delta_x^3",
+            "-50*exp(delta_y) + 50",
+            "1.0"}; // Uses none of the variables.
+
+    // The variables only need to be in the order given to the constructor.
+    ExpressionEvaluator reordered("2*a + b", {"b", "a"});
+    ASSERT_EQUAL(7.0, reordered.evaluate({1.0, 3.0}), SimTK::Eps);
+    ASSERT(reordered.getNumVariables() == 2);
+
+    // Every variable in the expression must be given a value.
+    ASSERT_THROW(Lepton::Exception, ExpressionEvaluator("2*q11 + qdot",
+            {"q1", "qdot"}));
+    ASSERT_THROW(OpenSim::Exception, ExpressionEvaluator().evaluate({}));
+
+    const int numEvals = 20000;
+    double dq[6];
+    double sumProgram = 0;
+    double sumEvaluator = 0;
+
+    Stopwatch watch;
+    for (const auto& expr : expressions) {
+        Lepton::ExpressionProgram program =
+                Lepton::Parser::parse(expr).optimize().createProgram();
+        std::map<std::string, double> vars;
+        for (int k = 0; k < numEvals; ++k) {
+            for (int i = 0; i < 6; ++i) dq[i] = 1e-4 * (k % 100) * (i + 1);
+            for (int i = 0; i < 6; ++i) vars[names[i]] = dq[i];
+            sumProgram += program.evaluate(vars);
+        }
+    }
+    const long long programNs = watch.getElapsedTimeInNs();
+
+    watch.reset();
+    for (const auto& expr : expressions) {
+        ExpressionEvaluator evaluator(expr, names);
+        // Copies must evaluate their own compiled expression.
+        ExpressionEvaluator copy = evaluator;
+        for (int k = 0; k < numEvals; ++k) {
+            for (int i = 0; i < 6; ++i) dq[i] = 1e-4 * (k % 100) * (i + 1);
+            sumEvaluator += copy.evaluate(dq);
+        }
+    }
+    const long long evaluatorNs = watch.getElapsedTimeInNs();
+
+    ASSERT_EQUAL(sumProgram, sumEvaluator,
+            1e-10 * std::max(1.0, std::abs(sumProgram)));
+    cout << "ExpressionProgram with variable map: "
+         << Stopwatch::formatNs(programNs) << endl;
+    cout << "ExpressionEvaluator: " << Stopwatch::formatNs(evaluatorNs)
+         << endl;
+}
+
 void testExpressionBasedCoordinateForce() {
     using namespace SimTK;
 
@@ -0,0 +1,157 @@
+/* -------------------------------------------------------------------------- *
+ *                OpenSim:  testGeometryPathSurrogate.cpp                     *
+ * -------------------------------------------------------------------------- *
+ * The OpenSim API is a toolkit for musculoskeletal modeling and simulation.  *
+ * See http://opensim.stanford.edu and the NOTICE file for more information.  *
+ * OpenSim is developed at Stanford University and supported by the US        *
+ * National Institutes of Health (U54 GM072970, R24 HD065690) and by DARPA    *
+ * through the Warrior Web program.                                           *
+ *                                                                            *
+ * Copyright (c) 2005-2020 Stanford University and the Authors                *
+ *                                                                            *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may    *
+ * not use this file except in compliance with the License. You may obtain a  *
+ * copy of the License at http://www.apache.org/licenses/LICENSE-2.0.         *
+ *                                                                            *
+ * Unless required by applicable law or agreed to in writing, software        *
+ * distributed under the License is distributed on an "AS IS" BASIS,          *
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.   *
+ * See the License for the specific language governing permissions and        *
+ * limitations under the License.                                             *
+ * -------------------------------------------------------------------------- */
+
+/*  Tests that the GeometryPathSurrogates fit to the paths of the arm26 model
+    approximate the exact lengths and moment arms, that the lengthening speeds
+    and generalized forces of the paths are consistent with the moment arms of
+    the surrogates, and that the surrogates are saved with the model. */
+
+#include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
+#include <OpenSim/Common/LoadOpenSimLibrary.h>
+#include <OpenSim/Common/ScaleSet.h>
+#include <OpenSim/Simulation/osimSimulation.h>
+
+using namespace OpenSim;
+using namespace std;
+
+void testTermOrder()
+{
+    ASSERT(GeometryPathSurrogate::getNumTerms(0, 4) == 1);
+    ASSERT(GeometryPathSurrogate::getNumTerms(2, 2) == 6);
+    ASSERT(GeometryPathSurrogate::getNumTerms(3, 4) == 35);
+
+    // l = 1 + 2 x1 + 3 x0 + 4 x1^2 + 5 x0 x1 + 6 x0^2, where x0 = (q0 - 1) / 2
+    // and x1 = q1.
+    GeometryPathSurrogate surrogate;
+    surrogate.set_order(2);
+    surrogate.append_coordinates("/jointset/j0/q0");
+    surrogate.append_coordinates("/jointset/j1/q1");
+    surrogate.append_coordinate_centers(1.0);
+    surrogate.append_coordinate_centers(0.0);
+    surrogate.append_coordinate_half_widths(2.0);
+    surrogate.append_coordinate_half_widths(1.0);
+    for (int t = 1; t <= 6; ++t) surrogate.append_coefficients(t);
+    surrogate.finalizeFromProperties();
+
+    const double q[2] = {2.0, 0.5};
+    const double x0 = 0.5, x1 = 0.5;
+    double dldq[2];
+    const double length = surrogate.calcLength(q, dldq);
+    ASSERT_EQUAL(1 + 2 * x1 + 3 * x0 + 4 * x1 * x1 + 5 * x0 * x1 + 6 * x0 * x0,
+            length, 1e-14);
+    ASSERT_EQUAL((3 + 5 * x1 + 12 * x0) / 2.0, dldq[0], 1e-14);
+    ASSERT_EQUAL(2 + 8 * x1 + 5 * x0, dldq[1], 1e-14);
+
+    surrogate.append_coefficients(7);
+    ASSERT_THROW(InvalidPropertyValue, surrogate.finalizeFromProperties());
+}
+
+void testFitArm26()
+{
+    Model exact("arm26.osim");
+    exact.initSystem();
+    Model model("arm26.osim");
+    model.initSystem();
+    GeometryPathSurrogate::fit(model, 6);
+    SimTK::State& s = model.initSystem();
+    SimTK::State& se = exact.updWorkingState();
+
+    for (const auto& path : model.getComponentList<GeometryPath>()) {
+        ASSERT(path.hasSurrogate());
+        ASSERT(path.getSurrogate().getNumCoordinates() > 0);
+    }
+    for (const auto& accuracy : GeometryPathSurrogate::calcAccuracy(model)) {
+        ASSERT(accuracy.numSamples == 200);
+        ASSERT(accuracy.maxLengthError < 1e-3);
+        ASSERT(accuracy.maxMomentArmError < 5e-3);
+    }
+
+    const Coordinate& shoulder = model.getCoordinateSet().get("r_shoulder_elev");
+    const Coordinate& elbow = model.getCoordinateSet().get("r_elbow_flex");
+    SimTK::Vector mobilityForces;
+    SimTK::Vector_<SimTK::SpatialVec> bodyForces;
+    for (double qs : {-0.5, 0.3, 1.2}) {
+        for (double qe : {0.2, 1.0, 2.0}) {
+            shoulder.setValue(s, qs);
+            elbow.setValue(s, qe);
+            shoulder.setSpeedValue(s, 0.7);
+            elbow.setSpeedValue(s, -1.3);
+            se.updY() = s.getY();
+            model.realizeVelocity(s);
+            exact.realizeVelocity(se);
+
+            for (const auto& path : model.getComponentList<GeometryPath>()) {
+                const auto& exactPath = exact.getComponent<GeometryPath>(
+                        path.getAbsolutePath());
+                ASSERT_EQUAL(exactPath.getLength(se), path.getLength(s), 1e-3);
+
+                const double maShoulder = path.computeMomentArm(s, shoulder);
+                const double maElbow = path.computeMomentArm(s, elbow);
+                ASSERT_EQUAL(exactPath.computeMomentArm(se,
+                        exact.getCoordinateSet().get("r_elbow_flex")),
+                        maElbow, 5e-3);
+
+                // The speed and the generalized forces are consistent with
+                // the moment arms of the surrogate.
+                ASSERT_EQUAL(-0.7 * maShoulder + 1.3 * maElbow,
+                        path.getLengtheningSpeed(s), 1e-12);
+                mobilityForces.resize(s.getNU());
+                mobilityForces.setToZero();
+                bodyForces.resize(model.getMatterSubsystem().getNumBodies());
+                bodyForces.setToZero();
+                path.addInEquivalentForces(s, 10.0, bodyForces,
+                        mobilityForces);
+                const auto& mobod = model.getMatterSubsystem()
+                        .getMobilizedBody(shoulder.getBodyIndex());
+                ASSERT_EQUAL(10.0 * maShoulder, mobod.getOneFromUPartition(s,
+                        shoulder.getMobilizerQIndex(), mobilityForces), 1e-10);
+            }
+        }
+    }
+
+    // The surrogates are saved with the model.
+    model.print("arm26_surrogate.osim");
+    Model reloaded("arm26_surrogate.osim");
+    SimTK::State& sr = reloaded.initSystem();
+    sr.updY() = s.getY();
+    reloaded.realizePosition(sr);
+    for (const auto& path : model.getComponentList<GeometryPath>()) {
+        const auto& reloadedPath = reloaded.getComponent<GeometryPath>(
+                path.getAbsolutePath());
+        ASSERT(reloadedPath.hasSurrogate());
+        ASSERT_EQUAL(path.getLength(s), reloadedPath.getLength(sr), 1e-10);
+    }
+
+    // Scaling removes the surrogates.
+    model.scale(s, ScaleSet(), true);
+    for (const auto& path : model.getComponentList<GeometryPath>())
+        ASSERT(!path.hasSurrogate());
+}
+
+int main()
+{
+    LoadOpenSimLibrary("osimActuators");
+    SimTK_START_TEST("testGeometryPathSurrogate");
+        SimTK_SUBTEST(testTermOrder);
+        SimTK_SUBTEST(testFitArm26);
+    SimTK_END_TEST();
+}
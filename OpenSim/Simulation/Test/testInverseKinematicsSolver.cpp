@@ -43,6 +43,10 @@ void testMarkersReference();
 // Verify that the orientations sensor weights are consistent with the initial
 // Set of OrientationWeights used to construct the OrientationsReference
 void testOrientationsReference();
+// Verify that the references find the nearest frame or interpolate between
+// frames for times visited in any order, and that marker weights are updated
+// when the weight properties change.
+void testReferencesAtTimesBetweenFrames();
 
 // Utility function to build a simple pendulum with markers attached
 Model* constructPendulumWithMarkers();
@@ -102,6 +106,11 @@ int main()
         cout << e.what() << endl;
         failures.push_back("testOrientationsReference");
     }
+    try { testReferencesAtTimesBetweenFrames(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testReferencesAtTimesBetweenFrames");
+    }
     try { testAccuracy(); }
     catch (const std::exception& e) {
         cout << e.what() << endl; failures.push_back("testAccuracy");
@@ -278,6 +287,89 @@ void testOrientationsReference()
     }
 }
 
+void testReferencesAtTimesBetweenFrames()
+{
+    vector<std::string> labels{ "A", "B" };
+    const int nr = 11;
+
+    // Marker B is missing at frame 3.
+    TimeSeriesTable_<SimTK::Vec3> markerData;
+    markerData.setColumnLabels(labels);
+    TimeSeriesTable_<SimTK::Rotation> orientationData;
+    orientationData.setColumnLabels(labels);
+    for (int r = 0; r < nr; ++r) {
+        SimTK::RowVector_<SimTK::Vec3> row{ 2, SimTK::Vec3(r, 2 * r, -r) };
+        if (r == 3) row[1] = SimTK::Vec3(SimTK::NaN);
+        markerData.appendRow(0.1*r, row);
+        SimTK::RowVector_<SimTK::Rotation> rotations{ 2, SimTK::Rotation() };
+        rotations[0] = SimTK::Rotation(0.2*r, SimTK::ZAxis);
+        rotations[1] = SimTK::Rotation(-0.1*r, SimTK::XAxis);
+        orientationData.appendRow(0.1*r, rotations);
+    }
+
+    MarkersReference markersRef(markerData, Set<MarkerWeight>());
+    OrientationsReference orientationsRef(orientationData);
+
+    Model model;
+    SimTK::State& s = model.initSystem();
+    SimTK::Array_<SimTK::Vec3> markers;
+    SimTK::Array_<SimTK::Rotation> orientations;
+
+    // By default, the nearest frame is used, in any order of times.
+    for (double time : { 0.0, 0.04, 0.06, 0.74, 0.26, 0.96, 1.0, 0.5 }) {
+        s.updTime() = time;
+        const double frame = std::round(10 * time);
+        markersRef.getValues(s, markers);
+        SimTK_ASSERT_ALWAYS(markers.size() == 2 &&
+            markers[0] == SimTK::Vec3(frame, 2 * frame, -frame),
+            "MarkersReference did not return the nearest frame.");
+        orientationsRef.getValues(s, orientations);
+        SimTK_ASSERT_ALWAYS(orientations.size() == 2 &&
+            orientations[0].isSameRotationToWithinAngle(
+                SimTK::Rotation(0.2*frame, SimTK::ZAxis), 1e-12),
+            "OrientationsReference did not return the nearest frame.");
+    }
+
+    markersRef.setInterpolateValues(true);
+    orientationsRef.setInterpolateValues(true);
+    for (double time : { 0.0, 0.15, 0.25, 0.975, 1.0, 0.45 }) {
+        s.updTime() = time;
+        const double frame = 10 * time;
+        markersRef.getValues(s, markers);
+        SimTK_ASSERT_ALWAYS((markers[0] -
+                SimTK::Vec3(frame, 2 * frame, -frame)).norm() < 1e-12,
+            "MarkersReference did not interpolate between frames.");
+        // A marker missing from either frame is missing when interpolated.
+        SimTK_ASSERT_ALWAYS((frame > 2 && frame < 4) == markers[1].isNaN(),
+            "MarkersReference did not propagate a missing marker.");
+        orientationsRef.getValues(s, orientations);
+        SimTK_ASSERT_ALWAYS(orientations[0].isSameRotationToWithinAngle(
+                SimTK::Rotation(0.2*frame, SimTK::ZAxis), 1e-12) &&
+            orientations[1].isSameRotationToWithinAngle(
+                SimTK::Rotation(-0.1*frame, SimTK::XAxis), 1e-12),
+            "OrientationsReference did not interpolate between frames.");
+    }
+
+    s.updTime() = 1.1;
+    SimTK_TEST_MUST_THROW_EXC(markersRef.getValues(s, markers),
+        TimeOutOfRange);
+    SimTK_TEST_MUST_THROW_EXC(orientationsRef.getValues(s, orientations),
+        TimeOutOfRange);
+
+    // The weights are rebuilt when the weight properties change.
+    SimTK::Array_<double> weights;
+    markersRef.getWeights(s, weights);
+    SimTK_ASSERT_ALWAYS(weights[0] == 1.0 && weights[1] == 1.0,
+        "Expected the default marker weights.");
+    markersRef.updMarkerWeightSet().adoptAndAppend(new MarkerWeight("B", 5.0));
+    markersRef.getWeights(s, weights);
+    SimTK_ASSERT_ALWAYS(weights[0] == 1.0 && weights[1] == 5.0,
+        "Marker weights were not updated.");
+    markersRef.setDefaultWeight(2.0);
+    markersRef.getWeights(s, weights);
+    SimTK_ASSERT_ALWAYS(weights[0] == 2.0 && weights[1] == 5.0,
+        "Default marker weight was not updated.");
+}
 
 void testAccuracy()
 {
@@ -37,6 +37,10 @@ Manager Tests:
 4. testConstructors: Ensure different constructors work as intended.
 5. testIntegratorInterface: Ensure setting integrator options works as intended.
 6. testExceptions: Test that misuse actually triggers exceptions.
+7. testEnsembleManager: Integrate several members (initial states and a model
+   modification) concurrently and compare with the analytical solution.
+8. testComponentProfiler: Profile the arm26 model during a simulation and check
+   that the instrumented operations were recorded.
 
 //=============================================================================*/
 #include <OpenSim/Simulation/Model/Model.h>
@@ -44,10 +48,15 @@ Manager Tests:
 #include <OpenSim/Simulation/SimbodyEngine/FreeJoint.h>
 #include <OpenSim/Auxiliary/auxiliaryTestFunctions.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
+#include <OpenSim/Simulation/Manager/EnsembleManager.h>
 #include <OpenSim/Common/LoadOpenSimLibrary.h>
 #include <OpenSim/Simulation/Control/PrescribedController.h>
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/Constant.h>
 
+#include <cstdio>
+#include <fstream>
+
 using namespace OpenSim;
 using namespace std;
 void testStationCalcWithManager();
@@ -56,6 +65,8 @@ void testExcitationUpdatesWithManager();
 void testConstructors();
 void testIntegratorInterface();
 void testExceptions();
+void testEnsembleManager();
+void testComponentProfiler();
 
 int main()
 {
@@ -97,6 +108,18 @@ int main()
         failures.push_back("testExceptions");
     }
 
+    try { testEnsembleManager(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testEnsembleManager");
+    }
+
+    try { testComponentProfiler(); }
+    catch (const std::exception& e) {
+        cout << e.what() << endl;
+        failures.push_back("testComponentProfiler");
+    }
+
     if (!failures.empty()) {
         cout << "Done, with failure(s): " << failures << endl;
         return 1;
@@ -478,3 +501,170 @@ void testExceptions()
     manager.setIntegratorAccuracy(1e-4);
     manager.setIntegratorMinimumStepSize(0.01);
 }
+
+void testEnsembleManager()
+{
+    cout << "Running testEnsembleManager" << endl;
+
+    using SimTK::Vec3;
+
+    Model model;
+    model.setName("ball");
+    auto ball = new Body("ball", 0.7, Vec3(0.1),
+        SimTK::Inertia::sphere(0.5));
+    model.addBody(ball);
+    auto freeJoint = new FreeJoint("freeJoint", model.getGround(), Vec3(0),
+        Vec3(0), *ball, Vec3(0), Vec3(0));
+    model.addJoint(freeJoint);
+    const double g = 9.81;
+    model.setGravity(Vec3(0, -g, 0));
+    const Coordinate& sliderCoord =
+        freeJoint->getCoordinate(FreeJoint::Coord::TranslationY);
+
+    SimTK::State state = model.initSystem();
+    const double duration = 0.7;
+    const int numMembers = 7;
+
+    EnsembleManager ensemble(model);
+    ensemble.setReportingInterval(0.1);
+    std::vector<double> initHeights, initSpeeds, gravities;
+    for (int i = 0; i < numMembers; ++i) {
+        initHeights.push_back(-0.5 + 0.1 * i);
+        initSpeeds.push_back(0.3 * i);
+        sliderCoord.setValue(state, initHeights.back());
+        sliderCoord.setSpeedValue(state, initSpeeds.back());
+        gravities.push_back(g);
+        ensemble.addMember(state, duration);
+    }
+    // This member changes the model (but not the model passed in).
+    const double moonGravity = 1.62;
+    gravities.push_back(moonGravity);
+    initHeights.push_back(initHeights.back());
+    initSpeeds.push_back(initSpeeds.back());
+    ensemble.addMember(state, duration, [=](Model& m) {
+        m.setGravity(Vec3(0, -moonGravity, 0));
+    });
+    ASSERT(ensemble.getNumMembers() == numMembers + 1);
+
+    for (int numThreads : {1, 3}) {
+        ensemble.setNumThreads(numThreads);
+        std::vector<EnsembleMemberResult> results = ensemble.integrate();
+        ASSERT(results.size() == gravities.size());
+        for (int i = 0; i < (int)results.size(); ++i) {
+            const auto& states = results[i].states;
+            // Initial state, 0.1, ..., 0.6, and the final state.
+            ASSERT(states.getSize() == 8);
+            const SimTK::State& finalState = states.back();
+            SimTK_TEST_EQ(finalState.getTime(), duration);
+            SimTK_TEST_EQ(sliderCoord.getValue(finalState),
+                initHeights[i] + initSpeeds[i] * duration
+                    - 0.5 * gravities[i] * duration * duration);
+            SimTK_TEST_EQ(sliderCoord.getSpeedValue(finalState),
+                initSpeeds[i] - gravities[i] * duration);
+            ASSERT(results[i].numStepsTaken > 0);
+            ASSERT(results[i].threadIndex < numThreads);
+        }
+    }
+    // The original model is unchanged.
+    SimTK_TEST_EQ(model.getGravity(), Vec3(0, -g, 0));
+}
+
+void testComponentProfiler()
+{
+    cout << "Running testComponentProfiler" << endl;
+
+    Model model("arm26.osim");
+    ComponentProfiler profiler;
+    const std::string traceFile = "testManager_componentProfilerTrace.json";
+    profiler.setTraceFileName(traceFile);
+    model.setProfiler(&profiler);
+    SimTK::State& state = model.initSystem();
+    model.equilibrateMuscles(state);
+
+    const auto& muscle = model.getComponent<Muscle>("/forceset/BIClong");
+    ASSERT(model.getProfiler() == &profiler);
+    ASSERT(muscle.getProfiler() == &profiler);
+    ASSERT(muscle.getGeometryPath().getProfiler() == &profiler);
+
+    std::remove(traceFile.c_str());
+    Manager manager(model);
+    manager.initialize(state);
+    manager.integrate(0.05);
+    // integrate() does not write the trace; dump() does.
+    ASSERT(!std::ifstream(traceFile).good());
+
+    auto findEntry = [&](const std::string& path,
+            const std::string& operation) -> ComponentProfilerEntry {
+        for (const auto& entry : profiler.getEntries()) {
+            if (entry.componentPath == path && entry.operation == operation)
+                return entry;
+        }
+        throw Exception("No profiler entry for " + operation + " of " + path);
+    };
+    const std::string musclePath = "/forceset/BIClong";
+    const auto computeForce = findEntry(musclePath, "computeForce");
+    ASSERT(computeForce.stage == SimTK::Stage::Dynamics);
+    ASSERT(computeForce.numCalls > 0);
+    ASSERT(computeForce.selfTime <= computeForce.totalTime);
+    ASSERT(computeForce.maxTime <= computeForce.totalTime);
+    const auto derivatives =
+            findEntry(musclePath, "computeStateVariableDerivatives");
+    ASSERT(derivatives.stage == SimTK::Stage::Acceleration);
+    // Derivatives are computed while realizing the acceleration stage.
+    const auto realizeAcceleration =
+            findEntry(musclePath, "realizeAcceleration");
+    ASSERT(realizeAcceleration.numCalls == derivatives.numCalls);
+    ASSERT(derivatives.totalTime <= realizeAcceleration.totalTime);
+    ASSERT(findEntry(musclePath, "computeEquilibrium").numCalls == 1);
+    ASSERT(findEntry(musclePath, "calcMuscleLengthInfo").numCalls > 0);
+    ASSERT(findEntry(
+            muscle.getGeometryPath().getAbsolutePathString(), "computePath")
+            .stage == SimTK::Stage::Position);
+
+    // The report lists the entries, and dump() writes the trace.
+    const std::string report = profiler.getReport();
+    ASSERT(report.find("computeForce") != std::string::npos);
+    ASSERT(report.find(musclePath) != std::string::npos);
+    profiler.dump();
+    std::ifstream trace(traceFile);
+    ASSERT(trace.good());
+    std::string traceStart(15, ' ');
+    trace.read(&traceStart[0], traceStart.size());
+    ASSERT(traceStart == "{\"traceEvents\":");
+
+    // Copies of the model are not profiled.
+    Model copy(model);
+    copy.initSystem();
+    ASSERT(copy.getProfiler() == nullptr);
+    ASSERT(copy.getComponent<Muscle>(musclePath).getProfiler() == nullptr);
+
+    // Stop profiling.
+    model.setProfiler(nullptr);
+    ASSERT(muscle.getProfiler() == nullptr);
+    profiler.reset();
+    Manager manager2(model);
+    manager2.initialize(state);
+    manager2.integrate(0.1);
+    ASSERT(profiler.getEntries().empty());
+
+    // Entries are kept per component path: rebuilding the system adds to the
+    // same entries, and a renamed component gets entries under its new path.
+    model.setProfiler(&profiler);
+    model.initSystem();
+    const auto numTopologyCalls =
+            findEntry(musclePath, "realizeTopology").numCalls;
+    model.initSystem();
+    ASSERT(findEntry(musclePath, "realizeTopology").numCalls >
+            numTopologyCalls);
+    const auto numEntries = profiler.getEntries().size();
+    model.initSystem();
+    ASSERT(profiler.getEntries().size() == numEntries);
+    model.updComponent<Muscle>(musclePath).setName("BIClong_renamed");
+    const auto numRebuiltTopologyCalls =
+            findEntry(musclePath, "realizeTopology").numCalls;
+    model.initSystem();
+    ASSERT(findEntry("/forceset/BIClong_renamed", "realizeTopology")
+            .numCalls > 0);
+    ASSERT(findEntry(musclePath, "realizeTopology").numCalls ==
+            numRebuiltTopologyCalls);
+}
@@ -26,12 +26,14 @@
 #include <OpenSim/Simulation/SimbodyEngine/PinJoint.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
 #include <OpenSim/Common/LoadOpenSimLibrary.h>
+#include <OpenSim/Common/StateVariableLayout.h>
 
 using namespace OpenSim;
 using namespace std;
 
 void testModelFinalizePropertiesAndConnections();
 void testModelTopologyErrors();
+void testStateVariableLayout();
 
 int main() {
     LoadOpenSimLibrary("osimActuators");
@@ -39,6 +41,7 @@ int main() {
     SimTK_START_TEST("testModelInterface");
         SimTK_SUBTEST(testModelFinalizePropertiesAndConnections);
         SimTK_SUBTEST(testModelTopologyErrors);
+        SimTK_SUBTEST(testStateVariableLayout);
     SimTK_END_TEST();
 }
 
@@ -227,3 +230,76 @@ void testModelTopologyErrors()
 
     ASSERT_THROW(JointFramesHaveSameBaseFrame, degenerate.initSystem());
 }
+
+void testStateVariableLayout()
+{
+    Model model("arm26.osim");
+    // A locked coordinate keeps its value when the state variables are set.
+    Coordinate& elbow = model.updCoordinateSet().get("r_elbow_flex");
+    elbow.set_locked(true);
+    SimTK::State& state = model.initSystem();
+
+    const StateVariableLayout& layout = model.getStateVariableLayout(state);
+    const Array<std::string> names = model.getStateVariableNames();
+    ASSERT(layout.getNumStateVariables() == names.size());
+    ASSERT(layout.isCompatible(state));
+    ASSERT(layout.findIndex("not_a_state_variable") == -1);
+    ASSERT_THROW(OpenSim::Exception,
+            layout.getIndices({names[0], "not_a_state_variable"}));
+
+    // Coordinates and muscles store all their state variables in Y.
+    model.realizeVelocity(state);
+    const SimTK::Vector& y = state.getY();
+    for (int i = 0; i < names.size(); ++i) {
+        ASSERT(layout.getNames()[i] == names[i]);
+        ASSERT(layout.findIndex(names[i]) == i);
+        ASSERT(layout.getSystemYIndex(i).isValid());
+        const double value = model.getStateVariableValue(state, names[i]);
+        ASSERT(y[layout.getSystemYIndex(i)] == value);
+        ASSERT(layout.getValue(state, i) == value);
+    }
+
+    // Set all of the state variables.
+    const double elbowValue = elbow.getValue(state);
+    SimTK::Vector values(names.size());
+    for (int i = 0; i < names.size(); ++i) values[i] = 0.01 * (i + 1);
+    layout.setValues(state, values);
+    ASSERT(state.getSystemStage() < SimTK::Stage::Position);
+    const int elbowIndex = layout.findIndex(elbow.getAbsolutePathString() +
+                                            "/value");
+    for (int i = 0; i < names.size(); ++i) {
+        const double expected = i == elbowIndex ? elbowValue : values[i];
+        ASSERT(model.getStateVariableValue(state, names[i]) == expected);
+    }
+    SimTK::Vector allValues;
+    layout.getValues(state, allValues);
+    ASSERT(allValues.size() == names.size());
+    ASSERT(model.getStateVariableValues(state)[elbowIndex] == elbowValue);
+
+    // Set a subset of the state variables.
+    const std::vector<int> indices = layout.getIndices(
+            {"/jointset/r_shoulder/r_shoulder_elev/speed",
+             "/forceset/BIClong/activation"});
+    layout.setValues(state, indices, SimTK::Vector(2, 0.5));
+    ASSERT(model.getStateVariableValue(state,
+            "/jointset/r_shoulder/r_shoulder_elev/speed") == 0.5);
+    ASSERT(model.getStateVariableValue(state,
+            "/forceset/BIClong/activation") == 0.5);
+    SimTK::Vector subset = layout.getValues(state, indices);
+    ASSERT(subset[0] == 0.5 && subset[1] == 0.5);
+    ASSERT_THROW(OpenSim::Exception,
+            layout.setValues(state, indices, SimTK::Vector(3, 0.5)));
+
+    // The layout is the same until the System is rebuilt.
+    ASSERT(&model.getStateVariableLayout(state) == &layout);
+    model.getStateVariableValues(model.getWorkingState());
+    ASSERT(&model.getStateVariableLayout(state) == &layout);
+    SimTK::State& newState = model.initSystem();
+    const StateVariableLayout& newLayout =
+            model.getStateVariableLayout(newState);
+    ASSERT(newLayout.getNumStateVariables() == names.size());
+    newLayout.setValues(newState, values);
+    ASSERT(model.getStateVariableValue(newState,
+            "/forceset/BIClong/activation") == values[
+                    newLayout.findIndex("/forceset/BIClong/activation")]);
+}
@@ -56,6 +56,10 @@ void testMomentArmDefinitionForModel(const string &filename,
 
 void testMomentArmsAcrossCompoundJoint();
 
+void testBatchedMomentArmsMatchPairwise(const string& filename);
+
+void testPathCacheSkipsUnrelatedCoordinates();
+
 int main()
 {
     clock_t startTime = clock();
@@ -128,6 +132,13 @@ int main()
 
         testMomentArmDefinitionForModel("CoupledCoordinatesMPPsMomentArmTest.osim", "foot_angle", "vas_int_r", SimTK::Vec2(-2*SimTK::Pi/3, SimTK::Pi/18), -1.0, "Multiple moving path points: FAILED");
         cout << "Multiple moving path points coupled coordinates test: PASSED\n" << endl;
+
+        testBatchedMomentArmsMatchPairwise("testMomentArmsConstraintB.osim");
+        testBatchedMomentArmsMatchPairwise("gait2354_simbody.osim");
+        cout << "Batched moment arms of all muscles and coordinates: PASSED\n" << endl;
+
+        testPathCacheSkipsUnrelatedCoordinates();
+        cout << "Path cache skips unrelated coordinates: PASSED\n" << endl;
     }
     catch (const Exception& e) {
         e.print(cerr);
@@ -442,3 +453,84 @@ void testMomentArmDefinitionForModel(const string &filename, const string &coord
     // dL/dTheta definition or is at least dynamically consistent, in which dL/dTheta is not
     ASSERT(passesDefinition || passesDynamicConsistency, __FILE__, __LINE__, errorMessage);
 }
+
+void testBatchedMomentArmsMatchPairwise(const string& filename)
+{
+    Model model(filename);
+    SimTK::State& s = model.initSystem();
+
+    // Use a pose other than the default.
+    for (auto& coord : model.updComponentList<Coordinate>()) {
+        if (!coord.isConstrained(s) && !coord.getLocked(s)) {
+            coord.setValue(s, 0.5*(coord.getRangeMin() + coord.getRangeMax()),
+                    false);
+        }
+    }
+    model.assemble(s);
+    model.realizePosition(s);
+
+    std::vector<const Coordinate*> coords;
+    for (const auto& coord : model.getComponentList<Coordinate>())
+        coords.push_back(&coord);
+    std::vector<const GeometryPath*> paths;
+    for (const auto& muscle : model.getComponentList<Muscle>())
+        paths.push_back(&muscle.getGeometryPath());
+
+    MomentArmSolver solver(model);
+    SimTK::Matrix momentArms = solver.solve(s, coords, paths);
+    ASSERT(momentArms.nrow() == int(paths.size()));
+    ASSERT(momentArms.ncol() == int(coords.size()));
+
+    for (int i = 0; i < int(paths.size()); ++i) {
+        for (int j = 0; j < int(coords.size()); ++j) {
+            const double expected = paths[i]->computeMomentArm(s, *coords[j]);
+            ASSERT_EQUAL(expected, momentArms(i, j), 1e-10, __FILE__,
+                    __LINE__, "Batched moment arm of " + paths[i]->getName() +
+                    " about " + coords[j]->getName() +
+                    " differs from pairwise moment arm.");
+        }
+    }
+}
+
+void testPathCacheSkipsUnrelatedCoordinates()
+{
+    Model model("gait2354_simbody.osim");
+    SimTK::State& s = model.initSystem();
+    Model reference("gait2354_simbody.osim");
+
+    // vas_int_r has a moving path point that depends on knee_angle_r, and
+    // does not depend on the coordinates of the left leg.
+    const GeometryPath& path =
+            model.getMuscles().get("vas_int_r").getGeometryPath();
+    const Coordinate& kneeR = model.getCoordinateSet().get("knee_angle_r");
+    const Coordinate& hipL = model.getCoordinateSet().get("hip_flexion_l");
+
+    // The length computed from scratch in another system.
+    auto calcReferenceLength = [&]() {
+        SimTK::State& sr = reference.initSystem();
+        sr.updQ() = s.getQ();
+        reference.realizePosition(sr);
+        return reference.getMuscles().get("vas_int_r").getGeometryPath()
+                .getLength(sr);
+    };
+
+    model.realizePosition(s);
+    path.getLength(s);
+    path.resetPathCacheCounters();
+
+    hipL.setValue(s, 0.6, false);
+    model.realizePosition(s);
+    ASSERT_EQUAL(calcReferenceLength(), path.getLength(s), 1e-12);
+    ASSERT(path.getNumPathCacheHits() == 1);
+    ASSERT(path.getNumPathCacheMisses() == 0);
+
+    kneeR.setValue(s, -0.8, false);
+    model.realizePosition(s);
+    ASSERT_EQUAL(calcReferenceLength(), path.getLength(s), 1e-12);
+    ASSERT(path.getNumPathCacheHits() == 1);
+    ASSERT(path.getNumPathCacheMisses() == 1);
+
+    // The moment arm about a coordinate of the other leg reuses the path.
+    ASSERT_EQUAL(0.0, path.computeMomentArm(s, hipL), 1e-12);
+    ASSERT(path.getNumPathCacheMisses() == 1);
+}
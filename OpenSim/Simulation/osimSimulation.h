@@ -52,6 +52,7 @@
 #include "Model/ConditionalPathPoint.h"
 #include "Model/MovingPathPoint.h"
 #include "Model/GeometryPath.h"
+#include "Model/GeometryPathSurrogate.h"
 #include "Model/PrescribedForce.h"
 #include "Model/PointToPointSpring.h"
 #include "Model/ExpressionBasedPointToPointForce.h"
@@ -73,6 +74,7 @@
 #include "Model/Ground.h"
 
 #include "Manager/Manager.h"
+#include "Manager/EnsembleManager.h"
 
 #include "Control/ControlSet.h"
 #include "Control/ControlSetController.h"
@@ -124,6 +126,7 @@
 #include "StatesTrajectory.h"
 #include "StatesTrajectoryReporter.h"
 #include "OpenSense/OpenSenseUtilities.h"
+#include "OpenSense/StreamingIMUInverseKinematics.h"
 
 #include "SimulationUtilities.h"
 
@@ -21,6 +21,8 @@
  * -------------------------------------------------------------------------- */
 #include <OpenSim/Common/XMLDocument.h>
 #include "AnalyzeTool.h"
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Common/GCVSplineSet.h>
 
@@ -35,6 +37,10 @@
 #include <OpenSim/Simulation/Model/PrescribedForce.h>
 #include <OpenSim/Actuators/Thelen2003Muscle.h>
 
+#include <algorithm>
+#include <memory>
+#include <vector>
+
 using namespace OpenSim;
 using namespace std;
 
@@ -59,6 +65,7 @@ AnalyzeTool::AnalyzeTool() :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(false)
 {
@@ -79,6 +86,7 @@ AnalyzeTool::AnalyzeTool(const string &aFileName, bool aLoadModelAndInput) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(aLoadModelAndInput)
 {
@@ -111,6 +119,7 @@ AnalyzeTool::AnalyzeTool(Model& aModel) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _printResultFiles(true),
     _loadModelAndInput(false)
 {
@@ -171,6 +180,7 @@ AnalyzeTool(const AnalyzeTool &aTool) :
     _coordinatesFileName(_coordinatesFileNameProp.getValueStr()),
     _speedsFileName(_speedsFileNameProp.getValueStr()),
     _lowpassCutoffFrequency(_lowpassCutoffFrequencyProp.getValueDbl()),
+    _numThreads(_numThreadsProp.getValueInt()),
     _loadModelAndInput(false)
 {
     setNull();
@@ -191,6 +201,7 @@ setNull()
     _coordinatesFileName = "";
     _speedsFileName = "";
     _lowpassCutoffFrequency = -1.0;
+    _numThreads = 1;
 
     _statesStore = NULL;
 
@@ -236,6 +247,16 @@ void AnalyzeTool::setupProperties()
     _lowpassCutoffFrequencyProp.setName("lowpass_cutoff_frequency_for_coordinates");
     _propertySet.append( &_lowpassCutoffFrequencyProp );
 
+    comment = "Number of threads used to run the analyses that support it "
+                 "(e.g., Kinematics, BodyKinematics, MuscleAnalysis, JointReaction) on "
+                 "different time frames concurrently, each with its own copy of the model. "
+                 "With 1 (default), all frames are analyzed one after another. A value of 0 or "
+                 "less uses all available hardware threads. The results do not depend on the "
+                 "number of threads.";
+    _numThreadsProp.setComment(comment);
+    _numThreadsProp.setName("num_threads");
+    _propertySet.append( &_numThreadsProp );
+
 }
 
 
@@ -259,6 +280,7 @@ operator=(const AnalyzeTool &aTool)
     _coordinatesFileName = aTool._coordinatesFileName;
     _speedsFileName = aTool._speedsFileName;
     _lowpassCutoffFrequency= aTool._lowpassCutoffFrequency;
+    _numThreads = aTool._numThreads;
     _statesStore = aTool._statesStore;
     _printResultFiles = aTool._printResultFiles;
     return(*this);
@@ -588,7 +610,8 @@ bool AnalyzeTool::run(bool plotting)
     //}
 
     log_info("Executing the analyses from {} to {}...", ti, tf);
-    run(s, *_model, iInitial, iFinal, *_statesStore, _solveForEquilibriumForAuxiliaryStates);
+    run(s, *_model, iInitial, iFinal, *_statesStore, _solveForEquilibriumForAuxiliaryStates,
+        _numThreads);
     _model->getMultibodySystem().realize(s, SimTK::Stage::Position );
     } catch (const Exception& x) {
         x.print(cout);
@@ -606,13 +629,61 @@ bool AnalyzeTool::run(bool plotting)
 
     removeExternalLoadsFromModel();
 
+    if (ComponentProfiler* profiler = _model->getProfiler()) {
+        profiler->dump();
+    }
+
     return completed;
 }
 
 //=============================================================================
 // HELPER
 //=============================================================================
-void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium)
+namespace {
+    // Set the state to the given frame of the states storage (with the state
+    // variables that are not in the storage set to stateValues), assemble
+    // it, and optionally equilibrate the muscles.
+    void setStateToFrame(SimTK::State& s, Model& model,
+            const Storage& statesStore, int i, const Array<int>& dataToModel,
+            SimTK::Vector& stateValues, SimTK::Vector& stateData,
+            bool solveForEquilibrium)
+    {
+        statesStore.getTime(i,s.updTime()); // time
+        double t = s.getTime();
+        model.setAllControllersEnabled(true);
+
+        statesStore.getData(i,stateData.size(),&stateData[0]); // states
+        // Get data into local Vector and assign to State using common utility
+        // to handle internal (non-OpenSim) states that may exist
+
+        for (int k=0; k < dataToModel.getSize(); ++k) {
+            stateValues[dataToModel[k]] = stateData[k];
+        }
+        model.setStateVariableValues(s, stateValues);
+
+        // Adjust configuration to match constraints and other goals
+        model.assemble(s);
+
+        // equilibrateMuscles before realization as it may affect forces
+        if(solveForEquilibrium){
+            try{// might not be able to equilibrate if model is in
+                // a non-physical pose. For example, a pose where the 
+                // muscle length is shorter than the tendon slack-length.
+                // the muscle will throw an Exception in this case.
+                model.equilibrateMuscles(s);
+            }
+            catch (const std::exception& e) {
+                log_warn("AnalyzeTool::run() unable to equilibrate muscles at "
+                    "time = {}. Reason: {}.", t, e.what());
+            }
+        }
+        // Make sure model is at least ready to provide kinematics
+        model.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
+    }
+}
+
+void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal, const Storage &aStatesStore, bool aSolveForEquilibrium,
+    int numThreads)
 {
     AnalysisSet& analysisSet = aModel.updAnalysisSet();
 
@@ -622,11 +693,6 @@ void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal,
 
 
     // PERFORM THE ANALYSES
-    double /*tPrev=0.0,*/t=0.0/*,dt=0.0*/;
-    int ny = s.getNY();
-    Array<double> dydt(0.0,ny);
-    Array<double> yFromStorage(0.0,ny);
-
     const Array<string>& labels =  aStatesStore.getColumnLabels();
     int numOpenSimStates = labels.getSize()-1;
 
@@ -662,47 +728,132 @@ void AnalyzeTool::run(SimTK::State& s, Model &aModel, int iInitial, int iFinal,
     // model defaults.
     SimTK::Vector stateValues = aModel.getStateVariableValues(s);
 
-    for(int i=iInitial;i<=iFinal;i++) {
-        // tPrev = t;
-        aStatesStore.getTime(i,s.updTime()); // time
-        t = s.getTime();
-        aModel.setAllControllersEnabled(true);
+    // The analyses that can analyze the frames between the first and the last
+    // frame on other threads.
+    std::vector<int> concurrent;
+    const int numInteriorFrames = iFinal - iInitial - 1;
+    if(numInteriorFrames > 1)
+        numThreads = getNumThreadsForTasks(numThreads, numInteriorFrames);
+    else
+        numThreads = 1;
+    if(numThreads > 1) {
+        for(int i=0;i<analysisSet.getSize();i++) {
+            const Analysis& analysis = analysisSet.get(i);
+            if(analysis.getOn() && analysis.isFrameIndependent())
+                concurrent.push_back(i);
+        }
+    }
 
-        aStatesStore.getData(i,numOpenSimStates,&stateData[0]); // states
-        // Get data into local Vector and assign to State using common utility
-        // to handle internal (non-OpenSim) states that may exist
+    if(concurrent.empty()) {
+        for(int i=iInitial;i<=iFinal;i++) {
+            setStateToFrame(s, aModel, aStatesStore, i, dataToModel,
+                    stateValues, stateData, aSolveForEquilibrium);
+
+            if(i==iInitial) {
+                analysisSet.begin(s);
+            } else if(i==iFinal) {
+                analysisSet.end(s);
+            // Step
+            } else {
+                analysisSet.step(s,i);
+            }
+        }
+        return;
+    }
 
-        for (int k=0; k < nsData; ++k) {
-            stateValues[dataToModel[k]] = stateData[k];
+    setStateToFrame(s, aModel, aStatesStore, iInitial, dataToModel,
+            stateValues, stateData, aSolveForEquilibrium);
+    analysisSet.begin(s);
+
+    // Copy the model and the concurrent analyses for each thread. The forces
+    // disabled in s are also disabled in the state of each copy.
+    const ForceSet& forces = aModel.getForceSet();
+    std::vector<std::unique_ptr<Model>> models(numThreads);
+    for(int t = 0; t < numThreads; ++t) {
+        models[t].reset(aModel.clone());
+        AnalysisSet& copiedAnalyses = models[t]->updAnalysisSet();
+        copiedAnalyses.setSize(0);
+        copiedAnalyses.setMemoryOwner(true);
+        SimTK::State& state = models[t]->initSystem();
+        const ForceSet& copiedForces = models[t]->getForceSet();
+        for(int k = 0; k < forces.getSize(); ++k) {
+            copiedForces[k].setAppliesForce(state, forces[k].appliesForce(s));
         }
-        aModel.setStateVariableValues(s, stateValues);
-       
-        // Adjust configuration to match constraints and other goals
-        aModel.assemble(s);
+        for(int a : concurrent) {
+            Analysis* analysis = analysisSet.get(a).clone();
+            analysis->setModel(*models[t]);
+            analysis->setStatesStore(aStatesStore);
+            models[t]->addAnalysis(analysis);
+        }
+    }
 
-        // equilibrateMuscles before realization as it may affect forces
-        if(aSolveForEquilibrium){
-            try{// might not be able to equilibrate if model is in
-                // a non-physical pose. For example, a pose where the 
-                // muscle length is shorter than the tendon slack-length.
-                // the muscle will throw an Exception in this case.
-                aModel.equilibrateMuscles(s);
-            }
-            catch (const std::exception& e) {
-                log_warn("AnalyzeTool::run() unable to equilibrate muscles at "
-                    "time = {}. Reason: {}.", t, e.what());
+    // Each thread analyzes a contiguous block of the frames between the first
+    // and the last frame.
+    std::vector<int> blockBegins(numThreads);
+    executeInParallelBlocks(iInitial + 1, iFinal, numThreads,
+            [&](int thread, int blockBegin, int blockEnd) {
+        Model& model = *models[thread];
+        SimTK::State& state = model.updWorkingState();
+        AnalysisSet& analyses = model.updAnalysisSet();
+        SimTK::Vector values = stateValues;
+        SimTK::Vector data(numOpenSimStates);
+        blockBegins[thread] = blockBegin;
+        for(int i = blockBegin; i < blockEnd; ++i) {
+            setStateToFrame(state, model, aStatesStore, i, dataToModel,
+                    values, data, aSolveForEquilibrium);
+            if(i == blockBegin) analyses.begin(state);
+            else analyses.step(state, i);
+        }
+    });
+
+    // Append the results of the copies to those of the analyses, in order.
+    for(int t = 0; t < numThreads; ++t) {
+        AnalysisSet& copiedAnalyses = models[t]->updAnalysisSet();
+        double firstTime;
+        aStatesStore.getTime(blockBegins[t], firstTime);
+        for(int c = 0; c < (int)concurrent.size(); ++c) {
+            Analysis& analysis = analysisSet.get(concurrent[c]);
+            ArrayPtrs<Storage>& results = analysis.getStorageList();
+            ArrayPtrs<Storage>& copiedResults =
+                    copiedAnalyses.get(c).getStorageList();
+            OPENSIM_THROW_IF(results.getSize() != copiedResults.getSize(),
+                    Exception,
+                    "Analysis '{}' has {} storages but its copy has {}.",
+                    analysis.getName(), results.getSize(),
+                    copiedResults.getSize());
+            // begin() records the first frame of the block, which step()
+            // only records if it is a multiple of the step interval.
+            const bool skipFirst = !analysis.proceed(blockBegins[t]);
+            for(int k = 0; k < results.getSize(); ++k) {
+                const Storage& copied = *copiedResults[k];
+                for(int r = 0; r < copied.getSize(); ++r) {
+                    const StateVector& row = *copied.getStateVector(r);
+                    if(r == 0 && skipFirst && row.getTime() == firstTime)
+                        continue;
+                    results[k]->append(row);
+                }
             }
         }
-        // Make sure model is at least ready to provide kinematics
-        aModel.getMultibodySystem().realize(s, SimTK::Stage::Velocity);
-
-        if(i==iInitial) {
-            analysisSet.begin(s);
-        } else if(i==iFinal) {
-            analysisSet.end(s);
-        // Step
-        } else {
-            analysisSet.step(s,i);
+    }
+
+    // Step the other analyses through the frames in order.
+    std::vector<int> sequential;
+    for(int i=0;i<analysisSet.getSize();i++) {
+        if(analysisSet.get(i).getOn() &&
+                std::find(concurrent.begin(), concurrent.end(), i)
+                        == concurrent.end())
+            sequential.push_back(i);
+    }
+    if(!sequential.empty()) {
+        for(int i=iInitial+1;i<iFinal;i++) {
+            setStateToFrame(s, aModel, aStatesStore, i, dataToModel,
+                    stateValues, stateData, aSolveForEquilibrium);
+            for(int a : sequential)
+                analysisSet.get(a).step(s,i);
         }
     }
+
+    setStateToFrame(s, aModel, aStatesStore, iFinal, dataToModel,
+            stateValues, stateData, aSolveForEquilibrium);
+    analysisSet.end(s);
 }
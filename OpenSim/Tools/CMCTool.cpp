@@ -28,6 +28,7 @@
 #include "VectorFunctionForActuators.h"
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Common/GCVSplineSet.h>
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
 #include <OpenSim/Simulation/Model/CMCActuatorSubsystem.h>
@@ -848,6 +849,9 @@ bool CMCTool::run()
         return false;
     }
     time(&finishTime);
+    if (ComponentProfiler* profiler = _model->getProfiler()) {
+        profiler->dump();
+    }
     log_info("-------------------------------------------");
     log_info("Finished tracking the specified kinematics.");
     log_info("-------------------------------------------");
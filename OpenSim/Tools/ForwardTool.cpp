@@ -25,6 +25,7 @@
 //=============================================================================
 #include <OpenSim/Common/XMLDocument.h>
 #include "ForwardTool.h"
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/IO.h>
 
 #include <OpenSim/Simulation/Model/Model.h>
@@ -318,6 +319,10 @@ bool ForwardTool::run()
         completed = false;
         IO::chDir(saveWorkingDirectory);
     }
+    if (ComponentProfiler* profiler = _model->getProfiler()) {
+        profiler->dump();
+    }
+
     // PRINT RESULTS
     string fileName;
     if(_printResultFiles) printResultsInternal();
@@ -1,6 +1,7 @@
 
 #include "IMUInverseKinematicsTool.h"
 #include <OpenSim/Simulation/OpenSense/OpenSenseUtilities.h>
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Common/TimeSeriesTable.h>
 #include <OpenSim/Common/TableSource.h>
@@ -11,6 +12,7 @@
 #include <OpenSim/Simulation/Model/PhysicalOffsetFrame.h>
 #include <OpenSim/Simulation/InverseKinematicsSolver.h>
 #include <OpenSim/Simulation/OrientationsReference.h>
+#include <OpenSim/Simulation/SimulationUtilities.h>
 
 
 using namespace OpenSim;
@@ -188,6 +190,8 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
         model.getVisualizer().show(s0);
         model.getVisualizer().getSimbodyVisualizer().setShowSimTime(true);
     }
+    ProgressLogger progress("Solved", (int)times.size());
+    int numFramesDone = 0;
     for (auto time : times) {
         s0.updTime() = time;
         ikSolver.track(s0);
@@ -198,8 +202,7 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
         }
         if (visualizeResults)  
             model.getVisualizer().show(s0);
-        else
-            log_info("Solved at time: {} s", time);
+        progress.update(++numFramesDone);
         // realize to report to get reporter to pull values from model
         model.realizeReport(s0);
     }
@@ -228,6 +231,10 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
     }
     // Results written to file, clear in case we run again
     ikReporter->clearTable();
+
+    if (ComponentProfiler* profiler = model.getProfiler()) {
+        profiler->dump();
+    }
 }
 
 
@@ -235,7 +242,7 @@ void IMUInverseKinematicsTool::runInverseKinematicsWithOrientationsFromFile(
 bool IMUInverseKinematicsTool::run(bool visualizeResults)
 {
     if (_model.empty()) {
-        _model.reset(new Model(get_model_file()));
+        _model.reset(loadToolModel(get_model_file()).release());
     }
 
     runInverseKinematicsWithOrientationsFromFile(*_model,
@@ -88,6 +88,10 @@ protected:
     PropertyStr _outputBodyForcesAtJointsFileNameProp;
     std::string &_outputBodyForcesAtJointsFileName;
 
+    /** number of threads used to solve different time frames concurrently */
+    PropertyInt _numThreadsProp;
+    int &_numThreads;
+
 //=============================================================================
 // METHODS
 //=============================================================================
@@ -156,6 +160,13 @@ public:
     void setLowpassCutoffFrequency(double aFrequency) {
         _lowpassCutoffFrequency = aFrequency;
     }
+    /** Set the number of threads used to solve different time frames
+    concurrently. With 1 (the default), frames are solved one after another.
+    Otherwise, each thread solves a contiguous block of frames with its own
+    copy of the model; a value of 0 or less uses all available hardware
+    threads. The results do not depend on the number of threads. */
+    void setNumThreads(int numThreads) { _numThreads = numThreads; }
+    int getNumThreads() const { return _numThreads; }
     //--------------------------------------------------------------------------
     // INTERFACE
     //--------------------------------------------------------------------------
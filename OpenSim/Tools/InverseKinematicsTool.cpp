@@ -30,6 +30,8 @@
 #include "IKTaskSet.h"
 
 #include <OpenSim/Analyses/Kinematics.h>
+#include <OpenSim/Common/CommonUtilities.h>
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/Constant.h>
 #include <OpenSim/Common/FunctionSet.h>
 #include <OpenSim/Common/GCVSplineSet.h>
@@ -39,11 +41,90 @@
 #include <OpenSim/Common/XMLDocument.h>
 #include <OpenSim/Simulation/InverseKinematicsSolver.h>
 #include <OpenSim/Simulation/Model/Model.h>
+#include <OpenSim/Simulation/SimulationUtilities.h>
 
 using namespace OpenSim;
 using namespace std;
 using namespace SimTK;
 
+namespace {
+    // Number of frames preceding each time window that a worker tracks (and
+    // discards) so that the first frame of the window is solved from a
+    // configuration as close as possible to that of the serial solver.
+    const int numWarmStartFrames = 5;
+
+    // The solution of a single frame computed by a worker thread.
+    struct IKFrameSolution {
+        SimTK::Vector q;
+        SimTK::Array_<double> squaredMarkerErrors;
+        SimTK::Array_<SimTK::Vec3> markerLocations;
+        int numIterations = 0;
+    };
+
+    // Solve frames [start_ix, final_ix] by splitting them into contiguous
+    // time windows, one per thread. Each thread has its own copy of the model,
+    // references, and InverseKinematicsSolver.
+    std::vector<IKFrameSolution> solveFramesInParallel(const Model& model,
+            const MarkersReference& markersReference,
+            const SimTK::Array_<CoordinateReference>& coordinateReferences,
+            double constraintWeight, double accuracy,
+            bool useLevenbergMarquardt, const std::vector<double>& times,
+            int start_ix, int final_ix, int numThreads, bool reportErrors,
+            bool reportLocations) {
+        const int Nframes = final_ix - start_ix + 1;
+        std::vector<IKFrameSolution> solutions(Nframes);
+
+        // Copying the model is not thread-safe, so the copies are created
+        // up front.
+        std::vector<std::unique_ptr<Model>> models;
+        for (int ithread = 0; ithread < numThreads; ++ithread) {
+            models.emplace_back(model.clone());
+            models.back()->updAnalysisSet().setSize(0);
+        }
+
+        executeInParallelBlocks(start_ix, final_ix + 1, numThreads,
+                [&](int ithread, int blockBegin, int blockEnd) {
+            Model& workerModel = *models[ithread];
+            SimTK::State& s = workerModel.initSystem();
+            MarkersReference workerMarkersReference(markersReference);
+            SimTK::Array_<CoordinateReference> workerCoordinateReferences(
+                    coordinateReferences);
+            InverseKinematicsSolver ikSolver(workerModel,
+                    workerMarkersReference, workerCoordinateReferences,
+                    constraintWeight);
+            ikSolver.setAccuracy(accuracy);
+            ikSolver.setUseLevenbergMarquardt(useLevenbergMarquardt);
+
+            const int warmStart_ix =
+                    std::max(start_ix, blockBegin - numWarmStartFrames);
+            s.updTime() = times[warmStart_ix];
+            ikSolver.assemble(s);
+
+            const int nm = ikSolver.getNumMarkersInUse();
+            for (int i = warmStart_ix; i < blockEnd; ++i) {
+                s.updTime() = times[i];
+                ikSolver.track(s);
+                if (i < blockBegin) continue;
+
+                IKFrameSolution& solution = solutions[i - start_ix];
+                solution.q = s.getQ();
+                solution.numIterations = ikSolver.getNumIterations();
+                if (reportErrors) {
+                    solution.squaredMarkerErrors.resize(nm);
+                    ikSolver.computeCurrentSquaredMarkerErrors(
+                            solution.squaredMarkerErrors);
+                }
+                if (reportLocations) {
+                    solution.markerLocations.resize(nm);
+                    ikSolver.computeCurrentMarkerLocations(
+                            solution.markerLocations);
+                }
+            }
+        });
+        return solutions;
+    }
+}
+
 //=============================================================================
 // CONSTRUCTOR(S) AND DESTRUCTOR
 //=============================================================================
@@ -88,6 +169,8 @@ void InverseKinematicsTool::constructProperties()
     constructProperty_coordinate_file("");
     constructProperty_output_motion_file("");
     constructProperty_report_marker_locations(false);
+    constructProperty_num_threads(1);
+    constructProperty_solver("assembler");
 }
 
 //=============================================================================
@@ -112,7 +195,7 @@ bool InverseKinematicsTool::run()
         if (_model.empty()) { 
             OPENSIM_THROW_IF_FRMOBJ(get_model_file().empty(), Exception,
                     "No model filename was provided.");
-            _model.reset(new Model(get_model_file())); 
+            _model.reset(loadToolModel(get_model_file()).release());
         }
         else
             modelFromFile = false;
@@ -170,10 +253,18 @@ bool InverseKinematicsTool::run()
         const int Nframes = final_ix - start_ix + 1;
         const auto& times = markersTable.getIndependentColumn();
 
+        OPENSIM_THROW_IF_FRMOBJ(get_solver() != "assembler" &&
+                get_solver() != "levenberg_marquardt", Exception,
+                "Expected solver to be 'assembler' or 'levenberg_marquardt', "
+                "but got '{}'.", get_solver());
+        const bool useLevenbergMarquardt =
+                get_solver() == "levenberg_marquardt";
+
         // create the solver given the input data
         InverseKinematicsSolver ikSolver(*_model, markersReference,
             coordinateReferences, get_constraint_weight());
         ikSolver.setAccuracy(get_accuracy());
+        ikSolver.setUseLevenbergMarquardt(useLevenbergMarquardt);
         s.updTime() = times[start_ix];
         ikSolver.assemble(s);
         kinematicsReporter->begin(s);
@@ -194,19 +285,55 @@ bool InverseKinematicsTool::run()
 
         Stopwatch watch;
 
+        // When solving in parallel, all frames are solved up front and the
+        // loop below replays the solutions through the reporters in order.
+        const int numThreads =
+                getNumThreadsForTasks(get_num_threads(), Nframes);
+        std::vector<IKFrameSolution> solutions;
+        if (numThreads > 1) {
+            log_info("Solving {} frames using {} threads.", Nframes,
+                    numThreads);
+            solutions = solveFramesInParallel(*_model, markersReference,
+                    coordinateReferences, get_constraint_weight(),
+                    get_accuracy(), useLevenbergMarquardt, times, start_ix,
+                    final_ix, numThreads, get_report_errors(),
+                    get_report_marker_locations());
+        }
+
+        const bool reportIterations =
+                ikSolver.isTrackingWithLevenbergMarquardt();
+        long long totalIterations = 0;
+        // The frames solved in parallel are only replayed below, so there is
+        // no progress to report for them.
+        ProgressLogger progress("Solved", Nframes);
         for (int i = start_ix; i <= final_ix; ++i) {
             s.updTime() = times[i];
-            ikSolver.track(s);
-            // show progress line every 1000 frames so users see progress
-            if (std::remainder(i - start_ix, 1000) == 0 && i != start_ix)
-                log_info("Solved {} frame(s)...", i - start_ix);
+            int numIterations = 0;
+            if (solutions.empty()) {
+                ikSolver.track(s);
+                numIterations = ikSolver.getNumIterations();
+            } else {
+                s.updQ() = solutions[i - start_ix].q;
+                numIterations = solutions[i - start_ix].numIterations;
+                _model->realizePosition(s);
+            }
+            totalIterations += numIterations;
+            if (reportIterations)
+                log_debug("Frame {} (t = {}):\t solved in {} iteration(s).", i,
+                    s.getTime(), numIterations);
+            if (solutions.empty()) progress.update(i - start_ix + 1);
             if(get_report_errors()){
                 Array<double> markerErrors(0.0, 3);
                 double totalSquaredMarkerError = 0.0;
                 double maxSquaredMarkerError = 0.0;
                 int worst = -1;
 
-                ikSolver.computeCurrentSquaredMarkerErrors(squaredMarkerErrors);
+                if (solutions.empty())
+                    ikSolver.computeCurrentSquaredMarkerErrors(
+                            squaredMarkerErrors);
+                else
+                    squaredMarkerErrors =
+                            solutions[i - start_ix].squaredMarkerErrors;
                 for(int j=0; j<nm; ++j){
                     totalSquaredMarkerError += squaredMarkerErrors[j];
                     if(squaredMarkerErrors[j] > maxSquaredMarkerError){
@@ -229,7 +356,10 @@ bool InverseKinematicsTool::run()
             }
 
             if(get_report_marker_locations()){
-                ikSolver.computeCurrentMarkerLocations(markerLocations);
+                if (solutions.empty())
+                    ikSolver.computeCurrentMarkerLocations(markerLocations);
+                else
+                    markerLocations = solutions[i - start_ix].markerLocations;
                 Array<double> locations(0.0, 3*nm);
                 for(int j=0; j<nm; ++j){
                     for(int k=0; k<3; ++k)
@@ -299,6 +429,13 @@ bool InverseKinematicsTool::run()
 
         log_info("InverseKinematicsTool completed {} frames in {}.", Nframes,
             watch.getElapsedTimeFormatted());
+        if (reportIterations)
+            log_info("Levenberg-Marquardt iterations per frame: {}.",
+                double(totalIterations) / Nframes);
+
+        if (ComponentProfiler* profiler = _model->getProfiler()) {
+            profiler->dump();
+        }
     }
     catch (const std::exception& ex) {
         log_error("InverseKinematicsTool Failed: {}", ex.what());
@@ -71,6 +71,20 @@ public:
             "Flag indicating whether or not to report model marker locations. "
             "Note, model marker locations are expressed in Ground.");
 
+    OpenSim_DECLARE_PROPERTY(num_threads, int,
+            "Number of threads used to solve the trial. The frames are split "
+            "into contiguous time windows, each solved by its own copy of the "
+            "model. The default (1) solves all frames serially; 0 uses all "
+            "available hardware threads.");
+
+    OpenSim_DECLARE_PROPERTY(solver, std::string,
+            "Solver used to track the frames after the first, which is always "
+            "assembled with the SimTK::Assembler: 'assembler' (default) or "
+            "'levenberg_marquardt', which is specialized for markers and "
+            "coordinate tasks and reports the number of iterations per frame. "
+            "Models with enforced constraints, prescribed coordinates, or "
+            "quaternions are always tracked with the assembler.");
+
 //=============================================================================
 // METHODS
 //=============================================================================
@@ -102,6 +116,12 @@ public:
 
     IKTaskSet& getIKTaskSet() { return upd_IKTaskSet(); }
 
+    void setNumThreads(int numThreads) { upd_num_threads() = numThreads; }
+    int getNumThreads() const { return get_num_threads(); }
+
+    void setSolver(const std::string& solver) { upd_solver() = solver; }
+    const std::string& getSolver() const { return get_solver(); }
+
     //--------------------------------------------------------------------------
     // INTERFACE
     //--------------------------------------------------------------------------
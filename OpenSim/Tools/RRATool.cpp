@@ -27,6 +27,7 @@
 #include "ActuatorForceTargetFast.h"
 #include "AnalyzeTool.h"
 #include "VectorFunctionForActuators.h"
+#include <OpenSim/Common/ComponentProfiler.h>
 #include <OpenSim/Common/IO.h>
 #include <OpenSim/Simulation/Model/Model.h>
 #include <OpenSim/Simulation/Manager/Manager.h>
@@ -837,6 +838,9 @@ bool RRATool::run()
         return false;
     }
     time(&finishTime);
+    if (ComponentProfiler* profiler = _model->getProfiler()) {
+        profiler->dump();
+    }
     log_info("-------------------------------------------");
     log_info("Finished tracking the specified kinematics:");
     log_info("-------------------------------------------");